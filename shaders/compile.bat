@@ -1,3 +1,7 @@
 C:/VulkanSDK/1.3.268.0/Bin/glslc.exe shader.vert -o vert.spv
+C:/VulkanSDK/1.3.268.0/Bin/glslc.exe shader_quantized.vert -o vert_quantized.spv
 C:/VulkanSDK/1.3.268.0/Bin/glslc.exe shader.frag -o frag.spv
+C:/VulkanSDK/1.3.268.0/Bin/glslc.exe depth.vert -o depth.spv
+C:/VulkanSDK/1.3.268.0/Bin/glslc.exe depth_quantized.vert -o depth_quantized.spv
+C:/VulkanSDK/1.3.268.0/Bin/glslc.exe meshlet_cull.comp -o cull.spv
 pause
\ No newline at end of file
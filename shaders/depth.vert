@@ -0,0 +1,18 @@
+#version 450
+
+// Uniform Buffer Object containing matrices (the prefix of shader.vert's block)
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// Position stream only (VERTEX_STREAM_POSITION)
+layout(location = 0) in vec3 inPosition;
+
+// Must match shader.vert bit for bit, or the main pass fails its LESS_OR_EQUAL test
+invariant gl_Position;
+
+void main() {
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+}
@@ -0,0 +1,21 @@
+#version 450
+
+// Uniform Buffer Object containing matrices and the mesh's dequantization
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    vec4 positionScale;  // Bounding box extent (xyz)
+    vec4 positionOffset; // Bounding box minimum (xyz)
+} ubo;
+
+// Position stream only (VERTEX_STREAM_POSITION), 0..1 within the bounding box (UNORM16)
+layout(location = 0) in vec4 inPosition;
+
+// Must match shader_quantized.vert bit for bit, or the main pass fails its LESS_OR_EQUAL test
+invariant gl_Position;
+
+void main() {
+    vec3 position = ubo.positionOffset.xyz + ubo.positionScale.xyz * inPosition.xyz;
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 1.0);
+}
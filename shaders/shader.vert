@@ -17,6 +17,9 @@ layout(location = 0) out vec3 outPosition;
 layout(location = 1) out vec3 outNormal;
 layout(location = 2) out vec3 outColor;
 
+// Matches the depth prepass shaders exactly (depth.vert, depth_quantized.vert)
+invariant gl_Position;
+
 void main() {
     // Calculate final position in clip space
     gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
@@ -0,0 +1,41 @@
+#version 450
+
+// Uniform Buffer Object containing matrices and the mesh's dequantization
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    vec4 positionScale;  // Bounding box extent (xyz)
+    vec4 positionOffset; // Bounding box minimum (xyz)
+} ubo;
+
+// Input attributes from the quantized vertex buffer (QuantizedVertex)
+layout(location = 0) in vec4 inPosition; // 0..1 within the bounding box (UNORM16)
+layout(location = 1) in vec2 inNormal;   // Octahedral (SNORM16)
+layout(location = 2) in vec4 inColor;    // RGBA8
+
+// Output to fragment shader
+layout(location = 0) out vec3 outPosition;
+layout(location = 1) out vec3 outNormal;
+layout(location = 2) out vec3 outColor;
+
+// Matches the depth prepass shaders exactly (depth.vert, depth_quantized.vert)
+invariant gl_Position;
+
+// Octahedral decoding (inverse of VertexQuantizer::encodeOctahedral)
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float fold = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -fold : fold;
+    n.y += n.y >= 0.0 ? -fold : fold;
+    return normalize(n);
+}
+
+void main() {
+    // Dequantize into model space, then transform as in shader.vert
+    vec3 position = ubo.positionOffset.xyz + ubo.positionScale.xyz * inPosition.xyz;
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(position, 1.0);
+    outColor = inColor.rgb;
+    outNormal = decodeOctahedral(inNormal);
+    outPosition = position;
+}
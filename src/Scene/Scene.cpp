@@ -1,14 +1,70 @@
 #include "Scene.h"
 #include "../objects/geometry/Geometry.h"
+#include "../objects/geometry/MeshSimplifier.h"
+#include "../objects/geometry/MeshOptimizer.h"
+#include "../objects/geometry/MeshletBuilder.h"
+#include "../objects/geometry/VertexQuantizer.h"
+#include "../objects/geometry/IndexPacker.h"
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <memory>
 
+namespace {
+
+// Split meshes with more than 65536 vertices into several draws so they can use 16-bit indices
+constexpr bool SPLIT_FOR_16BIT_INDICES = true;
+
+// Bump when the processing done after ObjLoader changes, so cached meshes are rebuilt
+constexpr uint64_t PROCESSING_VERSION = 4;
+
+// File formats loadMesh reads, chosen by extension (anything unknown is read as OBJ)
+enum class ModelFormat { Obj, Glb, Ply, Stl, Package };
+
+// Splits "<file>.vpak#<asset>" (or just "<file>.vpak", meaning its first asset) into its parts
+bool splitPackagePath(const std::string& path, std::string& packagePath, std::string& assetName) {
+    static const std::string EXTENSION = ".vpak";
+    const size_t hash = path.find('#');
+    packagePath = path.substr(0, hash);
+    assetName = hash == std::string::npos ? std::string() : path.substr(hash + 1);
+    return packagePath.size() >= EXTENSION.size() &&
+           packagePath.compare(packagePath.size() - EXTENSION.size(), EXTENSION.size(), EXTENSION) == 0;
+}
+
+ModelFormat modelFormat(const std::string& path) {
+    std::string packagePath, assetName;
+    if (splitPackagePath(path, packagePath, assetName)) return ModelFormat::Package;
+    const size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return ModelFormat::Obj;
+    std::string extension = path.substr(dot);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".glb") return ModelFormat::Glb;
+    if (extension == ".ply") return ModelFormat::Ply;
+    if (extension == ".stl") return ModelFormat::Stl;
+    return ModelFormat::Obj;
+}
+
+} // namespace
+
+/**
+ * @brief Stops a background load that is still running.
+ */
+Scene::~Scene() {
+    supersedeLoad();
+    reapSupersededLoads(true);
+}
+
 /**
  * @brief Initializes the scene. Generates the sphere mesh and sets the initial radius.
  *
  * Keywords: Scene Initialization, Mesh Generation
  */
-void Scene::init(const std::string& modelPath, const float scale) {
+void Scene::init(const std::string& path, const float scale) {
+    supersedeLoad();
+    modelPath = path;
+    streamed = false;
+
     // Make new geometry object, assign the loaded obj to it, pass the geometry to a mesh/object, store as a child on the scene
     // Requires a mesh class that can take a geometry and display it
     // Requires a parent-child relationship between the scene and the object
@@ -16,13 +72,312 @@ void Scene::init(const std::string& modelPath, const float scale) {
     // Also consider if loadObj should generate the geometry object or if that should be done in the scene
     // std::unique_ptr<Geometry> geometry = std::make_unique<Geometry>();
 
-    // Load the model from OBJ file
-    if (!ObjLoader::loadObj(modelPath, scale, vertices, indices)) {
-        std::cerr << "Failed to load model: " << modelPath << std::endl;
+    std::string error;
+    std::shared_ptr<const LoadedMesh> loaded = loadMesh(modelPath, scale, vertexFormat, vertexLayout, nullptr, nullptr, error);
+    if (!loaded) {
+        std::cerr << "Failed to load model: " << modelPath << " (" << error << ")" << std::endl;
         // You might want to handle this error more gracefully
         throw std::runtime_error("Failed to load model");
     }
+    mesh = std::move(loaded);
+    ++meshVersion;
+    loadState = LoadState::Ready;
+
+    resetPhysics();
+}
+
+/**
+ * @brief Starts a background model load.
+ *
+ * The worker only builds a LoadedMesh; the scene's own state is changed on the
+ * main thread in publishLoadedMesh(), so rendering never sees a half-loaded mesh.
+ * The worker only touches its LoadJob, so a superseded one can keep running after
+ * the scene has moved on.
+ *
+ * Keywords: Asynchronous Loading, Background Worker, Cancellation
+ */
+void Scene::requestModelLoad(const std::string& path, const float scale) {
+    // A newer request supersedes the older one, which is cancelled rather than waited for
+    supersedeLoad();
+    reapSupersededLoads(false);
+
+    modelPath = path;
+    streamed = false;
+    loadError.clear();
+    loadState = LoadState::Loading;
+
+    const std::shared_ptr<LoadJob> job = std::make_shared<LoadJob>();
+    const VertexFormat format = vertexFormat;
+    const VertexLayout layout = vertexLayout;
+    load.job = job;
+    load.thread = std::thread([job, path, scale, format, layout]() {
+        std::string error;
+        std::shared_ptr<const LoadedMesh> loaded = loadMesh(path, scale, format, layout,
+            [&job](float fraction) {
+                // Workers report out of order; progress only moves forward
+                float current = job->progress.load();
+                while (fraction > current && !job->progress.compare_exchange_weak(current, fraction)) {}
+            },
+            &job->cancelled, error);
+
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->mesh = std::move(loaded);
+            job->error = error;
+        }
+        job->finished = true;
+    });
+}
+
+/**
+ * @brief Loads a model, preferring its binary cache.
+ *
+ * Keywords: Mesh Cache, Model Loading
+ */
+std::shared_ptr<const LoadedMesh> Scene::loadMesh(const std::string& path, float scale, VertexFormat format,
+                                                  VertexLayout layout, const std::function<void(float)>& progress,
+                                                  const std::atomic<bool>* cancelled, std::string& error) {
+    auto loaded = std::make_shared<LoadedMesh>();
+    // Checked between stages: a superseded load stops before the next expensive one
+    auto isCancelled = [cancelled, &error]() {
+        if (!cancelled || !cancelled->load()) return false;
+        error = "cancelled";
+        return true;
+    };
+
+    // Try the binary cache first; it is only used if it matches the source file and options
+    // (the LOD ratios are part of the key, as the cache holds the LODs too)
+    const ModelFormat fileFormat = modelFormat(path);
+    const bool gltf = fileFormat == ModelFormat::Glb;
+    ObjLoader::Options options;
+    uint64_t formatKey = ObjLoader::cacheKey(scale, options);
+    if (fileFormat == ModelFormat::Glb) formatKey = GlbLoader::cacheKey(scale);
+    if (fileFormat == ModelFormat::Ply) formatKey = PlyLoader::cacheKey(scale);
+    if (fileFormat == ModelFormat::Stl) formatKey = StlLoader::cacheKey(scale);
+    const std::vector<float>& lodRatios = MeshSimplifier::DEFAULT_LOD_RATIOS;
+    const uint64_t cacheKey = MeshCache::hashBytes(lodRatios.data(), lodRatios.size() * sizeof(float),
+                                                   formatKey + PROCESSING_VERSION);
+    const std::string cachePath = MeshCache::cachePathFor(path);
+
+    GlbLoader::Model gltfModel;
+    auto cache = std::make_shared<MeshCache>();
+    if (fileFormat == ModelFormat::Package) {
+        // Packaged meshes were processed (and scaled) by the asset packer, so there is nothing to cache
+        std::string packagePath, assetName;
+        splitPackagePath(path, packagePath, assetName);
+        AssetPackage package;
+        size_t index = 0;
+        if (!package.open(packagePath, error)) {
+            error = packagePath + ": " + error;
+            return nullptr;
+        }
+        if (assetName.empty() ? package.getAssetCount() == 0 : !package.find(assetName, index)) {
+            error = packagePath + " has no asset " + (assetName.empty() ? "at all" : assetName);
+            return nullptr;
+        }
+        AssetPackage::Asset asset;
+        if (!package.load(index, asset, error)) {
+            error = packagePath + ": " + error;
+            return nullptr;
+        }
+        if (scale != 1.0f) {
+            std::cerr << "Warning: packaged meshes keep the scale they were packed with; ignoring " << scale << std::endl;
+        }
+        loaded->geometry = std::move(asset.geometry);
+        loaded->boundingSphereCenter = asset.boundingSphereCenter;
+        loaded->boundingSphereRadius = asset.boundingSphereRadius;
+        std::cout << "Loaded packaged mesh: " << asset.name << " from " << packagePath << " ("
+                  << loaded->geometry->getVertexCount() << " vertices)" << std::endl;
+    } else if (cache->open(cachePath, path, cacheKey)) {
+        // The mapped file stays open for as long as the geometry's CPU copy is needed
+        const MeshView cacheView = cache->view();
+        loaded->boundingSphereCenter = cache->getBoundingSphereCenter();
+        loaded->boundingSphereRadius = cache->getBoundingSphereRadius();
+        loaded->geometry = GeometryBuffer::wrap(cacheView, std::move(cache));
+        std::cout << "Loaded mesh cache: " << cachePath << std::endl;
+        std::cout << "Vertices: " << cacheView.vertexCount << std::endl;
+        std::cout << "Indices: " << cacheView.indexCount << std::endl;
+    } else if (gltf && !GlbLoader::load(path, gltfModel, error)) {
+        error = path + ": " + error;
+        return nullptr;
+    } else if (std::shared_ptr<const GeometryBuffer> stored = GlbLoader::zeroCopyGeometry(gltfModel, scale)) {
+        // The file already holds our vertex layout: draw it as stored, straight from the
+        // mapping (in the exporter's triangle order, without generated LODs)
+        loaded->geometry = std::move(stored);
+        MeshCache::computeBoundingSphere(loaded->geometry->getCpuData()->view, loaded->boundingSphereCenter,
+                                         loaded->boundingSphereRadius);
+        std::cout << "Loaded glTF without copying: " << path << " (" << loaded->geometry->getVertexCount()
+                  << " vertices)" << std::endl;
+    } else {
+        // Load the model from OBJ file (parsing is most of the work; LOD generation takes the rest),
+        // bake the glTF nodes into one mesh, or decode the PLY/STL records
+        if (progress) {
+            options.progress = [&progress](float fraction) { progress(fraction * 0.9f); };
+        }
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        if (gltf) {
+            GlbLoader::flatten(gltfModel, scale, vertices, indices);
+            if (gltfModel.missingNormals) NormalGenerator::generate(vertices, indices, options.normalOptions);
+            gltfModel = GlbLoader::Model(); // Drop the per-primitive copies
+            if (indices.empty()) {
+                error = path + " has no triangles";
+                return nullptr;
+            }
+        } else if (fileFormat == ModelFormat::Ply) {
+            bool hasNormals = false;
+            if (!PlyLoader::load(path, scale, vertices, indices, hasNormals, error)) {
+                error = path + ": " + error;
+                return nullptr;
+            }
+            if (!hasNormals) NormalGenerator::generate(vertices, indices, options.normalOptions);
+        } else if (fileFormat == ModelFormat::Stl) {
+            // Welded, so smooth normals with creases replace the facet normals
+            if (!StlLoader::load(path, scale, vertices, indices, error)) {
+                error = path + ": " + error;
+                return nullptr;
+            }
+            NormalGenerator::generate(vertices, indices, options.normalOptions);
+        } else {
+            // The meshlet order below replaces ObjLoader's vertex cache order, so that pass is skipped
+            ObjLoader::Options objOptions = options;
+            objOptions.optimizeVertexOrder = false;
+            if (!ObjLoader::loadObj(path, scale, vertices, indices, objOptions)) {
+                error = "could not load " + path;
+                return nullptr;
+            }
+        }
+
+        if (isCancelled()) return nullptr;
+
+        // Group LOD 0's triangles into compact meshlets for cluster culling, each meshlet in vertex
+        // cache order (and the meshlets sorted for overdraw if asked), and report the drawn order
+        const bool sortForOverdraw = options.overdrawThreshold > 0.0f;
+        const MeshOptimizer::Report order = MeshletBuilder::optimize(vertices, indices, sortForOverdraw);
+        std::cout << "Vertex cache (meshlet order): ACMR " << order.before.acmr << " -> " << order.after.acmr
+                  << ", ATVR " << order.before.atvr << " -> " << order.after.atvr << std::endl;
+        if (sortForOverdraw) {
+            std::cout << "Overdraw (CPU estimate): " << order.overdrawBefore.overdraw << " -> "
+                      << order.overdrawAfter.overdraw << std::endl;
+        }
+
+        // Every format but flat-shaded OBJ has smooth normals by now; the LODs keep them
+        const bool smoothNormals = fileFormat != ModelFormat::Obj || (options.smoothNormals && options.weldVertices);
+        std::vector<MeshLod> lods = MeshSimplifier::appendLodChain(vertices, indices, lodRatios,
+                                                                   MeshSimplifier::Options::forNormals(smoothNormals));
+        for (size_t i = 1; i < lods.size(); ++i) {
+            std::cout << "LOD " << i << ": " << lods[i].indexCount / 3 << " triangles, error "
+                      << lods[i].error << std::endl;
+        }
+        loaded->geometry = GeometryBuffer::create(std::move(vertices), std::move(indices), std::move(lods));
+        const std::shared_ptr<const GeometryBuffer::CpuData> parsed = loaded->geometry->getCpuData();
+        MeshCache::computeBoundingSphere(parsed->view, loaded->boundingSphereCenter, loaded->boundingSphereRadius);
+
+        // Write the cache for the next launch; failure (e.g. read-only directory) is not fatal
+        if (isCancelled()) return nullptr;
+        if (!MeshCache::write(cachePath, path, cacheKey, parsed->view)) {
+            std::cerr << "Warning: could not write mesh cache " << cachePath << std::endl;
+        }
+    }
+
+    if (isCancelled()) return nullptr;
+
+    // Nothing else references the geometry yet, so its CPU copy is still there
+    const std::shared_ptr<const GeometryBuffer::CpuData> cpuData = loaded->geometry->getCpuData();
+    const MeshView& view = cpuData->view;
+
+    // Meshlets for cluster culling are cheap to build, so they are not cached
+    const size_t lod0IndexCount = view.lodCount > 0 ? view.lods[0].indexCount : view.indexCount;
+    MeshletBuilder::build(view.vertices, view.vertexCount, view.indices, lod0IndexCount,
+                          loaded->meshlets, loaded->meshletBounds);
+
+    // The cache always holds full interleaved vertices; the renderer quantizes and splits them while uploading
+    loaded->vertexFormat = format;
+    loaded->vertexLayout = layout;
+    if (format == VertexFormat::Quantized) {
+        loaded->quantization = VertexQuantizer::computeQuantization(view.vertices, view.vertexCount);
+    }
+
+    // Index width and draw ranges (the cache holds 32-bit indices; the renderer packs them while uploading)
+    loaded->indexLayout = IndexPacker::plan(view, loaded->meshlets, SPLIT_FOR_16BIT_INDICES);
+
+    if (progress) progress(1.0f);
+    return loaded;
+}
+
+/**
+ * @brief Publishes the result of a finished background load.
+ */
+void Scene::publishLoadedMesh() {
+    if (!load.job || !load.job->finished) return;
+    load.thread.join(); // Already past its last statement
+    const std::shared_ptr<LoadJob> job = std::move(load.job);
+    load = LoadWorker();
+
+    std::lock_guard<std::mutex> lock(job->mutex);
+    if (job->mesh) {
+        mesh = std::move(job->mesh);
+        ++meshVersion;
+        loadState = LoadState::Ready;
+        resetPhysics();
+    } else {
+        loadError = job->error;
+        std::cerr << "Failed to load model: " << modelPath << " (" << loadError << ")" << std::endl;
+        loadState = LoadState::Failed;
+    }
+}
+
+/**
+ * @brief Cancels the current load without waiting for its worker.
+ */
+void Scene::supersedeLoad() {
+    if (!load.job) return;
+    load.job->cancelled = true;
+    supersededLoads.push_back(std::move(load));
+    load = LoadWorker();
+}
+
+/**
+ * @brief Joins superseded workers; only finished ones unless wait is set.
+ */
+void Scene::reapSupersededLoads(bool wait) {
+    for (size_t i = 0; i < supersededLoads.size();) {
+        LoadWorker& worker = supersededLoads[i];
+        if (!wait && !worker.job->finished) {
+            ++i;
+            continue;
+        }
+        worker.thread.join();
+        supersededLoads.erase(supersededLoads.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+}
+
+/**
+ * @brief Initializes the scene for a streamed model. The renderer performs the import.
+ *
+ * Keywords: Scene Initialization, Streaming Import
+ */
+void Scene::initStreamed(const std::string& path, const float scale, size_t memoryBudget) {
+    if (modelFormat(path) != ModelFormat::Obj) {
+        // The streaming importer reads OBJ text; binary formats are already cheap to load as a whole
+        std::cerr << "Streaming import only reads OBJ files; loading " << path << " normally." << std::endl;
+        requestModelLoad(path, scale);
+        return;
+    }
+    modelPath = path;
+    streamed = true;
+    streamOptions.scale = scale;
+    streamOptions.memoryBudget = memoryBudget;
+    mesh.reset();
+    ++meshVersion;
+
+    resetPhysics();
+}
 
+/**
+ * @brief Sets the initial physics state of the object.
+ */
+void Scene::resetPhysics() {
     // Initialize physics state - REPLACE WITH TRANSFORMATION MATRIX
     objPosition = glm::vec3(0.0f, -4.0f, 0.0f);
     objVelocity = glm::vec3(0.0f, 0.0f, 0.0f);
@@ -37,6 +392,10 @@ void Scene::init(const std::string& modelPath, const float scale) {
  * Keywords: Scene Update, Game Loop Update, Physics Step
  */
 void Scene::update(float deltaTime) {
+    // Pick up a model that finished loading in the background, and workers of cancelled ones
+    publishLoadedMesh();
+    reapSupersededLoads(false);
+
     // Update the physics simulation for the obj
     updatePhysics(deltaTime);
 }
@@ -82,7 +441,13 @@ void Scene::updatePhysics(float deltaTime) {
  * Keywords: Scene Cleanup, Resource Release
  */
 void Scene::cleanup() {
-    // TODO: Implement cleanup
+    // Nothing is published any more; wait for every worker (they stop at their next checkpoint)
+    supersedeLoad();
+    reapSupersededLoads(true);
+
+    // Release the mesh (its CPU geometry is usually gone already: the renderer frees
+    // it after uploading, and keeps its own reference while an upload is in flight)
+    mesh.reset();
 }
 
 
@@ -105,17 +470,76 @@ glm::vec3 Scene::getObjRotation() const {
 }
 
 /**
- * @brief Gets the vertex data.
- * @return Const reference to the vertex vector.
+ * @brief Whether the model is streamed by the renderer.
+ */
+bool Scene::isStreamed() const {
+    return streamed;
+}
+
+/**
+ * @brief Gets the model path.
+ */
+const std::string& Scene::getModelPath() const {
+    return modelPath;
+}
+
+/**
+ * @brief Gets the streaming import options.
+ */
+const ObjStreamImporter::Options& Scene::getStreamOptions() const {
+    return streamOptions;
+}
+
+/**
+ * @brief Sets the GPU vertex layout of models loaded from now on.
+ */
+void Scene::setVertexFormat(VertexFormat format) {
+    vertexFormat = format;
+}
+
+/**
+ * @brief Sets the GPU vertex stream layout of models loaded from now on.
+ */
+void Scene::setVertexLayout(VertexLayout layout) {
+    vertexLayout = layout;
+}
+
+/**
+ * @brief Gets the load state and progress.
+ */
+Scene::LoadStatus Scene::getLoadStatus() const {
+    LoadStatus status;
+    status.state = loadState;
+    if (status.state == LoadState::Ready) {
+        status.progress = 1.0f;
+    } else if (load.job) {
+        status.progress = load.job->progress;
+    }
+    if (status.state == LoadState::Failed) status.error = loadError;
+    return status;
+}
+
+/**
+ * @brief Gets the current mesh.
  */
-const std::vector<Vertex>& Scene::getVertices() const {
-    return vertices;
+std::shared_ptr<const LoadedMesh> Scene::getMesh() const {
+    return mesh;
+}
+
+/**
+ * @brief Gets the bounding sphere of the current mesh.
+ */
+glm::vec3 Scene::getBoundingSphereCenter() const {
+    return mesh ? mesh->boundingSphereCenter : glm::vec3(0.0f);
+}
+
+float Scene::getBoundingSphereRadius() const {
+    return mesh ? mesh->boundingSphereRadius : 0.0f;
 }
 
 /**
- * @brief Gets the index data.
- * @return Const reference to the index vector.
+ * @brief Gets the mesh version.
  */
-const std::vector<uint32_t>& Scene::getIndices() const {
-    return indices;
+uint64_t Scene::getMeshVersion() const {
+    return meshVersion;
 }
\ No newline at end of file
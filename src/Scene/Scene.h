@@ -1,16 +1,29 @@
 #pragma once
 
 #include "../objects/loaders/ObjLoader.h" // Include OBJ loader
+#include "../objects/loaders/GlbLoader.h" // Binary glTF (.glb) loader
+#include "../objects/loaders/PlyLoader.h" // Binary PLY scans
+#include "../objects/loaders/StlLoader.h" // Binary STL
+#include "../objects/loaders/AssetPackage.h" // Packed meshes (.vpak)
+#include "../objects/loaders/MeshCache.h" // Binary mesh cache (.vmesh)
+#include "../objects/loaders/ObjStreamImporter.h" // Bounded-memory streaming import
+#include "../objects/loaders/LoadedMesh.h"
+#include "../objects/geometry/MeshView.h"
 #include <glm/glm.hpp>
+#include <atomic>
 #include <vector>
 #include <cstdint> // For uint32_t
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 /**
  * @brief Manages the scene objects, physics, and geometry data.
  *
  * This class is responsible for:
- * - Loading and managing 3D models from OBJ files
+ * - Loading and managing 3D models from OBJ, binary glTF (.glb), PLY and STL files,
+ *   and from asset packages (.vpak)
  * - Storing and updating the physics state of objects (position, velocity)
  * - Defining the boundaries of the scene
  * - Providing methods to initialize, update, and retrieve data needed for rendering
@@ -19,19 +32,109 @@
  */
 class Scene {
 public:
+    /**
+     * @brief State of a background model load (see requestModelLoad()).
+     */
+    enum class LoadState {
+        Idle,    // No load requested
+        Loading, // Worker is parsing / reading the cache
+        Ready,   // Mesh has been published (getMeshVersion() was bumped)
+        Failed   // Load failed; the previous mesh (if any) stays in place
+    };
+
+    /**
+     * @brief Snapshot of the background load, safe to query every frame.
+     */
+    struct LoadStatus {
+        LoadState state = LoadState::Idle;
+        float progress = 0.0f; // 0..1 while Loading, 1 once Ready
+        std::string error;     // Set when Failed
+    };
+
+    Scene() = default;
+    ~Scene();
+
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
     /**
      * @brief Initializes the scene, loading models and setting initial physics state.
-     * @param modelPath Path to the OBJ file to load
+     * @param modelPath Path to the OBJ, .glb, .ply or .stl file to load, or "<package>.vpak#<asset>"
      * @param scale Scale factor for the model
      * Should be called once after the Scene object is created.
      */
     void init(const std::string& modelPath, const float scale);
 
+    /**
+     * @brief Initializes the scene for a streaming model import.
+     * @param modelPath Path to the OBJ file to stream
+     * @param scale Scale factor for the model
+     * @param memoryBudget Host memory budget for the import, in bytes
+     *
+     * No geometry is loaded here. The renderer streams the model straight into GPU
+     * memory during initialization (see ObjStreamImporter), so the scene never holds
+     * a CPU copy of it.
+     */
+    void initStreamed(const std::string& modelPath, const float scale, size_t memoryBudget);
+
+    /**
+     * @brief Starts loading a model on a background worker and returns immediately.
+     * @param modelPath Path to the OBJ, .glb, .ply or .stl file to load, or "<package>.vpak#<asset>"
+     * @param scale Scale factor for the model
+     *
+     * The scene keeps its current mesh (possibly none) until the worker is done; the
+     * next update() then publishes the new mesh and bumps getMeshVersion(), which is
+     * the renderer's cue to upload it. If a previous load is still running it is
+     * cancelled without waiting: its worker stops at its next checkpoint (or finishes
+     * the parse it is in) and is joined by a later update(), its result discarded.
+     */
+    void requestModelLoad(const std::string& modelPath, const float scale);
+
+    /**
+     * @brief Selects the GPU vertex layout for models loaded from now on.
+     * @param format VertexFormat::Quantized trades a little precision for 16-byte vertices
+     *               (large scans); VertexFormat::Full keeps the 36-byte Vertex.
+     *
+     * Not used by streamed imports, which always write full vertices.
+     */
+    void setVertexFormat(VertexFormat format);
+
+    /**
+     * @brief Selects how vertex attributes of models loaded from now on are arranged on the GPU.
+     * @param layout VertexLayout::Split stores positions apart from normals and colors,
+     *               so position-only passes (depth prepass) fetch less; Interleaved keeps
+     *               whole vertices together.
+     *
+     * Not used by streamed imports, which always write interleaved vertices.
+     */
+    void setVertexLayout(VertexLayout layout);
+
+    /**
+     * @brief Gets the state and progress of the last requestModelLoad().
+     */
+    LoadStatus getLoadStatus() const;
+
+    /**
+     * @brief Whether the model should be streamed by the renderer instead of read from getMesh().
+     */
+    bool isStreamed() const;
+
+    /**
+     * @brief Gets the model path.
+     */
+    const std::string& getModelPath() const;
+
+    /**
+     * @brief Gets the options to stream the model with (valid when isStreamed()).
+     */
+    const ObjStreamImporter::Options& getStreamOptions() const;
+
     /**
      * @brief Updates the physics state of the scene based on elapsed time.
      * @param deltaTime The time elapsed since the last update, in seconds.
      *
      * This method moves objects, checks for collisions, and applies effects like gravity (optional).
+     * It also publishes the result of a finished background load.
      */
     void update(float deltaTime);
 
@@ -55,25 +158,54 @@ public:
     glm::vec3 getObjRotation() const;
 
     /**
-     * @brief Provides direct access to the vertex data for rendering.
-     * @return Const reference to the vector of vertices.
+     * @brief Gets shared ownership of the current mesh (null while no mesh is loaded).
      *
-     * The VulkanEngine will use this to create and populate the vertex buffer.
+     * Lets the renderer keep the data alive while an upload of it is in flight, even
+     * if the scene moves on to another mesh in the meantime. The renderer releases the
+     * CPU copy of its geometry once uploaded; code that needs the vertices afterwards
+     * (physics, picking) must call GeometryBuffer::requestCpuAccess() before that.
      */
-    const std::vector<Vertex>& getVertices() const;
+    std::shared_ptr<const LoadedMesh> getMesh() const;
 
     /**
-     * @brief Provides direct access to the index data for rendering.
-     * @return Const reference to the vector of indices.
-     *
-     * The VulkanEngine will use this to create and populate the index buffer.
+     * @brief Gets the model-space bounding sphere of the current mesh (zero while none is loaded).
      */
-    const std::vector<uint32_t>& getIndices() const;
+    glm::vec3 getBoundingSphereCenter() const;
+    float getBoundingSphereRadius() const;
+
+    /**
+     * @brief Gets a counter that changes every time a new mesh is published.
+     */
+    uint64_t getMeshVersion() const;
 
 private:
     // --- Geometry Data ---
-    std::vector<Vertex> vertices;   // Vertex data for the model
-    std::vector<uint32_t> indices;  // Index data for the model
+    std::shared_ptr<const LoadedMesh> mesh; // Current mesh, null until one is loaded
+    uint64_t meshVersion = 0;               // Bumped whenever mesh changes
+    std::string modelPath;          // Source model file
+    bool streamed = false;          // Model is streamed by the renderer (no CPU copy)
+    ObjStreamImporter::Options streamOptions;
+    VertexFormat vertexFormat = VertexFormat::Full; // GPU vertex format of loaded models
+    VertexLayout vertexLayout = VertexLayout::Interleaved; // GPU vertex stream layout of loaded models
+
+    // --- Background Load ---
+    // Shared by a load and its worker, so a superseded worker can finish without the scene
+    struct LoadJob {
+        std::atomic<bool> cancelled{false}; // Superseded; the worker gives up at its next checkpoint
+        std::atomic<float> progress{0.0f};
+        std::atomic<bool> finished{false};  // Worker is done; result is waiting in mesh / error
+        std::mutex mutex;                   // Guards mesh and error
+        std::shared_ptr<const LoadedMesh> mesh;
+        std::string error;
+    };
+    struct LoadWorker {
+        std::shared_ptr<LoadJob> job;
+        std::thread thread;
+    };
+    LoadWorker load;                          // Current load (job null while none is pending)
+    std::vector<LoadWorker> supersededLoads;  // Cancelled loads still running; joined once finished
+    LoadState loadState = LoadState::Idle;
+    std::string loadError;                    // Of the last failed load
 
     // --- Physics State ---
     glm::vec3 objPosition = glm::vec3(0.0f, 0.0f, 0.0f);       // Current position
@@ -91,4 +223,47 @@ private:
      * Internal helper function called by update().
      */
     void updatePhysics(float deltaTime);
+
+    /**
+     * @brief Sets the initial physics state of the object after a model is loaded.
+     */
+    void resetPhysics();
+
+    /**
+     * @brief Loads a model from its .vmesh cache or the OBJ/.glb/.ply/.stl file, writing the cache on a miss.
+     *
+     * A .glb whose single primitive already has our vertex layout is drawn straight
+     * from the mapped file instead (see GlbLoader::zeroCopyGeometry()). Any other
+     * glTF has its node transforms baked into one mesh, which is processed like an OBJ.
+     * PLY and STL files get smooth normals unless the file has its own (STL's are
+     * never used). A path "<package>.vpak#<asset>" loads a packaged mesh as-is (no
+     * cache, no processing); without "#<asset>" the package's first asset is used.
+     *
+     * Freshly loaded models get their levels of detail generated (see
+     * MeshSimplifier::DEFAULT_LOD_RATIOS); the cache stores them, so this only happens
+     * once per model.
+     * @param progress Optional, receives 0..1 (called from worker threads).
+     * @param cancelled Optional, checked between stages; once set the load gives up (writing no cache).
+     * @return The loaded mesh, or null on failure or cancellation (error is set).
+     *
+     * Touches no scene state, so it can run on the background worker.
+     */
+    static std::shared_ptr<const LoadedMesh> loadMesh(const std::string& modelPath, float scale, VertexFormat format,
+                                                      VertexLayout layout, const std::function<void(float)>& progress,
+                                                      const std::atomic<bool>* cancelled, std::string& error);
+
+    /**
+     * @brief Joins a finished worker and makes its mesh current (called from update()).
+     */
+    void publishLoadedMesh();
+
+    /**
+     * @brief Cancels the current load, if any, and moves its worker to supersededLoads (never waits).
+     */
+    void supersedeLoad();
+
+    /**
+     * @brief Joins superseded workers that have finished, or all of them if wait is set.
+     */
+    void reapSupersededLoads(bool wait);
 };
\ No newline at end of file
@@ -0,0 +1,435 @@
+#include "AsyncFileReader.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #include <linux/io_uring.h>
+        #include <sys/syscall.h>
+        #if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+            #define ASYNC_FILE_READER_IO_URING 1
+        #endif
+    #endif
+#endif
+
+#ifdef ASYNC_FILE_READER_IO_URING
+    #include <cerrno>
+    #include <cstring>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+/**
+ * @brief Hands completed files from the reader to the parse threads, and keeps the buffered data in budget.
+ */
+class Batch {
+public:
+    Batch(const AsyncFileReader::Callback& callback, size_t maxBufferedBytes)
+        : callback_(callback), maxBufferedBytes_(maxBufferedBytes) {}
+
+    void startParsers(unsigned count) {
+        for (unsigned i = 0; i < count; ++i) parsers_.emplace_back([this]() { parseLoop(); });
+    }
+
+    // Waits until bytes more fit in the budget (always fits when nothing is buffered)
+    void reserve(size_t bytes) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_.wait(lock, [&]() { return buffered_ == 0 || buffered_ + bytes <= maxBufferedBytes_; });
+        buffered_ += bytes;
+    }
+
+    bool tryReserve(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (buffered_ != 0 && buffered_ + bytes > maxBufferedBytes_) return false;
+        buffered_ += bytes;
+        return true;
+    }
+
+    // Queues a finished file; reserved is what was taken from the budget for it
+    void complete(size_t index, std::vector<char>&& data, std::string&& error, size_t reserved) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back({index, std::move(data), std::move(error), reserved});
+        }
+        ready_.notify_one();
+    }
+
+    // Lets the parse threads drain the queue and exit, and waits for them
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            finished_ = true;
+        }
+        ready_.notify_all();
+        for (auto& parser : parsers_) parser.join();
+        parsers_.clear();
+    }
+
+private:
+    struct Done {
+        size_t index;
+        std::vector<char> data;
+        std::string error;
+        size_t reserved;
+    };
+
+    void parseLoop() {
+        for (;;) {
+            Done done;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [&]() { return !queue_.empty() || finished_; });
+                if (queue_.empty()) return;
+                done = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            callback_(done.index, done.data, done.error);
+            done.data = std::vector<char>();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                buffered_ -= done.reserved;
+            }
+            space_.notify_all();
+        }
+    }
+
+    const AsyncFileReader::Callback& callback_;
+    const size_t maxBufferedBytes_;
+    std::mutex mutex_;
+    std::condition_variable ready_; // Queue has work or reading is finished
+    std::condition_variable space_; // Buffered data was released
+    std::deque<Done> queue_;
+    size_t buffered_ = 0;
+    bool finished_ = false;
+    std::vector<std::thread> parsers_;
+};
+
+// Blocking read of a whole file with the standard library
+void readWithThreads(const std::vector<std::string>& paths, Batch& batch, unsigned threadCount) {
+    std::atomic<size_t> next{0};
+    auto reader = [&]() {
+        for (size_t i = next.fetch_add(1); i < paths.size(); i = next.fetch_add(1)) {
+            // file_size fails for anything but a regular file (directories open as streams)
+            std::error_code ec;
+            const uintmax_t fileSize = std::filesystem::file_size(paths[i], ec);
+            std::ifstream file(paths[i], std::ios::binary);
+            if (ec || !file.is_open()) {
+                batch.complete(i, {}, "could not open " + paths[i], 0);
+                continue;
+            }
+            const size_t size = static_cast<size_t>(fileSize);
+            batch.reserve(size);
+            std::vector<char> data(size);
+            file.read(data.data(), static_cast<std::streamsize>(size));
+            if (!file) {
+                batch.complete(i, {}, "could not read " + paths[i], size);
+            } else {
+                batch.complete(i, std::move(data), {}, size);
+            }
+        }
+    };
+
+    const size_t count = std::min<size_t>(std::max(1u, threadCount), paths.size());
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < count; ++t) threads.emplace_back(reader);
+    reader(); // The calling thread reads too
+    for (auto& thread : threads) thread.join();
+}
+
+#ifdef ASYNC_FILE_READER_IO_URING
+
+// Largest single read; longer files take several (short reads are continued the same way)
+constexpr size_t MAX_READ_SIZE = size_t(1) << 30;
+
+/**
+ * @brief Minimal io_uring submission/completion rings, set up with the raw system calls.
+ */
+class Ring {
+public:
+    Ring() = default;
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    ~Ring() {
+        if (sqes_) munmap(sqes_, sqesSize_);
+        if (cqRing_ && cqRing_ != sqRing_) munmap(cqRing_, cqRingSize_);
+        if (sqRing_) munmap(sqRing_, sqRingSize_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool init(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0) return false;
+
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMapping) sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+        sqRing_ = mapRegion(sqRingSize_, IORING_OFF_SQ_RING);
+        if (!sqRing_) return false;
+        cqRing_ = singleMapping ? sqRing_ : mapRegion(cqRingSize_, IORING_OFF_CQ_RING);
+        if (!cqRing_) return false;
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(mapRegion(sqesSize_, IORING_OFF_SQES));
+        if (!sqes_) return false;
+
+        char* sq = static_cast<char*>(sqRing_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqEntries_ = params.sq_entries;
+
+        char* cq = static_cast<char*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    unsigned capacity() const { return sqEntries_; }
+
+    // Queues a vectored read; iov must stay valid until it completes
+    bool queueRead(int fd, const iovec* iov, uint64_t offset, uint64_t userData) {
+        const unsigned tail = *sqTail_; // Only we write the tail
+        if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_) return false;
+        const unsigned slot = tail & sqMask_;
+        io_uring_sqe& sqe = sqes_[slot];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(iov);
+        sqe.len = 1;
+        sqe.off = offset;
+        sqe.user_data = userData;
+        sqArray_[slot] = slot;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // Submits count queued reads and waits for at least waitFor completions; returns -errno on failure
+    int enter(unsigned count, unsigned waitFor) {
+        for (;;) {
+            const long result = syscall(__NR_io_uring_enter, fd_, count, waitFor,
+                                        waitFor > 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (result >= 0) return static_cast<int>(result);
+            if (errno != EINTR) return -errno;
+        }
+    }
+
+    bool popCompletion(uint64_t& userData, int32_t& result) {
+        const unsigned head = *cqHead_; // Only we write the head
+        if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) return false;
+        const io_uring_cqe& cqe = cqes_[head & cqMask_];
+        userData = cqe.user_data;
+        result = cqe.res;
+        __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    void* mapRegion(size_t size, off_t offset) {
+        void* region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        return region == MAP_FAILED ? nullptr : region;
+    }
+
+    int fd_ = -1;
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqRingSize_ = 0, cqRingSize_ = 0, sqesSize_ = 0;
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqMask_ = 0, sqEntries_ = 0;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+};
+
+// Reads through io_uring; false (before reading anything) if the ring cannot be set up
+bool readWithIoUring(const std::vector<std::string>& paths, Batch& batch, unsigned queueDepth) {
+    Ring ring;
+    if (!ring.init(std::max(1u, queueDepth))) return false;
+    const size_t depth = ring.capacity();
+
+    struct Read {
+        int fd = -1;
+        size_t size = 0;
+        size_t done = 0;
+        std::vector<char> data;
+        iovec iov{};
+    };
+    std::vector<Read> reads(paths.size());
+
+    auto finish = [&](size_t i, std::string&& error) {
+        Read& read = reads[i];
+        if (read.fd >= 0) ::close(read.fd);
+        read.fd = -1;
+        batch.complete(i, error.empty() ? std::move(read.data) : std::vector<char>(), std::move(error), read.size);
+        read.data = std::vector<char>();
+    };
+    auto queueRemainder = [&](size_t i) {
+        Read& read = reads[i];
+        read.iov.iov_base = read.data.data() + read.done;
+        read.iov.iov_len = std::min(read.size - read.done, MAX_READ_SIZE);
+        return ring.queueRead(read.fd, &read.iov, read.done, i);
+    };
+
+    size_t next = 0;       // Next file to open
+    bool opened = false;   // reads[next] is open but waits for budget
+    size_t inFlight = 0;
+    size_t finished = 0;
+    unsigned unsubmitted = 0;
+    while (finished < paths.size()) {
+        // Start reads while the queue and the memory budget allow
+        while (next < paths.size() && inFlight < depth) {
+            Read& read = reads[next];
+            if (!opened) {
+                read.fd = ::open(paths[next].c_str(), O_RDONLY | O_CLOEXEC);
+                struct stat info;
+                if (read.fd < 0 || fstat(read.fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+                    finish(next, "could not open " + paths[next]);
+                    ++next;
+                    ++finished;
+                    continue;
+                }
+                read.size = static_cast<size_t>(info.st_size);
+                opened = true;
+            }
+            if (inFlight == 0) {
+                batch.reserve(read.size); // Only the parse threads can free memory now
+            } else if (!batch.tryReserve(read.size)) {
+                break;
+            }
+            opened = false;
+            if (read.size == 0) {
+                finish(next++, {});
+                ++finished;
+                continue;
+            }
+            read.data.resize(read.size);
+            if (!queueRemainder(next)) {
+                finish(next++, "could not queue a read");
+                ++finished;
+                continue;
+            }
+            ++next;
+            ++inFlight;
+            ++unsubmitted;
+        }
+        if (inFlight == 0) continue;
+
+        const int entered = ring.enter(unsubmitted, 1);
+        if (entered < 0) {
+            // The ring is unusable: fail what is still outstanding
+            for (size_t i = 0; i < paths.size(); ++i) {
+                if (reads[i].fd >= 0 && i < next) {
+                    finish(i, "io_uring_enter failed: " + std::string(std::strerror(-entered)));
+                    ++finished;
+                }
+            }
+            inFlight = 0;
+            unsubmitted = 0;
+            continue;
+        }
+        unsubmitted -= std::min<unsigned>(unsubmitted, static_cast<unsigned>(entered));
+
+        uint64_t index;
+        int32_t result;
+        while (ring.popCompletion(index, result)) {
+            Read& read = reads[index];
+            bool retry = result == -EINTR || result == -EAGAIN;
+            if (result > 0) {
+                read.done += static_cast<size_t>(result);
+                retry = read.done < read.size; // Short read: continue where it stopped
+            }
+            if (retry && queueRemainder(index)) {
+                ++unsubmitted;
+                continue;
+            }
+            std::string error;
+            if (result < 0) {
+                error = "could not read " + paths[index] + ": " + std::strerror(-result);
+            } else if (read.done < read.size) {
+                error = "unexpected end of " + paths[index];
+            }
+            finish(index, std::move(error));
+            --inFlight;
+            ++finished;
+        }
+    }
+    return true;
+}
+
+#endif
+
+} // namespace
+
+bool AsyncFileReader::ioUringAvailable() {
+#ifdef ASYNC_FILE_READER_IO_URING
+    static const bool available = []() {
+        Ring ring;
+        return ring.init(2);
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+AsyncFileReader::Backend AsyncFileReader::readAll(const std::vector<std::string>& paths, const Callback& onRead,
+                                                  const Options& options) {
+    const bool useIoUring = options.useIoUring && ioUringAvailable();
+    if (paths.empty()) return useIoUring ? Backend::IoUring : Backend::Threads;
+
+    Batch batch(onRead, options.maxBufferedBytes);
+    const unsigned parseThreads = options.parseThreads > 0 ? options.parseThreads : Parallel::workerCount();
+    batch.startParsers(static_cast<unsigned>(std::min<size_t>(parseThreads, paths.size())));
+
+    Backend backend = Backend::Threads;
+#ifdef ASYNC_FILE_READER_IO_URING
+    if (useIoUring && readWithIoUring(paths, batch, options.queueDepth)) backend = Backend::IoUring;
+#endif
+    if (backend == Backend::Threads) readWithThreads(paths, batch, options.ioThreads);
+
+    batch.finish();
+    return backend;
+}
+
+bool AsyncFileReader::readFiles(const std::vector<std::string>& paths, std::vector<std::vector<char>>& contents,
+                                std::string& error) {
+    contents.assign(paths.size(), {});
+    std::mutex errorMutex;
+    error.clear();
+    Options options;
+    options.parseThreads = 1; // Only moves buffers
+    readAll(paths, [&](size_t index, std::vector<char>& data, const std::string& readError) {
+        if (readError.empty()) {
+            contents[index] = std::move(data);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (error.empty()) error = readError;
+    }, options);
+    return error.empty();
+}
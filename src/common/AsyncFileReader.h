@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Reads a batch of whole files concurrently and hands each one to a worker as soon as it lands.
+ *
+ * On Linux the reads go through io_uring: every file is opened, a read for it is
+ * queued, and the calling thread keeps up to queueDepth reads in flight with one
+ * system call per round of submissions and completions. Elsewhere, or when the
+ * kernel refuses io_uring (old kernel, seccomp), a pool of reader threads issues
+ * blocking reads instead. Both keep many requests outstanding, so the latency of
+ * network storage is paid once per batch rather than once per file.
+ *
+ * Completed files are queued to parse threads, which run the callback while other
+ * reads are still in progress. Reading pauses while more than maxBufferedBytes of
+ * file data waits to be consumed; a buffer is freed when its callback returns
+ * (unless the callback moved it out).
+ *
+ * Keywords: Asynchronous I/O, io_uring, Batched Reads, Thread Pool, I/O and Compute Overlap
+ */
+class AsyncFileReader {
+public:
+    enum class Backend { IoUring, Threads };
+
+    struct Options {
+        unsigned queueDepth = 64;     // io_uring reads in flight
+        unsigned ioThreads = 8;       // Reader threads of the fallback (blocking reads in flight)
+        unsigned parseThreads = 0;    // Threads running the callback (0: Parallel::workerCount())
+        size_t maxBufferedBytes = size_t(512) << 20; // Read data waiting for its callback
+        bool useIoUring = true;       // false forces the thread fallback
+    };
+
+    /**
+     * @brief Receives one file.
+     * @param index Position of the file in the path list.
+     * @param data The file content (may be moved out); empty on failure.
+     * @param error Empty on success, otherwise why the file could not be read.
+     *
+     * Called from the parse threads, concurrently for different files, in completion order.
+     */
+    using Callback = std::function<void(size_t index, std::vector<char>& data, const std::string& error)>;
+
+    /**
+     * @brief Reads every file and runs the callback for each; returns when all callbacks are done.
+     * @return The backend that did the reads.
+     */
+    static Backend readAll(const std::vector<std::string>& paths, const Callback& onRead, const Options& options);
+
+    /**
+     * @brief Reads a batch of files into memory.
+     * @param contents Receives the content of every file, in path order.
+     * @param error Receives the first failure.
+     * @return true if every file was read.
+     */
+    static bool readFiles(const std::vector<std::string>& paths, std::vector<std::vector<char>>& contents,
+                          std::string& error);
+
+    /**
+     * @brief Whether this system lets us use io_uring.
+     */
+    static bool ioUringAvailable();
+};
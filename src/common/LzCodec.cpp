@@ -0,0 +1,144 @@
+#include "LzCodec.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 14;
+constexpr unsigned LENGTH_MASK = 15; // Nibble value meaning "more length bytes follow"
+
+uint32_t read32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Appends the bytes of a length beyond its nibble
+bool writeLength(char*& out, const char* end, size_t length) {
+    for (; length >= 255; length -= 255) {
+        if (out == end) return false;
+        *out++ = static_cast<char>(255);
+    }
+    if (out == end) return false;
+    *out++ = static_cast<char>(length);
+    return true;
+}
+
+bool readLength(const unsigned char*& in, const unsigned char* end, size_t& length) {
+    for (;;) {
+        if (in == end) return false;
+        const unsigned char byte = *in++;
+        length += byte;
+        if (byte != 255) return true;
+    }
+}
+
+// Emits one sequence: literals [literal, literal + literalLength), then a match unless matchLength is 0
+bool writeSequence(char*& out, const char* end, const char* literal, size_t literalLength, size_t offset,
+                   size_t matchLength) {
+    if (out == end) return false;
+    char* token = out++;
+    const size_t literalCode = literalLength < LENGTH_MASK ? literalLength : LENGTH_MASK;
+    const size_t matchCode = matchLength == 0 ? 0
+        : (matchLength - MIN_MATCH < LENGTH_MASK ? matchLength - MIN_MATCH : LENGTH_MASK);
+    *token = static_cast<char>((literalCode << 4) | matchCode);
+
+    if (literalCode == LENGTH_MASK && !writeLength(out, end, literalLength - LENGTH_MASK)) return false;
+    if (static_cast<size_t>(end - out) < literalLength) return false;
+    std::memcpy(out, literal, literalLength);
+    out += literalLength;
+
+    if (matchLength == 0) return true;
+    if (end - out < 2) return false;
+    *out++ = static_cast<char>(offset & 0xFF);
+    *out++ = static_cast<char>(offset >> 8);
+    return matchCode != LENGTH_MASK || writeLength(out, end, matchLength - MIN_MATCH - LENGTH_MASK);
+}
+
+} // namespace
+
+size_t LzCodec::maxCompressedSize(size_t rawSize) {
+    return rawSize + rawSize / 255 + 16;
+}
+
+size_t LzCodec::compress(const char* source, size_t size, char* destination, size_t capacity) {
+    char* out = destination;
+    const char* end = destination + capacity;
+
+    // Positions of the last occurrence of each hashed 4-byte sequence. Stale or colliding
+    // entries are harmless: a candidate is only used after its bytes are compared.
+    std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+
+    size_t anchor = 0; // Start of the pending literals
+    size_t position = 0;
+    while (size >= MIN_MATCH && position <= size - MIN_MATCH) {
+        const uint32_t sequence = read32(source + position);
+        uint32_t& slot = table[hash(sequence)];
+        const size_t candidate = slot;
+        slot = static_cast<uint32_t>(position);
+
+        if (candidate < position && position - candidate <= MAX_OFFSET && read32(source + candidate) == sequence) {
+            size_t length = MIN_MATCH;
+            while (position + length < size && source[candidate + length] == source[position + length]) ++length;
+            if (!writeSequence(out, end, source + anchor, position - anchor, position - candidate, length)) return 0;
+            position += length;
+            anchor = position;
+        } else {
+            // Skip ahead faster through data that does not compress
+            position += 1 + ((position - anchor) >> 6);
+        }
+    }
+
+    if (!writeSequence(out, end, source + anchor, size - anchor, 0, 0)) return 0;
+    return static_cast<size_t>(out - destination);
+}
+
+bool LzCodec::decompress(const char* source, size_t size, char* destination, size_t rawSize) {
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(source);
+    const unsigned char* inEnd = in + size;
+    char* out = destination;
+    char* outEnd = destination + rawSize;
+
+    while (in < inEnd) {
+        const unsigned token = *in++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == LENGTH_MASK && !readLength(in, inEnd, literalLength)) return false;
+        if (static_cast<size_t>(inEnd - in) < literalLength || static_cast<size_t>(outEnd - out) < literalLength) {
+            return false;
+        }
+        std::memcpy(out, in, literalLength);
+        in += literalLength;
+        out += literalLength;
+
+        if (in == inEnd) break; // The last sequence has no match
+
+        if (inEnd - in < 2) return false;
+        const size_t offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+        in += 2;
+        size_t matchLength = token & LENGTH_MASK;
+        if (matchLength == LENGTH_MASK && !readLength(in, inEnd, matchLength)) return false;
+        matchLength += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<size_t>(out - destination) ||
+            static_cast<size_t>(outEnd - out) < matchLength) {
+            return false;
+        }
+
+        // Overlapping matches repeat the last offset bytes, so they are copied forward byte by byte
+        const char* match = out - offset;
+        if (offset >= matchLength) {
+            std::memcpy(out, match, matchLength);
+            out += matchLength;
+        } else {
+            for (size_t i = 0; i < matchLength; ++i) *out++ = match[i];
+        }
+    }
+    return out == outEnd;
+}
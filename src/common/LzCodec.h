@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Small LZ77 byte codec for independently compressed blocks.
+ *
+ * The format follows LZ4: a stream of sequences, each a token byte (literal length
+ * in the high nibble, match length - 4 in the low nibble, 15 meaning "more length
+ * bytes follow"), the literals, then a 16-bit little-endian match offset. The last
+ * sequence has literals only. Matches are found greedily through a hash of the next
+ * four bytes, which keeps compression fast and decompression a plain copy loop.
+ *
+ * Every block stands alone, so blocks can be compressed and decompressed on any
+ * number of threads. The decoder checks every length and offset against both
+ * buffers, so corrupt input fails instead of reading or writing out of bounds.
+ *
+ * Keywords: LZ77, LZ4, Block Compression, Fast Decompression
+ */
+class LzCodec {
+public:
+    /**
+     * @brief Output size that compress() always fits in.
+     */
+    static size_t maxCompressedSize(size_t rawSize);
+
+    /**
+     * @brief Compresses one block.
+     * @return Compressed size, or 0 if it does not fit in capacity.
+     */
+    static size_t compress(const char* source, size_t size, char* destination, size_t capacity);
+
+    /**
+     * @brief Decompresses one block.
+     * @param rawSize Exact size of the decompressed data.
+     * @return true if the block decoded to exactly rawSize bytes.
+     */
+    static bool decompress(const char* source, size_t size, char* destination, size_t rawSize);
+};
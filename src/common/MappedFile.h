@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Wraps CreateFileMapping/MapViewOfFile on Windows and mmap elsewhere. The mapping
+ * is released when the object is destroyed. Move-only.
+ *
+ * Keywords: Memory Mapped File, mmap, Zero-Copy File I/O
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Maps the given file, closing any previous mapping.
+     * @param filename Path to the file.
+     * @return true on success. Empty files succeed with size() == 0.
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    void close();
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool isOpen() const { return isOpen_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool isOpen_ = false;
+#ifdef _WIN32
+    void* fileHandle_ = nullptr;
+    void* mappingHandle_ = nullptr;
+#endif
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Minimal fork/join helpers used by the CPU-heavy asset code paths.
+ *
+ * Work is split into independent tasks that worker threads pull from a shared
+ * atomic counter. The calling thread participates, so a single-core machine runs
+ * everything inline without spawning threads.
+ *
+ * Keywords: Parallel For, Fork/Join, Thread Pool, Work Distribution
+ */
+namespace Parallel {
+
+    /**
+     * @brief Number of worker threads to use for parallel work (at least 1).
+     */
+    inline unsigned workerCount() {
+        unsigned count = std::thread::hardware_concurrency();
+        return count == 0 ? 1u : count;
+    }
+
+    /**
+     * @brief Runs fn(taskIndex) for every taskIndex in [0, taskCount) across all cores.
+     *
+     * Blocks until every task has completed. fn must be safe to call concurrently
+     * for different task indices.
+     * @param taskCount Number of tasks.
+     * @param fn Callable taking a size_t task index.
+     */
+    template <typename Fn>
+    void forEach(size_t taskCount, Fn&& fn) {
+        if (taskCount == 0) return;
+
+        const size_t threadCount = std::min<size_t>(workerCount(), taskCount);
+        if (threadCount <= 1) {
+            for (size_t i = 0; i < taskCount; ++i) fn(i);
+            return;
+        }
+
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t i = next.fetch_add(1); i < taskCount; i = next.fetch_add(1)) {
+                fn(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (size_t t = 1; t < threadCount; ++t) threads.emplace_back(worker);
+        worker(); // The calling thread works too
+        for (auto& thread : threads) thread.join();
+    }
+
+} // namespace Parallel
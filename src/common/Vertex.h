@@ -9,6 +9,7 @@
 #include <vector>
 #include <array>
 #include <cstddef> // For offsetof
+#include <cstdint>
 
 /**
  * @brief Represents a single vertex in a 3D mesh.
@@ -96,6 +97,97 @@ struct Vertex {
     }
 };
 
+/**
+ * @brief Vertex layout a mesh is uploaded to the GPU with (chosen per mesh at load time).
+ */
+enum class VertexFormat {
+    Full,      // Vertex: 36 bytes, full-precision floats
+    Quantized  // QuantizedVertex: 16 bytes, dequantized in the vertex shader
+};
+
+/**
+ * @brief How a mesh's vertex attributes are arranged in its vertex buffer (chosen per mesh at load time).
+ */
+enum class VertexLayout {
+    Interleaved, // One stream (binding 0) of whole vertices
+    Split        // Positions (binding 0), then normals and colors (binding 1), see VertexStreams
+};
+
+/**
+ * @brief Vertex streams a pipeline reads (bit mask).
+ *
+ * Depth-only pipelines read VERTEX_STREAM_POSITION alone, so with the Split layout
+ * they fetch positions only instead of whole vertices.
+ */
+enum VertexStreamBits : uint32_t {
+    VERTEX_STREAM_POSITION = 1u << 0,   // Location 0
+    VERTEX_STREAM_ATTRIBUTES = 1u << 1, // Locations 1 (normal) and 2 (color)
+    VERTEX_STREAM_ALL = VERTEX_STREAM_POSITION | VERTEX_STREAM_ATTRIBUTES
+};
+
+/**
+ * @brief Compact 16-byte vertex layout for large meshes (see VertexQuantizer).
+ *
+ * - Position: 16-bit unsigned normalized per axis, relative to the mesh bounding box.
+ *   The shader reconstructs it as offset + scale * pos.xyz with the mesh's quantization
+ *   (passed in the uniform buffer). The fourth component only pads to 8 bytes, as
+ *   three-component 16-bit formats are not guaranteed to be supported for vertex input.
+ * - Normal: octahedral encoding in two 16-bit signed normalized components.
+ * - Color: RGBA8 unsigned normalized.
+ *
+ * Attribute locations match Vertex, but the shader inputs are vec4/vec2/vec4, so it
+ * needs its own vertex shader (shader_quantized.vert).
+ *
+ * Keywords: Vertex Quantization, Octahedral Normals, Compact Vertex Format
+ */
+struct QuantizedVertex {
+    uint16_t pos[4];   // x, y, z (UNORM, bounding box relative), padding
+    int16_t normal[2]; // Octahedral (SNORM)
+    uint8_t color[4];  // RGBA (UNORM)
+
+    /**
+     * @brief Provides the Vulkan binding description for this vertex type (binding 0, 16-byte stride).
+     */
+    static VkVertexInputBindingDescription getBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = 0;
+        bindingDescription.stride = sizeof(QuantizedVertex);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return bindingDescription;
+    }
+
+    /**
+     * @brief Provides the Vulkan attribute descriptions for this vertex type.
+     *
+     * The normalized formats are converted to floats by the vertex input stage, so the
+     * shader only has to apply the bounding box and decode the octahedral normal.
+     */
+    static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions() {
+        std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
+
+        // Position Attribute (location = 0): vec4 in 0..1
+        attributeDescriptions[0].binding = 0;
+        attributeDescriptions[0].location = 0;
+        attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+        attributeDescriptions[0].offset = offsetof(QuantizedVertex, pos);
+
+        // Normal Attribute (location = 1): vec2 in -1..1
+        attributeDescriptions[1].binding = 0;
+        attributeDescriptions[1].location = 1;
+        attributeDescriptions[1].format = VK_FORMAT_R16G16_SNORM;
+        attributeDescriptions[1].offset = offsetof(QuantizedVertex, normal);
+
+        // Color Attribute (location = 2): vec4 in 0..1
+        attributeDescriptions[2].binding = 0;
+        attributeDescriptions[2].location = 2;
+        attributeDescriptions[2].format = VK_FORMAT_R8G8B8A8_UNORM;
+        attributeDescriptions[2].offset = offsetof(QuantizedVertex, color);
+
+        return attributeDescriptions;
+    }
+};
+static_assert(sizeof(QuantizedVertex) == 16, "QuantizedVertex must stay tightly packed");
+
 // --- Provide a hash function specialization for Vertex ---
 // This allows Vertex structs to be used as keys in std::unordered_map (e.g., for vertex deduplication).
 // It relies on glm::vec3 having a hash specialization (provided by <glm/gtx/hash.hpp>).
@@ -3,6 +3,8 @@
 #include <stdexcept>
 #include <cstdlib> // For EXIT_SUCCESS, EXIT_FAILURE
 #include <chrono>  // For delta time calculation
+#include <string>
+#include <algorithm> // For std::max, std::clamp
 
 // Third-party Libraries (assumed to be in include paths)
 #define GLFW_INCLUDE_VULKAN // Makes GLFW include Vulkan headers
@@ -19,6 +21,8 @@
 
 // --- Constants ---
 const std::string APP_NAME = "Obj Viewer";
+const std::string MODEL_PATH = "models/bunny.obj"; // Default path, can be changed
+const float MODEL_SCALE = 40.0f;
 
 /**
  * @brief Main application class orchestrating the window, engine, and scene.
@@ -28,6 +32,76 @@ const std::string APP_NAME = "Obj Viewer";
  */
 class Application {
 public:
+    /**
+     * @brief Enables streaming import of the model with the given host memory budget.
+     * @param budgetMB Host memory budget for the import, in MiB.
+     */
+    void setStreaming(size_t budgetMB) {
+        streamModel = true;
+        streamBudgetMB = budgetMB;
+    }
+
+    /**
+     * @brief Selects the model to load instead of MODEL_PATH.
+     * @param path OBJ, binary glTF (.glb), PLY or STL file, or "<package>.vpak#<asset>".
+     * @param scale Uniform scale applied to the model.
+     */
+    void setModel(const std::string& path, float scale) {
+        modelPath = path;
+        modelScale = scale;
+    }
+
+    /**
+     * @brief Uploads loaded models with the compact quantized vertex layout.
+     */
+    void setQuantized() {
+        quantizeVertices = true;
+    }
+
+    /**
+     * @brief Uploads loaded models with positions in their own vertex stream.
+     */
+    void setSplitStreams() {
+        splitStreams = true;
+    }
+
+    /**
+     * @brief Renders with a position-only depth prepass before shading.
+     */
+    void setDepthPrepass() {
+        depthPrepass = true;
+    }
+
+    /**
+     * @brief Prints GPU times of the render passes (for comparing vertex layouts).
+     */
+    void setGpuTiming() {
+        gpuTiming = true;
+    }
+
+    /**
+     * @brief Shows loaded models at their coarsest level first and refines them over the next frames.
+     * @param budgetMB Mesh data uploaded per frame, in MiB.
+     */
+    void setProgressiveUpload(size_t budgetMB) {
+        progressiveUpload = true;
+        uploadBudgetMB = budgetMB;
+    }
+
+    /**
+     * @brief Always uploads through staging memory, even where device memory is host-visible (ReBAR/UMA).
+     */
+    void setStagedUploads() {
+        stagedUploads = true;
+    }
+
+    /**
+     * @brief Sets how many frames the CPU may record ahead of the GPU (1 for lowest latency, up to 4).
+     */
+    void setFramesInFlight(uint32_t count) {
+        framesInFlight = count;
+    }
+
     /**
      * @brief Runs the main application lifecycle.
      *
@@ -45,10 +119,24 @@ private:
     Window window{APP_NAME};
     VulkanEngine* vulkanEngine = nullptr; // Pointer to the Vulkan engine instance
     Scene scene;                          // The scene object instance
+    std::string modelPath = MODEL_PATH;   // Model to load (--model=<path>)
+    float modelScale = MODEL_SCALE;       // Its scale (--scale=<s>)
+    bool streamModel = false;             // Stream the model into GPU memory (--stream)
+    size_t streamBudgetMB = 64;           // Host memory budget for streaming (--stream=<MiB>)
+    bool quantizeVertices = false;        // 16-byte quantized vertices instead of 36-byte ones (--quantize)
+    bool splitStreams = false;            // Positions apart from normals/colors (--split-streams)
+    bool depthPrepass = false;            // Position-only depth prepass (--depth-prepass)
+    bool gpuTiming = false;               // Report GPU pass times (--gpu-timing)
+    bool progressiveUpload = false;       // Coarse level first, refined in place (--progressive)
+    size_t uploadBudgetMB = 16;           // Per-frame upload budget of --progressive=<MiB>
+    bool stagedUploads = false;           // No direct writes into ReBAR/UMA memory (--staged-uploads)
+    uint32_t framesInFlight = 2;          // Frames recorded ahead of the GPU (--frames-in-flight=<n>)
 
     // Timing for delta time calculation
     std::chrono::high_resolution_clock::time_point lastFrameTime;
 
+    int shownLoadPercent = -1; // Load progress currently shown in the window title (-1 = none)
+
     /**
      * @brief Initializes the GLFW window.
      *
@@ -65,7 +153,20 @@ private:
      * @brief Initializes the scene logic and data.
      */
     void initScene() {
-        scene.init("models/bunny.obj", 40.0f); // Default path, can be changed
+        if (quantizeVertices) {
+            scene.setVertexFormat(VertexFormat::Quantized);
+        }
+        if (splitStreams) {
+            scene.setVertexLayout(VertexLayout::Split);
+        }
+        if (streamModel) {
+            // Bounded-memory import straight into GPU buffers (for very large scans)
+            scene.initStreamed(modelPath, modelScale, streamBudgetMB * 1024 * 1024);
+        } else {
+            // Parse in the background; the renderer starts with an empty scene and
+            // swaps the model in once it is loaded and uploaded
+            scene.requestModelLoad(modelPath, modelScale);
+        }
         std::cout << "Scene Initialized." << std::endl;
     }
 
@@ -78,6 +179,11 @@ private:
      */
     void initVulkan() {
         vulkanEngine = new VulkanEngine(window.getHandle());
+        vulkanEngine->setDepthPrepass(depthPrepass);
+        vulkanEngine->setGpuTiming(gpuTiming);
+        vulkanEngine->setProgressiveUpload(progressiveUpload, static_cast<VkDeviceSize>(uploadBudgetMB) * 1024 * 1024);
+        vulkanEngine->setDirectUploads(!stagedUploads);
+        vulkanEngine->setFramesInFlight(framesInFlight);
         vulkanEngine->initVulkan(scene);
     }
 
@@ -89,7 +195,13 @@ private:
      */
     void mainLoop() {
         while (!glfwWindowShouldClose(window.getHandle())) {
-            glfwPollEvents(); // Check for and process window events (input, resize, close)
+            // Check for and process window events (input, resize, close). While minimized
+            // nothing is drawn, so sleep until something happens (timed, to keep loading)
+            if (vulkanEngine && vulkanEngine->isRenderingSuspended()) {
+                glfwWaitEventsTimeout(0.1);
+            } else {
+                glfwPollEvents();
+            }
 
             // Calculate delta time for physics and animations
             auto currentTime = std::chrono::high_resolution_clock::now();
@@ -101,6 +213,7 @@ private:
 
             // Update scene logic (e.g., physics simulation)
             scene.update(deltaTime);
+            updateLoadProgress();
 
             // Render the frame using the Vulkan engine, passing the current scene state
             if (vulkanEngine) {
@@ -116,6 +229,31 @@ private:
         }
     }
 
+    /**
+     * @brief Shows the background model load progress in the window title.
+     *
+     * The title is only touched when the displayed percentage changes.
+     */
+    void updateLoadProgress() {
+        const Scene::LoadStatus status = scene.getLoadStatus();
+        int percent = -1;
+        if (status.state == Scene::LoadState::Loading) {
+            percent = static_cast<int>(status.progress * 100.0f);
+        } else if (vulkanEngine && vulkanEngine->isMeshUploadPending()) {
+            percent = 100; // Parsed, GPU upload still in flight
+        }
+        if (percent == shownLoadPercent) return;
+        shownLoadPercent = percent;
+
+        std::string title = APP_NAME;
+        if (percent >= 0) {
+            title += " - Loading " + std::to_string(percent) + "%";
+        } else if (status.state == Scene::LoadState::Failed) {
+            title += " - Failed to load model";
+        }
+        glfwSetWindowTitle(window.getHandle(), title.c_str());
+    }
+
     /**
      * @brief Cleans up application resources.
      *
@@ -141,11 +279,57 @@ private:
 };
 
 // --- Entry Point ---
-int main() {
+int main(int argc, char** argv) {
     std::cout << "Application starting..." << std::endl;
 
     Application app; // Create the application instance
 
+    // --stream[=<MiB>] imports the model with bounded host memory
+    // --quantize uploads the model with quantized vertices
+    // --split-streams uploads positions and normals/colors as separate vertex streams
+    // --depth-prepass draws a position-only depth pass before shading
+    // --gpu-timing prints GPU times of the passes
+    // --progressive[=<MiB>] shows a loaded model coarse first and refines it, uploading at most <MiB> per frame
+    // --staged-uploads copies through staging memory even where device memory is host-visible
+    // --frames-in-flight=<n> lets the CPU run n frames (1-4) ahead of the GPU
+    // --model=<path> loads another OBJ, .glb, .ply or .stl file (scale 1 unless --scale=<s> is given),
+    // or a packaged mesh (<package>.vpak#<asset>)
+    std::string modelPath;
+    float modelScale = 0.0f;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quantize") {
+            app.setQuantized();
+        } else if (arg == "--split-streams") {
+            app.setSplitStreams();
+        } else if (arg == "--depth-prepass") {
+            app.setDepthPrepass();
+        } else if (arg == "--gpu-timing") {
+            app.setGpuTiming();
+        } else if (arg == "--progressive") {
+            app.setProgressiveUpload(16);
+        } else if (arg.rfind("--progressive=", 0) == 0) {
+            app.setProgressiveUpload(static_cast<size_t>(std::max(1, std::atoi(arg.c_str() + 14))));
+        } else if (arg == "--staged-uploads") {
+            app.setStagedUploads();
+        } else if (arg.rfind("--frames-in-flight=", 0) == 0) {
+            app.setFramesInFlight(static_cast<uint32_t>(std::clamp(std::atoi(arg.c_str() + 19), 1, 4)));
+        } else if (arg == "--stream") {
+            app.setStreaming(64);
+        } else if (arg.rfind("--stream=", 0) == 0) {
+            app.setStreaming(static_cast<size_t>(std::max(1, std::atoi(arg.c_str() + 9))));
+        } else if (arg.rfind("--model=", 0) == 0) {
+            modelPath = arg.substr(8);
+        } else if (arg.rfind("--scale=", 0) == 0) {
+            modelScale = static_cast<float>(std::atof(arg.c_str() + 8));
+        }
+    }
+    if (!modelPath.empty()) {
+        app.setModel(modelPath, modelScale > 0.0f ? modelScale : 1.0f);
+    } else if (modelScale > 0.0f) {
+        app.setModel(MODEL_PATH, modelScale);
+    }
+
     try {
         app.run(); // Run the application lifecycle
     } catch (const std::exception& e) {
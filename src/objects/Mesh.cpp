@@ -0,0 +1,10 @@
+#include "Mesh.h"
+#include <utility>
+
+Mesh::Mesh(const std::string& name)
+    : Object(name) {
+}
+
+void Mesh::addPrimitive(std::shared_ptr<const GeometryBuffer> geometry) {
+    if (geometry) primitives.push_back(std::move(geometry));
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../common/Object.h"
+#include "geometry/GeometryBuffer.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Scene object that draws shared geometry with its world transform.
+ *
+ * A mesh holds one GeometryBuffer per primitive. Every Mesh instancing the same
+ * source mesh points at the same buffers, so repeated props cost one copy of
+ * their data no matter how many nodes place them.
+ *
+ * Keywords: Mesh, Scene Graph Node, Shared Geometry, Instancing
+ */
+class Mesh : public Object {
+public:
+    explicit Mesh(const std::string& name = "");
+
+    /**
+     * @brief Adds a primitive drawn by this mesh.
+     */
+    void addPrimitive(std::shared_ptr<const GeometryBuffer> geometry);
+
+    const std::vector<std::shared_ptr<const GeometryBuffer>>& getPrimitives() const { return primitives; }
+
+private:
+    std::vector<std::shared_ptr<const GeometryBuffer>> primitives;
+};
@@ -0,0 +1,260 @@
+#include "Bounds.h"
+#include "../../common/Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BOUNDS_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Vertices per parallel task (keeps small meshes on the calling thread)
+constexpr size_t REDUCE_BATCH = 1 << 16;
+
+// Ritter growth passes before the radius is simply extended to the farthest vertex
+constexpr int MAX_GROWTH_PASSES = 32;
+
+// Growth stops once the farthest vertex is this close (relative) outside the sphere;
+// the last steps only approach the final radius asymptotically
+constexpr float GROWTH_TOLERANCE = 1e-3f;
+
+// Directions whose extremal points seed the Ritter sphere (axes and cube diagonals)
+constexpr int DIRECTION_COUNT = 7;
+const glm::vec3 DIRECTIONS[DIRECTION_COUNT] = {
+    glm::vec3(1.0f, 0.0f, 0.0f),  glm::vec3(0.0f, 1.0f, 0.0f),  glm::vec3(0.0f, 0.0f, 1.0f),
+    glm::vec3(1.0f, 1.0f, 1.0f),  glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(1.0f, -1.0f, 1.0f),
+    glm::vec3(1.0f, -1.0f, -1.0f)};
+
+#ifdef BOUNDS_SSE
+// The SSE paths load 4 floats at pos, reading the first float after it
+static_assert(offsetof(Vertex, pos) + 4 * sizeof(float) <= sizeof(Vertex), "SSE loads must stay inside a Vertex");
+#endif
+
+size_t batchCount(size_t count) {
+    return (count + REDUCE_BATCH - 1) / REDUCE_BATCH;
+}
+
+void computeBoxRange(const Vertex* vertices, size_t begin, size_t end, glm::vec3& minBounds, glm::vec3& maxBounds) {
+    size_t i = begin;
+    minBounds = maxBounds = vertices[i].pos;
+#ifdef BOUNDS_SSE
+    // One vertex per register; the fourth lane (normal.x) is ignored
+    __m128 low = _mm_loadu_ps(&vertices[i].pos.x);
+    __m128 high = low;
+    for (++i; i < end; ++i) {
+        const __m128 p = _mm_loadu_ps(&vertices[i].pos.x);
+        low = _mm_min_ps(low, p);
+        high = _mm_max_ps(high, p);
+    }
+    alignas(16) float lows[4], highs[4];
+    _mm_store_ps(lows, low);
+    _mm_store_ps(highs, high);
+    minBounds = glm::vec3(lows[0], lows[1], lows[2]);
+    maxBounds = glm::vec3(highs[0], highs[1], highs[2]);
+#else
+    for (++i; i < end; ++i) {
+        minBounds = glm::min(minBounds, vertices[i].pos);
+        maxBounds = glm::max(maxBounds, vertices[i].pos);
+    }
+#endif
+}
+
+// Largest squared distance from center in [begin, end), and a vertex at that distance
+float maxDistanceSquaredRange(const Vertex* vertices, size_t begin, size_t end, const glm::vec3& center,
+                              size_t& farthest) {
+    size_t i = begin;
+    float best = -1.0f;
+#ifdef BOUNDS_SSE
+    // Four vertices per iteration, transposed into x/y/z registers
+    const __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+    __m128 bestLanes = _mm_set1_ps(-1.0f);
+    size_t blockBegin = i;
+    for (; i + 4 <= end; i += 4) {
+        __m128 r0 = _mm_loadu_ps(&vertices[i].pos.x);
+        __m128 r1 = _mm_loadu_ps(&vertices[i + 1].pos.x);
+        __m128 r2 = _mm_loadu_ps(&vertices[i + 2].pos.x);
+        __m128 r3 = _mm_loadu_ps(&vertices[i + 3].pos.x);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        const __m128 dx = _mm_sub_ps(r0, cx), dy = _mm_sub_ps(r1, cy), dz = _mm_sub_ps(r2, cz);
+        const __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        bestLanes = _mm_max_ps(bestLanes, d2);
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, bestLanes);
+    best = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    if (best >= 0.0f) {
+        // Find the vertex again; the scalar sum may round differently, so take the scalar maximum
+        float found = -1.0f;
+        for (size_t j = blockBegin; j < i; ++j) {
+            const glm::vec3 d = vertices[j].pos - center;
+            const float d2 = glm::dot(d, d);
+            if (d2 > found) {
+                found = d2;
+                farthest = j;
+            }
+        }
+        best = std::max(best, found);
+    }
+#endif
+    for (; i < end; ++i) {
+        const glm::vec3 d = vertices[i].pos - center;
+        const float d2 = glm::dot(d, d);
+        if (d2 > best) {
+            best = d2;
+            farthest = i;
+        }
+    }
+    return best;
+}
+
+// Extremal vertices along DIRECTIONS within [begin, end)
+struct Extremes {
+    float minProjection[DIRECTION_COUNT];
+    float maxProjection[DIRECTION_COUNT];
+    size_t minVertex[DIRECTION_COUNT];
+    size_t maxVertex[DIRECTION_COUNT];
+};
+
+void findExtremesRange(const Vertex* vertices, size_t begin, size_t end, Extremes& extremes) {
+    for (int d = 0; d < DIRECTION_COUNT; ++d) {
+        extremes.minProjection[d] = std::numeric_limits<float>::max();
+        extremes.maxProjection[d] = std::numeric_limits<float>::lowest();
+        extremes.minVertex[d] = extremes.maxVertex[d] = begin;
+    }
+    for (size_t i = begin; i < end; ++i) {
+        const glm::vec3& p = vertices[i].pos;
+        for (int d = 0; d < DIRECTION_COUNT; ++d) {
+            const float projection = glm::dot(p, DIRECTIONS[d]);
+            if (projection < extremes.minProjection[d]) {
+                extremes.minProjection[d] = projection;
+                extremes.minVertex[d] = i;
+            }
+            if (projection > extremes.maxProjection[d]) {
+                extremes.maxProjection[d] = projection;
+                extremes.maxVertex[d] = i;
+            }
+        }
+    }
+}
+
+void fitRitterSphere(const Vertex* vertices, size_t count, glm::vec3& center, float& radius) {
+    // Extremal points of every chunk, merged into the mesh's extremal points
+    const size_t batches = batchCount(count);
+    std::vector<Extremes> partial(batches);
+    Parallel::forEach(batches, [&](size_t batch) {
+        findExtremesRange(vertices, batch * REDUCE_BATCH, std::min(count, (batch + 1) * REDUCE_BATCH),
+                          partial[batch]);
+    });
+    Extremes extremes = partial[0];
+    for (size_t batch = 1; batch < batches; ++batch) {
+        for (int d = 0; d < DIRECTION_COUNT; ++d) {
+            if (partial[batch].minProjection[d] < extremes.minProjection[d]) {
+                extremes.minProjection[d] = partial[batch].minProjection[d];
+                extremes.minVertex[d] = partial[batch].minVertex[d];
+            }
+            if (partial[batch].maxProjection[d] > extremes.maxProjection[d]) {
+                extremes.maxProjection[d] = partial[batch].maxProjection[d];
+                extremes.maxVertex[d] = partial[batch].maxVertex[d];
+            }
+        }
+    }
+
+    // Start from the most distant pair of extremal points
+    glm::vec3 a = vertices[extremes.minVertex[0]].pos;
+    glm::vec3 b = vertices[extremes.maxVertex[0]].pos;
+    float widest = -1.0f;
+    for (int d = 0; d < DIRECTION_COUNT; ++d) {
+        const glm::vec3& low = vertices[extremes.minVertex[d]].pos;
+        const glm::vec3& high = vertices[extremes.maxVertex[d]].pos;
+        const float distance2 = glm::dot(high - low, high - low);
+        if (distance2 > widest) {
+            widest = distance2;
+            a = low;
+            b = high;
+        }
+    }
+    center = (a + b) * 0.5f;
+    radius = std::sqrt(widest) * 0.5f;
+
+    // Ritter growth, always towards the farthest vertex: the new sphere just covers
+    // the old one and that vertex, so few passes are needed
+    for (int pass = 0; pass < MAX_GROWTH_PASSES; ++pass) {
+        size_t farthest = 0;
+        const float distance = Bounds::maxDistance(vertices, count, center, &farthest);
+        if (distance <= radius * (1.0f + GROWTH_TOLERANCE)) {
+            radius = std::max(radius, distance);
+            return;
+        }
+        const float grownRadius = (radius + distance) * 0.5f;
+        center += (vertices[farthest].pos - center) * ((grownRadius - radius) / distance);
+        radius = grownRadius;
+    }
+
+    // Rounding in the center update can leave a vertex just outside
+    radius = std::max(radius, Bounds::maxDistance(vertices, count, center));
+}
+
+} // namespace
+
+void Bounds::computeBox(const Vertex* vertices, size_t count, glm::vec3& minBounds, glm::vec3& maxBounds) {
+    minBounds = maxBounds = glm::vec3(0.0f);
+    if (count == 0) return;
+
+    const size_t batches = batchCount(count);
+    std::vector<glm::vec3> mins(batches), maxs(batches);
+    Parallel::forEach(batches, [&](size_t batch) {
+        computeBoxRange(vertices, batch * REDUCE_BATCH, std::min(count, (batch + 1) * REDUCE_BATCH), mins[batch],
+                        maxs[batch]);
+    });
+    minBounds = mins[0];
+    maxBounds = maxs[0];
+    for (size_t batch = 1; batch < batches; ++batch) {
+        minBounds = glm::min(minBounds, mins[batch]);
+        maxBounds = glm::max(maxBounds, maxs[batch]);
+    }
+}
+
+float Bounds::maxDistance(const Vertex* vertices, size_t count, const glm::vec3& center, size_t* farthest) {
+    if (farthest) *farthest = 0;
+    if (count == 0) return 0.0f;
+
+    const size_t batches = batchCount(count);
+    std::vector<float> distances2(batches);
+    std::vector<size_t> indices(batches);
+    Parallel::forEach(batches, [&](size_t batch) {
+        distances2[batch] = maxDistanceSquaredRange(vertices, batch * REDUCE_BATCH,
+                                                    std::min(count, (batch + 1) * REDUCE_BATCH), center,
+                                                    indices[batch]);
+    });
+    size_t best = 0;
+    for (size_t batch = 1; batch < batches; ++batch) {
+        if (distances2[batch] > distances2[best]) best = batch;
+    }
+    if (farthest) *farthest = indices[best];
+    return std::sqrt(std::max(distances2[best], 0.0f));
+}
+
+void Bounds::computeSphere(const Vertex* vertices, size_t count, glm::vec3& center, float& radius, SphereFit fit) {
+    center = glm::vec3(0.0f);
+    radius = 0.0f;
+    if (count == 0) return;
+
+    glm::vec3 minBounds, maxBounds;
+    computeBox(vertices, count, minBounds, maxBounds);
+    center = (minBounds + maxBounds) * 0.5f;
+    radius = maxDistance(vertices, count, center);
+    if (fit == SphereFit::BoxCenter) return;
+
+    glm::vec3 ritterCenter;
+    float ritterRadius;
+    fitRitterSphere(vertices, count, ritterCenter, ritterRadius);
+    if (ritterRadius < radius) {
+        center = ritterCenter;
+        radius = ritterRadius;
+    }
+}
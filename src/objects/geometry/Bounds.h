@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../../common/Vertex.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+
+/**
+ * @brief Bounding boxes and spheres of vertex positions.
+ *
+ * The box and farthest-vertex reductions read positions straight out of the
+ * interleaved Vertex array with SSE, four vertices at a time. Large meshes are
+ * split into chunks that are reduced in parallel, and the partial results are
+ * then combined.
+ *
+ * The classic sphere, centred on the bounding box, is often 20-40% larger than
+ * needed (for example on diagonal or lopsided shapes). SphereFit::Ritter starts
+ * from the widest pair among extremal points along 7 directions (as in EPOS-6 by
+ * Larsson). Ritter's growth step is then applied repeatedly to the farthest
+ * vertex, which is found with a parallel reduction, until every vertex is inside.
+ * This usually comes within a few percent of the minimal sphere. The result is
+ * never larger than the box sphere, because the smaller of the two is returned.
+ *
+ * Keywords: Bounding Box, Bounding Sphere, Ritter Sphere, EPOS, SIMD Reduction
+ */
+class Bounds {
+public:
+    /**
+     * @brief How a bounding sphere is fitted.
+     */
+    enum class SphereFit {
+        BoxCenter, // Bounding box center, radius to the farthest vertex (one pass)
+        Ritter     // Near-minimal: extremal points plus Ritter growth (a few passes)
+    };
+
+    /**
+     * @brief Axis-aligned bounding box of the positions (both zero when count is 0).
+     */
+    static void computeBox(const Vertex* vertices, size_t count, glm::vec3& minBounds, glm::vec3& maxBounds);
+
+    /**
+     * @brief Bounding sphere of the positions (zero when count is 0).
+     */
+    static void computeSphere(const Vertex* vertices, size_t count, glm::vec3& center, float& radius,
+                              SphereFit fit = SphereFit::Ritter);
+
+    /**
+     * @brief Largest distance from center to any position.
+     * @param farthest Optional, receives the index of a vertex at that distance.
+     */
+    static float maxDistance(const Vertex* vertices, size_t count, const glm::vec3& center, size_t* farthest = nullptr);
+};
@@ -1,5 +1,6 @@
 #include "Geometry.h"
 #include <algorithm>
+#include <utility>
 
 Geometry::Geometry() 
     : boundingBoxMin_(glm::vec3(0.0f))
@@ -10,18 +11,39 @@ Geometry::Geometry()
 }
 
 void Geometry::setVertices(const std::vector<Vertex>& vertices) {
-    vertices_ = vertices;
+    setVertices(std::vector<Vertex>(vertices));
+}
+
+void Geometry::setVertices(std::vector<Vertex>&& vertices) {
+    dropLods(); // Also drops the LOD indices, which refer to the old vertices
+    clearMeshlets();
+    vertices_ = std::move(vertices);
     computeBoundingBox();
     computeBoundingSphere();
 }
 
 void Geometry::setIndices(const std::vector<uint32_t>& indices) {
-    indices_ = indices;
+    setIndices(std::vector<uint32_t>(indices));
+}
+
+void Geometry::setIndices(std::vector<uint32_t>&& indices) {
+    dropLods(); // Also drops the LOD-only vertices appended after LOD 0
+    clearMeshlets();
+    indices_ = std::move(indices);
+}
+
+std::shared_ptr<const GeometryBuffer> Geometry::releaseBuffer() {
+    std::shared_ptr<const GeometryBuffer> buffer =
+        GeometryBuffer::create(std::move(vertices_), std::move(indices_), std::move(lods_));
+    clear();
+    return buffer;
 }
 
 void Geometry::clear() {
     vertices_.clear();
     indices_.clear();
+    lods_.clear();
+    clearMeshlets();
     boundingBoxMin_ = glm::vec3(0.0f);
     boundingBoxMax_ = glm::vec3(0.0f);
     boundingSphereCenter_ = glm::vec3(0.0f);
@@ -30,57 +52,92 @@ void Geometry::clear() {
 
 void Geometry::computeVertexNormals() {
     if (vertices_.empty() || indices_.empty()) return;
+    dropLods(); // The coarser levels hold copies of the old normals
 
-    // Reset all normals to zero
-    for (auto& vertex : vertices_) {
-        vertex.normal = glm::vec3(0.0f);
-    }
-
-    // Compute face normals and add them to vertex normals
-    for (size_t i = 0; i < indices_.size(); i += 3) {
-        const auto& v0 = vertices_[indices_[i]];
-        const auto& v1 = vertices_[indices_[i + 1]];
-        const auto& v2 = vertices_[indices_[i + 2]];
-
-        glm::vec3 edge1 = v1.pos - v0.pos;
-        glm::vec3 edge2 = v2.pos - v0.pos;
-        glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
+    // No crease angle, so no vertex is split and the meshlets stay valid
+    NormalGenerator::Options options;
+    options.creaseAngle = 180.0f;
+    NormalGenerator::generate(vertices_, indices_, options);
+}
 
-        vertices_[indices_[i]].normal += normal;
-        vertices_[indices_[i + 1]].normal += normal;
-        vertices_[indices_[i + 2]].normal += normal;
-    }
+size_t Geometry::generateNormals(const NormalGenerator::Options& options) {
+    if (vertices_.empty() || indices_.empty()) return 0;
+    dropLods();
 
-    // Normalize all vertex normals
-    for (auto& vertex : vertices_) {
-        vertex.normal = glm::normalize(vertex.normal);
-    }
+    // Split vertices are copies, so the bounds stay valid
+    const size_t added = NormalGenerator::generate(vertices_, indices_, options);
+    if (added > 0) clearMeshlets();
+    return added;
 }
 
 void Geometry::computeBoundingBox() {
     if (vertices_.empty()) return;
+    Bounds::computeBox(vertices_.data(), vertices_.size(), boundingBoxMin_, boundingBoxMax_);
+}
 
-    boundingBoxMin_ = vertices_[0].pos;
-    boundingBoxMax_ = vertices_[0].pos;
+void Geometry::computeBoundingSphere(Bounds::SphereFit fit) {
+    if (vertices_.empty()) return;
+    Bounds::computeSphere(vertices_.data(), vertices_.size(), boundingSphereCenter_, boundingSphereRadius_, fit);
+}
+
+MeshOptimizer::Report Geometry::optimizeVertexOrder(uint32_t cacheSize) {
+    if (vertices_.empty() || indices_.empty()) return MeshOptimizer::Report{};
+    dropLods();
+    clearMeshlets();
 
-    for (const auto& vertex : vertices_) {
-        boundingBoxMin_ = glm::min(boundingBoxMin_, vertex.pos);
-        boundingBoxMax_ = glm::max(boundingBoxMax_, vertex.pos);
-    }
+    // Vertices are only reordered (unused ones dropped), so the bounds stay valid
+    return MeshOptimizer::optimize(vertices_, indices_, cacheSize);
 }
 
-void Geometry::computeBoundingSphere() {
-    if (vertices_.empty()) return;
+MeshOptimizer::Report Geometry::optimizeOverdraw(float threshold, uint32_t cacheSize) {
+    MeshOptimizer::Report report;
+    if (vertices_.empty() || indices_.empty()) return report;
+    dropLods();
+    clearMeshlets();
 
-    // Use bounding box center as initial sphere center
-    boundingSphereCenter_ = (boundingBoxMin_ + boundingBoxMax_) * 0.5f;
-    
-    // Find maximum distance from center to any vertex
-    float maxDistance = 0.0f;
-    for (const auto& vertex : vertices_) {
-        float distance = glm::distance(vertex.pos, boundingSphereCenter_);
-        maxDistance = std::max(maxDistance, distance);
-    }
-    
-    boundingSphereRadius_ = maxDistance;
-}
\ No newline at end of file
+    report.before = MeshOptimizer::analyzeVertexCache(indices_.data(), indices_.size(), vertices_.size(), cacheSize);
+    report.overdrawBefore = MeshOptimizer::analyzeOverdraw(vertices_, indices_);
+
+    MeshOptimizer::optimizeOverdraw(indices_, vertices_, threshold, cacheSize);
+    MeshOptimizer::optimizeVertexFetch(vertices_, indices_); // Cluster order changed the first-use order
+
+    report.after = MeshOptimizer::analyzeVertexCache(indices_.data(), indices_.size(), vertices_.size(), cacheSize);
+    report.overdrawAfter = MeshOptimizer::analyzeOverdraw(vertices_, indices_);
+    return report;
+}
+
+const std::vector<MeshLod>& Geometry::generateLods(const std::vector<float>& ratios,
+                                                   const MeshSimplifier::Options& options) {
+    dropLods(); // LOD 0 (and its meshlets) stays as is
+    if (vertices_.empty() || indices_.empty()) return lods_;
+
+    // Simplified levels only reuse input positions, so the bounds stay valid
+    lods_ = MeshSimplifier::appendLodChain(vertices_, indices_, ratios, options);
+    return lods_;
+}
+
+void Geometry::dropLods() {
+    if (lods_.empty()) return;
+
+    // Truncate the arrays back to LOD 0
+    indices_.resize(lods_[0].indexCount);
+    if (lods_.size() > 1) vertices_.resize(static_cast<size_t>(lods_[1].vertexOffset));
+    lods_.clear();
+}
+
+void Geometry::buildMeshlets(uint32_t maxVertices, uint32_t maxTriangles) {
+    // LOD 0 is the start of the arrays; coarser levels are drawn whole
+    const size_t indexCount = lods_.empty() ? indices_.size() : lods_[0].indexCount;
+    MeshletBuilder::orderTriangles(indices_.data(), indexCount, vertices_.data(), vertices_.size(),
+                                   maxVertices, maxTriangles);
+    MeshletBuilder::build(vertices_.data(), vertices_.size(), indices_.data(), indexCount,
+                          meshlets_, meshletBounds_, &meshletVertices_, &meshletTriangles_,
+                          maxVertices, maxTriangles);
+}
+
+void Geometry::clearMeshlets() {
+    meshlets_.clear();
+    meshletBounds_.clear();
+    meshletVertices_.clear();
+    meshletTriangles_.clear();
+}
@@ -0,0 +1,72 @@
+#include "GeometryBuffer.h"
+#include <utility>
+
+std::shared_ptr<const GeometryBuffer> GeometryBuffer::create(std::vector<Vertex>&& vertices,
+                                                             std::vector<uint32_t>&& indices,
+                                                             std::vector<MeshLod>&& lods) {
+    auto cpuData = std::make_shared<CpuData>();
+    cpuData->vertices = std::move(vertices);
+    cpuData->indices = std::move(indices);
+    cpuData->lods = std::move(lods);
+    cpuData->view = MeshView(cpuData->vertices, cpuData->indices, cpuData->lods);
+    return std::shared_ptr<const GeometryBuffer>(new GeometryBuffer(std::move(cpuData)));
+}
+
+std::shared_ptr<const GeometryBuffer> GeometryBuffer::wrap(const MeshView& view, std::shared_ptr<const void> backing) {
+    auto cpuData = std::make_shared<CpuData>();
+    cpuData->backing = std::move(backing);
+    cpuData->view = view;
+    return std::shared_ptr<const GeometryBuffer>(new GeometryBuffer(std::move(cpuData)));
+}
+
+GeometryBuffer::GeometryBuffer(std::shared_ptr<const CpuData> cpuData)
+    : vertexCount_(cpuData->view.vertexCount)
+    , indexCount_(cpuData->view.indexCount)
+    , lods_(cpuData->view.lods, cpuData->view.lods + cpuData->view.lodCount)
+    , cpuData_(std::move(cpuData))
+{
+}
+
+std::shared_ptr<const GeometryBuffer::CpuData> GeometryBuffer::getCpuData() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cpuData_;
+}
+
+bool GeometryBuffer::isCpuResident() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cpuData_ != nullptr;
+}
+
+size_t GeometryBuffer::getCpuBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!cpuData_) return 0;
+    return cpuData_->vertices.capacity() * sizeof(Vertex) + cpuData_->indices.capacity() * sizeof(uint32_t) +
+           cpuData_->lods.capacity() * sizeof(MeshLod);
+}
+
+bool GeometryBuffer::requestCpuAccess() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!cpuData_) return false;
+    ++accessCount_;
+    return true;
+}
+
+void GeometryBuffer::releaseCpuAccess() const {
+    std::shared_ptr<const CpuData> released; // Freed after the lock is dropped
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (accessCount_ > 0) --accessCount_;
+    released = takeIfUnused();
+}
+
+void GeometryBuffer::markUploaded() const {
+    std::shared_ptr<const CpuData> released;
+    std::lock_guard<std::mutex> lock(mutex_);
+    uploaded_ = true;
+    released = takeIfUnused();
+}
+
+std::shared_ptr<const GeometryBuffer::CpuData> GeometryBuffer::takeIfUnused() const {
+    // Readers still holding getCpuData() keep the data until they are done
+    if (uploaded_ && accessCount_ == 0) return std::move(cpuData_);
+    return nullptr;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "MeshView.h"
+#include "../../common/Vertex.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Immutable vertex and index data, shared by every object drawing it, whose CPU copy can be dropped.
+ *
+ * The data is taken over by move when the buffer is created and is never changed
+ * afterwards. Any number of meshes and objects can hold the same
+ * std::shared_ptr<const GeometryBuffer>, so host memory grows with the number of
+ * unique meshes rather than instances.
+ *
+ * Once the renderer has the data on the GPU it calls markUploaded(), which frees
+ * the CPU copy. Consumers that still need it (physics, picking) call
+ * requestCpuAccess() first; the copy is then kept until the last of them calls
+ * releaseCpuAccess(). Readers take a getCpuData() reference, which keeps the data
+ * alive while they use it even if the buffer lets go of it meanwhile (e.g. a
+ * staging copy on a worker thread).
+ *
+ * Counts and the LOD table stay available after the CPU copy is gone.
+ *
+ * Keywords: Shared Geometry, Immutable Buffer, Move Semantics, CPU Residency, Instancing
+ */
+class GeometryBuffer {
+public:
+    /**
+     * @brief The CPU copy of the data.
+     */
+    struct CpuData {
+        std::vector<Vertex> vertices;      // Owned data (empty when the view points into backing)
+        std::vector<uint32_t> indices;
+        std::vector<MeshLod> lods;
+        std::shared_ptr<const void> backing; // External storage the view points into (e.g. a mapped mesh cache)
+        MeshView view;                       // Points at either the vectors above or backing
+    };
+
+    /**
+     * @brief Takes ownership of mesh data.
+     * @param lods Level of detail table (LOD 0 first), or empty for a single level.
+     */
+    static std::shared_ptr<const GeometryBuffer> create(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices,
+                                                        std::vector<MeshLod>&& lods);
+
+    /**
+     * @brief Shares mesh data that lives in external storage.
+     * @param view Data inside backing.
+     * @param backing Kept alive for as long as the CPU copy is.
+     */
+    static std::shared_ptr<const GeometryBuffer> wrap(const MeshView& view, std::shared_ptr<const void> backing);
+
+    GeometryBuffer(const GeometryBuffer&) = delete;
+    GeometryBuffer& operator=(const GeometryBuffer&) = delete;
+
+    size_t getVertexCount() const { return vertexCount_; }
+    size_t getIndexCount() const { return indexCount_; }
+    const std::vector<MeshLod>& getLods() const { return lods_; }
+
+    /**
+     * @brief Gets the CPU copy, or null once it was released.
+     */
+    std::shared_ptr<const CpuData> getCpuData() const;
+
+    /**
+     * @brief Whether the CPU copy is still held by the buffer.
+     */
+    bool isCpuResident() const;
+
+    /**
+     * @brief Host bytes held by the CPU copy (0 once released or when it lives in external storage).
+     */
+    size_t getCpuBytes() const;
+
+    /**
+     * @brief Keeps the CPU copy after upload, until a matching releaseCpuAccess().
+     * @return False if the copy was already released.
+     */
+    bool requestCpuAccess() const;
+
+    /**
+     * @brief Ends a requestCpuAccess(); the copy is freed if the data was uploaded and nobody else needs it.
+     */
+    void releaseCpuAccess() const;
+
+    /**
+     * @brief Notes that the GPU holds the data; the copy is freed unless CPU access was requested.
+     */
+    void markUploaded() const;
+
+private:
+    GeometryBuffer(std::shared_ptr<const CpuData> cpuData);
+
+    // Hands out the CPU copy for freeing once it was uploaded and nobody needs it (mutex_ held)
+    std::shared_ptr<const CpuData> takeIfUnused() const;
+
+    size_t vertexCount_;
+    size_t indexCount_;
+    std::vector<MeshLod> lods_;
+
+    // Residency bookkeeping, the only state that changes after creation
+    mutable std::mutex mutex_;
+    mutable std::shared_ptr<const CpuData> cpuData_;
+    mutable uint32_t accessCount_ = 0;
+    mutable bool uploaded_ = false;
+};
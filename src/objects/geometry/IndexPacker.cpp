@@ -0,0 +1,130 @@
+#include "IndexPacker.h"
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief Levels of a mesh as draw ranges (the whole index buffer when it has no LODs).
+ */
+std::vector<IndexRange> levelRanges(const MeshView& mesh) {
+    std::vector<IndexRange> levels;
+    if (mesh.lodCount == 0) {
+        levels.push_back({0, static_cast<uint32_t>(mesh.indexCount), 0});
+        return levels;
+    }
+    for (size_t i = 0; i < mesh.lodCount; ++i) {
+        levels.push_back({mesh.lods[i].firstIndex, mesh.lods[i].indexCount, mesh.lods[i].vertexOffset});
+    }
+    return levels;
+}
+
+/**
+ * @brief One range per level, as stored.
+ */
+IndexPacker::Layout unsplitLayout(const std::vector<IndexRange>& levels, size_t meshletCount, IndexFormat format) {
+    IndexPacker::Layout layout;
+    layout.format = format;
+    layout.ranges = levels;
+    for (uint32_t i = 0; i <= levels.size(); ++i) layout.lodRangeOffsets.push_back(i);
+    layout.meshletVertexOffsets.assign(meshletCount, levels.empty() ? 0 : levels[0].vertexOffset);
+    return layout;
+}
+
+} // namespace
+
+IndexPacker::Layout IndexPacker::plan(const MeshView& mesh, const std::vector<Meshlet>& meshlets, bool allowSplit) {
+    const std::vector<IndexRange> levels = levelRanges(mesh);
+
+    // Indices of a level are relative to its vertexOffset; narrowing is lossless if all fit
+    bool fits = true;
+    for (const IndexRange& level : levels) {
+        const uint32_t* begin = mesh.indices + level.firstIndex;
+        const uint32_t* end = begin + level.indexCount;
+        if (begin != end && *std::max_element(begin, end) >= MAX_UINT16_SPAN) {
+            fits = false;
+            break;
+        }
+    }
+    if (fits) return unsplitLayout(levels, meshlets.size(), IndexFormat::Uint16);
+    if (!allowSplit) return unsplitLayout(levels, meshlets.size(), IndexFormat::Uint32);
+
+    Layout layout;
+    layout.format = IndexFormat::Uint16;
+    layout.meshletVertexOffsets.assign(meshlets.size(), 0);
+    layout.lodRangeOffsets.push_back(0);
+
+    for (size_t levelIndex = 0; levelIndex < levels.size(); ++levelIndex) {
+        const IndexRange& level = levels[levelIndex];
+        const uint32_t levelEnd = level.firstIndex + level.indexCount;
+
+        // Split points: between meshlets for LOD 0 (then between leftover triangles), between
+        // triangles elsewhere
+        std::vector<uint32_t> segmentEnds;
+        uint32_t covered = level.firstIndex;
+        if (levelIndex == 0) {
+            for (const Meshlet& meshlet : meshlets) {
+                covered = level.firstIndex + 3 * (meshlet.triangleOffset + meshlet.triangleCount);
+                segmentEnds.push_back(covered);
+            }
+        }
+        for (uint32_t end = covered + 3; end <= levelEnd; end += 3) segmentEnds.push_back(end);
+
+        uint32_t rangeStart = level.firstIndex;
+        uint32_t rangeMin = 0, rangeMax = 0;
+        bool rangeEmpty = true;
+        size_t firstMeshletInRange = 0;
+        uint32_t segmentStart = level.firstIndex;
+
+        auto closeRange = [&](uint32_t end, size_t meshletEnd) {
+            const int32_t vertexOffset = level.vertexOffset + static_cast<int32_t>(rangeMin);
+            layout.ranges.push_back({rangeStart, end - rangeStart, vertexOffset});
+            for (size_t m = firstMeshletInRange; m < meshletEnd; ++m) layout.meshletVertexOffsets[m] = vertexOffset;
+            firstMeshletInRange = meshletEnd;
+        };
+
+        for (size_t s = 0; s < segmentEnds.size(); ++s) {
+            const uint32_t segmentEnd = segmentEnds[s];
+            const auto bounds = std::minmax_element(mesh.indices + segmentStart, mesh.indices + segmentEnd);
+            const uint32_t segmentMin = *bounds.first;
+            const uint32_t segmentMax = *bounds.second;
+            if (segmentMax - segmentMin >= MAX_UINT16_SPAN) {
+                // Cannot be drawn from any single base vertex
+                return unsplitLayout(levels, meshlets.size(), IndexFormat::Uint32);
+            }
+
+            const size_t meshletIndex = levelIndex == 0 ? std::min(s, meshlets.size()) : 0;
+            if (!rangeEmpty &&
+                std::max(rangeMax, segmentMax) - std::min(rangeMin, segmentMin) >= MAX_UINT16_SPAN) {
+                closeRange(segmentStart, meshletIndex);
+                rangeStart = segmentStart;
+                rangeEmpty = true;
+            }
+            rangeMin = rangeEmpty ? segmentMin : std::min(rangeMin, segmentMin);
+            rangeMax = rangeEmpty ? segmentMax : std::max(rangeMax, segmentMax);
+            rangeEmpty = false;
+            segmentStart = segmentEnd;
+        }
+        if (!rangeEmpty) closeRange(segmentStart, levelIndex == 0 ? meshlets.size() : 0);
+        layout.lodRangeOffsets.push_back(static_cast<uint32_t>(layout.ranges.size()));
+    }
+    return layout;
+}
+
+void IndexPacker::packUint16(const MeshView& mesh, const Layout& layout, uint16_t* out) {
+    for (uint32_t levelIndex = 0; levelIndex < layout.lodCount(); ++levelIndex) {
+        packUint16Level(mesh, layout, levelIndex, out);
+    }
+}
+
+void IndexPacker::packUint16Level(const MeshView& mesh, const Layout& layout, uint32_t levelIndex, uint16_t* out) {
+    const std::vector<IndexRange> levels = levelRanges(mesh);
+    if (levelIndex >= layout.lodCount() || levelIndex >= levels.size()) return;
+    for (uint32_t r = layout.lodRangeOffsets[levelIndex]; r < layout.lodRangeOffsets[levelIndex + 1]; ++r) {
+        const IndexRange& range = layout.ranges[r];
+        // Stored indices are relative to the level; packed ones to the range
+        const uint32_t rebase = static_cast<uint32_t>(range.vertexOffset - levels[levelIndex].vertexOffset);
+        for (uint32_t i = range.firstIndex; i < range.firstIndex + range.indexCount; ++i) {
+            out[i] = static_cast<uint16_t>(mesh.indices[i] - rebase);
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "MeshView.h"
+#include "MeshletBuilder.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Width of the indices in a GPU index buffer.
+ */
+enum class IndexFormat {
+    Uint16,
+    Uint32
+};
+
+/**
+ * @brief One draw over a contiguous part of the index buffer:
+ * vkCmdDrawIndexed(indexCount, 1, firstIndex, vertexOffset, 0).
+ */
+struct IndexRange {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int32_t vertexOffset = 0;
+};
+
+/**
+ * @brief Chooses the index width of a mesh and packs its indices for the GPU.
+ *
+ * 16-bit indices halve index memory and bandwidth. They only reach 65535 vertices
+ * past a draw's vertexOffset (base vertex), which every level of detail already has.
+ * So a mesh whose levels each span at most 65536 vertices packs as is: each index
+ * is simply narrowed.
+ *
+ * Larger levels can be split into several draws. Triangles are walked in order and
+ * a new range is started whenever the vertices referenced since the range began
+ * would span more than 65536. The range's vertexOffset is then its smallest vertex,
+ * and its indices are stored relative to that. Vertices are not duplicated. This
+ * works because meshes are stored in vertex fetch order (vertices numbered by
+ * first use), so consecutive triangles reference a sliding window of vertices. If a
+ * single triangle (or meshlet) spans too far, the mesh keeps 32-bit indices.
+ *
+ * Ranges of LOD 0 only break between meshlets, so every meshlet is drawn with the
+ * vertexOffset of the range holding it.
+ *
+ * Keywords: 16-bit Indices, Index Buffer Compression, Base Vertex, Draw Splitting
+ */
+class IndexPacker {
+public:
+    static constexpr uint32_t MAX_UINT16_SPAN = 65536; // Vertices reachable from one base vertex
+
+    /**
+     * @brief How a mesh's indices are laid out on the GPU and drawn.
+     */
+    struct Layout {
+        IndexFormat format = IndexFormat::Uint32;
+        std::vector<IndexRange> ranges;              // Draws of all levels, in index buffer order
+        std::vector<uint32_t> lodRangeOffsets;       // Level k draws ranges[lodRangeOffsets[k] .. lodRangeOffsets[k + 1])
+        std::vector<int32_t> meshletVertexOffsets;   // Base vertex of each LOD 0 meshlet (empty without meshlets)
+
+        size_t indexSize() const { return format == IndexFormat::Uint16 ? sizeof(uint16_t) : sizeof(uint32_t); }
+        uint32_t lodCount() const { return lodRangeOffsets.empty() ? 0 : static_cast<uint32_t>(lodRangeOffsets.size() - 1); }
+    };
+
+    /**
+     * @brief Plans the index layout of a mesh.
+     * @param mesh Mesh data, with or without levels of detail.
+     * @param meshlets Meshlets covering the start of LOD 0 (may be empty).
+     * @param allowSplit Split levels spanning more than 65536 vertices into several draws;
+     *                   without it such meshes keep 32-bit indices.
+     */
+    static Layout plan(const MeshView& mesh, const std::vector<Meshlet>& meshlets, bool allowSplit = true);
+
+    /**
+     * @brief Writes the mesh's indices as 16-bit, relative to each range's vertexOffset.
+     * @param mesh The mesh the layout was planned for.
+     * @param layout A Uint16 layout from plan().
+     * @param out Receives mesh.indexCount indices (may be mapped GPU memory).
+     */
+    static void packUint16(const MeshView& mesh, const Layout& layout, uint16_t* out);
+
+    /**
+     * @brief packUint16() for the draw ranges of one level only.
+     * @param out The whole index buffer; only the level's indices are written.
+     */
+    static void packUint16Level(const MeshView& mesh, const Layout& layout, uint32_t level, uint16_t* out);
+
+    /**
+     * @brief The narrowest format for a mesh drawn in one range.
+     */
+    static IndexFormat formatFor(size_t vertexCount) {
+        return vertexCount <= MAX_UINT16_SPAN ? IndexFormat::Uint16 : IndexFormat::Uint32;
+    }
+};
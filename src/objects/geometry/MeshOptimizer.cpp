@@ -0,0 +1,422 @@
+#include "MeshOptimizer.h"
+#include "../../common/Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+/**
+ * @brief Vertex -> triangle adjacency in compressed (CSR) form.
+ */
+struct TriangleAdjacency {
+    std::vector<uint32_t> offsets;   // vertexCount + 1 entries
+    std::vector<uint32_t> triangles; // Triangles of vertex v are triangles[offsets[v] .. offsets[v + 1])
+
+    TriangleAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount)
+        : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+        for (uint32_t index : indices) ++offsets[index + 1];
+        for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+};
+
+/**
+ * @brief FIFO cache model shared by the overdraw clustering passes (same model as Tipsify).
+ */
+struct CacheModel {
+    std::vector<uint32_t> timestamps;
+    uint32_t timestamp;
+    uint32_t size;
+
+    CacheModel(size_t vertexCount, uint32_t cacheSize)
+        : timestamps(vertexCount, 0), timestamp(cacheSize + 1), size(cacheSize) {}
+
+    // Returns the number of misses (0..3) for one triangle
+    uint32_t update(const uint32_t* triangle) {
+        uint32_t misses = 0;
+        for (int c = 0; c < 3; ++c) {
+            if (timestamp - timestamps[triangle[c]] > size) {
+                timestamps[triangle[c]] = timestamp++;
+                ++misses;
+            }
+        }
+        return misses;
+    }
+
+    // Empties the cache without touching every entry
+    void flush() { timestamp += size + 1; }
+};
+
+// Direction of each canonical view used by the overdraw estimate
+const glm::vec3 OVERDRAW_VIEWS[] = {
+    {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1},
+    {1, 1, 1}, {1, 1, -1}, {1, -1, 1}, {1, -1, -1}, {-1, 1, 1}, {-1, 1, -1}, {-1, -1, 1}, {-1, -1, -1},
+};
+
+// Edge function of (a, b) at p: positive when p is left of a->b
+inline float edge(const glm::vec2& a, const glm::vec2& b, const glm::vec2& p) {
+    return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+// Top-left fill rule for counter-clockwise triangles (y up): pixels on a shared edge are drawn once
+inline bool isTopLeft(const glm::vec2& a, const glm::vec2& b) {
+    return (a.y == b.y && b.x < a.x) || b.y < a.y;
+}
+
+/**
+ * @brief Reorders triangle clusters so that clusters likely to occlude others come first.
+ * @param clusters First triangle of every cluster, followed by the triangle count.
+ */
+void sortClusters(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                  const std::vector<size_t>& clusters) {
+    const size_t clusterCount = clusters.size() - 1;
+
+    // Sort key per cluster: area-weighted centroid and normal against the mesh centroid
+    double meshCentroid[3] = {0.0, 0.0, 0.0}; // Accumulated in double: millions of triangles
+    double meshArea = 0.0;
+    std::vector<glm::vec3> centroids(clusterCount);
+    std::vector<glm::vec3> normals(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f); // Sum of cross products = 2 * area-weighted normal
+        float area = 0.0f;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const glm::vec3& p0 = vertices[indices[3 * t + 0]].pos;
+            const glm::vec3& p1 = vertices[indices[3 * t + 1]].pos;
+            const glm::vec3& p2 = vertices[indices[3 * t + 2]].pos;
+            const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            const float triangleArea = glm::length(n);
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += n;
+            area += triangleArea;
+        }
+        centroids[c] = area > 0.0f ? centroid / area : vertices[indices[3 * clusters[c]]].pos;
+        const float normalLength = glm::length(normal);
+        normals[c] = normalLength > 0.0f ? normal / normalLength : glm::vec3(0.0f);
+        for (int i = 0; i < 3; ++i) meshCentroid[i] += centroid[i];
+        meshArea += area;
+    }
+    glm::vec3 center(0.0f);
+    if (meshArea > 0.0) {
+        center = glm::vec3(static_cast<float>(meshCentroid[0] / meshArea),
+                           static_cast<float>(meshCentroid[1] / meshArea),
+                           static_cast<float>(meshCentroid[2] / meshArea));
+    }
+
+    std::vector<float> keys(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        keys[c] = glm::dot(centroids[c] - center, normals[c]);
+    }
+
+    // Outermost, outward-facing clusters first; stable so equal keys keep the cache order
+    std::vector<uint32_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) order[c] = static_cast<uint32_t>(c);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] > keys[b]; });
+
+    // Emit clusters in sorted order
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (uint32_t c : order) {
+        result.insert(result.end(), indices.begin() + 3 * clusters[c], indices.begin() + 3 * clusters[c + 1]);
+    }
+    indices.swap(result);
+}
+
+} // namespace
+
+MeshOptimizer::CacheStats MeshOptimizer::analyzeVertexCache(const uint32_t* indices, size_t indexCount,
+                                                            size_t vertexCount, uint32_t cacheSize) {
+    CacheStats stats;
+    if (indexCount < 3 || vertexCount == 0) return stats;
+
+    // FIFO cache: a vertex is resident if fewer than cacheSize misses happened since it was loaded
+    std::vector<uint64_t> loadedAt(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    uint64_t misses = 0;
+    size_t uniqueVertices = 0;
+
+    for (size_t i = 0; i < indexCount; ++i) {
+        const uint32_t v = indices[i];
+        if (!referenced[v]) {
+            referenced[v] = true;
+            ++uniqueVertices;
+        }
+        // loadedAt holds the (1-based) miss that loaded the vertex, 0 means "never loaded"
+        if (loadedAt[v] == 0 || misses - loadedAt[v] >= cacheSize) {
+            ++misses;
+            loadedAt[v] = misses;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(uniqueVertices);
+    return stats;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) return;
+
+    const TriangleAdjacency adjacency(indices, vertexCount);
+
+    // Live triangle count per vertex (triangles not yet emitted)
+    std::vector<uint32_t> live(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0); // Timestamp at which a vertex entered the cache
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnd;                   // Recently used vertices, to resume from at dead ends
+    deadEnd.reserve(indices.size());
+    std::vector<uint32_t> candidates;
+    candidates.reserve(64);
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    uint32_t timestamp = cacheSize + 1;
+    size_t cursor = 0;   // Next vertex to try when the dead-end stack runs dry
+    uint32_t fanning = 0;
+
+    while (fanning != NONE) {
+        // 1. Emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (uint32_t a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; ++a) {
+            const uint32_t t = adjacency.triangles[a];
+            if (emitted[t]) continue;
+            emitted[t] = true;
+
+            for (int c = 0; c < 3; ++c) {
+                const uint32_t v = indices[3 * static_cast<size_t>(t) + c];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (timestamp - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = timestamp++; // Cache miss: v is (re)loaded
+                }
+            }
+        }
+
+        // 2. Next fanning vertex: the candidate that stays in cache the longest while
+        //    it still has triangles left (oldest wins, so fewer vertices get evicted)
+        fanning = NONE;
+        int bestPriority = -1;
+        for (uint32_t v : candidates) {
+            if (live[v] == 0) continue;
+            int priority = 0;
+            if (timestamp - cacheTime[v] + 2 * live[v] <= cacheSize) {
+                priority = static_cast<int>(timestamp - cacheTime[v]);
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                fanning = v;
+            }
+        }
+
+        // 3. Dead end: resume from a recently used vertex, else scan for any vertex with work left
+        if (fanning == NONE) {
+            while (!deadEnd.empty()) {
+                const uint32_t v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0) {
+                    fanning = v;
+                    break;
+                }
+            }
+        }
+        if (fanning == NONE) {
+            while (cursor < vertexCount && live[cursor] == 0) ++cursor;
+            if (cursor < vertexCount) fanning = static_cast<uint32_t>(cursor);
+        }
+    }
+
+    indices.swap(result);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    std::vector<uint32_t> remap(vertices.size(), NONE);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (uint32_t& index : indices) {
+        uint32_t& target = remap[index];
+        if (target == NONE) {
+            target = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = target;
+    }
+
+    vertices.swap(reordered);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                                     float threshold, uint32_t cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2 || vertices.empty()) return;
+
+    // 1. Hard boundaries: a triangle missing all three vertices starts a new patch
+    std::vector<size_t> hard;
+    CacheModel cache(vertices.size(), cacheSize);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        if (cache.update(&indices[3 * t]) == 3 || t == 0) hard.push_back(t);
+    }
+    hard.push_back(triangleCount);
+
+    // 2. Soft boundaries: split a patch wherever the running ACMR has dropped below
+    //    threshold times the patch's overall ACMR
+    std::vector<size_t> clusters;
+    for (size_t h = 0; h + 1 < hard.size(); ++h) {
+        const size_t start = hard[h];
+        const size_t end = hard[h + 1];
+
+        cache.flush();
+        uint32_t patchMisses = 0;
+        for (size_t t = start; t < end; ++t) patchMisses += cache.update(&indices[3 * t]);
+        const float patchThreshold = threshold * static_cast<float>(patchMisses) / static_cast<float>(end - start);
+
+        cache.flush();
+        clusters.push_back(start);
+        uint32_t runningMisses = 0;
+        uint32_t runningTriangles = 0;
+        for (size_t t = start; t < end; ++t) {
+            runningMisses += cache.update(&indices[3 * t]);
+            ++runningTriangles;
+            if (t + 1 < end && static_cast<float>(runningMisses) / static_cast<float>(runningTriangles) <= patchThreshold) {
+                clusters.push_back(t + 1);
+                cache.flush();
+                runningMisses = 0;
+                runningTriangles = 0;
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    // 3. Outermost, outward-facing clusters first
+    sortClusters(indices, vertices, clusters);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                                     const std::vector<uint32_t>& clusterStarts) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2 || vertices.empty() || clusterStarts.empty()) return;
+
+    std::vector<size_t> clusters(clusterStarts.begin(), clusterStarts.end());
+    clusters.push_back(triangleCount);
+    sortClusters(indices, vertices, clusters);
+}
+
+MeshOptimizer::OverdrawStats MeshOptimizer::analyzeOverdraw(const std::vector<Vertex>& vertices,
+                                                            const std::vector<uint32_t>& indices,
+                                                            uint32_t resolution) {
+    OverdrawStats stats;
+    if (vertices.empty() || indices.size() < 3 || resolution == 0) return stats;
+
+    // Fit every view around the bounding sphere of the mesh
+    glm::vec3 boundsMin = vertices[0].pos;
+    glm::vec3 boundsMax = vertices[0].pos;
+    for (const Vertex& vertex : vertices) {
+        boundsMin = glm::min(boundsMin, vertex.pos);
+        boundsMax = glm::max(boundsMax, vertex.pos);
+    }
+    const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+    float radius = 0.0f;
+    for (const Vertex& vertex : vertices) radius = std::max(radius, glm::distance(vertex.pos, center));
+    if (radius <= 0.0f) return stats;
+
+    constexpr size_t VIEW_COUNT = sizeof(OVERDRAW_VIEWS) / sizeof(OVERDRAW_VIEWS[0]);
+    std::vector<uint64_t> covered(VIEW_COUNT, 0);
+    std::vector<uint64_t> shaded(VIEW_COUNT, 0);
+    const size_t triangleCount = indices.size() / 3;
+
+    Parallel::forEach(VIEW_COUNT, [&](size_t view) {
+        // Orthographic camera looking along forward, screen x/y in pixels
+        const glm::vec3 forward = glm::normalize(OVERDRAW_VIEWS[view]);
+        const glm::vec3 worldUp = std::abs(forward.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+        const glm::vec3 right = glm::normalize(glm::cross(forward, worldUp));
+        const glm::vec3 up = glm::cross(right, forward);
+        const float pixelScale = 0.5f * static_cast<float>(resolution) / radius;
+        const float half = 0.5f * static_cast<float>(resolution);
+
+        std::vector<float> depth(static_cast<size_t>(resolution) * resolution, std::numeric_limits<float>::max());
+        uint64_t viewShaded = 0;
+
+        for (size_t t = 0; t < triangleCount; ++t) {
+            glm::vec2 s[3];
+            float z[3];
+            for (int c = 0; c < 3; ++c) {
+                const glm::vec3 p = vertices[indices[3 * t + c]].pos - center;
+                s[c] = glm::vec2(glm::dot(p, right) * pixelScale + half, glm::dot(p, up) * pixelScale + half);
+                z[c] = glm::dot(p, forward);
+            }
+
+            // Back-face culling (counter-clockwise is front facing, as in the pipeline)
+            const float area = edge(s[0], s[1], s[2]);
+            if (area <= 0.0f) continue;
+
+            const int x0 = std::max(0, static_cast<int>(std::floor(std::min({s[0].x, s[1].x, s[2].x}))));
+            const int y0 = std::max(0, static_cast<int>(std::floor(std::min({s[0].y, s[1].y, s[2].y}))));
+            const int x1 = std::min(static_cast<int>(resolution) - 1, static_cast<int>(std::ceil(std::max({s[0].x, s[1].x, s[2].x}))));
+            const int y1 = std::min(static_cast<int>(resolution) - 1, static_cast<int>(std::ceil(std::max({s[0].y, s[1].y, s[2].y}))));
+
+            const bool topLeft0 = isTopLeft(s[1], s[2]);
+            const bool topLeft1 = isTopLeft(s[2], s[0]);
+            const bool topLeft2 = isTopLeft(s[0], s[1]);
+            const float inverseArea = 1.0f / area;
+
+            for (int y = y0; y <= y1; ++y) {
+                for (int x = x0; x <= x1; ++x) {
+                    const glm::vec2 p(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f);
+                    const float w0 = edge(s[1], s[2], p);
+                    const float w1 = edge(s[2], s[0], p);
+                    const float w2 = edge(s[0], s[1], p);
+                    if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+                    if ((w0 == 0.0f && !topLeft0) || (w1 == 0.0f && !topLeft1) || (w2 == 0.0f && !topLeft2)) continue;
+
+                    // Early depth test: only fragments in front of the stored depth are shaded
+                    const float fragmentDepth = (w0 * z[0] + w1 * z[1] + w2 * z[2]) * inverseArea;
+                    float& stored = depth[static_cast<size_t>(y) * resolution + x];
+                    if (fragmentDepth < stored) {
+                        stored = fragmentDepth;
+                        ++viewShaded;
+                    }
+                }
+            }
+        }
+
+        uint64_t viewCovered = 0;
+        for (float d : depth) viewCovered += d != std::numeric_limits<float>::max();
+        covered[view] = viewCovered;
+        shaded[view] = viewShaded;
+    });
+
+    for (size_t view = 0; view < VIEW_COUNT; ++view) {
+        stats.coveredPixels += covered[view];
+        stats.shadedPixels += shaded[view];
+    }
+    stats.overdraw = stats.coveredPixels > 0
+        ? static_cast<float>(stats.shadedPixels) / static_cast<float>(stats.coveredPixels) : 0.0f;
+    return stats;
+}
+
+MeshOptimizer::Report MeshOptimizer::optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                                              uint32_t cacheSize, float overdrawThreshold) {
+    Report report;
+    report.before = analyzeVertexCache(indices.data(), indices.size(), vertices.size(), cacheSize);
+    if (overdrawThreshold > 0.0f) report.overdrawBefore = analyzeOverdraw(vertices, indices);
+
+    optimizeVertexCache(indices, vertices.size(), cacheSize);
+    if (overdrawThreshold > 0.0f) optimizeOverdraw(indices, vertices, overdrawThreshold, cacheSize);
+    optimizeVertexFetch(vertices, indices);
+
+    report.after = analyzeVertexCache(indices.data(), indices.size(), vertices.size(), cacheSize);
+    if (overdrawThreshold > 0.0f) report.overdrawAfter = analyzeOverdraw(vertices, indices);
+    return report;
+}
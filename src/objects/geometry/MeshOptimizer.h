@@ -0,0 +1,140 @@
+#pragma once
+
+#include "../../common/Vertex.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Reorders indexed triangle meshes for the GPU's post-transform cache and vertex fetch.
+ *
+ * optimizeVertexCache() reorders triangles with Tipsify (Sander, Nehab, Barczak 2007):
+ * it fans around one vertex at a time, emitting all of its remaining triangles,
+ * and picks the next fanning vertex among the just-emitted ones that will still be
+ * in a FIFO cache of the given size. It runs in linear time and does not need to
+ * know the exact hardware cache size to help.
+ *
+ * optimizeOverdraw() optionally splits the cache-optimized triangle order into
+ * clusters and sorts them so that clusters likely to occlude others are drawn
+ * first (same paper, section 4). Clusters start wherever the cache order restarts
+ * (a triangle missing all three vertices) and are split further wherever the
+ * running ACMR drops below threshold times the cluster's ACMR; a higher threshold
+ * gives more, smaller clusters (less overdraw, worse cache efficiency). Clusters
+ * are sorted by how far out they face: dot(cluster centroid - mesh centroid,
+ * cluster normal), largest first. The result is view independent.
+ *
+ * optimizeVertexFetch() then renumbers vertices in the order the index buffer
+ * first references them, so vertex fetches walk memory nearly linearly.
+ *
+ * Cache efficiency is measured by simulating a FIFO cache:
+ * - ACMR (average cache miss ratio): transformed vertices per triangle (0.5 .. 3).
+ * - ATVR (average transform to vertex ratio): transformed vertices per unique vertex (1 is ideal).
+ *
+ * Overdraw is estimated without a GPU by rasterizing the mesh in submission order
+ * into a CPU depth buffer from 14 canonical views (6 axes, 8 diagonals), with
+ * back-face culling and a LESS depth test like our pipeline. Overdraw is shaded
+ * fragments per covered pixel (1 is ideal).
+ *
+ * Keywords: Vertex Cache Optimization, Tipsify, Vertex Fetch Locality, Overdraw Reduction, ACMR, ATVR
+ */
+class MeshOptimizer {
+public:
+    static constexpr uint32_t DEFAULT_CACHE_SIZE = 16;
+
+    /**
+     * @brief Result of a FIFO cache simulation over an index buffer.
+     */
+    struct CacheStats {
+        float acmr = 0.0f; // Cache misses per triangle
+        float atvr = 0.0f; // Cache misses per referenced vertex
+    };
+
+    /**
+     * @brief Result of the CPU overdraw estimate.
+     */
+    struct OverdrawStats {
+        float overdraw = 0.0f;     // Shaded fragments per covered pixel
+        uint64_t coveredPixels = 0; // Summed over all views
+        uint64_t shadedPixels = 0;  // Fragments that passed the depth test, summed over all views
+    };
+
+    /**
+     * @brief Statistics before and after optimize().
+     */
+    struct Report {
+        CacheStats before;
+        CacheStats after;
+        OverdrawStats overdrawBefore; // Only filled when overdraw optimization ran
+        OverdrawStats overdrawAfter;
+    };
+
+    /**
+     * @brief Simulates a FIFO post-transform cache over the index buffer.
+     * @param indices Triangle list indices.
+     * @param indexCount Number of indices (multiple of 3).
+     * @param vertexCount Number of vertices the indices refer to.
+     * @param cacheSize FIFO cache size in vertices.
+     */
+    static CacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                                         uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+    /**
+     * @brief Reorders triangles in place for the post-transform vertex cache (Tipsify).
+     * @param indices Triangle list indices, reordered in place.
+     * @param vertexCount Number of vertices the indices refer to.
+     * @param cacheSize Cache size the ordering targets.
+     */
+    static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount,
+                                    uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+    /**
+     * @brief Reorders clusters of triangles in place to reduce overdraw.
+     *
+     * Expects indices already ordered by optimizeVertexCache(); the order within a
+     * cluster is kept.
+     * @param indices Triangle list indices, reordered in place.
+     * @param vertices Vertex data (positions and vertex count are used).
+     * @param threshold How much ACMR may degrade, e.g. 1.05 allows 5%. Values <= 1 only use hard boundaries.
+     * @param cacheSize Cache size the ordering targets.
+     */
+    static void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                                 float threshold, uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+    /**
+     * @brief Sorts given clusters of triangles (e.g. meshlets) in place to reduce overdraw.
+     *
+     * Same sort as optimizeOverdraw(), but over clusters the caller already has, so
+     * every cluster stays contiguous and keeps its triangle order.
+     * @param indices Triangle list indices, reordered in place.
+     * @param vertices Vertex data (positions are used).
+     * @param clusterStarts First triangle of every cluster, ascending and starting at 0.
+     */
+    static void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                                 const std::vector<uint32_t>& clusterStarts);
+
+    /**
+     * @brief Estimates overdraw by rasterizing the mesh from canonical views on the CPU.
+     * @param vertices Vertex data.
+     * @param indices Triangle list indices, drawn in order.
+     * @param resolution Width and height of the depth buffer per view.
+     */
+    static OverdrawStats analyzeOverdraw(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                                         uint32_t resolution = 256);
+
+    /**
+     * @brief Renumbers vertices in order of first use and remaps the indices.
+     *
+     * Vertices no index refers to are dropped.
+     * @param vertices Vertex data, reordered in place.
+     * @param indices Index data, remapped in place.
+     */
+    static void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+    /**
+     * @brief Runs optimizeVertexCache(), optimizeOverdraw() (if enabled) and optimizeVertexFetch().
+     * @param overdrawThreshold Passed to optimizeOverdraw(); 0 skips the overdraw pass.
+     * @return ACMR/ATVR before and after, and overdraw before and after when that pass ran.
+     */
+    static Report optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                           uint32_t cacheSize = DEFAULT_CACHE_SIZE, float overdrawThreshold = 0.0f);
+};
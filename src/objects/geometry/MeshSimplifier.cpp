@@ -0,0 +1,446 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "VertexWelder.h"
+#include "../../common/Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+// Extra weight of the planes that keep unlocked borders in place
+constexpr double BORDER_WEIGHT = 10.0;
+
+/**
+ * @brief Symmetric 4x4 quadric (plane distance squared), stored as its 10 coefficients.
+ */
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0;
+    double b2 = 0, bc = 0, bd = 0;
+    double c2 = 0, cd = 0;
+    double d2 = 0;
+    double weight = 0; // Sum of the plane weights, to turn the error into a mean squared distance
+
+    void addPlane(double a, double b, double c, double d, double w) {
+        a2 += w * a * a; ab += w * a * b; ac += w * a * c; ad += w * a * d;
+        b2 += w * b * b; bc += w * b * c; bd += w * b * d;
+        c2 += w * c * c; cd += w * c * d;
+        d2 += w * d * d;
+        weight += w;
+    }
+
+    void add(const Quadric& q) {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+        weight += q.weight;
+    }
+
+    // Weighted sum of squared plane distances at p (not normalized by weight)
+    double evaluate(const glm::vec3& p) const {
+        const double x = p.x, y = p.y, z = p.z;
+        const double e = a2 * x * x + b2 * y * y + c2 * z * z
+                       + 2.0 * (ab * x * y + ac * x * z + bc * y * z)
+                       + 2.0 * (ad * x + bd * y + cd * z) + d2;
+        return std::max(e, 0.0);
+    }
+};
+
+// Float bit pattern with -0.0 folded onto +0.0
+inline uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits == 0x80000000u ? 0u : bits;
+}
+
+struct PositionKey {
+    uint32_t x, y, z;
+    bool operator==(const PositionKey& other) const { return x == other.x && y == other.y && z == other.z; }
+};
+
+struct PositionKeyHash {
+    size_t operator()(const PositionKey& key) const {
+        uint64_t h = 0xCBF29CE484222325ull;
+        h = (h ^ key.x) * 0x9E3779B97F4A7C15ull;
+        h = (h ^ key.y) * 0x9E3779B97F4A7C15ull;
+        h = (h ^ key.z) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+};
+
+struct Candidate {
+    double cost;     // Ordering cost: geometric error plus attribute change
+    double distance; // Geometric part only (mean squared distance to the original planes)
+    uint32_t from;   // Removed position
+    uint32_t to;   // Kept position
+
+    bool operator<(const Candidate& other) const {
+        if (cost != other.cost) return cost < other.cost;
+        if (from != other.from) return from < other.from;
+        return to < other.to;
+    }
+};
+
+inline uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+}
+
+/**
+ * @brief Position-level mesh that is collapsed step by step.
+ */
+class WorkingMesh {
+public:
+    WorkingMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                const MeshSimplifier::Options& options)
+        : options_(options) {
+        // 1. Merge vertices that share a position; attributes are averaged per position
+        std::unordered_map<PositionKey, uint32_t, PositionKeyHash> lookup;
+        lookup.reserve(vertices.size());
+        std::vector<uint32_t> positionOf(vertices.size());
+        std::vector<uint32_t> attributeCount;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            const Vertex& vertex = vertices[i];
+            const PositionKey key{floatBits(vertex.pos.x), floatBits(vertex.pos.y), floatBits(vertex.pos.z)};
+            auto inserted = lookup.emplace(key, static_cast<uint32_t>(positions_.size()));
+            if (inserted.second) {
+                positions_.push_back(vertex.pos);
+                colors_.push_back(glm::vec3(0.0f));
+                normals_.push_back(glm::vec3(0.0f));
+                attributeCount.push_back(0);
+            }
+            const uint32_t position = inserted.first->second;
+            positionOf[i] = position;
+            colors_[position] += vertex.color;
+            normals_[position] += vertex.normal;
+            ++attributeCount[position];
+        }
+        for (size_t p = 0; p < positions_.size(); ++p) {
+            colors_[p] /= static_cast<float>(attributeCount[p]);
+            const float length = glm::length(normals_[p]);
+            normals_[p] = length > 0.0f ? normals_[p] / length : glm::vec3(0.0f, 0.0f, 1.0f);
+        }
+
+        triangles_.reserve(indices.size());
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const uint32_t a = positionOf[indices[i]];
+            const uint32_t b = positionOf[indices[i + 1]];
+            const uint32_t c = positionOf[indices[i + 2]];
+            if (a == b || b == c || a == c) continue;
+            triangles_.insert(triangles_.end(), {a, b, c});
+        }
+
+        // 2. Attribute weights relative to the mesh size
+        glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+        if (!positions_.empty()) {
+            boundsMin = boundsMax = positions_[0];
+            for (const glm::vec3& p : positions_) {
+                boundsMin = glm::min(boundsMin, p);
+                boundsMax = glm::max(boundsMax, p);
+            }
+        }
+        const double extent = glm::length(boundsMax - boundsMin);
+        colorScale_ = (options.colorWeight * extent) * (options.colorWeight * extent);
+        normalScale_ = (options.normalWeight * extent) * (options.normalWeight * extent);
+        maxErrorSquared_ = (options.maxError * extent) * (options.maxError * extent);
+
+        buildQuadrics();
+    }
+
+    size_t triangleCount() const { return triangles_.size() / 3; }
+    double error() const { return std::sqrt(maxCollapseError_); }
+
+    /**
+     * @brief Collapses the cheapest non-overlapping edges until targetTriangles is reached.
+     * @return Number of collapses performed (0 when nothing could be collapsed).
+     */
+    size_t collapsePass(size_t targetTriangles) {
+        const size_t triangles = triangleCount();
+        if (triangles <= targetTriangles) return 0;
+        const size_t positionCount = positions_.size();
+
+        // Position -> triangle adjacency for this pass
+        std::vector<uint32_t> offsets(positionCount + 1, 0);
+        for (uint32_t p : triangles_) ++offsets[p + 1];
+        for (size_t p = 0; p < positionCount; ++p) offsets[p + 1] += offsets[p];
+        std::vector<uint32_t> adjacency(triangles_.size());
+        {
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < triangles_.size(); ++i) adjacency[cursor[triangles_[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        // Unique edges, each with its cheaper collapse direction
+        std::vector<uint64_t> edges;
+        edges.reserve(triangles_.size());
+        for (size_t t = 0; t < triangles; ++t) {
+            for (int e = 0; e < 3; ++e) {
+                edges.push_back(edgeKey(triangles_[3 * t + e], triangles_[3 * t + (e + 1) % 3]));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        std::vector<Candidate> candidates;
+        candidates.reserve(edges.size());
+        for (uint64_t edge : edges) {
+            const uint32_t a = static_cast<uint32_t>(edge >> 32);
+            const uint32_t b = static_cast<uint32_t>(edge & 0xFFFFFFFFu);
+            Candidate best{0.0, 0.0, 0, 0};
+            bool found = false;
+            if (!locked_[a]) {
+                best = collapseCandidate(a, b);
+                found = true;
+            }
+            if (!locked_[b]) {
+                const Candidate reverse = collapseCandidate(b, a);
+                if (!found || reverse < best) best = reverse;
+                found = true;
+            }
+            if (found && best.distance <= maxErrorSquared_) candidates.push_back(best);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        // Collapse in cost order; a collapse locks the one-ring of the removed position
+        // for the rest of the pass, so the flip checks below stay valid
+        std::vector<uint32_t> remap(positionCount);
+        for (size_t p = 0; p < positionCount; ++p) remap[p] = static_cast<uint32_t>(p);
+        std::vector<uint8_t> touched(positionCount, 0);
+        const size_t needed = triangles - targetTriangles;
+        size_t removed = 0;
+        size_t collapses = 0;
+
+        for (const Candidate& candidate : candidates) {
+            if (removed >= needed) break;
+            const uint32_t u = candidate.from;
+            const uint32_t v = candidate.to;
+            if (touched[u] || touched[v]) continue;
+            if (flipsTriangle(u, v, offsets, adjacency)) continue;
+
+            size_t shared = 0;
+            for (uint32_t a = offsets[u]; a < offsets[u + 1]; ++a) {
+                const uint32_t* tri = &triangles_[3 * static_cast<size_t>(adjacency[a])];
+                if (tri[0] == v || tri[1] == v || tri[2] == v) ++shared;
+                touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+            }
+
+            remap[u] = v;
+            quadrics_[v].add(quadrics_[u]);
+            maxCollapseError_ = std::max(maxCollapseError_, candidate.distance);
+            removed += shared;
+            ++collapses;
+        }
+
+        // Apply the collapses and drop the triangles that became degenerate
+        size_t write = 0;
+        for (size_t t = 0; t < triangles; ++t) {
+            const uint32_t a = remap[triangles_[3 * t]];
+            const uint32_t b = remap[triangles_[3 * t + 1]];
+            const uint32_t c = remap[triangles_[3 * t + 2]];
+            if (a == b || b == c || a == c) continue;
+            triangles_[write++] = a;
+            triangles_[write++] = b;
+            triangles_[write++] = c;
+        }
+        triangles_.resize(write);
+        return collapses;
+    }
+
+    /**
+     * @brief Converts the current triangles back to our Vertex format.
+     */
+    void emit(std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices) const {
+        outVertices.clear();
+        outIndices.clear();
+        outIndices.reserve(triangles_.size());
+
+        if (options_.flatShading) {
+            // Per-face normals, identical corners shared (as in ObjLoader)
+            VertexWelder welder(outVertices, 0.0f, triangles_.size() / 2);
+            for (size_t t = 0; t + 2 < triangles_.size(); t += 3) {
+                const glm::vec3& p0 = positions_[triangles_[t]];
+                const glm::vec3& p1 = positions_[triangles_[t + 1]];
+                const glm::vec3& p2 = positions_[triangles_[t + 2]];
+                const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+                const float length = glm::length(cross);
+                const glm::vec3 normal = length > 0.0f ? cross / length : glm::vec3(0.0f, 0.0f, 1.0f);
+                for (int c = 0; c < 3; ++c) {
+                    const uint32_t p = triangles_[t + c];
+                    Vertex vertex{};
+                    vertex.pos = positions_[p];
+                    vertex.normal = normal;
+                    vertex.color = colors_[p];
+                    outIndices.push_back(welder.insert(vertex));
+                }
+            }
+        } else {
+            std::vector<uint32_t> local(positions_.size(), 0xFFFFFFFFu);
+            for (uint32_t p : triangles_) {
+                if (local[p] == 0xFFFFFFFFu) {
+                    local[p] = static_cast<uint32_t>(outVertices.size());
+                    Vertex vertex{};
+                    vertex.pos = positions_[p];
+                    vertex.normal = normals_[p];
+                    vertex.color = colors_[p];
+                    outVertices.push_back(vertex);
+                }
+                outIndices.push_back(local[p]);
+            }
+        }
+
+        MeshOptimizer::optimizeVertexCache(outIndices, outVertices.size());
+        MeshOptimizer::optimizeVertexFetch(outVertices, outIndices);
+    }
+
+private:
+    const MeshSimplifier::Options& options_;
+    std::vector<glm::vec3> positions_;
+    std::vector<glm::vec3> colors_;
+    std::vector<glm::vec3> normals_;
+    std::vector<Quadric> quadrics_;
+    std::vector<uint8_t> locked_;   // Positions that may not be removed
+    std::vector<uint32_t> triangles_;
+    double colorScale_ = 0.0;
+    double normalScale_ = 0.0;
+    double maxErrorSquared_ = 0.0;
+    double maxCollapseError_ = 0.0; // Largest squared geometric collapse error so far
+
+    void buildQuadrics() {
+        quadrics_.assign(positions_.size(), Quadric{});
+        locked_.assign(positions_.size(), 0);
+
+        // Edge use counts: 1 = open border, > 2 = non-manifold
+        std::vector<uint64_t> edges;
+        edges.reserve(triangles_.size());
+        for (size_t t = 0; t < triangles_.size(); t += 3) {
+            for (int e = 0; e < 3; ++e) edges.push_back(edgeKey(triangles_[t + e], triangles_[t + (e + 1) % 3]));
+        }
+        std::sort(edges.begin(), edges.end());
+        auto edgeUses = [&](uint32_t a, uint32_t b) {
+            const auto range = std::equal_range(edges.begin(), edges.end(), edgeKey(a, b));
+            return static_cast<size_t>(range.second - range.first);
+        };
+
+        for (size_t t = 0; t < triangles_.size(); t += 3) {
+            const glm::vec3& p0 = positions_[triangles_[t]];
+            const glm::vec3& p1 = positions_[triangles_[t + 1]];
+            const glm::vec3& p2 = positions_[triangles_[t + 2]];
+            const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+            const double length = glm::length(cross);
+            if (length <= 0.0) continue;
+
+            // Face plane, weighted by area
+            const glm::vec3 normal = cross / static_cast<float>(length);
+            const double d = -glm::dot(normal, p0);
+            const double area = 0.5 * length;
+            for (int c = 0; c < 3; ++c) {
+                quadrics_[triangles_[t + c]].addPlane(normal.x, normal.y, normal.z, d, area);
+            }
+
+            for (int e = 0; e < 3; ++e) {
+                const uint32_t a = triangles_[t + e];
+                const uint32_t b = triangles_[t + (e + 1) % 3];
+                const size_t uses = edgeUses(a, b);
+                if (uses == 2) continue;
+
+                if (options_.lockBorders || uses > 2) {
+                    locked_[a] = locked_[b] = 1;
+                    continue;
+                }
+
+                // Open border: a plane through the edge, perpendicular to the face, keeps it from moving inwards
+                const glm::vec3 edgeVector = positions_[b] - positions_[a];
+                const glm::vec3 borderNormal = glm::cross(edgeVector, normal);
+                const float borderLength = glm::length(borderNormal);
+                if (borderLength <= 0.0f) continue;
+                const glm::vec3 n = borderNormal / borderLength;
+                const double bd = -glm::dot(n, positions_[a]);
+                const double weight = BORDER_WEIGHT * glm::dot(edgeVector, edgeVector);
+                quadrics_[a].addPlane(n.x, n.y, n.z, bd, weight);
+                quadrics_[b].addPlane(n.x, n.y, n.z, bd, weight);
+            }
+        }
+    }
+
+    // Collapse of from onto to: mean squared distance of both quadrics at the kept
+    // position, plus the attribute change for ordering
+    Candidate collapseCandidate(uint32_t from, uint32_t to) const {
+        const Quadric& qFrom = quadrics_[from];
+        const Quadric& qTo = quadrics_[to];
+        const double weight = qFrom.weight + qTo.weight;
+        const double distance =
+            weight > 0.0 ? (qFrom.evaluate(positions_[to]) + qTo.evaluate(positions_[to])) / weight : 0.0;
+
+        const glm::vec3 colorDelta = colors_[from] - colors_[to];
+        double cost = distance + colorScale_ * glm::dot(colorDelta, colorDelta);
+        if (normalScale_ > 0.0) {
+            const glm::vec3 normalDelta = normals_[from] - normals_[to];
+            cost += normalScale_ * glm::dot(normalDelta, normalDelta);
+        }
+        return {cost, distance, from, to};
+    }
+
+    // Whether moving position u onto v turns any remaining face around u upside down
+    bool flipsTriangle(uint32_t u, uint32_t v, const std::vector<uint32_t>& offsets,
+                       const std::vector<uint32_t>& adjacency) const {
+        for (uint32_t a = offsets[u]; a < offsets[u + 1]; ++a) {
+            const uint32_t* tri = &triangles_[3 * static_cast<size_t>(adjacency[a])];
+            if (tri[0] == v || tri[1] == v || tri[2] == v) continue; // Removed by the collapse
+
+            glm::vec3 corners[3] = {positions_[tri[0]], positions_[tri[1]], positions_[tri[2]]};
+            const glm::vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+            for (int c = 0; c < 3; ++c) {
+                if (tri[c] == u) corners[c] = positions_[v];
+            }
+            const glm::vec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+            if (glm::dot(before, after) <= 0.0f) return true;
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+std::vector<MeshLod> MeshSimplifier::appendLodChain(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                                                    const std::vector<float>& ratios, const Options& options) {
+    std::vector<MeshLod> lods;
+    if (vertices.empty() || indices.empty()) return lods;
+
+    MeshLod base;
+    base.indexCount = static_cast<uint32_t>(indices.size());
+    lods.push_back(base);
+
+    WorkingMesh mesh(vertices, indices, options);
+    const size_t baseTriangles = mesh.triangleCount();
+    size_t previousTriangles = baseTriangles;
+
+    std::vector<Vertex> lodVertices;
+    std::vector<uint32_t> lodIndices;
+    for (float ratio : ratios) {
+        const size_t target = static_cast<size_t>(static_cast<double>(baseTriangles) * ratio);
+        while (mesh.triangleCount() > target && mesh.collapsePass(target) > 0) {}
+
+        // Nothing gained over the previous level (error limit or fully locked)
+        if (mesh.triangleCount() == 0 || mesh.triangleCount() >= previousTriangles) break;
+        previousTriangles = mesh.triangleCount();
+
+        mesh.emit(lodVertices, lodIndices);
+        MeshLod lod;
+        lod.firstIndex = static_cast<uint32_t>(indices.size());
+        lod.indexCount = static_cast<uint32_t>(lodIndices.size());
+        lod.vertexOffset = static_cast<int32_t>(vertices.size());
+        lod.error = static_cast<float>(mesh.error());
+        lods.push_back(lod);
+
+        vertices.insert(vertices.end(), lodVertices.begin(), lodVertices.end());
+        indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+    }
+    return lods;
+}
+
+void MeshSimplifier::appendLodChains(const std::vector<Job>& jobs, const std::vector<float>& ratios,
+                                     const Options& options) {
+    Parallel::forEach(jobs.size(), [&](size_t i) {
+        *jobs[i].lods = appendLodChain(*jobs[i].vertices, *jobs[i].indices, ratios, options);
+    });
+}
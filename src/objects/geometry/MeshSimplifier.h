@@ -0,0 +1,83 @@
+#pragma once
+
+#include "MeshView.h"
+#include "../../common/Vertex.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Quadric error metric (QEM) edge-collapse simplifier producing LOD chains.
+ *
+ * Simplification runs on the position topology: vertices that only differ in
+ * normal or color (e.g. the flat-shaded corners ObjLoader emits) are merged first,
+ * so faces stay connected. Each position accumulates the area-weighted plane
+ * quadrics of its faces (Garland and Heckbert 1997), and edges are collapsed onto
+ * one of their endpoints (half-edge collapse), so every output position is an
+ * input position and attributes never have to be interpolated.
+ *
+ * The collapse cost is the quadric error at the kept position plus a weighted
+ * color (and optionally normal) difference, so collapses across attribute
+ * boundaries are postponed. Collapses that would flip a face are rejected, and
+ * vertices on open borders or non-manifold edges can be locked.
+ *
+ * Collapses are done in passes: all candidate edges are sorted by cost and the
+ * cheapest non-overlapping ones are collapsed. The result depends only on the
+ * input, so LODs are deterministic and can be cached on disk. A chain keeps
+ * collapsing the same working mesh and emits a level at each target ratio.
+ *
+ * Keywords: Mesh Simplification, Quadric Error Metric, Edge Collapse, Level of Detail
+ */
+class MeshSimplifier {
+public:
+    // Triangle counts of the levels of detail generated for loaded and packaged models,
+    // relative to the full mesh (shared so .vmesh caches and .vpak packages agree)
+    static inline const std::vector<float> DEFAULT_LOD_RATIOS = {0.5f, 0.25f, 0.125f, 0.0625f};
+
+    /**
+     * @brief Simplification settings.
+     */
+    struct Options {
+        bool lockBorders = true;   // Keep vertices on open borders and non-manifold edges in place
+        float colorWeight = 0.05f; // Error per unit of color difference, as a fraction of the mesh extent
+        float normalWeight = 0.0f; // Same for vertex normals (useful for smooth normals only)
+        bool flatShading = true;   // Emit per-face normals like ObjLoader instead of the input normals
+        float maxError = 1.0f;     // Stop collapsing past this error, as a fraction of the mesh extent
+
+        // Settings for input with smooth (shared) or flat (per-face) normals, so every level is
+        // shaded like LOD 0: smooth normals are kept and weigh in the collapse cost
+        static Options forNormals(bool smoothNormals) {
+            Options options;
+            options.flatShading = !smoothNormals;
+            options.normalWeight = smoothNormals ? 0.05f : 0.0f;
+            return options;
+        }
+    };
+
+    /**
+     * @brief One mesh to simplify in appendLodChains().
+     */
+    struct Job {
+        std::vector<Vertex>* vertices;
+        std::vector<uint32_t>* indices;
+        std::vector<MeshLod>* lods;
+    };
+
+    /**
+     * @brief Appends simplified levels of detail to a mesh.
+     * @param vertices Vertex data; the existing content is LOD 0 and each LOD's vertices are appended.
+     * @param indices Index data; the existing content is LOD 0 and each LOD's indices are appended.
+     * @param ratios Target triangle counts as fractions of LOD 0, in decreasing order (e.g. 0.5, 0.25).
+     * @param options Simplification settings.
+     * @return The LOD table, LOD 0 first. A level is omitted when it could not be
+     *         simplified further than the previous one (e.g. maxError was reached).
+     */
+    static std::vector<MeshLod> appendLodChain(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                                               const std::vector<float>& ratios, const Options& options);
+
+    /**
+     * @brief Runs appendLodChain() for several meshes in parallel (one task per mesh).
+     */
+    static void appendLodChains(const std::vector<Job>& jobs, const std::vector<float>& ratios,
+                                const Options& options);
+};
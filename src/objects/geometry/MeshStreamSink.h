@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../../common/Vertex.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Destination for mesh data produced incrementally by a streaming importer.
+ *
+ * The importer asks the sink for writable space, converts data straight into it and
+ * then commits what it wrote. This lets a renderer hand out pointers into mapped
+ * staging memory so streamed geometry never passes through an intermediate buffer.
+ * Space is handed out in spans; a span may be smaller than requested but always
+ * holds at least one element.
+ *
+ * Keywords: Streaming Import, Producer/Consumer, Zero-Copy, Staging Memory
+ */
+class MeshStreamSink {
+public:
+    virtual ~MeshStreamSink() = default;
+
+    /**
+     * @brief Called once before any data with the exact totals.
+     * @param vertexCount Total number of vertices that will be committed.
+     * @param indexCount Total number of indices that will be committed.
+     * @param stagingBudget Bytes of host memory the sink may use for staging.
+     */
+    virtual void begin(size_t vertexCount, size_t indexCount, size_t stagingBudget) = 0;
+
+    /**
+     * @brief Returns writable space for between 1 and maxCount vertices.
+     * @param maxCount Number of vertices the caller would like to write.
+     * @param count Receives the number of vertices that fit in the returned span.
+     */
+    virtual Vertex* acquireVertices(size_t maxCount, size_t& count) = 0;
+
+    /**
+     * @brief Commits the first count vertices written to the last acquired span.
+     */
+    virtual void commitVertices(size_t count) = 0;
+
+    /**
+     * @brief Returns writable space for between 1 and maxCount indices.
+     */
+    virtual uint32_t* acquireIndices(size_t maxCount, size_t& count) = 0;
+
+    /**
+     * @brief Commits the first count indices written to the last acquired span.
+     */
+    virtual void commitIndices(size_t count) = 0;
+
+    /**
+     * @brief Called once after all data has been committed. Blocks until the data is in place.
+     */
+    virtual void finish() = 0;
+
+    /**
+     * @brief Host memory currently used by the sink for staging, in bytes.
+     */
+    virtual size_t stagingBytes() const = 0;
+};
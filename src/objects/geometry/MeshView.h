@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../../common/Vertex.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief One level of detail inside a mesh's vertex and index data.
+ *
+ * All levels live in the same vertex/index arrays; a level is drawn with
+ * vkCmdDrawIndexed(indexCount, 1, firstIndex, vertexOffset, 0).
+ */
+struct MeshLod {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int32_t vertexOffset = 0;
+    float error = 0.0f;       // Geometric deviation from the full mesh, in model units
+};
+
+/**
+ * @brief Non-owning view of indexed triangle mesh data.
+ *
+ * Lets the renderer upload vertices and indices without caring whether they live
+ * in std::vectors owned by the Scene or in a memory-mapped mesh cache file. The
+ * owner must keep the data alive while the view is in use.
+ *
+ * When the mesh has levels of detail, lods describes them (finest first) and the
+ * arrays hold all of them back to back; without LODs the whole index range is
+ * the only level.
+ *
+ * Keywords: Mesh View, Non-Owning Span, Zero-Copy Upload
+ */
+struct MeshView {
+    const Vertex* vertices = nullptr;
+    size_t vertexCount = 0;
+    const uint32_t* indices = nullptr;
+    size_t indexCount = 0;
+    const MeshLod* lods = nullptr;
+    size_t lodCount = 0;
+
+    MeshView() = default;
+    MeshView(const Vertex* vertexData, size_t numVertices, const uint32_t* indexData, size_t numIndices)
+        : vertices(vertexData), vertexCount(numVertices), indices(indexData), indexCount(numIndices) {}
+    MeshView(const std::vector<Vertex>& vertexData, const std::vector<uint32_t>& indexData)
+        : vertices(vertexData.data()), vertexCount(vertexData.size()),
+          indices(indexData.data()), indexCount(indexData.size()) {}
+
+    MeshView(const std::vector<Vertex>& vertexData, const std::vector<uint32_t>& indexData,
+             const std::vector<MeshLod>& lodData)
+        : MeshView(vertexData, indexData) {
+        lods = lodData.data();
+        lodCount = lodData.size();
+    }
+
+    bool empty() const { return vertexCount == 0 || indexCount == 0; }
+
+    /**
+     * @brief Checks that every index addresses a vertex of its own level of detail.
+     *
+     * A level's vertices run from its vertexOffset to the next level's (or the end of
+     * the array), and its indices are relative to its vertexOffset. Without LODs every
+     * index must be below vertexCount. The LOD table itself must already be in bounds.
+     * Data read from disk goes through this before anything dereferences the indices.
+     */
+    bool indicesInRange() const {
+        if (lodCount == 0) return indicesBelow(0, indexCount, vertexCount);
+        for (size_t i = 0; i < lodCount; ++i) {
+            const size_t first = static_cast<size_t>(lods[i].vertexOffset);
+            size_t end = vertexCount;
+            for (size_t j = 0; j < lodCount; ++j) {
+                const size_t other = static_cast<size_t>(lods[j].vertexOffset);
+                if (other > first && other < end) end = other;
+            }
+            if (!indicesBelow(lods[i].firstIndex, lods[i].indexCount, end - first)) return false;
+        }
+        return true;
+    }
+
+private:
+    bool indicesBelow(size_t first, size_t count, size_t limit) const {
+        uint32_t largest = 0;
+        for (size_t i = first; i < first + count; ++i) largest = indices[i] > largest ? indices[i] : largest;
+        return count == 0 || largest < limit;
+    }
+};
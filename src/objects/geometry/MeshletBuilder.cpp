@@ -0,0 +1,344 @@
+#include "MeshletBuilder.h"
+#include "Bounds.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+// Cones whose triangles deviate this much from the axis (dot <= value) are not worth testing
+constexpr float MIN_CONE_DOT = 0.1f;
+// How much facing away from the meshlet's average normal counts against a candidate,
+// relative to its distance (in meshlet radii)
+constexpr float CONE_WEIGHT = 2.0f;
+constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+// Float bit pattern with -0.0 folded onto +0.0
+inline uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits == 0x80000000u ? 0u : bits;
+}
+
+struct PositionKey {
+    uint32_t x, y, z;
+    bool operator==(const PositionKey& other) const { return x == other.x && y == other.y && z == other.z; }
+};
+
+struct PositionKeyHash {
+    size_t operator()(const PositionKey& key) const {
+        uint64_t h = 0xCBF29CE484222325ull;
+        h = (h ^ key.x) * 0x9E3779B97F4A7C15ull;
+        h = (h ^ key.y) * 0x9E3779B97F4A7C15ull;
+        h = (h ^ key.z) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+};
+
+} // namespace
+
+void MeshletBuilder::build(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount,
+                           std::vector<Meshlet>& meshlets, std::vector<MeshletBounds>& bounds,
+                           std::vector<uint32_t>* meshletVertices, std::vector<uint8_t>* meshletTriangles,
+                           uint32_t maxVertices, uint32_t maxTriangles) {
+    meshlets.clear();
+    bounds.clear();
+    if (meshletVertices) meshletVertices->clear();
+    if (meshletTriangles) meshletTriangles->clear();
+    if (vertexCount == 0 || indexCount < 3) return;
+
+    // Local indices must fit in a byte
+    maxVertices = std::min(std::max(maxVertices, 3u), 256u);
+    maxTriangles = std::max(maxTriangles, 1u);
+
+    // owner[v] is the meshlet (+1) that v was last added to, slot[v] its local index there;
+    // comparing against the current meshlet avoids clearing the arrays per meshlet
+    std::vector<uint32_t> owner(vertexCount, 0);
+    std::vector<uint8_t> slot(vertexCount, 0);
+    const size_t triangleCount = indexCount / 3;
+    meshlets.reserve(triangleCount / maxTriangles + 1);
+    bounds.reserve(triangleCount / maxTriangles + 1);
+
+    Meshlet current;
+    uint32_t currentId = 1;
+    uint32_t vertexListSize = 0; // Total vertex list entries, also without a meshletVertices output
+
+    auto finishMeshlet = [&]() {
+        if (current.triangleCount == 0) return;
+        meshlets.push_back(current);
+        bounds.push_back(computeBounds(vertices, indices + 3 * static_cast<size_t>(current.triangleOffset),
+                                       3 * static_cast<size_t>(current.triangleCount)));
+        vertexListSize += current.vertexCount;
+    };
+
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const uint32_t a = indices[3 * t];
+        const uint32_t b = indices[3 * t + 1];
+        const uint32_t c = indices[3 * t + 2];
+
+        // Vertices this triangle would add to the current meshlet
+        const uint32_t newVertices = (owner[a] != currentId ? 1u : 0u)
+                                   + (owner[b] != currentId && b != a ? 1u : 0u)
+                                   + (owner[c] != currentId && c != a && c != b ? 1u : 0u);
+        if (current.vertexCount + newVertices > maxVertices || current.triangleCount + 1 > maxTriangles) {
+            finishMeshlet();
+            current = Meshlet();
+            current.vertexOffset = vertexListSize;
+            current.triangleOffset = static_cast<uint32_t>(t);
+            ++currentId;
+        }
+
+        for (uint32_t v : {a, b, c}) {
+            if (owner[v] != currentId) {
+                owner[v] = currentId;
+                slot[v] = static_cast<uint8_t>(current.vertexCount++);
+                if (meshletVertices) meshletVertices->push_back(v);
+            }
+            if (meshletTriangles) meshletTriangles->push_back(slot[v]);
+        }
+        ++current.triangleCount;
+    }
+    finishMeshlet();
+}
+
+void MeshletBuilder::orderTriangles(uint32_t* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount,
+                                    uint32_t maxVertices, uint32_t maxTriangles) {
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2 || vertexCount == 0) return;
+    maxVertices = std::min(std::max(maxVertices, 3u), 256u);
+    maxTriangles = std::max(maxTriangles, 1u);
+
+    // --- 1. Surface connectivity through shared positions ---
+    std::vector<uint32_t> positionOf(vertexCount);
+    {
+        std::unordered_map<PositionKey, uint32_t, PositionKeyHash> lookup;
+        lookup.reserve(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            const glm::vec3& p = vertices[v].pos;
+            const PositionKey key{floatBits(p.x), floatBits(p.y), floatBits(p.z)};
+            positionOf[v] = lookup.emplace(key, static_cast<uint32_t>(lookup.size())).first->second;
+        }
+    }
+    size_t positionCount = 0;
+    for (uint32_t p : positionOf) positionCount = std::max(positionCount, static_cast<size_t>(p) + 1);
+
+    std::vector<uint32_t> offsets(positionCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) ++offsets[positionOf[indices[i]] + 1];
+    for (size_t p = 0; p < positionCount; ++p) offsets[p + 1] += offsets[p];
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i) {
+            adjacency[cursor[positionOf[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<glm::vec3> centroids(triangleCount);
+    std::vector<glm::vec3> normals(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const glm::vec3& p0 = vertices[indices[3 * t]].pos;
+        const glm::vec3& p1 = vertices[indices[3 * t + 1]].pos;
+        const glm::vec3& p2 = vertices[indices[3 * t + 2]].pos;
+        centroids[t] = (p0 + p1 + p2) / 3.0f;
+        const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+        const float length = glm::length(cross);
+        normals[t] = length > 0.0f ? cross / length : glm::vec3(0.0f);
+    }
+
+    // --- 2. Grow meshlets greedily ---
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> candidateStamp(triangleCount, 0); // Meshlet that last listed the triangle
+    std::vector<uint32_t> owner(vertexCount, 0);            // Meshlet that last used the vertex
+    std::vector<uint32_t> order;
+    order.reserve(triangleCount);
+    std::vector<uint32_t> meshletStarts; // First entry of every meshlet in order
+    std::vector<uint32_t> candidates;
+
+    size_t scan = 0;
+    uint32_t meshletId = 0;
+    while (order.size() < triangleCount) {
+        ++meshletId;
+        meshletStarts.push_back(static_cast<uint32_t>(order.size()));
+        uint32_t meshletVertices = 0;
+        uint32_t meshletTriangles = 0;
+        glm::vec3 centroidSum(0.0f);
+        glm::vec3 normalSum(0.0f);
+        glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+
+        // Continue next to the previous meshlet when possible, so the surface is covered without holes
+        uint32_t seed = NONE;
+        for (uint32_t candidate : candidates) {
+            if (!emitted[candidate]) {
+                seed = candidate;
+                break;
+            }
+        }
+        if (seed == NONE) {
+            while (emitted[scan]) ++scan;
+            seed = static_cast<uint32_t>(scan);
+        }
+        candidates.clear();
+
+        auto addTriangle = [&](uint32_t t) {
+            emitted[t] = 1;
+            order.push_back(t);
+            for (int c = 0; c < 3; ++c) {
+                const uint32_t v = indices[3 * static_cast<size_t>(t) + c];
+                if (owner[v] != meshletId) {
+                    owner[v] = meshletId;
+                    ++meshletVertices;
+                }
+                const glm::vec3& p = vertices[v].pos;
+                if (meshletTriangles == 0 && c == 0) boundsMin = boundsMax = p;
+                boundsMin = glm::min(boundsMin, p);
+                boundsMax = glm::max(boundsMax, p);
+
+                const uint32_t position = positionOf[v];
+                for (uint32_t a = offsets[position]; a < offsets[position + 1]; ++a) {
+                    const uint32_t neighbour = adjacency[a];
+                    if (!emitted[neighbour] && candidateStamp[neighbour] != meshletId) {
+                        candidateStamp[neighbour] = meshletId;
+                        candidates.push_back(neighbour);
+                    }
+                }
+            }
+            ++meshletTriangles;
+            centroidSum += centroids[t];
+            normalSum += normals[t];
+        };
+        addTriangle(seed);
+
+        while (meshletTriangles < maxTriangles) {
+            const glm::vec3 center = centroidSum / static_cast<float>(meshletTriangles);
+            const float normalLength = glm::length(normalSum);
+            const glm::vec3 axis = normalLength > 0.0f ? normalSum / normalLength : glm::vec3(0.0f);
+            const float radius = std::max(glm::length(boundsMax - boundsMin) * 0.5f, 1e-20f);
+
+            // Best candidate: fewest new vertices, then closest and best aligned
+            uint32_t best = NONE;
+            uint32_t bestNew = 4;
+            float bestScore = 0.0f;
+            size_t write = 0;
+            for (size_t k = 0; k < candidates.size(); ++k) {
+                const uint32_t t = candidates[k];
+                if (emitted[t]) continue; // Drop from the list
+                candidates[write++] = t;
+
+                uint32_t newVertices = 0;
+                for (int c = 0; c < 3; ++c) {
+                    const uint32_t v = indices[3 * static_cast<size_t>(t) + c];
+                    if (owner[v] != meshletId) {
+                        // Count repeated new vertices of a degenerate triangle once
+                        bool repeated = false;
+                        for (int e = 0; e < c; ++e) repeated |= indices[3 * static_cast<size_t>(t) + e] == v;
+                        if (!repeated) ++newVertices;
+                    }
+                }
+                if (meshletVertices + newVertices > maxVertices) continue;
+
+                const float score = glm::length(centroids[t] - center) / radius
+                                  + CONE_WEIGHT * (1.0f - glm::dot(normals[t], axis));
+                if (newVertices < bestNew || (newVertices == bestNew && score < bestScore)) {
+                    best = t;
+                    bestNew = newVertices;
+                    bestScore = score;
+                }
+            }
+            candidates.resize(write);
+            if (best == NONE) break;
+            addTriangle(best);
+        }
+    }
+
+    // --- 3. Write the triangles back in meshlet order, each meshlet in vertex cache order ---
+    // Tipsify runs on the meshlet's vertices renumbered from 0 in order of first use, so it
+    // starts with the meshlet's first triangle and build() still cuts the meshlet there.
+    meshletStarts.push_back(static_cast<uint32_t>(triangleCount));
+    std::vector<uint32_t> reordered(triangleCount * 3);
+    std::vector<uint32_t> localIndex(vertexCount); // Valid while owner[v] is the current meshlet
+    std::vector<uint32_t> meshletVertices;         // Local to global vertex index
+    std::vector<uint32_t> local;
+    for (size_t m = 0; m + 1 < meshletStarts.size(); ++m) {
+        ++meshletId;
+        meshletVertices.clear();
+        local.clear();
+        for (uint32_t i = meshletStarts[m]; i < meshletStarts[m + 1]; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                const uint32_t v = indices[3 * static_cast<size_t>(order[i]) + c];
+                if (owner[v] != meshletId) {
+                    owner[v] = meshletId;
+                    localIndex[v] = static_cast<uint32_t>(meshletVertices.size());
+                    meshletVertices.push_back(v);
+                }
+                local.push_back(localIndex[v]);
+            }
+        }
+        MeshOptimizer::optimizeVertexCache(local, meshletVertices.size());
+        uint32_t* out = &reordered[3 * static_cast<size_t>(meshletStarts[m])];
+        for (size_t i = 0; i < local.size(); ++i) out[i] = meshletVertices[local[i]];
+    }
+    std::memcpy(indices, reordered.data(), reordered.size() * sizeof(uint32_t));
+}
+
+MeshOptimizer::Report MeshletBuilder::optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                                               bool sortForOverdraw, uint32_t cacheSize) {
+    MeshOptimizer::Report report;
+    report.before = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), vertices.size(), cacheSize);
+    if (sortForOverdraw) report.overdrawBefore = MeshOptimizer::analyzeOverdraw(vertices, indices);
+
+    orderTriangles(indices.data(), indices.size(), vertices.data(), vertices.size());
+    if (sortForOverdraw) {
+        // Sort whole meshlets, as build() will cut them, so the clusters stay intact
+        std::vector<Meshlet> meshlets;
+        std::vector<MeshletBounds> bounds;
+        build(vertices.data(), vertices.size(), indices.data(), indices.size(), meshlets, bounds);
+        std::vector<uint32_t> starts(meshlets.size());
+        for (size_t m = 0; m < meshlets.size(); ++m) starts[m] = meshlets[m].triangleOffset;
+        MeshOptimizer::optimizeOverdraw(indices, vertices, starts);
+    }
+    MeshOptimizer::optimizeVertexFetch(vertices, indices);
+
+    report.after = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), vertices.size(), cacheSize);
+    if (sortForOverdraw) report.overdrawAfter = MeshOptimizer::analyzeOverdraw(vertices, indices);
+    return report;
+}
+
+MeshletBounds MeshletBuilder::computeBounds(const Vertex* vertices, const uint32_t* indices, size_t indexCount) {
+    MeshletBounds result;
+    if (indexCount < 3) return result;
+
+    // Sphere: near-minimal around the meshlet's corners (duplicates don't change it)
+    std::vector<Vertex> corners(indexCount);
+    for (size_t i = 0; i < indexCount; ++i) {
+        corners[i] = vertices[indices[i]];
+    }
+    Bounds::computeSphere(corners.data(), corners.size(), result.center, result.radius);
+
+    // Cone: the average face normal and the widest deviation from it
+    std::vector<glm::vec3> normals;
+    normals.reserve(indexCount / 3);
+    glm::vec3 normalSum(0.0f);
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        const glm::vec3& p0 = vertices[indices[i]].pos;
+        const glm::vec3 cross = glm::cross(vertices[indices[i + 1]].pos - p0, vertices[indices[i + 2]].pos - p0);
+        const float length = glm::length(cross);
+        if (length <= 0.0f) continue; // Degenerate triangles face nowhere
+        normals.push_back(cross / length);
+        normalSum += normals.back();
+    }
+
+    const float sumLength = glm::length(normalSum);
+    if (normals.empty() || sumLength <= 0.0f) return result;
+    const glm::vec3 axis = normalSum / sumLength;
+
+    float minDot = 1.0f;
+    for (const glm::vec3& normal : normals) {
+        minDot = std::min(minDot, glm::dot(normal, axis));
+    }
+    if (minDot <= MIN_CONE_DOT) return result;
+
+    result.coneAxis = axis;
+    result.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    return result;
+}
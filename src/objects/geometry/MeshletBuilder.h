@@ -0,0 +1,122 @@
+#pragma once
+
+#include "../../common/Vertex.h"
+#include "MeshOptimizer.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief One cluster of at most MAX_VERTICES vertices and MAX_TRIANGLES triangles.
+ *
+ * Meshlets take the triangles in index buffer order, so meshlet triangles
+ * [triangleOffset, triangleOffset + triangleCount) are also the index range
+ * [3 * triangleOffset, 3 * (triangleOffset + triangleCount)) of the source index
+ * buffer and can be drawn from it directly. vertexOffset/vertexCount refer to
+ * the optional meshlet vertex list (for mesh shaders).
+ */
+struct Meshlet {
+    uint32_t vertexOffset = 0;   // First entry in the meshlet vertex list
+    uint32_t triangleOffset = 0; // First triangle (in the source index buffer and the micro-index list)
+    uint32_t vertexCount = 0;
+    uint32_t triangleCount = 0;
+};
+
+/**
+ * @brief Culling bounds of a meshlet: a bounding sphere and a normal cone.
+ *
+ * Laid out as two vec4s so it can be copied into GPU buffers (std430) as is. The
+ * meshlet faces away from a viewer at cameraPosition (all its triangles are back
+ * faces) when
+ *   dot(center - cameraPosition, coneAxis) >= coneCutoff * length(center - cameraPosition) + radius.
+ * A coneCutoff of 1 (with a zero axis) means the normals spread too far to ever cull.
+ */
+struct MeshletBounds {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+    glm::vec3 coneAxis = glm::vec3(0.0f);
+    float coneCutoff = 1.0f; // sin of the cone's half angle
+};
+
+/**
+ * @brief Splits triangle lists into meshlets and computes their culling bounds.
+ *
+ * build() walks the index buffer once and starts a new meshlet whenever the
+ * next triangle would exceed the vertex or triangle limit. It runs in linear time,
+ * so it is cheap enough to run at load time (also on cached meshes).
+ *
+ * Meshlets are only as compact as the triangle order, and the vertex cache order
+ * wanders across the surface. orderTriangles() therefore regroups the triangles
+ * once, before the mesh is cached: it grows each meshlet over surface neighbours
+ * (connected through shared positions, so flat-shaded corners count), preferring
+ * triangles that add few vertices, lie close to the meshlet and face the same way.
+ * Compact, flat meshlets give tight spheres and narrow normal cones, which is what
+ * makes frustum and backface culling of clusters effective. Within each meshlet the
+ * triangles are then put in vertex cache order (MeshOptimizer's Tipsify on the
+ * meshlet's vertices), which restores most of the cache efficiency a whole-mesh
+ * cache order would have. build() on the reordered indices cuts the same meshlets,
+ * except that a meshlet that ran out of neighbours early may be merged with the
+ * next one.
+ *
+ * optimize() is the whole pass for a freshly loaded mesh: it replaces
+ * MeshOptimizer::optimize(), whose order the meshlet grouping would discard.
+ *
+ * The limits follow the common mesh shader sizing (64 vertices, 124 triangles,
+ * so a meshlet's micro-indices fit in 372 bytes).
+ *
+ * Keywords: Meshlets, Cluster Culling, Normal Cone, Bounding Sphere
+ */
+class MeshletBuilder {
+public:
+    static constexpr uint32_t MAX_VERTICES = 64;
+    static constexpr uint32_t MAX_TRIANGLES = 124;
+
+    /**
+     * @brief Builds meshlets over a triangle list.
+     * @param vertices Vertex data the indices refer to.
+     * @param vertexCount Number of vertices.
+     * @param indices Triangle list indices (the whole range is split).
+     * @param indexCount Number of indices (multiple of 3).
+     * @param meshlets Receives the meshlets.
+     * @param bounds Receives one MeshletBounds per meshlet.
+     * @param meshletVertices Optional, receives the vertex list of every meshlet (global vertex indices).
+     * @param meshletTriangles Optional, receives three local (per-meshlet) vertex indices per triangle.
+     * @param maxVertices Vertex limit per meshlet (3 .. 256).
+     * @param maxTriangles Triangle limit per meshlet.
+     */
+    static void build(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount,
+                      std::vector<Meshlet>& meshlets, std::vector<MeshletBounds>& bounds,
+                      std::vector<uint32_t>* meshletVertices = nullptr,
+                      std::vector<uint8_t>* meshletTriangles = nullptr,
+                      uint32_t maxVertices = MAX_VERTICES, uint32_t maxTriangles = MAX_TRIANGLES);
+
+    /**
+     * @brief Reorders triangles in place so that build() yields spatially compact meshlets.
+     * @param indices Triangle list indices; the first indexCount are reordered.
+     * @param indexCount Number of indices to reorder (e.g. LOD 0 only).
+     * @param vertices Vertex data the indices refer to.
+     * @param vertexCount Number of vertices.
+     */
+    static void orderTriangles(uint32_t* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount,
+                               uint32_t maxVertices = MAX_VERTICES, uint32_t maxTriangles = MAX_TRIANGLES);
+
+    /**
+     * @brief Runs orderTriangles(), the overdraw sort over whole meshlets (if enabled) and
+     *        MeshOptimizer::optimizeVertexFetch() on a mesh without LODs.
+     * @param vertices Vertex data, reordered in place.
+     * @param indices Triangle list indices, reordered and remapped in place.
+     * @param sortForOverdraw Sorts the meshlets with MeshOptimizer::optimizeOverdraw().
+     * @param cacheSize Cache size the statistics are measured with.
+     * @return ACMR/ATVR before and after, and overdraw before and after when the sort ran,
+     *         all measured on the order that is drawn.
+     */
+    static MeshOptimizer::Report optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                                          bool sortForOverdraw = false,
+                                          uint32_t cacheSize = MeshOptimizer::DEFAULT_CACHE_SIZE);
+
+    /**
+     * @brief Computes the bounding sphere and normal cone of a set of triangles.
+     */
+    static MeshletBounds computeBounds(const Vertex* vertices, const uint32_t* indices, size_t indexCount);
+};
@@ -0,0 +1,248 @@
+#include "NormalGenerator.h"
+#include "../../common/Parallel.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NORMAL_GENERATOR_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Triangles / vertices per parallel task (keeps small meshes on the calling thread)
+constexpr size_t FACE_BATCH = 1 << 15;
+constexpr size_t VERTEX_BATCH = 1 << 14;
+
+constexpr float PI = 3.14159265358979323846f;
+
+/**
+ * @brief Vertex -> corner adjacency in compressed (CSR) form; corner i belongs to triangle i / 3.
+ */
+struct CornerAdjacency {
+    std::vector<uint32_t> offsets; // vertexCount + 1 entries
+    std::vector<uint32_t> corners; // Corners of vertex v are corners[offsets[v] .. offsets[v + 1])
+
+    CornerAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount)
+        : offsets(vertexCount + 1, 0), corners(indices.size()) {
+        for (uint32_t index : indices) ++offsets[index + 1];
+        for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            corners[cursor[indices[i]]++] = static_cast<uint32_t>(i);
+        }
+    }
+};
+
+/**
+ * @brief Angle of a triangle at one corner, from its edge vectors.
+ *
+ * |e1 x e2| is twice the triangle area whichever corner the edges start from, so
+ * the face's cross product length is reused: atan2 stays accurate for needle-thin
+ * triangles where acos of a normalized dot product does not.
+ */
+float cornerAngle(const glm::vec3& e1, const glm::vec3& e2, float doubleArea) {
+    return std::atan2(doubleArea, glm::dot(e1, e2));
+}
+
+/**
+ * @brief Output of one vertex batch, kept until the split vertices' positions are known.
+ */
+struct BatchResult {
+    std::vector<glm::vec3> normals; // One per output vertex of the batch, in order (zero = keep the old normal)
+};
+
+} // namespace
+
+void NormalGenerator::computeFaceNormals(const Vertex* vertices, const uint32_t* indices, size_t indexCount,
+                                         glm::vec3* normals, float* doubleAreas) {
+    const size_t triangleCount = indexCount / 3;
+    const size_t batchCount = (triangleCount + FACE_BATCH - 1) / FACE_BATCH;
+    Parallel::forEach(batchCount, [&](size_t batch) {
+        const size_t begin = batch * FACE_BATCH;
+        const size_t end = std::min(triangleCount, begin + FACE_BATCH);
+        size_t t = begin;
+
+#ifdef NORMAL_GENERATOR_SSE
+        // Four triangles per iteration, transposed into x/y/z registers
+        alignas(16) float px[3][4], py[3][4], pz[3][4];
+        alignas(16) float nx[4], ny[4], nz[4], lengths[4];
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (; t + 4 <= end; t += 4) {
+            for (int lane = 0; lane < 4; ++lane) {
+                for (int corner = 0; corner < 3; ++corner) {
+                    const glm::vec3& p = vertices[indices[3 * (t + lane) + corner]].pos;
+                    px[corner][lane] = p.x;
+                    py[corner][lane] = p.y;
+                    pz[corner][lane] = p.z;
+                }
+            }
+            const __m128 ax = _mm_load_ps(px[0]), ay = _mm_load_ps(py[0]), az = _mm_load_ps(pz[0]);
+            const __m128 e1x = _mm_sub_ps(_mm_load_ps(px[1]), ax);
+            const __m128 e1y = _mm_sub_ps(_mm_load_ps(py[1]), ay);
+            const __m128 e1z = _mm_sub_ps(_mm_load_ps(pz[1]), az);
+            const __m128 e2x = _mm_sub_ps(_mm_load_ps(px[2]), ax);
+            const __m128 e2y = _mm_sub_ps(_mm_load_ps(py[2]), ay);
+            const __m128 e2z = _mm_sub_ps(_mm_load_ps(pz[2]), az);
+
+            const __m128 cx = _mm_sub_ps(_mm_mul_ps(e1y, e2z), _mm_mul_ps(e1z, e2y));
+            const __m128 cy = _mm_sub_ps(_mm_mul_ps(e1z, e2x), _mm_mul_ps(e1x, e2z));
+            const __m128 cz = _mm_sub_ps(_mm_mul_ps(e1x, e2y), _mm_mul_ps(e1y, e2x));
+            const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)),
+                                                         _mm_mul_ps(cz, cz)));
+            // Degenerate triangles (zero length) get a zero normal instead of NaN
+            const __m128 inverse = _mm_and_ps(_mm_cmpgt_ps(length, zero), _mm_div_ps(one, length));
+            _mm_store_ps(nx, _mm_mul_ps(cx, inverse));
+            _mm_store_ps(ny, _mm_mul_ps(cy, inverse));
+            _mm_store_ps(nz, _mm_mul_ps(cz, inverse));
+            _mm_store_ps(lengths, length);
+
+            for (int lane = 0; lane < 4; ++lane) {
+                normals[t + lane] = glm::vec3(nx[lane], ny[lane], nz[lane]);
+                if (doubleAreas) doubleAreas[t + lane] = lengths[lane];
+            }
+        }
+#endif
+
+        for (; t < end; ++t) {
+            const glm::vec3& a = vertices[indices[3 * t]].pos;
+            const glm::vec3 cross = glm::cross(vertices[indices[3 * t + 1]].pos - a, vertices[indices[3 * t + 2]].pos - a);
+            const float length = glm::length(cross);
+            normals[t] = length > 0.0f ? cross / length : glm::vec3(0.0f);
+            if (doubleAreas) doubleAreas[t] = length;
+        }
+    });
+}
+
+size_t NormalGenerator::generate(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const Options& options) {
+    const size_t vertexCount = vertices.size();
+    const size_t triangleCount = indices.size() / 3;
+    if (vertexCount == 0 || triangleCount == 0) return 0;
+
+    std::vector<glm::vec3> faceNormals(triangleCount);
+    std::vector<float> doubleAreas(triangleCount);
+    computeFaceNormals(vertices.data(), indices.data(), triangleCount * 3, faceNormals.data(), doubleAreas.data());
+
+    const CornerAdjacency adjacency(indices, vertexCount);
+
+    // Faces are smoothed together when their normals are within the crease angle. If every
+    // face of a vertex lies within half of it from their mean direction, all pairs do.
+    const bool splitting = options.creaseAngle < 180.0f;
+    const float creaseRadians = std::max(options.creaseAngle, 0.0f) * PI / 180.0f;
+    const float cosCrease = std::cos(creaseRadians);
+    const float cosHalfCrease = std::cos(creaseRadians * 0.5f);
+
+    // --- Pass 1 (per vertex): corner normals, grouped into one output vertex per distinct normal ---
+    std::vector<uint32_t> outputCounts(vertexCount, 1);
+    std::vector<uint32_t> cornerCopies(splitting ? indices.size() : 0); // Copy of its vertex each corner uses
+    const size_t batchCount = (vertexCount + VERTEX_BATCH - 1) / VERTEX_BATCH;
+    std::vector<BatchResult> batches(batchCount);
+
+    Parallel::forEach(batchCount, [&](size_t batch) {
+        const size_t begin = batch * VERTEX_BATCH;
+        const size_t end = std::min(vertexCount, begin + VERTEX_BATCH);
+        std::vector<glm::vec3>& out = batches[batch].normals;
+        out.reserve(end - begin);
+        std::vector<glm::vec3> weighted; // Weighted face normal per incident corner
+        std::vector<glm::vec3> copies;   // Distinct corner normals of the current vertex
+
+        for (size_t v = begin; v < end; ++v) {
+            const uint32_t first = adjacency.offsets[v];
+            const uint32_t count = adjacency.offsets[v + 1] - first;
+            if (count == 0) {
+                out.push_back(glm::vec3(0.0f)); // Unreferenced: keep the normal
+                continue;
+            }
+
+            weighted.resize(count);
+            glm::vec3 sum(0.0f), direction(0.0f);
+            for (uint32_t i = 0; i < count; ++i) {
+                const uint32_t corner = adjacency.corners[first + i];
+                const uint32_t triangle = corner / 3;
+                float weight = doubleAreas[triangle];
+                if (options.weighting == Weighting::Angle) {
+                    const uint32_t base = triangle * 3;
+                    const glm::vec3& p = vertices[v].pos;
+                    const glm::vec3 e1 = vertices[indices[base + (corner - base + 1) % 3]].pos - p;
+                    const glm::vec3 e2 = vertices[indices[base + (corner - base + 2) % 3]].pos - p;
+                    weight = cornerAngle(e1, e2, doubleAreas[triangle]);
+                }
+                weighted[i] = faceNormals[triangle] * weight;
+                sum += weighted[i];
+                direction += faceNormals[triangle];
+            }
+
+            bool smooth = !splitting;
+            if (!smooth) {
+                const float length = glm::length(direction);
+                smooth = length > 0.0f;
+                for (uint32_t i = 0; i < count && smooth; ++i) {
+                    const glm::vec3& normal = faceNormals[adjacency.corners[first + i] / 3];
+                    smooth = normal == glm::vec3(0.0f) || glm::dot(normal, direction) >= cosHalfCrease * length;
+                }
+            }
+
+            if (smooth) {
+                const float length = glm::length(sum);
+                out.push_back(length > 0.0f ? sum / length : glm::vec3(0.0f));
+                for (uint32_t i = 0; i < count && splitting; ++i) cornerCopies[adjacency.corners[first + i]] = 0;
+                continue;
+            }
+
+            // Near a crease: each corner sums the faces within the crease angle of its own face.
+            // Corners with the same neighbour set get bitwise identical sums and share a copy.
+            copies.clear();
+            for (uint32_t i = 0; i < count; ++i) {
+                const glm::vec3& own = faceNormals[adjacency.corners[first + i] / 3];
+                glm::vec3 cornerSum(0.0f);
+                for (uint32_t j = 0; j < count; ++j) {
+                    const glm::vec3& other = faceNormals[adjacency.corners[first + j] / 3];
+                    const bool degenerate = own == glm::vec3(0.0f) || other == glm::vec3(0.0f);
+                    if (degenerate || glm::dot(own, other) >= cosCrease) cornerSum += weighted[j];
+                }
+                const float length = glm::length(cornerSum);
+                const glm::vec3 normal = length > 0.0f ? cornerSum / length : glm::vec3(0.0f);
+
+                const auto found = std::find(copies.begin(), copies.end(), normal);
+                cornerCopies[adjacency.corners[first + i]] = static_cast<uint32_t>(found - copies.begin());
+                if (found == copies.end()) copies.push_back(normal);
+            }
+            outputCounts[v] = static_cast<uint32_t>(copies.size());
+            out.insert(out.end(), copies.begin(), copies.end());
+        }
+    });
+
+    // --- Output positions: the copies of a vertex follow each other ---
+    std::vector<uint32_t> outputOffsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) outputOffsets[v + 1] = outputOffsets[v] + outputCounts[v];
+    const size_t outputCount = outputOffsets[vertexCount];
+
+    // --- Pass 2 (per vertex batch): write vertices and remap the vertex's own corners ---
+    std::vector<Vertex> output(outputCount == vertexCount ? 0 : outputCount);
+    Vertex* target = outputCount == vertexCount ? vertices.data() : output.data();
+    Parallel::forEach(batchCount, [&](size_t batch) {
+        const size_t begin = batch * VERTEX_BATCH;
+        const size_t end = std::min(vertexCount, begin + VERTEX_BATCH);
+        const std::vector<glm::vec3>& normals = batches[batch].normals;
+        size_t next = 0;
+        for (size_t v = begin; v < end; ++v) {
+            const uint32_t offset = outputOffsets[v];
+            for (uint32_t copy = 0; copy < outputCounts[v]; ++copy, ++next) {
+                Vertex vertex = vertices[v];
+                if (normals[next] != glm::vec3(0.0f)) vertex.normal = normals[next];
+                target[offset + copy] = vertex;
+            }
+            if (outputCount != vertexCount) {
+                for (uint32_t i = adjacency.offsets[v]; i < adjacency.offsets[v + 1]; ++i) {
+                    const uint32_t corner = adjacency.corners[i];
+                    indices[corner] = offset + cornerCopies[corner];
+                }
+            }
+        }
+    });
+
+    if (outputCount != vertexCount) vertices.swap(output);
+    return outputCount - vertexCount;
+}
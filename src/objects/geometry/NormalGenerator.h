@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../../common/Vertex.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Generates smooth vertex normals, splitting vertices at hard edges.
+ *
+ * Each corner of a triangle gets the weighted sum of the face normals around its
+ * vertex. Only faces within the crease angle of the corner's own face count, so a
+ * cube keeps sharp edges while a scan is shaded smoothly. When the corners of a
+ * vertex end up with different normals, the vertex is split into one copy per
+ * distinct normal, and the copies are kept next to each other.
+ *
+ * Faces are weighted by area or by the angle at the corner. Angle weighting does
+ * not depend on how a surface is triangulated, so it is the default.
+ *
+ * All the work is a gather over a CSR (compressed sparse row) vertex -> corner
+ * adjacency. Every vertex is processed by exactly one task, which reads its
+ * incident faces and writes only its own vertices and its own corners. Threads
+ * never write to shared locations, so no atomics are needed. Face normals are
+ * computed four triangles at a time with SSE where available.
+ *
+ * Vertices must be shared between triangles (welded by position), or every corner
+ * keeps its face normal. Vertices whose faces are all degenerate, and vertices no
+ * triangle references, keep the normal they had.
+ *
+ * Keywords: Smooth Normals, Crease Angle, Angle-Weighted Normals, Vertex Splitting, CSR Adjacency
+ */
+class NormalGenerator {
+public:
+    /**
+     * @brief How face normals are weighted at a vertex.
+     */
+    enum class Weighting {
+        Area,  // By triangle area (large faces dominate)
+        Angle  // By the triangle's angle at the vertex (independent of tessellation)
+    };
+
+    struct Options {
+        Weighting weighting = Weighting::Angle;
+        float creaseAngle = 60.0f; // Degrees; faces meeting at a sharper angle are not smoothed together (>= 180: never split)
+    };
+
+    /**
+     * @brief Replaces the normals of a triangle mesh, splitting vertices at creases.
+     * @param vertices Vertex data; receives the new normals and any split copies.
+     * @param indices Triangle list indices, remapped to the split vertices.
+     * @param options Weighting and crease angle.
+     * @return Number of vertices added by splitting.
+     */
+    static size_t generate(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const Options& options);
+
+    /**
+     * @brief Computes the unit face normal of every triangle (zero for degenerate triangles).
+     * @param vertices Vertex data the indices refer to.
+     * @param indices Triangle list indices (3 per triangle).
+     * @param indexCount Number of indices (multiple of 3).
+     * @param normals Receives indexCount / 3 normals.
+     * @param doubleAreas Optional, receives the length of each cross product (twice the triangle area).
+     */
+    static void computeFaceNormals(const Vertex* vertices, const uint32_t* indices, size_t indexCount,
+                                   glm::vec3* normals, float* doubleAreas = nullptr);
+};
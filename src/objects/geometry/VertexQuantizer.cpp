@@ -0,0 +1,105 @@
+#include "VertexQuantizer.h"
+#include "Bounds.h"
+#include "../../common/Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Vertices per parallel task (keeps small meshes on the calling thread)
+constexpr size_t QUANTIZE_BATCH = 1 << 16;
+
+float signNotZero(float value) {
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+uint16_t toUnorm16(float value) {
+    return static_cast<uint16_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f));
+}
+
+int16_t toSnorm16(float value) {
+    return static_cast<int16_t>(std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+}
+
+uint8_t toUnorm8(float value) {
+    return static_cast<uint8_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f));
+}
+
+} // namespace
+
+VertexQuantizer::Quantization VertexQuantizer::computeQuantization(const Vertex* vertices, size_t vertexCount) {
+    Quantization quantization;
+    if (vertexCount == 0) return quantization;
+
+    glm::vec3 minimum, maximum;
+    Bounds::computeBox(vertices, vertexCount, minimum, maximum);
+    quantization.offset = minimum;
+    quantization.scale = maximum - minimum;
+    return quantization;
+}
+
+void VertexQuantizer::quantize(const Vertex* vertices, size_t vertexCount, const Quantization& quantization,
+                               QuantizedVertex* out) {
+    const size_t batchCount = (vertexCount + QUANTIZE_BATCH - 1) / QUANTIZE_BATCH;
+    Parallel::forEach(batchCount, [&](size_t batch) {
+        const size_t end = std::min(vertexCount, (batch + 1) * QUANTIZE_BATCH);
+        for (size_t i = batch * QUANTIZE_BATCH; i < end; ++i) {
+            out[i] = quantize(vertices[i], quantization);
+        }
+    });
+}
+
+QuantizedVertex VertexQuantizer::quantize(const Vertex& vertex, const Quantization& quantization) {
+    QuantizedVertex result{};
+
+    // A flat axis (zero extent) maps everything to the box minimum
+    for (int axis = 0; axis < 3; ++axis) {
+        const float extent = quantization.scale[axis];
+        const float relative = extent > 0.0f ? (vertex.pos[axis] - quantization.offset[axis]) / extent : 0.0f;
+        result.pos[axis] = toUnorm16(relative);
+    }
+    result.pos[3] = 0;
+
+    const glm::vec2 normal = encodeOctahedral(vertex.normal);
+    result.normal[0] = toSnorm16(normal.x);
+    result.normal[1] = toSnorm16(normal.y);
+
+    result.color[0] = toUnorm8(vertex.color.x);
+    result.color[1] = toUnorm8(vertex.color.y);
+    result.color[2] = toUnorm8(vertex.color.z);
+    result.color[3] = 255;
+    return result;
+}
+
+Vertex VertexQuantizer::dequantize(const QuantizedVertex& vertex, const Quantization& quantization) {
+    Vertex result{};
+    const glm::vec3 relative(vertex.pos[0] / 65535.0f, vertex.pos[1] / 65535.0f, vertex.pos[2] / 65535.0f);
+    result.pos = quantization.offset + quantization.scale * relative;
+    // SNORM conversion as defined by Vulkan: -32768 and -32767 both map to -1
+    const glm::vec2 normal(std::max(vertex.normal[0] / 32767.0f, -1.0f), std::max(vertex.normal[1] / 32767.0f, -1.0f));
+    result.normal = decodeOctahedral(normal);
+    result.color = glm::vec3(vertex.color[0] / 255.0f, vertex.color[1] / 255.0f, vertex.color[2] / 255.0f);
+    return result;
+}
+
+glm::vec2 VertexQuantizer::encodeOctahedral(const glm::vec3& normal) {
+    const float length1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (length1 <= 0.0f) return glm::vec2(0.0f); // Degenerate normal: decodes to +Z
+
+    glm::vec2 encoded(normal.x / length1, normal.y / length1);
+    if (normal.z < 0.0f) {
+        // Fold the lower hemisphere over the diagonals
+        encoded = glm::vec2((1.0f - std::abs(encoded.y)) * signNotZero(encoded.x),
+                            (1.0f - std::abs(encoded.x)) * signNotZero(encoded.y));
+    }
+    return encoded;
+}
+
+glm::vec3 VertexQuantizer::decodeOctahedral(const glm::vec2& encoded) {
+    glm::vec3 normal(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+    const float fold = std::max(-normal.z, 0.0f);
+    normal.x += normal.x >= 0.0f ? -fold : fold;
+    normal.y += normal.y >= 0.0f ? -fold : fold;
+    return glm::normalize(normal);
+}
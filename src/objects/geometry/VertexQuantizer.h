@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../../common/Vertex.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Converts full-precision vertices into the compact QuantizedVertex layout.
+ *
+ * Positions are stored relative to the mesh bounding box in 16 bits per axis, so
+ * the error is at most half a step of extent / 65535 per axis (about 0.008 mm on a
+ * 1 m scan). Normals use the octahedral mapping (Meyer et al. 2010): the unit
+ * sphere is projected onto an octahedron, whose lower half is folded over the
+ * upper one, giving a square that two 16-bit components cover with an angular
+ * error of about 0.04 degrees. Colors are clamped to 0..1 and stored as RGBA8.
+ *
+ * The conversion runs while the mesh is written into GPU staging memory, so no
+ * second CPU copy of the mesh is kept.
+ *
+ * Keywords: Vertex Quantization, Octahedral Normal Encoding, Bounding Box Quantization
+ */
+class VertexQuantizer {
+public:
+    /**
+     * @brief Per-mesh dequantization parameters: position = offset + scale * quantized (0..1).
+     */
+    struct Quantization {
+        glm::vec3 offset = glm::vec3(0.0f); // Bounding box minimum
+        glm::vec3 scale = glm::vec3(1.0f);  // Bounding box extent
+    };
+
+    /**
+     * @brief Computes the quantization of a mesh from its bounding box.
+     */
+    static Quantization computeQuantization(const Vertex* vertices, size_t vertexCount);
+
+    /**
+     * @brief Quantizes vertices (in parallel for large meshes).
+     * @param vertices Source vertices.
+     * @param vertexCount Number of vertices.
+     * @param quantization Quantization from computeQuantization() (positions outside the box are clamped).
+     * @param out Receives vertexCount quantized vertices (may be mapped GPU memory).
+     */
+    static void quantize(const Vertex* vertices, size_t vertexCount, const Quantization& quantization,
+                         QuantizedVertex* out);
+
+    /**
+     * @brief Quantizes a single vertex.
+     */
+    static QuantizedVertex quantize(const Vertex& vertex, const Quantization& quantization);
+
+    /**
+     * @brief Reconstructs a vertex the way the vertex shader does.
+     */
+    static Vertex dequantize(const QuantizedVertex& vertex, const Quantization& quantization);
+
+    /**
+     * @brief Maps a unit vector to octahedral coordinates in -1..1.
+     */
+    static glm::vec2 encodeOctahedral(const glm::vec3& normal);
+
+    /**
+     * @brief Maps octahedral coordinates back to a unit vector.
+     */
+    static glm::vec3 decodeOctahedral(const glm::vec2& encoded);
+};
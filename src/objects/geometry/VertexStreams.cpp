@@ -0,0 +1,139 @@
+#include "VertexStreams.h"
+#include "../../common/Parallel.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Vertices per parallel task (keeps small meshes on the calling thread)
+constexpr size_t WRITE_BATCH = 1 << 16;
+
+// Alignment of the attribute stream within a split buffer
+constexpr VkDeviceSize STREAM_ALIGNMENT = 16;
+
+// Attribute stream records of the split layout
+struct FullAttributes {
+    glm::vec3 normal;
+    glm::vec3 color;
+};
+
+struct QuantizedAttributes {
+    int16_t normal[2];
+    uint8_t color[4];
+};
+
+static_assert(sizeof(FullAttributes) == sizeof(Vertex) - sizeof(glm::vec3), "Split streams must not grow vertices");
+static_assert(sizeof(QuantizedAttributes) == 8, "QuantizedAttributes must stay tightly packed");
+
+} // namespace
+
+VertexStreams::InputDescription VertexStreams::describe(VertexFormat format, VertexLayout layout, uint32_t streams) {
+    const bool quantized = format == VertexFormat::Quantized;
+    const std::array<VkVertexInputAttributeDescription, 3> attributes =
+        quantized ? QuantizedVertex::getAttributeDescriptions() : Vertex::getAttributeDescriptions();
+
+    InputDescription description;
+    if (layout == VertexLayout::Interleaved) {
+        // Whole vertices in binding 0; a position-only pipeline just skips the other attributes
+        description.bindings.push_back(quantized ? QuantizedVertex::getBindingDescription()
+                                                 : Vertex::getBindingDescription());
+        if (streams & VERTEX_STREAM_POSITION) description.attributes.push_back(attributes[0]);
+        if (streams & VERTEX_STREAM_ATTRIBUTES) {
+            description.attributes.push_back(attributes[1]);
+            description.attributes.push_back(attributes[2]);
+        }
+        return description;
+    }
+
+    if (streams & VERTEX_STREAM_POSITION) {
+        VkVertexInputBindingDescription binding{};
+        binding.binding = 0;
+        binding.stride = static_cast<uint32_t>(positionSize(format));
+        binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        description.bindings.push_back(binding);
+
+        VkVertexInputAttributeDescription position = attributes[0];
+        position.binding = 0;
+        position.offset = 0;
+        description.attributes.push_back(position);
+    }
+    if (streams & VERTEX_STREAM_ATTRIBUTES) {
+        VkVertexInputBindingDescription binding{};
+        binding.binding = 1;
+        binding.stride = static_cast<uint32_t>(attributeSize(format));
+        binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        description.bindings.push_back(binding);
+
+        VkVertexInputAttributeDescription normal = attributes[1];
+        normal.binding = 1;
+        normal.offset = quantized ? offsetof(QuantizedAttributes, normal) : offsetof(FullAttributes, normal);
+        VkVertexInputAttributeDescription color = attributes[2];
+        color.binding = 1;
+        color.offset = quantized ? offsetof(QuantizedAttributes, color) : offsetof(FullAttributes, color);
+        description.attributes.push_back(normal);
+        description.attributes.push_back(color);
+    }
+    return description;
+}
+
+size_t VertexStreams::positionSize(VertexFormat format) {
+    return format == VertexFormat::Quantized ? sizeof(QuantizedVertex::pos) : sizeof(glm::vec3);
+}
+
+size_t VertexStreams::attributeSize(VertexFormat format) {
+    return format == VertexFormat::Quantized ? sizeof(QuantizedAttributes) : sizeof(FullAttributes);
+}
+
+VkDeviceSize VertexStreams::attributeOffset(VertexFormat format, VertexLayout layout, size_t vertexCount) {
+    if (layout == VertexLayout::Interleaved) return 0;
+    const VkDeviceSize positionBytes = static_cast<VkDeviceSize>(positionSize(format)) * vertexCount;
+    return (positionBytes + STREAM_ALIGNMENT - 1) / STREAM_ALIGNMENT * STREAM_ALIGNMENT;
+}
+
+VkDeviceSize VertexStreams::bufferSize(VertexFormat format, VertexLayout layout, size_t vertexCount) {
+    if (layout == VertexLayout::Interleaved) {
+        const size_t stride = format == VertexFormat::Quantized ? sizeof(QuantizedVertex) : sizeof(Vertex);
+        return static_cast<VkDeviceSize>(stride) * vertexCount;
+    }
+    return attributeOffset(format, layout, vertexCount) +
+           static_cast<VkDeviceSize>(attributeSize(format)) * vertexCount;
+}
+
+void VertexStreams::write(const Vertex* vertices, size_t vertexCount, VertexFormat format, VertexLayout layout,
+                          const VertexQuantizer::Quantization& quantization, void* out) {
+    writeRange(vertices, vertexCount, 0, vertexCount, format, layout, quantization, out);
+}
+
+void VertexStreams::writeRange(const Vertex* vertices, size_t vertexCount, size_t first, size_t count,
+                               VertexFormat format, VertexLayout layout,
+                               const VertexQuantizer::Quantization& quantization, void* out) {
+    if (layout == VertexLayout::Interleaved) {
+        if (format == VertexFormat::Quantized) {
+            VertexQuantizer::quantize(vertices + first, count, quantization, static_cast<QuantizedVertex*>(out) + first);
+        } else {
+            std::memcpy(static_cast<Vertex*>(out) + first, vertices + first, sizeof(Vertex) * count);
+        }
+        return;
+    }
+
+    char* positions = static_cast<char*>(out);
+    char* attributes = positions + attributeOffset(format, layout, vertexCount);
+    const size_t batchCount = (count + WRITE_BATCH - 1) / WRITE_BATCH;
+    Parallel::forEach(batchCount, [&](size_t batch) {
+        const size_t end = first + std::min(count, (batch + 1) * WRITE_BATCH);
+        for (size_t i = first + batch * WRITE_BATCH; i < end; ++i) {
+            if (format == VertexFormat::Quantized) {
+                const QuantizedVertex packed = VertexQuantizer::quantize(vertices[i], quantization);
+                QuantizedAttributes record{};
+                std::memcpy(record.normal, packed.normal, sizeof(record.normal));
+                std::memcpy(record.color, packed.color, sizeof(record.color));
+                std::memcpy(positions + i * sizeof(packed.pos), packed.pos, sizeof(packed.pos));
+                std::memcpy(attributes + i * sizeof(record), &record, sizeof(record));
+            } else {
+                const FullAttributes record{vertices[i].normal, vertices[i].color};
+                std::memcpy(positions + i * sizeof(glm::vec3), &vertices[i].pos, sizeof(glm::vec3));
+                std::memcpy(attributes + i * sizeof(record), &record, sizeof(record));
+            }
+        }
+    });
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "VertexQuantizer.h"
+#include "../../common/Vertex.h"
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Lays out vertex buffers as one interleaved stream or as split position and attribute streams.
+ *
+ * With VertexLayout::Split the buffer holds every position first, then every
+ * normal and color:
+ *
+ *     | positions (binding 0) | pad to 16 | normals + colors (binding 1) |
+ *
+ * Both streams live in one buffer and are bound at two offsets. A pipeline reading
+ * only VERTEX_STREAM_POSITION then fetches 12 bytes per vertex (8 when quantized)
+ * instead of the whole 36 (16). This suits the depth prepass, and later shadow or
+ * picking passes. Pipelines that read everything see the same locations under
+ * either layout, so the shaders don't change.
+ *
+ * Keywords: Split Vertex Streams, Position-Only Stream, Vertex Fetch Bandwidth, Depth Prepass
+ */
+class VertexStreams {
+public:
+    /**
+     * @brief Vertex input state for a pipeline.
+     */
+    struct InputDescription {
+        std::vector<VkVertexInputBindingDescription> bindings;
+        std::vector<VkVertexInputAttributeDescription> attributes;
+    };
+
+    /**
+     * @brief Describes the vertex input of a pipeline reading the given streams of a mesh.
+     * @param format Vertex format of the mesh.
+     * @param layout Vertex layout of the mesh.
+     * @param streams VertexStreamBits the pipeline's vertex shader reads.
+     */
+    static InputDescription describe(VertexFormat format, VertexLayout layout, uint32_t streams);
+
+    /**
+     * @brief Bytes of one vertex in the position stream.
+     */
+    static size_t positionSize(VertexFormat format);
+
+    /**
+     * @brief Bytes of one vertex in the attribute stream (normal and color).
+     */
+    static size_t attributeSize(VertexFormat format);
+
+    /**
+     * @brief Offset of the attribute stream (binding 1) in a split buffer, 0 when interleaved.
+     */
+    static VkDeviceSize attributeOffset(VertexFormat format, VertexLayout layout, size_t vertexCount);
+
+    /**
+     * @brief Size of the vertex buffer holding vertexCount vertices.
+     */
+    static VkDeviceSize bufferSize(VertexFormat format, VertexLayout layout, size_t vertexCount);
+
+    /**
+     * @brief Writes vertices in the given format and layout (in parallel for large meshes).
+     * @param vertices Source vertices.
+     * @param vertexCount Number of vertices.
+     * @param format Target format.
+     * @param layout Target layout.
+     * @param quantization Used with VertexFormat::Quantized.
+     * @param out Receives bufferSize() bytes (may be mapped GPU memory).
+     */
+    static void write(const Vertex* vertices, size_t vertexCount, VertexFormat format, VertexLayout layout,
+                      const VertexQuantizer::Quantization& quantization, void* out);
+
+    /**
+     * @brief Writes vertices [first, first + count) to their place in a buffer of vertexCount vertices.
+     *
+     * Lets an upload fill the buffer a piece at a time (see VulkanEngine::streamMeshUpload).
+     * @param vertices All source vertices.
+     * @param out The whole buffer, as in write().
+     */
+    static void writeRange(const Vertex* vertices, size_t vertexCount, size_t first, size_t count,
+                           VertexFormat format, VertexLayout layout,
+                           const VertexQuantizer::Quantization& quantization, void* out);
+};
@@ -0,0 +1,198 @@
+#include "VertexWelder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Float bit pattern with -0.0 folded onto +0.0, so values that compare equal hash equal.
+inline uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits == 0x80000000u ? 0u : bits;
+}
+
+inline uint64_t mix(uint64_t h, uint32_t value) {
+    h ^= value;
+    h *= 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 29);
+}
+
+inline uint64_t hashVertex(const Vertex& v) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (int i = 0; i < 3; ++i) h = mix(h, floatBits(v.pos[i]));
+    for (int i = 0; i < 3; ++i) h = mix(h, floatBits(v.normal[i]));
+    for (int i = 0; i < 3; ++i) h = mix(h, floatBits(v.color[i]));
+    return h;
+}
+
+inline uint64_t hashCell(int32_t x, int32_t y, int32_t z) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    h = mix(h, static_cast<uint32_t>(x));
+    h = mix(h, static_cast<uint32_t>(y));
+    h = mix(h, static_cast<uint32_t>(z));
+    return h;
+}
+
+// Cell coordinate of a scaled position component. Clamped so the cast (and the neighbour
+// cells at +-1) stay in int32 range: far-out positions share the outermost cells, which
+// only costs extra distance tests. NaN goes to cell 0.
+inline int32_t cellCoordinate(float scaled) {
+    constexpr float LIMIT = 2147483520.0f; // Largest float below 2^31 - 1
+    const float cell = std::floor(scaled);
+    if (std::isnan(cell)) return 0;
+    return static_cast<int32_t>(std::min(std::max(cell, -LIMIT), LIMIT));
+}
+
+inline bool sameVertex(const Vertex& a, const Vertex& b) {
+    return a.pos == b.pos && a.normal == b.normal && a.color == b.color;
+}
+
+inline size_t tableSizeFor(size_t count) {
+    size_t size = 16;
+    while (size < count * 2) size <<= 1;
+    return size;
+}
+
+} // namespace
+
+VertexWelder::VertexWelder(std::vector<Vertex>& outVertices, float epsilon, size_t expectedVertices)
+    : vertices_(outVertices)
+    , firstVertex_(outVertices.size())
+    , epsilon_(epsilon > 0.0f ? epsilon : 0.0f)
+    , inverseCellSize_(epsilon > 0.0f ? 1.0f / epsilon : 0.0f)
+{
+    if (epsilon_ > 0.0f) {
+        cells_.assign(tableSizeFor(expectedVertices), Cell{0, 0, 0, EMPTY});
+        cellNext_.reserve(expectedVertices);
+    } else {
+        slots_.assign(tableSizeFor(expectedVertices), EMPTY);
+    }
+    vertices_.reserve(firstVertex_ + expectedVertices);
+}
+
+uint32_t VertexWelder::insert(const Vertex& vertex) {
+    return epsilon_ > 0.0f ? insertSpatial(vertex) : insertExact(vertex);
+}
+
+uint32_t VertexWelder::insertExact(const Vertex& vertex) {
+    if ((used_ + 1) * 2 > slots_.size()) growExact();
+
+    const size_t mask = slots_.size() - 1;
+    size_t slot = static_cast<size_t>(hashVertex(vertex)) & mask;
+    while (slots_[slot] != EMPTY) {
+        if (sameVertex(vertices_[slots_[slot]], vertex)) {
+            return slots_[slot];
+        }
+        slot = (slot + 1) & mask; // Linear probing
+    }
+
+    uint32_t index = static_cast<uint32_t>(vertices_.size());
+    vertices_.push_back(vertex);
+    slots_[slot] = index;
+    ++used_;
+    return index;
+}
+
+uint32_t VertexWelder::findCell(int32_t x, int32_t y, int32_t z) const {
+    const size_t mask = cells_.size() - 1;
+    size_t slot = static_cast<size_t>(hashCell(x, y, z)) & mask;
+    while (cells_[slot].head != EMPTY) {
+        const Cell& cell = cells_[slot];
+        if (cell.x == x && cell.y == y && cell.z == z) {
+            return static_cast<uint32_t>(slot);
+        }
+        slot = (slot + 1) & mask;
+    }
+    return EMPTY;
+}
+
+uint32_t VertexWelder::insertSpatial(const Vertex& vertex) {
+    const glm::vec3 scaled = vertex.pos * inverseCellSize_;
+    const int32_t cx = cellCoordinate(scaled.x);
+    const int32_t cy = cellCoordinate(scaled.y);
+    const int32_t cz = cellCoordinate(scaled.z);
+    const float epsilonSq = epsilon_ * epsilon_;
+
+    // Any vertex within epsilon lies in this cell or one of its 26 neighbours
+    for (int32_t dz = -1; dz <= 1; ++dz) {
+        for (int32_t dy = -1; dy <= 1; ++dy) {
+            for (int32_t dx = -1; dx <= 1; ++dx) {
+                uint32_t slot = findCell(cx + dx, cy + dy, cz + dz);
+                if (slot == EMPTY) continue;
+
+                for (uint32_t candidate = cells_[slot].head; candidate != EMPTY;
+                     candidate = cellNext_[candidate - firstVertex_]) {
+                    const Vertex& other = vertices_[candidate];
+                    glm::vec3 delta = other.pos - vertex.pos;
+                    if (glm::dot(delta, delta) <= epsilonSq &&
+                        other.normal == vertex.normal && other.color == vertex.color) {
+                        return candidate;
+                    }
+                }
+            }
+        }
+    }
+
+    // No match: append the vertex and link it into its own cell
+    uint32_t index = static_cast<uint32_t>(vertices_.size());
+    vertices_.push_back(vertex);
+
+    uint32_t slot = findCell(cx, cy, cz);
+    if (slot == EMPTY) {
+        if ((used_ + 1) * 2 > cells_.size()) growSpatial();
+        const size_t mask = cells_.size() - 1;
+        size_t probe = static_cast<size_t>(hashCell(cx, cy, cz)) & mask;
+        while (cells_[probe].head != EMPTY) probe = (probe + 1) & mask;
+        cells_[probe] = Cell{cx, cy, cz, EMPTY};
+        slot = static_cast<uint32_t>(probe);
+        ++used_;
+    }
+    cellNext_.push_back(cells_[slot].head);
+    cells_[slot].head = index;
+    return index;
+}
+
+void VertexWelder::growExact() {
+    std::vector<uint32_t> old;
+    old.swap(slots_);
+    slots_.assign(old.size() * 2, EMPTY);
+
+    const size_t mask = slots_.size() - 1;
+    for (uint32_t index : old) {
+        if (index == EMPTY) continue;
+        size_t slot = static_cast<size_t>(hashVertex(vertices_[index])) & mask;
+        while (slots_[slot] != EMPTY) slot = (slot + 1) & mask;
+        slots_[slot] = index;
+    }
+}
+
+void VertexWelder::growSpatial() {
+    std::vector<Cell> old;
+    old.swap(cells_);
+    cells_.assign(old.size() * 2, Cell{0, 0, 0, EMPTY});
+
+    const size_t mask = cells_.size() - 1;
+    for (const Cell& cell : old) {
+        if (cell.head == EMPTY) continue;
+        size_t slot = static_cast<size_t>(hashCell(cell.x, cell.y, cell.z)) & mask;
+        while (cells_[slot].head != EMPTY) slot = (slot + 1) & mask;
+        cells_[slot] = cell;
+    }
+}
+
+void VertexWelder::weld(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float epsilon) {
+    std::vector<Vertex> unique;
+    VertexWelder welder(unique, epsilon, vertices.size());
+
+    // Weld each source vertex once, then remap the indices through the result
+    std::vector<uint32_t> remap(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        remap[i] = welder.insert(vertices[i]);
+    }
+    for (auto& index : indices) {
+        index = remap[index];
+    }
+
+    vertices.swap(unique);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../../common/Vertex.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Deduplicates vertices into a shared-vertex (indexed) mesh.
+ *
+ * Vertices are keyed on the full (position, normal, color) triple using an
+ * open-addressing hash table, so identical corners emitted by a loader collapse
+ * into a single entry and the index buffer references them. Note that
+ * Vertex::operator== and std::hash<Vertex> ignore the normal, so they cannot be
+ * used for this purpose.
+ *
+ * With a positive epsilon the welder switches to a spatial hash: positions are
+ * bucketed into cells of size epsilon and a new vertex is merged into any earlier
+ * vertex within epsilon that has the same normal and color. This cleans up the
+ * near-duplicate positions common in scanned meshes.
+ *
+ * Keywords: Vertex Welding, Vertex Deduplication, Index Buffer, Spatial Hash
+ */
+class VertexWelder {
+public:
+    /**
+     * @brief Creates a welder that appends unique vertices to outVertices.
+     * @param outVertices Vector receiving the unique vertices (existing content is kept and not welded against).
+     * @param epsilon Position tolerance. 0 welds exact matches only.
+     * @param expectedVertices Hint used to size the hash table up front.
+     */
+    explicit VertexWelder(std::vector<Vertex>& outVertices, float epsilon = 0.0f, size_t expectedVertices = 0);
+
+    /**
+     * @brief Inserts a vertex, returning the index of its unique representative.
+     * @param vertex The vertex to insert.
+     * @return Index into the output vertex vector.
+     */
+    uint32_t insert(const Vertex& vertex);
+
+    /**
+     * @brief Welds an existing vertex/index pair in place.
+     * @param vertices Vertex data, replaced by the unique vertices.
+     * @param indices Index data, remapped to the unique vertices.
+     * @param epsilon Position tolerance. 0 welds exact matches only.
+     */
+    static void weld(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float epsilon = 0.0f);
+
+private:
+    static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+
+    // Exact mode: slot holds a vertex index. Spatial mode: slot holds a cell whose
+    // vertices are chained through cellNext_.
+    struct Cell {
+        int32_t x, y, z;
+        uint32_t head;
+    };
+
+    std::vector<Vertex>& vertices_;
+    size_t firstVertex_;          // Vertices before this index were not inserted by us
+    float epsilon_;
+    float inverseCellSize_;
+
+    std::vector<uint32_t> slots_;  // Exact mode table
+    std::vector<Cell> cells_;      // Spatial mode table
+    std::vector<uint32_t> cellNext_;
+    size_t used_ = 0;
+
+    uint32_t insertExact(const Vertex& vertex);
+    uint32_t insertSpatial(const Vertex& vertex);
+    uint32_t findCell(int32_t x, int32_t y, int32_t z) const;
+    void growExact();
+    void growSpatial();
+};
@@ -0,0 +1,433 @@
+#include "AssetPackage.h"
+#include "MeshCache.h"
+#include "../geometry/Bounds.h"
+#include "../../common/LzCodec.h"
+#include "../../common/Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+constexpr char MAGIC[4] = {'V', 'P', 'A', 'K'};
+constexpr uint64_t SECTION_ALIGNMENT = 16; // Vertices, indices and LODs within a blob
+constexpr uint64_t BLOB_ALIGNMENT = 4096;  // Blobs within the file (page aligned)
+constexpr uint64_t TABLE_ALIGNMENT = 8;
+
+inline uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Whether [offset, offset + size) lies within a file of fileSize bytes
+inline bool inFile(uint64_t offset, uint64_t size, uint64_t fileSize) {
+    return offset <= fileSize && size <= fileSize - offset;
+}
+
+// Splits the bytes of 32-bit words into four planes; a tail shorter than a word stays in place
+void shuffle(const char* source, char* destination, size_t size) {
+    const size_t words = size / 4;
+    for (size_t i = 0; i < words; ++i) {
+        for (size_t k = 0; k < 4; ++k) destination[k * words + i] = source[4 * i + k];
+    }
+    std::memcpy(destination + 4 * words, source + 4 * words, size - 4 * words);
+}
+
+void unshuffle(const char* source, char* destination, size_t size) {
+    const size_t words = size / 4;
+    for (size_t i = 0; i < words; ++i) {
+        for (size_t k = 0; k < 4; ++k) destination[4 * i + k] = source[k * words + i];
+    }
+    std::memcpy(destination + 4 * words, source + 4 * words, size - 4 * words);
+}
+
+bool decodeBlock(const char* file, const AssetPackage::Block& block, char* destination) {
+    const char* stored = file + block.offset;
+    if (block.storedSize == block.rawSize) {
+        std::memcpy(destination, stored, block.rawSize);
+        return true;
+    }
+    thread_local std::vector<char> scratch;
+    scratch.resize(block.rawSize);
+    if (!LzCodec::decompress(stored, block.storedSize, scratch.data(), block.rawSize)) return false;
+    unshuffle(scratch.data(), destination, block.rawSize);
+    return true;
+}
+
+// Where the parts of a mesh go in its uncompressed blob
+struct BlobLayout {
+    uint64_t indexOffset;
+    uint64_t lodOffset;
+    uint64_t rawSize;
+};
+
+BlobLayout layoutFor(const MeshView& mesh) {
+    BlobLayout layout;
+    layout.indexOffset = alignUp(mesh.vertexCount * sizeof(Vertex), SECTION_ALIGNMENT);
+    layout.lodOffset = alignUp(layout.indexOffset + mesh.indexCount * sizeof(uint32_t), SECTION_ALIGNMENT);
+    layout.rawSize = layout.lodOffset + mesh.lodCount * sizeof(MeshLod);
+    return layout;
+}
+
+// Checks that an entry's parts fit its blob and its stored data fits the file
+bool validateEntry(const AssetPackage::TocEntry& entry, const std::vector<AssetPackage::Block>& blocks,
+                   uint32_t blockSize, uint64_t fileSize) {
+    if (entry.vertexCount > entry.rawSize / sizeof(Vertex) ||
+        entry.indexOffset < entry.vertexCount * sizeof(Vertex) || entry.indexOffset % SECTION_ALIGNMENT != 0 ||
+        !inFile(entry.indexOffset, entry.indexCount * sizeof(uint32_t), entry.rawSize) ||
+        entry.indexCount > entry.rawSize / sizeof(uint32_t) ||
+        entry.lodOffset < entry.indexOffset + entry.indexCount * sizeof(uint32_t) ||
+        entry.lodOffset % SECTION_ALIGNMENT != 0 || entry.lodCount > entry.rawSize / sizeof(MeshLod) ||
+        !inFile(entry.lodOffset, entry.lodCount * sizeof(MeshLod), entry.rawSize)) {
+        return false;
+    }
+
+    if (!(entry.flags & AssetPackage::FLAG_COMPRESSED)) {
+        return entry.dataOffset % SECTION_ALIGNMENT == 0 && inFile(entry.dataOffset, entry.rawSize, fileSize);
+    }
+
+    // Blocks cover the blob in order, all but the last one blockSize bytes
+    if (entry.firstBlock > blocks.size() || entry.blockCount > blocks.size() - entry.firstBlock) return false;
+    uint64_t covered = 0;
+    for (uint64_t b = 0; b < entry.blockCount; ++b) {
+        const AssetPackage::Block& block = blocks[entry.firstBlock + b];
+        const bool last = b + 1 == entry.blockCount;
+        if ((!last && block.rawSize != blockSize) || block.rawSize > blockSize || block.storedSize > block.rawSize ||
+            !inFile(block.offset, block.storedSize, fileSize)) {
+            return false;
+        }
+        covered += block.rawSize;
+    }
+    return covered == entry.rawSize;
+}
+
+// The LOD table and indices lie in the (possibly compressed) blob, so they are checked once
+// the blob is available. The writer runs the same checks on its sources.
+bool validateLods(const MeshView& mesh) {
+    for (size_t i = 0; i < mesh.lodCount; ++i) {
+        const MeshLod& lod = mesh.lods[i];
+        if (static_cast<uint64_t>(lod.firstIndex) + lod.indexCount > mesh.indexCount ||
+            lod.vertexOffset < 0 || static_cast<uint64_t>(lod.vertexOffset) > mesh.vertexCount) {
+            return false; // LOD outside the mesh data
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool AssetPackage::open(const std::string& path, std::string& error) {
+    close();
+
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(path)) {
+        error = "could not open " + path;
+        return false;
+    }
+    const char* data = file->data();
+    const uint64_t size = file->size();
+
+    Header header;
+    if (size < sizeof(Header)) {
+        error = "not an asset package";
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "not an asset package";
+        return false;
+    }
+    if (header.version != VERSION || header.vertexStride != sizeof(Vertex) || header.lodStride != sizeof(MeshLod)) {
+        error = "package was written by another version; rebuild it";
+        return false;
+    }
+    if (header.blockSize == 0 || header.assetCount > size / sizeof(TocEntry) ||
+        header.blockCount > size / sizeof(Block) ||
+        !inFile(header.tocOffset, header.assetCount * sizeof(TocEntry), size) ||
+        !inFile(header.blockOffset, header.blockCount * sizeof(Block), size) ||
+        !inFile(header.namesOffset, header.namesSize, size)) {
+        error = "package tables are truncated";
+        return false;
+    }
+
+    // Copy the tables out, so they need no particular alignment in the file
+    std::vector<TocEntry> toc(header.assetCount);
+    std::vector<Block> blocks(header.blockCount);
+    if (!toc.empty()) std::memcpy(toc.data(), data + header.tocOffset, toc.size() * sizeof(TocEntry));
+    if (!blocks.empty()) std::memcpy(blocks.data(), data + header.blockOffset, blocks.size() * sizeof(Block));
+
+    std::vector<std::string> names;
+    names.reserve(toc.size());
+    for (size_t i = 0; i < toc.size(); ++i) {
+        const TocEntry& entry = toc[i];
+        if (!inFile(entry.nameOffset, entry.nameLength, header.namesSize) ||
+            !validateEntry(entry, blocks, header.blockSize, size)) {
+            error = "asset " + std::to_string(i) + " is out of bounds";
+            return false;
+        }
+        names.emplace_back(data + header.namesOffset + entry.nameOffset, entry.nameLength);
+    }
+
+    file_ = std::move(file);
+    blockSize_ = header.blockSize;
+    toc_ = std::move(toc);
+    blocks_ = std::move(blocks);
+    names_ = std::move(names);
+    for (size_t i = 0; i < names_.size(); ++i) lookup_.emplace(names_[i], i);
+    return true;
+}
+
+void AssetPackage::close() {
+    file_.reset();
+    blockSize_ = 0;
+    toc_.clear();
+    blocks_.clear();
+    names_.clear();
+    lookup_.clear();
+}
+
+bool AssetPackage::find(const std::string& name, size_t& index) const {
+    const auto it = lookup_.find(name);
+    if (it == lookup_.end()) return false;
+    index = it->second;
+    return true;
+}
+
+bool AssetPackage::load(size_t index, Asset& asset, std::string& error) const {
+    std::vector<Asset> assets;
+    if (!loadAssets({index}, assets, error)) return false;
+    asset = std::move(assets[0]);
+    return true;
+}
+
+bool AssetPackage::loadAll(std::vector<Asset>& assets, std::string& error) const {
+    std::vector<size_t> indices(toc_.size());
+    for (size_t i = 0; i < indices.size(); ++i) indices[i] = i;
+    return loadAssets(indices, assets, error);
+}
+
+bool AssetPackage::loadAssets(const std::vector<size_t>& indices, std::vector<Asset>& assets,
+                              std::string& error) const {
+    assets.clear();
+    if (!file_) {
+        error = "package is not open";
+        return false;
+    }
+
+    // Compressed assets get a buffer each; their blocks are then decoded as one batch
+    struct Job {
+        const Block* block;
+        char* destination;
+    };
+    std::vector<std::shared_ptr<char[]>> buffers(indices.size());
+    std::vector<Job> jobs;
+    for (size_t k = 0; k < indices.size(); ++k) {
+        if (indices[k] >= toc_.size()) {
+            error = "no asset " + std::to_string(indices[k]);
+            return false;
+        }
+        const TocEntry& entry = toc_[indices[k]];
+        if (!(entry.flags & FLAG_COMPRESSED)) continue;
+        buffers[k].reset(new char[entry.rawSize]);
+        char* destination = buffers[k].get();
+        for (uint64_t b = 0; b < entry.blockCount; ++b) {
+            const Block& block = blocks_[entry.firstBlock + b];
+            jobs.push_back({&block, destination});
+            destination += block.rawSize;
+        }
+    }
+
+    std::atomic<bool> decoded{true};
+    const char* data = file_->data();
+    Parallel::forEach(jobs.size(), [&](size_t j) {
+        if (!decodeBlock(data, *jobs[j].block, jobs[j].destination)) decoded = false;
+    });
+    if (!decoded) {
+        error = "corrupt compressed block";
+        return false;
+    }
+
+    assets.resize(indices.size());
+    for (size_t k = 0; k < indices.size(); ++k) {
+        const TocEntry& entry = toc_[indices[k]];
+        const char* blob = buffers[k] ? buffers[k].get() : data + entry.dataOffset;
+
+        MeshView view(reinterpret_cast<const Vertex*>(blob), entry.vertexCount,
+                      reinterpret_cast<const uint32_t*>(blob + entry.indexOffset), entry.indexCount);
+        view.lods = reinterpret_cast<const MeshLod*>(blob + entry.lodOffset);
+        view.lodCount = entry.lodCount;
+        if (!validateLods(view)) {
+            error = "asset " + names_[indices[k]] + " has a level of detail out of bounds";
+            assets.clear();
+            return false;
+        }
+        if (!view.indicesInRange()) {
+            error = "asset " + names_[indices[k]] + " has an index out of range";
+            assets.clear();
+            return false;
+        }
+
+        Asset& asset = assets[k];
+        asset.name = names_[indices[k]];
+        // Decompressed data is owned by its buffer, stored data by the mapping
+        asset.geometry = buffers[k] ? GeometryBuffer::wrap(view, buffers[k]) : GeometryBuffer::wrap(view, file_);
+        asset.boundsMin = glm::vec3(entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]);
+        asset.boundsMax = glm::vec3(entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]);
+        asset.boundingSphereCenter = glm::vec3(entry.sphereCenter[0], entry.sphereCenter[1], entry.sphereCenter[2]);
+        asset.boundingSphereRadius = entry.sphereRadius;
+    }
+    return true;
+}
+
+bool AssetPackage::write(const std::string& path, const std::vector<Source>& assets, const WriteOptions& options,
+                         std::string& error) {
+    if (options.blockSize == 0 || options.blockSize % 4 != 0) {
+        error = "block size must be a positive multiple of 4";
+        return false;
+    }
+    std::unordered_map<std::string, size_t> seen;
+    for (const Source& source : assets) {
+        if (source.name.empty() || !seen.emplace(source.name, 0).second) {
+            error = "asset names must be unique and not empty: '" + source.name + "'";
+            return false;
+        }
+        if (source.mesh.empty()) {
+            error = "asset " + source.name + " is empty";
+            return false;
+        }
+        if (!validateLods(source.mesh)) {
+            error = "asset " + source.name + " has a level of detail out of bounds";
+            return false;
+        }
+        if (!source.mesh.indicesInRange()) {
+            error = "asset " + source.name + " has an index out of range";
+            return false;
+        }
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.vertexStride = sizeof(Vertex);
+    header.lodStride = sizeof(MeshLod);
+    header.blockSize = options.blockSize;
+    header.assetCount = assets.size();
+
+    std::vector<TocEntry> toc(assets.size());
+    std::vector<Block> blocks;
+    std::string names;
+
+    const std::string tempPath = path + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "could not create " + tempPath;
+        return false;
+    }
+
+    // The header is rewritten at the end, once the table offsets are known
+    uint64_t position = 0;
+    const std::vector<char> padding(BLOB_ALIGNMENT, 0);
+    auto emit = [&](const void* data, uint64_t size) {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        position += size;
+    };
+    auto padTo = [&](uint64_t alignment) {
+        emit(padding.data(), alignUp(position, alignment) - position);
+    };
+    emit(&header, sizeof(Header));
+
+    std::vector<char> raw;
+    for (size_t a = 0; a < assets.size() && out; ++a) {
+        const MeshView& mesh = assets[a].mesh;
+        const BlobLayout layout = layoutFor(mesh);
+        TocEntry& entry = toc[a];
+        entry.nameOffset = names.size();
+        entry.nameLength = static_cast<uint32_t>(assets[a].name.size());
+        names += assets[a].name;
+        entry.rawSize = layout.rawSize;
+        entry.vertexCount = mesh.vertexCount;
+        entry.indexCount = mesh.indexCount;
+        entry.indexOffset = layout.indexOffset;
+        entry.lodCount = mesh.lodCount;
+        entry.lodOffset = layout.lodOffset;
+
+        glm::vec3 minBounds, maxBounds, center;
+        Bounds::computeBox(mesh.vertices, mesh.vertexCount, minBounds, maxBounds);
+        MeshCache::computeBoundingSphere(mesh, center, entry.sphereRadius);
+        for (int i = 0; i < 3; ++i) {
+            entry.boundsMin[i] = minBounds[i];
+            entry.boundsMax[i] = maxBounds[i];
+            entry.sphereCenter[i] = center[i];
+        }
+
+        // The blob as it is loaded
+        raw.assign(layout.rawSize, 0);
+        std::memcpy(raw.data(), mesh.vertices, mesh.vertexCount * sizeof(Vertex));
+        std::memcpy(raw.data() + layout.indexOffset, mesh.indices, mesh.indexCount * sizeof(uint32_t));
+        if (mesh.lodCount > 0) std::memcpy(raw.data() + layout.lodOffset, mesh.lods, mesh.lodCount * sizeof(MeshLod));
+
+        // Compress the blocks in parallel; each keeps the smaller of its compressed and raw forms
+        const size_t blockCount = options.compress ? (raw.size() + options.blockSize - 1) / options.blockSize : 0;
+        std::vector<std::vector<char>> stored(blockCount);
+        Parallel::forEach(blockCount, [&](size_t b) {
+            const size_t begin = b * options.blockSize;
+            const size_t size = std::min<size_t>(options.blockSize, raw.size() - begin);
+            std::vector<char> shuffled(size);
+            shuffle(raw.data() + begin, shuffled.data(), size);
+            stored[b].resize(LzCodec::maxCompressedSize(size));
+            const size_t compressed = LzCodec::compress(shuffled.data(), size, stored[b].data(), stored[b].size());
+            if (compressed == 0 || compressed >= size) {
+                stored[b].assign(raw.data() + begin, raw.data() + begin + size);
+            } else {
+                stored[b].resize(compressed);
+            }
+        });
+        uint64_t storedSize = 0;
+        for (const auto& block : stored) storedSize += block.size();
+
+        padTo(BLOB_ALIGNMENT);
+        entry.dataOffset = position;
+        if (blockCount > 0 && storedSize * 16 <= raw.size() * 15) {
+            entry.flags = FLAG_COMPRESSED;
+            entry.firstBlock = blocks.size();
+            entry.blockCount = blockCount;
+            for (size_t b = 0; b < blockCount; ++b) {
+                const uint32_t rawSize = static_cast<uint32_t>(std::min<size_t>(options.blockSize, raw.size() - b * options.blockSize));
+                blocks.push_back({position, static_cast<uint32_t>(stored[b].size()), rawSize});
+                emit(stored[b].data(), stored[b].size());
+            }
+        } else {
+            emit(raw.data(), raw.size());
+        }
+    }
+
+    // Tables go after the blobs
+    padTo(TABLE_ALIGNMENT);
+    header.tocOffset = position;
+    emit(toc.data(), toc.size() * sizeof(TocEntry));
+    header.blockCount = blocks.size();
+    header.blockOffset = position;
+    emit(blocks.data(), blocks.size() * sizeof(Block));
+    header.namesSize = names.size();
+    header.namesOffset = position;
+    emit(names.data(), names.size());
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+    out.close();
+    std::error_code ec;
+    if (!out) {
+        std::filesystem::remove(tempPath, ec);
+        error = "could not write " + tempPath;
+        return false;
+    }
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        error = "could not rename " + tempPath + " to " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "../geometry/GeometryBuffer.h"
+#include "../geometry/MeshView.h"
+#include "../../common/MappedFile.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Package (.vpak) of many processed meshes in one file, with a table of contents.
+ *
+ * Each asset is a blob in the renderer's layout, the same as a .vmesh cache:
+ * Vertex records, uint32 indices and the MeshLod table, 16-byte aligned within the
+ * blob. Blobs start on 4 KiB boundaries after a fixed header. The table of contents,
+ * block table and names follow the last blob, where the writer knows their sizes, and
+ * the header records their offsets, so opening a package is one mapping and a few
+ * small reads however many assets it holds.
+ *
+ * Blobs are stored either as-is, in which case loading hands out a view straight
+ * into the mapping, or split into fixed-size blocks compressed independently with
+ * LzCodec. Before compression the bytes of each block are shuffled into four planes
+ * (byte 0 of every 32-bit word, then byte 1, ...), which groups the similar high
+ * bytes of floats and indices. Blocks decompress in parallel, across all assets
+ * when loadAll() is used. The writer only keeps an asset compressed when that saves
+ * at least 1/16 of its size; otherwise the zero-copy load is worth more.
+ *
+ * Keywords: Asset Package, Archive, Table of Contents, Memory Mapped I/O, Block Compression
+ */
+class AssetPackage {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+
+    /**
+     * @brief On-disk header. All offsets are in bytes from the start of the file.
+     */
+    struct Header {
+        char magic[4];         // "VPAK"
+        uint32_t version;      // AssetPackage::VERSION
+        uint32_t vertexStride; // sizeof(Vertex) at write time
+        uint32_t lodStride;    // sizeof(MeshLod) at write time
+        uint32_t blockSize;    // Uncompressed size of every block but an asset's last
+        uint32_t reserved;
+        uint64_t assetCount;
+        uint64_t tocOffset;    // assetCount TocEntry records
+        uint64_t blockCount;
+        uint64_t blockOffset;  // blockCount Block records, for all compressed assets
+        uint64_t namesSize;
+        uint64_t namesOffset;  // Asset names, back to back
+    };
+
+    /**
+     * @brief Table of contents entry of one asset.
+     */
+    struct TocEntry {
+        uint64_t nameOffset;  // Into the names area
+        uint32_t nameLength;
+        uint32_t flags;       // FLAG_COMPRESSED
+        uint64_t dataOffset;  // Stored blob (uncompressed assets)
+        uint64_t rawSize;     // Size of the uncompressed blob
+        uint64_t vertexCount; // Vertices start at the beginning of the blob
+        uint64_t indexCount;
+        uint64_t indexOffset; // Within the uncompressed blob
+        uint64_t lodCount;
+        uint64_t lodOffset;
+        uint64_t firstBlock;  // Compressed assets: blockCount entries of the block table
+        uint64_t blockCount;
+        float boundsMin[3];   // Axis-aligned bounds of the vertex positions
+        float boundsMax[3];
+        float sphereCenter[3];
+        float sphereRadius;
+    };
+
+    /**
+     * @brief One compressed block.
+     */
+    struct Block {
+        uint64_t offset;     // From the start of the file
+        uint32_t storedSize; // Equal to rawSize when the block did not compress and is stored as-is
+        uint32_t rawSize;
+    };
+
+    static constexpr uint32_t FLAG_COMPRESSED = 1;
+
+    /**
+     * @brief A loaded asset.
+     */
+    struct Asset {
+        std::string name;
+        std::shared_ptr<const GeometryBuffer> geometry;
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        glm::vec3 boundsMax = glm::vec3(0.0f);
+        glm::vec3 boundingSphereCenter = glm::vec3(0.0f);
+        float boundingSphereRadius = 0.0f;
+    };
+
+    /**
+     * @brief An asset to write.
+     */
+    struct Source {
+        std::string name;
+        MeshView mesh;
+    };
+
+    struct WriteOptions {
+        bool compress = true;
+        uint32_t blockSize = DEFAULT_BLOCK_SIZE;
+    };
+
+    /**
+     * @brief Maps a package and reads its table of contents.
+     * @return true if the file is a valid package of the current version and layout.
+     */
+    bool open(const std::string& path, std::string& error);
+
+    /**
+     * @brief Unmaps the package. Assets already loaded stay valid.
+     */
+    void close();
+
+    bool isOpen() const { return file_ != nullptr; }
+    size_t getAssetCount() const { return toc_.size(); }
+    const std::string& getName(size_t index) const { return names_[index]; }
+    bool isCompressed(size_t index) const { return (toc_[index].flags & FLAG_COMPRESSED) != 0; }
+
+    /**
+     * @brief Finds an asset by name.
+     * @return true and its index if the package has it.
+     */
+    bool find(const std::string& name, size_t& index) const;
+
+    /**
+     * @brief Loads one asset; uncompressed assets point into the mapping.
+     */
+    bool load(size_t index, Asset& asset, std::string& error) const;
+
+    /**
+     * @brief Loads every asset, decompressing the blocks of all of them in parallel.
+     */
+    bool loadAll(std::vector<Asset>& assets, std::string& error) const;
+
+    /**
+     * @brief Writes a package.
+     *
+     * Blocks of each asset are compressed in parallel and written in order, so only
+     * one asset's compressed data is held at a time. The file is written under a
+     * temporary name and renamed into place.
+     */
+    static bool write(const std::string& path, const std::vector<Source>& assets, const WriteOptions& options,
+                      std::string& error);
+
+private:
+    // Loads several assets; their compressed blocks form one parallel batch
+    bool loadAssets(const std::vector<size_t>& indices, std::vector<Asset>& assets, std::string& error) const;
+
+    std::shared_ptr<const MappedFile> file_;
+    uint32_t blockSize_ = 0;
+    std::vector<TocEntry> toc_;
+    std::vector<Block> blocks_;
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, size_t> lookup_;
+};
@@ -0,0 +1,623 @@
+#include "GlbLoader.h"
+#include "JsonValue.h"
+#include "MeshCache.h"
+#include "../Mesh.h"
+#include "../../common/MappedFile.h"
+#include "../../common/Parallel.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/euler_angles.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+// GLB container (little-endian)
+constexpr uint32_t GLB_MAGIC = 0x46546C67;       // "glTF"
+constexpr uint32_t GLB_VERSION = 2;
+constexpr uint32_t CHUNK_JSON = 0x4E4F534A;      // "JSON"
+constexpr uint32_t CHUNK_BIN = 0x004E4942;       // "BIN\0"
+constexpr size_t GLB_HEADER_SIZE = 12;
+constexpr size_t CHUNK_HEADER_SIZE = 8;
+
+// Accessor component types
+constexpr int COMPONENT_BYTE = 5120;
+constexpr int COMPONENT_UNSIGNED_BYTE = 5121;
+constexpr int COMPONENT_SHORT = 5122;
+constexpr int COMPONENT_UNSIGNED_SHORT = 5123;
+constexpr int COMPONENT_UNSIGNED_INT = 5125;
+constexpr int COMPONENT_FLOAT = 5126;
+
+constexpr int MODE_TRIANGLES = 4;
+
+// Node nesting limit (the hierarchy is walked recursively)
+constexpr int MAX_NODE_DEPTH = 256;
+
+// Vertices per parallel task when converting or flattening
+constexpr size_t CONVERT_BATCH = 1 << 16;
+
+// Aliasing reads whole Vertex records out of the file
+static_assert(sizeof(Vertex) == 36 && offsetof(Vertex, pos) == 0 && offsetof(Vertex, normal) == 12 &&
+              offsetof(Vertex, color) == 24, "Aliasing assumes the packed 36-byte Vertex");
+
+uint32_t readUint32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+size_t componentSize(int componentType) {
+    switch (componentType) {
+    case COMPONENT_BYTE:
+    case COMPONENT_UNSIGNED_BYTE: return 1;
+    case COMPONENT_SHORT:
+    case COMPONENT_UNSIGNED_SHORT: return 2;
+    case COMPONENT_UNSIGNED_INT:
+    case COMPONENT_FLOAT: return 4;
+    default: return 0;
+    }
+}
+
+int componentCount(const std::string& type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT2") return 4;
+    if (type == "MAT3") return 9;
+    if (type == "MAT4") return 16;
+    return 0;
+}
+
+/**
+ * @brief A validated accessor: element i starts at data + i * stride.
+ */
+struct Accessor {
+    const char* data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    int componentType = 0;
+    int components = 0;
+    bool normalized = false;
+    int bufferView = -1;
+    size_t offset = 0; // Of element 0 within the BIN chunk
+
+    float read(size_t element, int component) const {
+        const char* p = data + element * stride;
+        switch (componentType) {
+        case COMPONENT_FLOAT: {
+            float value;
+            std::memcpy(&value, p + 4 * component, sizeof(value));
+            return value;
+        }
+        case COMPONENT_UNSIGNED_BYTE: {
+            const float value = static_cast<float>(static_cast<uint8_t>(p[component]));
+            return normalized ? value / 255.0f : value;
+        }
+        case COMPONENT_UNSIGNED_SHORT: {
+            uint16_t value;
+            std::memcpy(&value, p + 2 * component, sizeof(value));
+            return normalized ? value / 65535.0f : static_cast<float>(value);
+        }
+        case COMPONENT_BYTE: {
+            const float value = static_cast<float>(static_cast<int8_t>(p[component]));
+            return normalized ? std::max(value / 127.0f, -1.0f) : value;
+        }
+        case COMPONENT_SHORT: {
+            int16_t value;
+            std::memcpy(&value, p + 2 * component, sizeof(value));
+            return normalized ? std::max(value / 32767.0f, -1.0f) : static_cast<float>(value);
+        }
+        default:
+            return 0.0f;
+        }
+    }
+
+    uint32_t readIndex(size_t element) const {
+        const char* p = data + element * stride;
+        switch (componentType) {
+        case COMPONENT_UNSIGNED_BYTE: return static_cast<uint8_t>(*p);
+        case COMPONENT_UNSIGNED_SHORT: {
+            uint16_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+        default: return readUint32(p);
+        }
+    }
+};
+
+/**
+ * @brief Parsing state shared by the steps of one load.
+ */
+struct Document {
+    const JsonValue& json;
+    const char* bin;     // BIN chunk (null when the file has none)
+    size_t binSize;
+    std::string& error;
+};
+
+bool fail(Document& document, const std::string& message) {
+    document.error = message;
+    return false;
+}
+
+/**
+ * @brief Resolves and bounds-checks accessor `index`.
+ */
+bool resolveAccessor(Document& document, int index, Accessor& out) {
+    const JsonValue& accessors = document.json["accessors"];
+    if (index < 0 || static_cast<size_t>(index) >= accessors.size()) {
+        return fail(document, "accessor " + std::to_string(index) + " does not exist");
+    }
+    const JsonValue& accessor = accessors[static_cast<size_t>(index)];
+    const std::string name = "accessor " + std::to_string(index);
+    if (accessor.has("sparse")) return fail(document, name + " is sparse (not supported)");
+    if (!accessor.has("bufferView")) return fail(document, name + " has no buffer view (not supported)");
+
+    out.componentType = static_cast<int>(accessor["componentType"].asNumber(-1));
+    out.components = componentCount(accessor["type"].asString());
+    out.normalized = accessor["normalized"].asBool(false);
+    const double count = accessor["count"].asNumber(-1);
+    const double accessorOffset = accessor["byteOffset"].asNumber(0);
+    const size_t elementSize = componentSize(out.componentType) * static_cast<size_t>(out.components);
+    if (elementSize == 0) return fail(document, name + " has an invalid component type or type");
+    if (count < 1 || accessorOffset < 0) return fail(document, name + " has an invalid count or offset");
+    out.count = static_cast<size_t>(count);
+
+    const JsonValue& views = document.json["bufferViews"];
+    out.bufferView = static_cast<int>(accessor["bufferView"].asNumber(-1));
+    if (out.bufferView < 0 || static_cast<size_t>(out.bufferView) >= views.size()) {
+        return fail(document, name + " refers to a missing buffer view");
+    }
+    const JsonValue& view = views[static_cast<size_t>(out.bufferView)];
+    if (view["buffer"].asNumber(-1) != 0 || !document.bin) {
+        return fail(document, name + ": only data in the GLB's own BIN chunk is supported");
+    }
+    const JsonValue& buffer = document.json["buffers"][static_cast<size_t>(0)];
+    if (buffer.has("uri")) return fail(document, name + ": external buffers are not supported");
+
+    const double viewOffset = view["byteOffset"].asNumber(0);
+    const double viewLength = view["byteLength"].asNumber(-1);
+    const double viewStride = view["byteStride"].asNumber(0);
+    if (viewOffset < 0 || viewLength < 0 || viewOffset + viewLength > static_cast<double>(document.binSize)) {
+        return fail(document, "buffer view " + std::to_string(out.bufferView) + " lies outside the BIN chunk");
+    }
+    out.stride = viewStride > 0 ? static_cast<size_t>(viewStride) : elementSize;
+    if (out.stride < elementSize) return fail(document, name + " has elements overlapping its stride");
+
+    // The last element must end inside the view
+    const double end = accessorOffset + static_cast<double>(out.stride) * static_cast<double>(out.count - 1) +
+                       static_cast<double>(elementSize);
+    if (end > viewLength) return fail(document, name + " reads past the end of its buffer view");
+
+    out.offset = static_cast<size_t>(viewOffset) + static_cast<size_t>(accessorOffset);
+    if (out.offset % componentSize(out.componentType) != 0 || out.stride % componentSize(out.componentType) != 0) {
+        return fail(document, name + " is misaligned");
+    }
+    out.data = document.bin + out.offset;
+    return true;
+}
+
+bool isFloat3(const Accessor& accessor) {
+    return accessor.componentType == COMPONENT_FLOAT && accessor.components == 3;
+}
+
+/**
+ * @brief Converts one triangle primitive into a GeometryBuffer (aliasing the file when possible).
+ */
+bool loadPrimitive(Document& document, const JsonValue& primitive, const std::shared_ptr<const void>& backing,
+                   GlbLoader::Model& model, std::shared_ptr<const GeometryBuffer>& out) {
+    const JsonValue& attributes = primitive["attributes"];
+    if (!attributes.has("POSITION")) return fail(document, "primitive without POSITION");
+
+    Accessor position, normal, color, index;
+    if (!resolveAccessor(document, static_cast<int>(attributes["POSITION"].asNumber(-1)), position)) return false;
+    if (!isFloat3(position)) return fail(document, "POSITION must be float3");
+    const bool hasNormal = attributes.has("NORMAL");
+    const bool hasColor = attributes.has("COLOR_0");
+    const bool hasIndices = primitive.has("indices");
+    if (hasNormal) {
+        if (!resolveAccessor(document, static_cast<int>(attributes["NORMAL"].asNumber(-1)), normal)) return false;
+        if (!isFloat3(normal) || normal.count != position.count) return fail(document, "NORMAL must be float3 per vertex");
+    }
+    if (hasColor) {
+        if (!resolveAccessor(document, static_cast<int>(attributes["COLOR_0"].asNumber(-1)), color)) return false;
+        const bool validType = color.componentType == COMPONENT_FLOAT ||
+                               (color.normalized && (color.componentType == COMPONENT_UNSIGNED_BYTE ||
+                                                     color.componentType == COMPONENT_UNSIGNED_SHORT));
+        if (!validType || (color.components != 3 && color.components != 4) || color.count != position.count) {
+            return fail(document, "COLOR_0 must be float, unorm8 or unorm16 rgb(a) per vertex");
+        }
+    }
+    if (hasIndices) {
+        if (!resolveAccessor(document, static_cast<int>(primitive["indices"].asNumber(-1)), index)) return false;
+        if (index.components != 1 || index.normalized ||
+            (index.componentType != COMPONENT_UNSIGNED_BYTE && index.componentType != COMPONENT_UNSIGNED_SHORT &&
+             index.componentType != COMPONENT_UNSIGNED_INT)) {
+            return fail(document, "indices must be unsigned 8, 16 or 32-bit scalars");
+        }
+    }
+
+    const size_t vertexCount = position.count;
+    const size_t cornerCount = hasIndices ? index.count : vertexCount;
+    const size_t indexCount = cornerCount - cornerCount % 3;
+
+    // Every index must name a vertex (checked in parallel; the data is read once more later anyway)
+    if (hasIndices) {
+        const size_t batches = (indexCount + CONVERT_BATCH - 1) / CONVERT_BATCH;
+        std::vector<uint32_t> maxIndex(batches, 0);
+        Parallel::forEach(batches, [&](size_t batch) {
+            const size_t end = std::min(indexCount, (batch + 1) * CONVERT_BATCH);
+            uint32_t highest = 0;
+            for (size_t i = batch * CONVERT_BATCH; i < end; ++i) highest = std::max(highest, index.readIndex(i));
+            maxIndex[batch] = highest;
+        });
+        for (uint32_t highest : maxIndex) {
+            if (highest >= vertexCount) return fail(document, "index out of range");
+        }
+    }
+
+    // Zero-copy: the file already holds our interleaved Vertex records and 32-bit indices
+    const bool interleaved = hasNormal && hasColor && isFloat3(color) &&
+                             position.bufferView == normal.bufferView && position.bufferView == color.bufferView &&
+                             position.stride == sizeof(Vertex) && normal.stride == sizeof(Vertex) &&
+                             color.stride == sizeof(Vertex) && normal.data == position.data + offsetof(Vertex, normal) &&
+                             color.data == position.data + offsetof(Vertex, color);
+    const bool packedIndices = hasIndices && index.componentType == COMPONENT_UNSIGNED_INT &&
+                               index.stride == sizeof(uint32_t);
+    if (backing && interleaved && packedIndices &&
+        reinterpret_cast<uintptr_t>(position.data) % alignof(Vertex) == 0 &&
+        reinterpret_cast<uintptr_t>(index.data) % alignof(uint32_t) == 0) {
+        const MeshView view(reinterpret_cast<const Vertex*>(position.data), vertexCount,
+                            reinterpret_cast<const uint32_t*>(index.data), indexCount);
+        out = GeometryBuffer::wrap(view, backing);
+        ++model.aliasedPrimitives;
+        return true;
+    }
+
+    // Convert in one pass into our layout
+    std::vector<Vertex> vertices(vertexCount);
+    const size_t vertexBatches = (vertexCount + CONVERT_BATCH - 1) / CONVERT_BATCH;
+    Parallel::forEach(vertexBatches, [&](size_t batch) {
+        const size_t end = std::min(vertexCount, (batch + 1) * CONVERT_BATCH);
+        for (size_t i = batch * CONVERT_BATCH; i < end; ++i) {
+            Vertex& vertex = vertices[i];
+            std::memcpy(&vertex.pos, position.data + i * position.stride, sizeof(glm::vec3));
+            if (hasNormal) {
+                std::memcpy(&vertex.normal, normal.data + i * normal.stride, sizeof(glm::vec3));
+            } else {
+                vertex.normal = glm::vec3(0.0f);
+            }
+            if (hasColor) {
+                vertex.color = glm::vec3(color.read(i, 0), color.read(i, 1), color.read(i, 2));
+            } else {
+                vertex.color = glm::vec3(1.0f, 1.0f, 1.0f);
+            }
+        }
+    });
+
+    std::vector<uint32_t> indices(indexCount);
+    if (hasIndices) {
+        const size_t indexBatches = (indexCount + CONVERT_BATCH - 1) / CONVERT_BATCH;
+        Parallel::forEach(indexBatches, [&](size_t batch) {
+            const size_t end = std::min(indexCount, (batch + 1) * CONVERT_BATCH);
+            for (size_t i = batch * CONVERT_BATCH; i < end; ++i) indices[i] = index.readIndex(i);
+        });
+    } else {
+        for (size_t i = 0; i < indexCount; ++i) indices[i] = static_cast<uint32_t>(i);
+    }
+
+    if (!hasNormal) model.missingNormals = true;
+    out = GeometryBuffer::create(std::move(vertices), std::move(indices), {});
+    return true;
+}
+
+/**
+ * @brief Sets an Object's position, rotation and scale from a glTF node.
+ */
+void applyNodeTransform(const JsonValue& node, Object& object) {
+    glm::vec3 translation(0.0f), scale(1.0f);
+    glm::mat3 rotation(1.0f);
+
+    const JsonValue& matrix = node["matrix"];
+    if (matrix.size() == 16) {
+        // Column-major; split into T * R * S (shear cannot be represented and is dropped)
+        glm::mat4 m;
+        for (int column = 0; column < 4; ++column) {
+            for (int row = 0; row < 4; ++row) {
+                m[column][row] = static_cast<float>(matrix[static_cast<size_t>(column * 4 + row)].asNumber());
+            }
+        }
+        translation = glm::vec3(m[3]);
+        glm::vec3 axes[3] = {glm::vec3(m[0]), glm::vec3(m[1]), glm::vec3(m[2])};
+        for (int i = 0; i < 3; ++i) scale[i] = glm::length(axes[i]);
+        if (glm::dot(glm::cross(axes[0], axes[1]), axes[2]) < 0.0f) scale.x = -scale.x; // Mirrored
+        for (int i = 0; i < 3; ++i) rotation[i] = scale[i] != 0.0f ? axes[i] / scale[i] : glm::vec3(0.0f);
+    } else {
+        const JsonValue& t = node["translation"];
+        const JsonValue& r = node["rotation"];
+        const JsonValue& s = node["scale"];
+        if (t.size() == 3) {
+            translation = glm::vec3(t[static_cast<size_t>(0)].asNumber(), t[1].asNumber(), t[2].asNumber());
+        }
+        if (s.size() == 3) {
+            scale = glm::vec3(s[static_cast<size_t>(0)].asNumber(1), s[1].asNumber(1), s[2].asNumber(1));
+        }
+        if (r.size() == 4) {
+            // Unit quaternion (x, y, z, w) to a rotation matrix
+            float x = static_cast<float>(r[static_cast<size_t>(0)].asNumber());
+            float y = static_cast<float>(r[1].asNumber());
+            float z = static_cast<float>(r[2].asNumber());
+            float w = static_cast<float>(r[3].asNumber(1));
+            const float length = std::sqrt(x * x + y * y + z * z + w * w);
+            if (length > 0.0f) {
+                x /= length;
+                y /= length;
+                z /= length;
+                w /= length;
+            }
+            rotation[0] = glm::vec3(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y));
+            rotation[1] = glm::vec3(2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x));
+            rotation[2] = glm::vec3(2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y));
+        }
+    }
+
+    // Object rotations are Euler angles applied as Y * X * Z
+    float yaw = 0.0f, pitch = 0.0f, roll = 0.0f;
+    glm::extractEulerAngleYXZ(glm::mat4(rotation), yaw, pitch, roll);
+    object.setPosition(translation);
+    object.setRotation(glm::vec3(pitch, yaw, roll));
+    object.setScale(scale);
+}
+
+/**
+ * @brief Creates the Object for node `index` and its subtree.
+ */
+bool buildNode(Document& document, int index, int depth, std::vector<bool>& visited, const GlbLoader::Model& model,
+               std::shared_ptr<Object>& out) {
+    const JsonValue& nodes = document.json["nodes"];
+    if (index < 0 || static_cast<size_t>(index) >= nodes.size()) {
+        return fail(document, "node " + std::to_string(index) + " does not exist");
+    }
+    if (depth > MAX_NODE_DEPTH) return fail(document, "node hierarchy too deep");
+    if (visited[static_cast<size_t>(index)]) {
+        return fail(document, "node " + std::to_string(index) + " has more than one parent");
+    }
+    visited[static_cast<size_t>(index)] = true;
+
+    const JsonValue& node = nodes[static_cast<size_t>(index)];
+    const std::string name = node["name"].asString();
+    if (node.has("mesh")) {
+        const double meshIndex = node["mesh"].asNumber(-1);
+        if (meshIndex < 0 || meshIndex >= static_cast<double>(model.meshes.size())) {
+            return fail(document, "node " + std::to_string(index) + " refers to a missing mesh");
+        }
+        auto mesh = std::make_shared<Mesh>(name);
+        for (const auto& primitive : model.meshes[static_cast<size_t>(meshIndex)]) mesh->addPrimitive(primitive);
+        out = mesh;
+    } else {
+        out = std::make_shared<Object>(name);
+    }
+    applyNodeTransform(node, *out);
+
+    const JsonValue& children = node["children"];
+    for (size_t i = 0; i < children.size(); ++i) {
+        std::shared_ptr<Object> child;
+        if (!buildNode(document, static_cast<int>(children[i].asNumber(-1)), depth + 1, visited, model, child)) {
+            return false;
+        }
+        out->addChild(child);
+    }
+    return true;
+}
+
+/**
+ * @brief Brings the world matrices of a subtree up to date, parents first.
+ */
+void updateWorldMatrices(Object& object) {
+    object.updateMatrix();
+    for (const auto& child : object.getChildren()) updateWorldMatrices(*child);
+}
+
+/**
+ * @brief Calls fn(mesh) for every Mesh in a subtree.
+ */
+template <typename Fn>
+void forEachMesh(const std::shared_ptr<Object>& object, Fn&& fn) {
+    if (auto mesh = std::dynamic_pointer_cast<Mesh>(object)) fn(*mesh);
+    for (const auto& child : object->getChildren()) forEachMesh(child, fn);
+}
+
+} // namespace
+
+bool GlbLoader::load(const std::string& filename, Model& model, std::string& error) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(filename)) {
+        error = "could not open " + filename;
+        return false;
+    }
+    const char* data = file->data();
+    const size_t size = file->size();
+    return parse(data, size, std::move(file), model, error);
+}
+
+bool GlbLoader::parse(const char* data, size_t size, std::shared_ptr<const void> backing, Model& model,
+                      std::string& error) {
+    model = Model();
+
+    // --- Container: header, JSON chunk, optional BIN chunk ---
+    if (size < GLB_HEADER_SIZE + CHUNK_HEADER_SIZE || readUint32(data) != GLB_MAGIC) {
+        error = "not a binary glTF file";
+        return false;
+    }
+    if (readUint32(data + 4) != GLB_VERSION) {
+        error = "unsupported glTF version " + std::to_string(readUint32(data + 4));
+        return false;
+    }
+    const size_t length = std::min<size_t>(readUint32(data + 8), size);
+    const size_t jsonLength = readUint32(data + GLB_HEADER_SIZE);
+    const size_t jsonOffset = GLB_HEADER_SIZE + CHUNK_HEADER_SIZE;
+    if (readUint32(data + GLB_HEADER_SIZE + 4) != CHUNK_JSON || jsonLength > length - jsonOffset) {
+        error = "missing or truncated JSON chunk";
+        return false;
+    }
+
+    const char* bin = nullptr;
+    size_t binSize = 0;
+    const size_t binHeader = jsonOffset + ((jsonLength + 3) & ~size_t(3));
+    if (binHeader + CHUNK_HEADER_SIZE <= length && readUint32(data + binHeader + 4) == CHUNK_BIN) {
+        binSize = readUint32(data + binHeader);
+        if (binSize > length - binHeader - CHUNK_HEADER_SIZE) {
+            error = "truncated BIN chunk";
+            return false;
+        }
+        bin = data + binHeader + CHUNK_HEADER_SIZE;
+    }
+
+    JsonValue json;
+    if (!JsonValue::parse(data + jsonOffset, jsonLength, json, error)) {
+        error = "invalid JSON chunk: " + error;
+        return false;
+    }
+    Document document{json, bin, binSize, error};
+
+    // --- Meshes: one GeometryBuffer per triangle primitive ---
+    const JsonValue& meshes = json["meshes"];
+    model.meshes.resize(meshes.size());
+    for (size_t m = 0; m < meshes.size(); ++m) {
+        const JsonValue& primitives = meshes[m]["primitives"];
+        for (size_t p = 0; p < primitives.size(); ++p) {
+            const JsonValue& primitive = primitives[p];
+            if (primitive["mode"].asNumber(MODE_TRIANGLES) != MODE_TRIANGLES) {
+                std::cerr << "Warning: skipping non-triangle primitive " << p << " of mesh " << m << std::endl;
+                continue;
+            }
+            std::shared_ptr<const GeometryBuffer> geometry;
+            if (!loadPrimitive(document, primitive, backing, model, geometry)) {
+                error = "mesh " + std::to_string(m) + ", primitive " + std::to_string(p) + ": " + error;
+                return false;
+            }
+            model.meshes[m].push_back(std::move(geometry));
+        }
+    }
+
+    // --- Nodes of the default scene (or every root node when there are no scenes) ---
+    const JsonValue& nodes = json["nodes"];
+    std::vector<int> roots;
+    const JsonValue& scenes = json["scenes"];
+    if (scenes.size() > 0) {
+        const JsonValue& scene = scenes[static_cast<size_t>(json["scene"].asNumber(0))];
+        const JsonValue& sceneNodes = scene["nodes"];
+        for (size_t i = 0; i < sceneNodes.size(); ++i) roots.push_back(static_cast<int>(sceneNodes[i].asNumber(-1)));
+    } else {
+        std::vector<bool> isChild(nodes.size(), false);
+        for (size_t n = 0; n < nodes.size(); ++n) {
+            const JsonValue& children = nodes[n]["children"];
+            for (size_t i = 0; i < children.size(); ++i) {
+                const double child = children[i].asNumber(-1);
+                if (child >= 0 && child < static_cast<double>(nodes.size())) isChild[static_cast<size_t>(child)] = true;
+            }
+        }
+        for (size_t n = 0; n < nodes.size(); ++n) {
+            if (!isChild[n]) roots.push_back(static_cast<int>(n));
+        }
+    }
+
+    model.root = std::make_shared<Object>("glTF scene");
+    std::vector<bool> visited(nodes.size(), false);
+    for (int root : roots) {
+        std::shared_ptr<Object> node;
+        if (!buildNode(document, root, 0, visited, model, node)) return false;
+        model.root->addChild(node);
+    }
+    updateWorldMatrices(*model.root);
+    return true;
+}
+
+std::shared_ptr<const GeometryBuffer> GlbLoader::zeroCopyGeometry(const Model& model, float scale) {
+    if (!model.root || scale != 1.0f || model.aliasedPrimitives == 0) return nullptr;
+
+    std::shared_ptr<const GeometryBuffer> only;
+    size_t drawn = 0;
+    bool identity = true;
+    forEachMesh(model.root, [&](const Mesh& mesh) {
+        drawn += mesh.getPrimitives().size();
+        if (!mesh.getPrimitives().empty()) {
+            only = mesh.getPrimitives().front();
+            identity = identity && mesh.getMatrixWorld() == glm::mat4(1.0f);
+        }
+    });
+    if (drawn != 1 || !identity) return nullptr;
+
+    // Aliased buffers are the ones backed by external storage
+    const std::shared_ptr<const GeometryBuffer::CpuData> cpuData = only->getCpuData();
+    return cpuData && cpuData->backing ? only : nullptr;
+}
+
+void GlbLoader::flatten(const Model& model, float scale, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    vertices.clear();
+    indices.clear();
+    if (!model.root) return;
+
+    // Every drawn primitive instance, with its place in the output
+    struct Instance {
+        std::shared_ptr<const GeometryBuffer::CpuData> data;
+        glm::mat4 transform;
+        size_t firstVertex;
+        size_t firstIndex;
+    };
+    std::vector<Instance> instances;
+    size_t vertexCount = 0, indexCount = 0;
+    const glm::mat4 scaling = glm::scale(glm::mat4(1.0f), glm::vec3(scale));
+    forEachMesh(model.root, [&](const Mesh& mesh) {
+        for (const auto& primitive : mesh.getPrimitives()) {
+            Instance instance{primitive->getCpuData(), scaling * mesh.getMatrixWorld(), vertexCount, indexCount};
+            if (!instance.data) continue;
+            vertexCount += instance.data->view.vertexCount;
+            indexCount += instance.data->view.indexCount;
+            instances.push_back(std::move(instance));
+        }
+    });
+
+    vertices.resize(vertexCount);
+    indices.resize(indexCount);
+    Parallel::forEach(instances.size(), [&](size_t i) {
+        const Instance& instance = instances[i];
+        const MeshView& view = instance.data->view;
+        const glm::mat3 linear(instance.transform);
+        const glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+        const bool mirrored = glm::dot(glm::cross(linear[0], linear[1]), linear[2]) < 0.0f;
+
+        for (size_t v = 0; v < view.vertexCount; ++v) {
+            Vertex vertex = view.vertices[v];
+            vertex.pos = glm::vec3(instance.transform * glm::vec4(vertex.pos, 1.0f));
+            const glm::vec3 n = normalMatrix * vertex.normal;
+            const float length = glm::length(n);
+            vertex.normal = length > 0.0f ? n / length : glm::vec3(0.0f);
+            vertices[instance.firstVertex + v] = vertex;
+        }
+
+        // Mirroring transforms flip the winding, so swap two corners to keep front faces
+        const uint32_t base = static_cast<uint32_t>(instance.firstVertex);
+        for (size_t t = 0; t + 2 < view.indexCount; t += 3) {
+            uint32_t* out = &indices[instance.firstIndex + t];
+            out[0] = base + view.indices[t];
+            out[1] = base + view.indices[mirrored ? t + 2 : t + 1];
+            out[2] = base + view.indices[mirrored ? t + 1 : t + 2];
+        }
+    });
+}
+
+uint64_t GlbLoader::cacheKey(float scale) {
+    static constexpr uint32_t CONVERSION_VERSION = 1;
+    const struct {
+        uint32_t format; // Distinguishes glTF results from OBJ ones
+        uint32_t version;
+        float scale;
+    } key{0x676C62u, CONVERSION_VERSION, scale};
+    return MeshCache::hashBytes(&key, sizeof(key));
+}
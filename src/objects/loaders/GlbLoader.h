@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../geometry/GeometryBuffer.h"
+#include "../../common/Object.h"
+#include "../../common/Vertex.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Loads binary glTF 2.0 (.glb) files without any text parsing of the geometry.
+ *
+ * The file is memory-mapped. Only the JSON chunk is parsed; vertex and index data
+ * is read straight from the BIN chunk through the accessors, after each accessor
+ * has been checked to lie within its buffer view and the view within the buffer.
+ *
+ * Every triangle primitive becomes a GeometryBuffer holding node-local, unscaled
+ * vertices:
+ * - Primitives whose POSITION, NORMAL and COLOR_0 are float3 and interleaved with a
+ *   36-byte stride (exactly our Vertex), and whose indices are 32-bit, alias the
+ *   mapped file. Nothing is copied until the renderer's staging copy.
+ * - Anything else is converted into Vertex arrays in one pass. Missing normals are
+ *   left zero (see Model::missingNormals), missing colors are white, and
+ *   non-indexed primitives get sequential indices.
+ *
+ * The nodes of the default scene become an Object hierarchy carrying each node's
+ * transform. Nodes with a mesh are Mesh objects, and nodes instancing the same mesh
+ * share its buffers. Only buffer 0 stored in the GLB itself is supported (no
+ * external .bin files or data URIs), and neither are sparse accessors.
+ *
+ * Keywords: glTF 2.0, GLB, Binary Mesh Loading, Memory Mapped I/O, Zero-Copy, Scene Graph
+ */
+class GlbLoader {
+public:
+    /**
+     * @brief A loaded .glb file.
+     */
+    struct Model {
+        std::shared_ptr<Object> root; // Nodes of the default scene, world matrices up to date
+        std::vector<std::vector<std::shared_ptr<const GeometryBuffer>>> meshes; // Primitives of every glTF mesh
+        size_t aliasedPrimitives = 0; // Primitives pointing straight into the mapped file
+        bool missingNormals = false;  // Some primitive had no NORMAL (its normals are zero)
+    };
+
+    /**
+     * @brief Memory-maps and loads a .glb file.
+     * @param filename Path to the file.
+     * @param model Receives the meshes and node hierarchy.
+     * @param error Receives a description of the problem on failure.
+     * @return true if loading was successful, false otherwise.
+     */
+    static bool load(const std::string& filename, Model& model, std::string& error);
+
+    /**
+     * @brief Loads a .glb file already in memory.
+     * @param data Start of the file (4-byte aligned).
+     * @param size Size of the file in bytes.
+     * @param backing Keeps data alive for aliased primitives (null: always convert).
+     * @param model Receives the meshes and node hierarchy.
+     * @param error Receives a description of the problem on failure.
+     * @return true if loading was successful, false otherwise.
+     */
+    static bool parse(const char* data, size_t size, std::shared_ptr<const void> backing, Model& model,
+                      std::string& error);
+
+    /**
+     * @brief The model's only primitive if it can be drawn as-is, straight from the file.
+     * @return The aliased buffer when the model draws exactly one aliased primitive once,
+     *         with an identity transform and scale 1; null otherwise.
+     */
+    static std::shared_ptr<const GeometryBuffer> zeroCopyGeometry(const Model& model, float scale);
+
+    /**
+     * @brief Bakes every drawn primitive into one mesh in world space.
+     * @param model Loaded model.
+     * @param scale Uniform scale applied on top of the node transforms.
+     * @param vertices Receives the transformed vertices.
+     * @param indices Receives the triangle indices.
+     */
+    static void flatten(const Model& model, float scale, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+    /**
+     * @brief Key of the flattened result for the mesh cache.
+     */
+    static uint64_t cacheKey(float scale);
+};
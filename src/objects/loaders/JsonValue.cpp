@@ -0,0 +1,285 @@
+#include "JsonValue.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Nesting limit, so hostile input cannot overflow the stack
+constexpr int MAX_DEPTH = 128;
+
+const JsonValue& nullValue() {
+    static const JsonValue value;
+    return value;
+}
+
+const std::string& emptyString() {
+    static const std::string value;
+    return value;
+}
+
+void appendUtf8(std::string& out, unsigned long codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Recursive descent over the JSON text (internal to JsonValue::parse).
+ */
+class JsonReader {
+public:
+    JsonReader(const char* data, size_t size) : begin_(data), p_(data), end_(data + size) {}
+
+    bool readDocument(JsonValue& out, std::string& error) {
+        if (!readValue(out, 0)) {
+            error = std::string(error_) + " at byte " + std::to_string(p_ - begin_);
+            return false;
+        }
+        skipWhitespace();
+        if (p_ != end_) {
+            error = "unexpected data after the document at byte " + std::to_string(p_ - begin_);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    const char* begin_;
+    const char* p_;
+    const char* end_;
+    const char* error_ = "";
+
+    bool fail(const char* message) {
+        error_ = message;
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) ++p_;
+    }
+
+    bool consume(const char* literal) {
+        const size_t length = std::strlen(literal);
+        if (static_cast<size_t>(end_ - p_) < length || std::memcmp(p_, literal, length) != 0) return false;
+        p_ += length;
+        return true;
+    }
+
+    bool readValue(JsonValue& out, int depth) {
+        if (depth > MAX_DEPTH) return fail("nesting too deep");
+        skipWhitespace();
+        if (p_ == end_) return fail("unexpected end of input");
+
+        switch (*p_) {
+        case '{': return readObject(out, depth);
+        case '[': return readArray(out, depth);
+        case '"':
+            out.type_ = JsonValue::Type::String;
+            return readString(out.string_);
+        case 't':
+            if (!consume("true")) return fail("invalid literal");
+            out.type_ = JsonValue::Type::Bool;
+            out.bool_ = true;
+            return true;
+        case 'f':
+            if (!consume("false")) return fail("invalid literal");
+            out.type_ = JsonValue::Type::Bool;
+            out.bool_ = false;
+            return true;
+        case 'n':
+            if (!consume("null")) return fail("invalid literal");
+            out.type_ = JsonValue::Type::Null;
+            return true;
+        default:
+            return readNumber(out);
+        }
+    }
+
+    bool readObject(JsonValue& out, int depth) {
+        out.type_ = JsonValue::Type::Object;
+        ++p_; // '{'
+        skipWhitespace();
+        if (p_ < end_ && *p_ == '}') {
+            ++p_;
+            return true;
+        }
+        for (;;) {
+            skipWhitespace();
+            if (p_ == end_ || *p_ != '"') return fail("expected a member name");
+            out.keys_.emplace_back();
+            if (!readString(out.keys_.back())) return false;
+            skipWhitespace();
+            if (p_ == end_ || *p_ != ':') return fail("expected ':'");
+            ++p_;
+            out.items_.emplace_back();
+            if (!readValue(out.items_.back(), depth + 1)) return false;
+            skipWhitespace();
+            if (p_ == end_) return fail("unterminated object");
+            if (*p_ == ',') {
+                ++p_;
+                continue;
+            }
+            if (*p_ == '}') {
+                ++p_;
+                return true;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+
+    bool readArray(JsonValue& out, int depth) {
+        out.type_ = JsonValue::Type::Array;
+        ++p_; // '['
+        skipWhitespace();
+        if (p_ < end_ && *p_ == ']') {
+            ++p_;
+            return true;
+        }
+        for (;;) {
+            out.items_.emplace_back();
+            if (!readValue(out.items_.back(), depth + 1)) return false;
+            skipWhitespace();
+            if (p_ == end_) return fail("unterminated array");
+            if (*p_ == ',') {
+                ++p_;
+                continue;
+            }
+            if (*p_ == ']') {
+                ++p_;
+                return true;
+            }
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    bool readHex4(unsigned long& value) {
+        if (end_ - p_ < 4) return fail("truncated \\u escape");
+        value = 0;
+        for (int i = 0; i < 4; ++i, ++p_) {
+            const char c = *p_;
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= static_cast<unsigned long>(c - '0');
+            else if (c >= 'a' && c <= 'f') value |= static_cast<unsigned long>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value |= static_cast<unsigned long>(c - 'A' + 10);
+            else return fail("invalid \\u escape");
+        }
+        return true;
+    }
+
+    bool readString(std::string& out) {
+        ++p_; // '"'
+        for (;;) {
+            // Copy the run up to the next quote or escape in one go
+            const char* run = p_;
+            while (p_ < end_ && *p_ != '"' && *p_ != '\\') {
+                if (static_cast<unsigned char>(*p_) < 0x20) return fail("control character in string");
+                ++p_;
+            }
+            out.append(run, p_);
+            if (p_ == end_) return fail("unterminated string");
+            if (*p_ == '"') {
+                ++p_;
+                return true;
+            }
+
+            ++p_; // '\\'
+            if (p_ == end_) return fail("unterminated string");
+            const char escape = *p_++;
+            switch (escape) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned long codePoint = 0;
+                if (!readHex4(codePoint)) return false;
+                // A high surrogate must be followed by a low one
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    unsigned long low = 0;
+                    if (!consume("\\u") || !readHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                        return fail("invalid surrogate pair");
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                return fail("invalid escape");
+            }
+        }
+    }
+
+    bool readNumber(JsonValue& out) {
+        // Validate the JSON number grammar, then convert the span with strtod
+        const char* start = p_;
+        if (p_ < end_ && *p_ == '-') ++p_;
+        if (p_ == end_ || *p_ < '0' || *p_ > '9') return fail("invalid value");
+        if (*p_ == '0') {
+            ++p_;
+        } else {
+            while (p_ < end_ && *p_ >= '0' && *p_ <= '9') ++p_;
+        }
+        if (p_ < end_ && *p_ == '.') {
+            ++p_;
+            if (p_ == end_ || *p_ < '0' || *p_ > '9') return fail("invalid number");
+            while (p_ < end_ && *p_ >= '0' && *p_ <= '9') ++p_;
+        }
+        if (p_ < end_ && (*p_ == 'e' || *p_ == 'E')) {
+            ++p_;
+            if (p_ < end_ && (*p_ == '+' || *p_ == '-')) ++p_;
+            if (p_ == end_ || *p_ < '0' || *p_ > '9') return fail("invalid number");
+            while (p_ < end_ && *p_ >= '0' && *p_ <= '9') ++p_;
+        }
+
+        // strtod needs a terminated string; numbers are short
+        const std::string text(start, p_);
+        out.type_ = JsonValue::Type::Number;
+        out.number_ = std::strtod(text.c_str(), nullptr);
+        return true;
+    }
+};
+
+bool JsonValue::parse(const char* data, size_t size, JsonValue& out, std::string& error) {
+    out = JsonValue();
+    JsonReader reader(data, size);
+    return reader.readDocument(out, error);
+}
+
+const std::string& JsonValue::asString() const {
+    return type_ == Type::String ? string_ : emptyString();
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+    return index < items_.size() ? items_[index] : nullValue();
+}
+
+const JsonValue& JsonValue::operator[](const char* key) const {
+    if (type_ != Type::Object) return nullValue();
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        if (keys_[i] == key) return items_[i];
+    }
+    return nullValue();
+}
+
+const std::string& JsonValue::keyAt(size_t index) const {
+    return index < keys_.size() ? keys_[index] : emptyString();
+}
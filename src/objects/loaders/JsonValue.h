@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Minimal read-only JSON document, enough for glTF.
+ *
+ * parse() builds the whole tree up front. Lookups never fail: a missing key or an
+ * out-of-range index yields a shared null value, and the as*() accessors return
+ * their fallback when the type does not match, so callers validate what they read
+ * instead of checking every step.
+ *
+ * Numbers are kept as double. Object members keep their file order, and lookup is a
+ * linear scan, which suits the small objects of a glTF document.
+ *
+ * Keywords: JSON Parsing, glTF, Recursive Descent
+ */
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    JsonValue() = default;
+
+    /**
+     * @brief Parses a JSON document.
+     * @param data Start of the JSON text (does not need to be null-terminated).
+     * @param size Size of the text in bytes.
+     * @param out Receives the document root.
+     * @param error Receives a description and byte offset of the problem on failure.
+     * @return true if the text is valid JSON.
+     */
+    static bool parse(const char* data, size_t size, JsonValue& out, std::string& error);
+
+    Type type() const { return type_; }
+    bool isNull() const { return type_ == Type::Null; }
+    bool isNumber() const { return type_ == Type::Number; }
+    bool isString() const { return type_ == Type::String; }
+    bool isArray() const { return type_ == Type::Array; }
+    bool isObject() const { return type_ == Type::Object; }
+
+    bool asBool(bool fallback = false) const { return type_ == Type::Bool ? bool_ : fallback; }
+    double asNumber(double fallback = 0.0) const { return type_ == Type::Number ? number_ : fallback; }
+    const std::string& asString() const; // Empty unless a string
+
+    /**
+     * @brief Number of array elements or object members (0 otherwise).
+     */
+    size_t size() const { return items_.size(); }
+
+    /**
+     * @brief Array element (or object member value) by position.
+     */
+    const JsonValue& operator[](size_t index) const;
+
+    /**
+     * @brief Object member by key (null when missing or not an object).
+     */
+    const JsonValue& operator[](const char* key) const;
+    bool has(const char* key) const { return !(*this)[key].isNull(); }
+
+    /**
+     * @brief Key of the object member at the given position.
+     */
+    const std::string& keyAt(size_t index) const;
+
+private:
+    friend class JsonReader;
+
+    Type type_ = Type::Null;
+    bool bool_ = false;
+    double number_ = 0.0;
+    std::string string_;
+    std::vector<std::string> keys_;  // Object member keys, parallel to items_
+    std::vector<JsonValue> items_;   // Array elements or object member values
+};
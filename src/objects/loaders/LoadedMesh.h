@@ -0,0 +1,37 @@
+#pragma once
+
+#include "MeshCache.h"
+#include "../geometry/MeshView.h"
+#include "../geometry/GeometryBuffer.h"
+#include "../geometry/MeshletBuilder.h"
+#include "../geometry/VertexQuantizer.h"
+#include "../geometry/IndexPacker.h"
+#include "../../common/Vertex.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Immutable result of loading a model, shared between the loader and the renderer.
+ *
+ * The vertex and index data lives in a shared GeometryBuffer, holding either the
+ * vectors parsed from the source file or the memory-mapped .vmesh cache. Its CPU
+ * copy is released once the renderer has uploaded it; the rest of the record is
+ * small and stays. A LoadedMesh is built once (possibly on a background thread) and
+ * then only read, so it is handed around as std::shared_ptr<const LoadedMesh> and
+ * stays alive for as long as the scene or a pending GPU upload still references it.
+ *
+ * Keywords: Loaded Mesh, Shared Ownership, Background Loading
+ */
+struct LoadedMesh {
+    std::shared_ptr<const GeometryBuffer> geometry; // Vertices, indices and levels of detail
+    glm::vec3 boundingSphereCenter = glm::vec3(0.0f); // Model-space bounding sphere, for LOD selection
+    float boundingSphereRadius = 0.0f;
+    std::vector<Meshlet> meshlets;    // Meshlets of LOD 0, for cluster culling
+    std::vector<MeshletBounds> meshletBounds;
+    VertexFormat vertexFormat = VertexFormat::Full; // Format of the GPU vertex buffer (converted during upload)
+    VertexLayout vertexLayout = VertexLayout::Interleaved; // Stream layout of the GPU vertex buffer (split during upload)
+    VertexQuantizer::Quantization quantization;     // Used when vertexFormat is Quantized
+    IndexPacker::Layout indexLayout;                // GPU index width and draw ranges (converted during upload)
+};
@@ -0,0 +1,253 @@
+#include "MeshCache.h"
+#include "../geometry/Bounds.h"
+#include "../../common/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+namespace {
+
+constexpr char MAGIC[4] = {'V', 'M', 'S', 'H'};
+constexpr uint64_t BLOB_ALIGNMENT = 16;
+// Inputs are hashed in blocks of this size so large files hash on all cores
+constexpr size_t HASH_BLOCK_SIZE = 4 * 1024 * 1024;
+
+constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+
+inline uint64_t rotl(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t hashRound(uint64_t acc, uint64_t input) {
+    acc += input * PRIME2;
+    acc = rotl(acc, 31);
+    return acc * PRIME1;
+}
+
+inline uint64_t finalize(uint64_t h) {
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME1;
+    return h ^ (h >> 32);
+}
+
+// Serial hash of one block: four independent lanes over 32-byte stripes, then the tail
+uint64_t hashBlock(const unsigned char* data, size_t size, uint64_t seed) {
+    uint64_t lanes[4] = {seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1};
+    size_t offset = 0;
+    for (; offset + 32 <= size; offset += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            uint64_t word;
+            std::memcpy(&word, data + offset + lane * 8, 8);
+            lanes[lane] = hashRound(lanes[lane], word);
+        }
+    }
+
+    uint64_t h = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+    h += static_cast<uint64_t>(size);
+    for (; offset < size; ++offset) {
+        h = hashRound(h, data[offset]);
+    }
+    return finalize(h);
+}
+
+inline uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Size and modification time of a file; false if it cannot be queried
+bool statSource(const std::string& sourcePath, uint64_t& size, int64_t& mtime) {
+    std::error_code ec;
+    const auto fileSize = std::filesystem::file_size(sourcePath, ec);
+    if (ec) return false;
+    const auto writeTime = std::filesystem::last_write_time(sourcePath, ec);
+    if (ec) return false;
+    size = static_cast<uint64_t>(fileSize);
+    mtime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+    return true;
+}
+
+bool hashSource(const std::string& sourcePath, uint64_t& hash) {
+    MappedFile source;
+    if (!source.open(sourcePath)) return false;
+    hash = MeshCache::hashBytes(source.data(), source.size());
+    return true;
+}
+
+} // namespace
+
+std::string MeshCache::cachePathFor(const std::string& sourcePath) {
+    return sourcePath + ".vmesh";
+}
+
+uint64_t MeshCache::hashBytes(const void* data, size_t size, uint64_t seed) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    const size_t blockCount = (size + HASH_BLOCK_SIZE - 1) / HASH_BLOCK_SIZE;
+    if (blockCount <= 1) {
+        return hashBlock(bytes, size, seed);
+    }
+
+    // Hash fixed-size blocks in parallel, then hash the block hashes. The result only
+    // depends on the input, not on the number of threads.
+    std::vector<uint64_t> blockHashes(blockCount);
+    Parallel::forEach(blockCount, [&](size_t block) {
+        const size_t offset = block * HASH_BLOCK_SIZE;
+        blockHashes[block] = hashBlock(bytes + offset, std::min(HASH_BLOCK_SIZE, size - offset), seed);
+    });
+    return hashBlock(reinterpret_cast<const unsigned char*>(blockHashes.data()),
+                     blockHashes.size() * sizeof(uint64_t), seed ^ size);
+}
+
+bool MeshCache::open(const std::string& cachePath, const std::string& sourcePath, uint64_t optionsHash) {
+    close();
+
+    MappedFile cache;
+    if (!cache.open(cachePath) || cache.size() < sizeof(Header)) return false;
+
+    Header header;
+    std::memcpy(&header, cache.data(), sizeof(Header));
+
+    // --- Format checks ---
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != VERSION ||
+        header.vertexStride != sizeof(Vertex) ||
+        header.indexSize != sizeof(uint32_t) ||
+        header.vertexOffset % BLOB_ALIGNMENT != 0 ||
+        header.indexOffset % BLOB_ALIGNMENT != 0 ||
+        header.lodOffset % BLOB_ALIGNMENT != 0) {
+        return false;
+    }
+    // Written as count <= space / size so that corrupt offsets and counts cannot overflow
+    auto fits = [&](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset <= cache.size() && count <= (cache.size() - offset) / elementSize;
+    };
+    if (!fits(header.vertexOffset, header.vertexCount, sizeof(Vertex)) ||
+        !fits(header.indexOffset, header.indexCount, sizeof(uint32_t)) ||
+        !fits(header.lodOffset, header.lodCount, sizeof(MeshLod))) {
+        return false; // Truncated file
+    }
+    const auto* lods = reinterpret_cast<const MeshLod*>(cache.data() + header.lodOffset);
+    for (uint64_t i = 0; i < header.lodCount; ++i) {
+        if (static_cast<uint64_t>(lods[i].firstIndex) + lods[i].indexCount > header.indexCount ||
+            lods[i].vertexOffset < 0 || static_cast<uint64_t>(lods[i].vertexOffset) > header.vertexCount) {
+            return false; // LOD outside the mesh data
+        }
+    }
+
+    // --- Staleness checks, cheapest first ---
+    if (header.optionsHash != optionsHash) return false;
+
+    uint64_t sourceSize = 0;
+    int64_t sourceMtime = 0;
+    if (!statSource(sourcePath, sourceSize, sourceMtime) ||
+        header.sourceSize != sourceSize || header.sourceMtime != sourceMtime) {
+        return false;
+    }
+
+    uint64_t sourceHash = 0;
+    if (!hashSource(sourcePath, sourceHash) || header.sourceHash != sourceHash) return false;
+
+    MeshView view(
+        reinterpret_cast<const Vertex*>(cache.data() + header.vertexOffset), static_cast<size_t>(header.vertexCount),
+        reinterpret_cast<const uint32_t*>(cache.data() + header.indexOffset), static_cast<size_t>(header.indexCount));
+    if (header.lodCount > 0) {
+        view.lods = lods;
+        view.lodCount = static_cast<size_t>(header.lodCount);
+    }
+    if (!view.indicesInRange()) return false; // Index past the mesh's (or its LOD's) vertices
+
+    file_ = std::move(cache); // Moving the mapping keeps its address, so the view stays valid
+    view_ = view;
+    boundsMin_ = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    boundsMax_ = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    sphereCenter_ = glm::vec3(header.sphereCenter[0], header.sphereCenter[1], header.sphereCenter[2]);
+    sphereRadius_ = header.sphereRadius;
+    return true;
+}
+
+void MeshCache::close() {
+    file_.close();
+    view_ = MeshView();
+    boundsMin_ = glm::vec3(0.0f);
+    boundsMax_ = glm::vec3(0.0f);
+    sphereCenter_ = glm::vec3(0.0f);
+    sphereRadius_ = 0.0f;
+}
+
+void MeshCache::computeBoundingSphere(const MeshView& mesh, glm::vec3& center, float& radius) {
+    Bounds::computeSphere(mesh.vertices, mesh.vertexCount, center, radius);
+}
+
+bool MeshCache::write(const std::string& cachePath, const std::string& sourcePath,
+                      uint64_t optionsHash, const MeshView& mesh) {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.vertexStride = sizeof(Vertex);
+    header.indexSize = sizeof(uint32_t);
+    header.vertexCount = mesh.vertexCount;
+    header.indexCount = mesh.indexCount;
+    header.vertexOffset = alignUp(sizeof(Header), BLOB_ALIGNMENT);
+    header.indexOffset = alignUp(header.vertexOffset + mesh.vertexCount * sizeof(Vertex), BLOB_ALIGNMENT);
+    header.lodCount = mesh.lodCount;
+    header.lodOffset = alignUp(header.indexOffset + mesh.indexCount * sizeof(uint32_t), BLOB_ALIGNMENT);
+    header.optionsHash = optionsHash;
+
+    if (!statSource(sourcePath, header.sourceSize, header.sourceMtime) ||
+        !hashSource(sourcePath, header.sourceHash)) {
+        return false;
+    }
+
+    // Bounds of the vertex positions
+    glm::vec3 minBounds, maxBounds;
+    Bounds::computeBox(mesh.vertices, mesh.vertexCount, minBounds, maxBounds);
+    for (int i = 0; i < 3; ++i) {
+        header.boundsMin[i] = minBounds[i];
+        header.boundsMax[i] = maxBounds[i];
+    }
+
+    glm::vec3 sphereCenter;
+    computeBoundingSphere(mesh, sphereCenter, header.sphereRadius);
+    for (int i = 0; i < 3; ++i) {
+        header.sphereCenter[i] = sphereCenter[i];
+    }
+
+    // Write to a temporary file, then rename it over the old cache
+    const std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        const char padding[BLOB_ALIGNMENT] = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        out.write(padding, static_cast<std::streamsize>(header.vertexOffset - sizeof(Header)));
+        out.write(reinterpret_cast<const char*>(mesh.vertices), static_cast<std::streamsize>(mesh.vertexCount * sizeof(Vertex)));
+        out.write(padding, static_cast<std::streamsize>(header.indexOffset - (header.vertexOffset + mesh.vertexCount * sizeof(Vertex))));
+        out.write(reinterpret_cast<const char*>(mesh.indices), static_cast<std::streamsize>(mesh.indexCount * sizeof(uint32_t)));
+        out.write(padding, static_cast<std::streamsize>(header.lodOffset - (header.indexOffset + mesh.indexCount * sizeof(uint32_t))));
+        if (mesh.lodCount > 0) {
+            out.write(reinterpret_cast<const char*>(mesh.lods), static_cast<std::streamsize>(mesh.lodCount * sizeof(MeshLod)));
+        }
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
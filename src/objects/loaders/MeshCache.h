@@ -0,0 +1,105 @@
+#pragma once
+
+#include "../geometry/MeshView.h"
+#include "../../common/MappedFile.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Versioned binary cache (.vmesh) of a processed mesh.
+ *
+ * The file holds a fixed header followed by a vertex blob laid out exactly like
+ * Vertex, a uint32 index blob and a MeshLod table (empty for meshes without
+ * levels of detail), all 16-byte aligned. Opening a cache maps the
+ * file and hands out a MeshView straight into the mapping, so the renderer can copy
+ * it into staging memory without any parsing or intermediate vectors.
+ *
+ * A cache is only accepted when it was written from the same source file (size,
+ * modification time and content hash) with the same loader options (an
+ * options hash supplied by the caller), and with the current Vertex layout.
+ *
+ * Keywords: Mesh Cache, Binary Asset Format, Memory Mapped I/O, Cache Invalidation
+ */
+class MeshCache {
+public:
+    static constexpr uint32_t VERSION = 3;
+
+    /**
+     * @brief On-disk header. All offsets are in bytes from the start of the file.
+     */
+    struct Header {
+        char magic[4];          // "VMSH"
+        uint32_t version;       // MeshCache::VERSION
+        uint32_t vertexStride;  // sizeof(Vertex) at write time
+        uint32_t indexSize;     // sizeof(uint32_t)
+        uint64_t vertexCount;
+        uint64_t indexCount;
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        uint64_t lodCount;      // MeshLod entries (0 when the mesh has no levels of detail)
+        uint64_t lodOffset;
+        uint64_t sourceSize;    // Source file size in bytes
+        int64_t sourceMtime;    // Source file last write time (filesystem clock ticks)
+        uint64_t sourceHash;    // hashBytes() of the source file content
+        uint64_t optionsHash;   // Caller-supplied hash of the loader options
+        float boundsMin[3];     // Axis-aligned bounds of the vertex positions
+        float boundsMax[3];
+        float sphereCenter[3];  // Bounding sphere of the vertex positions
+        float sphereRadius;
+    };
+
+    /**
+     * @brief Returns the cache path used for a source file (written next to it).
+     */
+    static std::string cachePathFor(const std::string& sourcePath);
+
+    /**
+     * @brief Maps and validates a cache file against its source.
+     * @param cachePath Path of the .vmesh file.
+     * @param sourcePath Path of the file the cache was built from.
+     * @param optionsHash Hash of the loader options the caller would load with.
+     * @return true if the cache is valid and mapped; false if missing or stale.
+     */
+    bool open(const std::string& cachePath, const std::string& sourcePath, uint64_t optionsHash);
+
+    /**
+     * @brief Unmaps the cache. Views returned by view() become invalid.
+     */
+    void close();
+
+    /**
+     * @brief Writes a cache file for the given mesh.
+     *
+     * The file is written under a temporary name and renamed into place, so a
+     * concurrent or interrupted write never leaves a truncated cache behind.
+     * @return true on success.
+     */
+    static bool write(const std::string& cachePath, const std::string& sourcePath,
+                      uint64_t optionsHash, const MeshView& mesh);
+
+    /**
+     * @brief 64-bit content hash used for cache validation (parallel over large inputs).
+     */
+    static uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+    bool isOpen() const { return file_.isOpen(); }
+    MeshView view() const { return view_; }
+    glm::vec3 getBoundsMin() const { return boundsMin_; }
+    glm::vec3 getBoundsMax() const { return boundsMax_; }
+    glm::vec3 getBoundingSphereCenter() const { return sphereCenter_; }
+    float getBoundingSphereRadius() const { return sphereRadius_; }
+
+    /**
+     * @brief Near-minimal bounding sphere of the vertex positions (see Bounds::SphereFit::Ritter).
+     */
+    static void computeBoundingSphere(const MeshView& mesh, glm::vec3& center, float& radius);
+
+private:
+    MappedFile file_;
+    MeshView view_;
+    glm::vec3 boundsMin_ = glm::vec3(0.0f);
+    glm::vec3 boundsMax_ = glm::vec3(0.0f);
+    glm::vec3 sphereCenter_ = glm::vec3(0.0f);
+    float sphereRadius_ = 0.0f;
+};
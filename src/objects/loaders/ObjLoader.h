@@ -1,17 +1,24 @@
 #pragma once
 
 #include "../../common/Vertex.h"
+#include "../geometry/VertexWelder.h"
+#include "../geometry/MeshOptimizer.h"
+#include "../geometry/NormalGenerator.h"
+#include "ObjParser.h"
+#include "MeshCache.h"
 #include <tiny_obj_loader/tiny_obj_loader.h>
 #include <string>
 #include <vector>
 #include <iostream>
+#include <functional>
 
 /**
  * @brief Utility class for loading OBJ files and converting them to our Mesh format
  * 
- * This class handles loading OBJ files using tiny_obj_loader and converting them
- * to our internal Vertex/Index format. It supports loading both geometry and
- * material properties.
+ * This class handles loading OBJ files and converting them to our internal
+ * Vertex/Index format. Parsing is done by the multithreaded, memory-mapped
+ * ObjParser; the original tiny_obj_loader path is kept behind Options::useTinyObj
+ * as a reference (see tools/ObjLoadBenchmark.cpp).
  */
 class ObjLoader {
 private:
@@ -20,7 +27,7 @@ private:
      * @param v0 First vertex position
      * @param v1 Second vertex position
      * @param v2 Third vertex position
-     * @return Normalized normal vector
+     * @return Normalized normal vector (zero for a degenerate triangle)
      */
     static glm::vec3 calculateTriangleNormal(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) {
         // Create two vectors from the triangle's edges
@@ -30,22 +37,23 @@ private:
         // Calculate cross product to get normal
         glm::vec3 normal = glm::cross(edge1, edge2);
         
-        // Normalize the result
-        return glm::normalize(normal);
+        // Normalize the result (a zero-area triangle has no direction to normalize)
+        const float length = glm::length(normal);
+        return length > 0.0f ? normal / length : glm::vec3(0.0f);
     }
 
-public:
     /**
-     * @brief Loads an OBJ file and converts it to our Mesh format
+     * @brief Parses an OBJ file with tiny_obj_loader into flat position/color/corner arrays
      * @param filename Path to the OBJ file
-     * @param vertices Output vector for vertices
-     * @param indices Output vector for indices
+     * @param positions Output xyz per vertex
+     * @param colors Output rgb per vertex (empty if the file has no vertex colors)
+     * @param cornerIndices Output position index of every triangle corner, across all shapes
      * @return true if loading was successful, false otherwise
      */
-    static bool loadObj(const std::string& filename, 
-                       const float scale,
-                       std::vector<Vertex>& vertices, 
-                       std::vector<uint32_t>& indices) {
+    static bool parseWithTinyObj(const std::string& filename,
+                                 std::vector<float>& positions,
+                                 std::vector<float>& colors,
+                                 std::vector<uint32_t>& cornerIndices) {
         tinyobj::attrib_t attrib;
         std::vector<tinyobj::shape_t> shapes;
         std::vector<tinyobj::material_t> materials;
@@ -59,75 +67,257 @@ public:
             return false;
         }
 
+        size_t cornerCount = 0;
+        for (const auto& shape : shapes) cornerCount += shape.mesh.indices.size();
+        cornerIndices.clear();
+        cornerIndices.reserve(cornerCount);
+        for (const auto& shape : shapes) {
+            for (const auto& idx : shape.mesh.indices) {
+                cornerIndices.push_back(static_cast<uint32_t>(idx.vertex_index));
+            }
+        }
+
+        positions.swap(attrib.vertices);
+        colors.swap(attrib.colors);
+        return true;
+    }
+
+public:
+    /**
+     * @brief Options controlling how OBJ data is converted to our Mesh format
+     */
+    struct Options {
+        bool weldVertices = true;  // Share identical (position, normal, color) corners through the index buffer
+        float weldEpsilon = 0.0f;  // > 0 also merges corners whose positions lie within this distance
+        bool useTinyObj = false;   // Parse with tinyobj::LoadObj instead of the multithreaded ObjParser
+        bool optimizeVertexOrder = true; // Reorder triangles/vertices for the GPU vertex cache and fetch (MeshOptimizer)
+        float overdrawThreshold = 0.0f;  // > 0 also sorts triangle clusters to reduce overdraw (e.g. 1.05, needs optimizeVertexOrder)
+        bool smoothNormals = true;       // Smooth normals with hard edges past normalOptions.creaseAngle (needs weldVertices); false keeps flat face normals
+        NormalGenerator::Options normalOptions;
+        std::function<void(float)> progress; // Optional, receives 0..1 while loading (may be called from worker threads)
+    };
+
+    /**
+     * @brief Hash of everything that affects loadObj's output, used to key mesh caches
+     * @param scale Uniform scale applied to positions
+     * @param options Conversion options
+     * @return 64-bit hash; bump CONVERSION_VERSION whenever the conversion itself changes
+     */
+    static uint64_t cacheKey(const float scale, const Options& options) {
+        static constexpr uint32_t CONVERSION_VERSION = 3;
+        const bool smooth = options.smoothNormals && options.weldVertices;
+        struct {
+            uint32_t version;
+            float scale;
+            uint32_t weldVertices;
+            float weldEpsilon;
+            uint32_t optimizeVertexOrder;
+            float overdrawThreshold;
+            uint32_t smoothNormals;
+            uint32_t normalWeighting;
+            float creaseAngle;
+        } key{CONVERSION_VERSION, scale, options.weldVertices ? 1u : 0u, options.weldEpsilon,
+              options.optimizeVertexOrder ? 1u : 0u, options.optimizeVertexOrder ? options.overdrawThreshold : 0.0f,
+              smooth ? 1u : 0u, smooth ? static_cast<uint32_t>(options.normalOptions.weighting) : 0u,
+              smooth ? options.normalOptions.creaseAngle : 0.0f};
+        return MeshCache::hashBytes(&key, sizeof(key));
+    }
+
+    /**
+     * @brief Loads an OBJ file and converts it to our Mesh format
+     * @param filename Path to the OBJ file
+     * @param vertices Output vector for vertices
+     * @param indices Output vector for indices
+     * @return true if loading was successful, false otherwise
+     */
+    static bool loadObj(const std::string& filename, 
+                       const float scale,
+                       std::vector<Vertex>& vertices, 
+                       std::vector<uint32_t>& indices) {
+        return loadObj(filename, scale, vertices, indices, Options{});
+    }
+
+    /**
+     * @brief Loads an OBJ file and converts it to our Mesh format
+     * @param filename Path to the OBJ file
+     * @param scale Uniform scale applied to positions
+     * @param vertices Output vector for vertices
+     * @param indices Output vector for indices
+     * @param options Conversion options (vertex welding, parser selection)
+     * @return true if loading was successful, false otherwise
+     */
+    static bool loadObj(const std::string& filename,
+                       const float scale,
+                       std::vector<Vertex>& vertices,
+                       std::vector<uint32_t>& indices,
+                       const Options& options) {
+        return loadObj(filename, nullptr, 0, scale, vertices, indices, options);
+    }
+
+    /**
+     * @brief Converts OBJ text already in memory (e.g. read by AsyncFileReader) to our Mesh format
+     * @param name Name of the file the text came from, for messages
+     * @param data Start of the OBJ text (does not need to be null-terminated; may be null only when size is 0)
+     * @param size Size of the text in bytes
+     * @param scale Uniform scale applied to positions
+     * @param vertices Output vector for vertices
+     * @param indices Output vector for indices
+     * @param options Conversion options (always parsed by ObjParser; useTinyObj is ignored)
+     * @return true if loading was successful, false otherwise
+     */
+    static bool loadObjFromMemory(const std::string& name,
+                                  const char* data,
+                                  size_t size,
+                                  const float scale,
+                                  std::vector<Vertex>& vertices,
+                                  std::vector<uint32_t>& indices,
+                                  const Options& options) {
+        if (data == nullptr && size != 0) {
+            std::cerr << "Failed to load OBJ file: " << name << std::endl;
+            std::cerr << "ERR: no text for " << size << " bytes" << std::endl;
+            return false;
+        }
+        return loadObj(name, data != nullptr ? data : "", size, scale, vertices, indices, options);
+    }
+
+private:
+    // Parses the file, or the text at data when it is not null, then converts it
+    static bool loadObj(const std::string& filename,
+                        const char* text,
+                        size_t textSize,
+                        const float scale,
+                        std::vector<Vertex>& vertices,
+                        std::vector<uint32_t>& indices,
+                        const Options& options) {
+        std::vector<float> positions;
+        std::vector<float> colors;
+        std::vector<uint32_t> cornerIndices; // Position index of each triangle corner
+
+        // Parsing is reported as the first 70% of the load, conversion as the rest
+        constexpr float PARSE_SHARE = 0.7f;
+        auto report = [&](float fraction) {
+            if (options.progress) options.progress(fraction);
+        };
+
+        if (options.useTinyObj && !text) {
+            if (!parseWithTinyObj(filename, positions, colors, cornerIndices)) return false;
+        } else {
+            ObjData data;
+            std::string error;
+            ObjParser::ProgressCallback parseProgress;
+            if (options.progress) {
+                parseProgress = [&](float fraction) { report(fraction * PARSE_SHARE); };
+            }
+            const bool parsed = text ? ObjParser::parse(text, textSize, data, error, parseProgress)
+                                     : ObjParser::parseFile(filename, data, error, parseProgress);
+            if (!parsed) {
+                std::cerr << "Failed to load OBJ file: " << filename << std::endl;
+                std::cerr << "ERR: " << error << std::endl;
+                return false;
+            }
+            positions.swap(data.positions);
+            colors.swap(data.colors);
+            cornerIndices.swap(data.positionIndices);
+        }
+
         // Clear output vectors
         vertices.clear();
         indices.clear();
 
-        // For each shape in the OBJ file
-        for (const auto& shape : shapes) {
-            // For each face in the shape
-            for (size_t f = 0; f < shape.mesh.indices.size(); f += 3) {
-                // Get the three vertices of the triangle
-                tinyobj::index_t idx0 = shape.mesh.indices[f + 0];
-                tinyobj::index_t idx1 = shape.mesh.indices[f + 1];
-                tinyobj::index_t idx2 = shape.mesh.indices[f + 2];
-
-                // Get vertex positions
-                glm::vec3 v0 = {
-                    attrib.vertices[3 * idx0.vertex_index + 0] * scale,
-                    attrib.vertices[3 * idx0.vertex_index + 1] * scale,
-                    attrib.vertices[3 * idx0.vertex_index + 2] * scale
-                };
-                glm::vec3 v1 = {
-                    attrib.vertices[3 * idx1.vertex_index + 0] * scale,
-                    attrib.vertices[3 * idx1.vertex_index + 1] * scale,
-                    attrib.vertices[3 * idx1.vertex_index + 2] * scale
-                };
-                glm::vec3 v2 = {
-                    attrib.vertices[3 * idx2.vertex_index + 0] * scale,
-                    attrib.vertices[3 * idx2.vertex_index + 1] * scale,
-                    attrib.vertices[3 * idx2.vertex_index + 2] * scale
+        const size_t cornerCount = cornerIndices.size();
+        indices.reserve(cornerCount);
+
+        // The welder hands back the index of an existing identical vertex, so shared
+        // corners are stored once. Without welding every corner gets its own vertex.
+        // Smooth normals are generated afterwards, so corners are then welded on
+        // position and color alone (their normal is left zero until then).
+        const bool smoothNormals = options.smoothNormals && options.weldVertices;
+        VertexWelder welder(vertices, options.weldEpsilon, options.weldVertices ? positions.size() / 3 : 0);
+        if (!options.weldVertices) vertices.reserve(cornerCount);
+
+        report(PARSE_SHARE);
+
+        // For each triangle
+        constexpr size_t PROGRESS_INTERVAL = 3 * 65536; // Corners between progress reports
+        for (size_t f = 0; f + 2 < cornerCount; f += 3) {
+            if (f % PROGRESS_INTERVAL == 0 && f > 0) {
+                report(PARSE_SHARE + (1.0f - PARSE_SHARE) * static_cast<float>(f) / static_cast<float>(cornerCount));
+            }
+
+            // Get vertex positions
+            glm::vec3 corners[3];
+            for (size_t i = 0; i < 3; i++) {
+                const size_t base = 3 * static_cast<size_t>(cornerIndices[f + i]);
+                corners[i] = {
+                    positions[base + 0] * scale,
+                    positions[base + 1] * scale,
+                    positions[base + 2] * scale
                 };
+            }
 
-                // Calculate normal for this triangle
-                glm::vec3 normal = calculateTriangleNormal(v0, v1, v2);
+            // Calculate normal for this triangle
+            glm::vec3 normal = smoothNormals ? glm::vec3(0.0f) : calculateTriangleNormal(corners[0], corners[1], corners[2]);
 
-                // Add vertices with the calculated normal
-                for (size_t i = 0; i < 3; i++) {
-                    tinyobj::index_t idx = shape.mesh.indices[f + i];
-                    Vertex vertex{};
+            // Add vertices with the calculated normal
+            for (size_t i = 0; i < 3; i++) {
+                const size_t base = 3 * static_cast<size_t>(cornerIndices[f + i]);
+                Vertex vertex{};
 
-                    // Position
-                    vertex.pos = {
-                        attrib.vertices[3 * idx.vertex_index + 0] * scale,
-                        attrib.vertices[3 * idx.vertex_index + 1] * scale,
-                        attrib.vertices[3 * idx.vertex_index + 2] * scale
-                    };
+                // Position
+                vertex.pos = corners[i];
 
-                    // Use calculated normal
-                    vertex.normal = normal;
-
-                    // Color (if available)
-                    if (attrib.colors.size() > 0) {
-                        vertex.color = {
-                            attrib.colors[3 * idx.vertex_index + 0],
-                            attrib.colors[3 * idx.vertex_index + 1],
-                            attrib.colors[3 * idx.vertex_index + 2]
-                        };
-                    } else {
-                        // If no color, use white
-                        vertex.color = {1.0f, 1.0f, 1.0f};
-                    }
+                // Use calculated normal
+                vertex.normal = normal;
 
+                // Color (if available)
+                if (colors.size() > 0) {
+                    vertex.color = {
+                        colors[base + 0],
+                        colors[base + 1],
+                        colors[base + 2]
+                    };
+                } else {
+                    // If no color, use white
+                    vertex.color = {1.0f, 1.0f, 1.0f};
+                }
+
+                if (options.weldVertices) {
+                    indices.push_back(welder.insert(vertex));
+                } else {
+                    indices.push_back(static_cast<uint32_t>(vertices.size()));
                     vertices.push_back(vertex);
-                    indices.push_back(static_cast<uint32_t>(indices.size()));
                 }
             }
         }
 
+        // Smooth normals over the welded vertices, splitting them again at creases
+        size_t creaseVertices = 0;
+        if (smoothNormals) {
+            creaseVertices = NormalGenerator::generate(vertices, indices, options.normalOptions);
+        }
+
+        MeshOptimizer::Report cacheReport;
+        if (options.optimizeVertexOrder) {
+            cacheReport = MeshOptimizer::optimize(vertices, indices, MeshOptimizer::DEFAULT_CACHE_SIZE,
+                                                  options.overdrawThreshold);
+        }
+
+        report(1.0f);
+
         std::cout << "Loaded OBJ file: " << filename << std::endl;
-        std::cout << "Vertices: " << vertices.size() << std::endl;
+        std::cout << "Vertices: " << vertices.size();
+        if (options.weldVertices) std::cout << " (welded from " << cornerCount << " corners)";
+        if (smoothNormals) std::cout << ", " << creaseVertices << " split at creases";
+        std::cout << std::endl;
         std::cout << "Indices: " << indices.size() << std::endl;
+        if (options.optimizeVertexOrder) {
+            std::cout << "Vertex cache: ACMR " << cacheReport.before.acmr << " -> " << cacheReport.after.acmr
+                      << ", ATVR " << cacheReport.before.atvr << " -> " << cacheReport.after.atvr << std::endl;
+            if (options.overdrawThreshold > 0.0f) {
+                std::cout << "Overdraw (CPU estimate): " << cacheReport.overdrawBefore.overdraw << " -> "
+                          << cacheReport.overdrawAfter.overdraw << std::endl;
+            }
+        }
 
         return true;
     }
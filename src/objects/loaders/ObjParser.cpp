@@ -0,0 +1,288 @@
+#include "ObjParser.h"
+#include "../../common/MappedFile.h"
+#include "../../common/Parallel.h"
+#include "ObjTokenizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+using namespace ObjTokenizer;
+
+// Chunks smaller than this are not worth a task of their own
+constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+// Extra chunks per worker so uneven chunks still balance across threads
+constexpr size_t CHUNKS_PER_WORKER = 4;
+
+// A relative (negative) OBJ index, stored chunk-local until the chunk's base is known
+struct Fixup {
+    size_t corner;     // Slot in the chunk's index array
+    int64_t relative;  // Zero-based index relative to the chunk's first element (may be negative)
+    bool isNormal;
+};
+
+struct Chunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+
+    std::vector<float> positions;
+    std::vector<float> colors;
+    std::vector<float> normals;
+    std::vector<uint32_t> positionIndices;
+    std::vector<uint32_t> normalIndices;
+    std::vector<Fixup> fixups;
+    bool hasColors = false;
+    bool hasNormalRefs = false;
+
+    std::vector<CornerRef> polygon; // Scratch for the face being parsed
+    std::string error;
+    size_t errorOffset = 0;         // Byte offset into the chunk of the failing line
+};
+
+void emitCorner(Chunk& chunk, const CornerRef& ref) {
+    const size_t corner = chunk.positionIndices.size();
+
+    if (ref.position > 0) {
+        chunk.positionIndices.push_back(static_cast<uint32_t>(ref.position - 1));
+    } else {
+        chunk.positionIndices.push_back(0);
+        chunk.fixups.push_back({corner, static_cast<int64_t>(chunk.positions.size() / 3) + ref.position, false});
+    }
+
+    if (ref.normal > 0) {
+        chunk.normalIndices.push_back(static_cast<uint32_t>(ref.normal - 1));
+    } else if (ref.normal < 0) {
+        chunk.normalIndices.push_back(0);
+        chunk.fixups.push_back({corner, static_cast<int64_t>(chunk.normals.size() / 3) + ref.normal, true});
+    } else {
+        chunk.normalIndices.push_back(ObjData::NO_INDEX);
+    }
+}
+
+// Parses `v x y z [r g b]`. p points just past the keyword.
+bool parseVertex(Chunk& chunk, const char* p, const char* end) {
+    float values[6];
+    const int count = parseFloats(p, end, values, 6);
+    if (count < 3) {
+        chunk.error = "vertex with fewer than 3 coordinates";
+        return false;
+    }
+
+    chunk.positions.insert(chunk.positions.end(), values, values + 3);
+
+    if (count == 6) {
+        if (!chunk.hasColors) {
+            // First colored vertex in this chunk: earlier vertices default to white
+            chunk.hasColors = true;
+            chunk.colors.assign(chunk.positions.size() - 3, 1.0f);
+        }
+        chunk.colors.insert(chunk.colors.end(), values + 3, values + 6);
+    } else if (chunk.hasColors) {
+        chunk.colors.insert(chunk.colors.end(), {1.0f, 1.0f, 1.0f});
+    }
+    return true;
+}
+
+// Parses `vn x y z`. p points just past the keyword.
+bool parseNormal(Chunk& chunk, const char* p, const char* end) {
+    float values[3];
+    if (parseFloats(p, end, values, 3) < 3) {
+        chunk.error = "normal with fewer than 3 coordinates";
+        return false;
+    }
+    chunk.normals.insert(chunk.normals.end(), values, values + 3);
+    return true;
+}
+
+// Parses `f v[/vt][/vn] ...` and fan-triangulates it. p points just past the keyword.
+bool parseFace(Chunk& chunk, const char* p, const char* end) {
+    const char* error = nullptr;
+    if (!parseFaceCorners(p, end, chunk.polygon, chunk.hasNormalRefs, error)) {
+        chunk.error = error;
+        return false;
+    }
+
+    // Points and lines written as faces carry no area; skip them like tinyobj does
+    if (chunk.polygon.size() < 3) return true;
+
+    for (size_t i = 2; i < chunk.polygon.size(); ++i) {
+        emitCorner(chunk, chunk.polygon[0]);
+        emitCorner(chunk, chunk.polygon[i - 1]);
+        emitCorner(chunk, chunk.polygon[i]);
+    }
+    return true;
+}
+
+void parseChunk(Chunk& chunk) {
+    const char* line = chunk.begin;
+    while (line < chunk.end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', chunk.end - line));
+        if (!lineEnd) lineEnd = chunk.end;
+
+        const char* rest = nullptr;
+        bool ok = true;
+        switch (classifyLine(line, lineEnd, rest)) {
+            case LineType::Vertex: ok = parseVertex(chunk, rest, lineEnd); break;
+            case LineType::Normal: ok = parseNormal(chunk, rest, lineEnd); break;
+            case LineType::Face:   ok = parseFace(chunk, rest, lineEnd); break;
+            case LineType::Other:  break;
+        }
+
+        if (!ok) {
+            chunk.errorOffset = static_cast<size_t>(line - chunk.begin);
+            return;
+        }
+        line = lineEnd + 1;
+    }
+}
+
+// Resolves a chunk's relative indices and checks every index against the file totals
+bool resolveIndices(Chunk& chunk, size_t positionBase, size_t normalBase,
+                    size_t positionCount, size_t normalCount) {
+    for (const Fixup& fixup : chunk.fixups) {
+        const int64_t base = static_cast<int64_t>(fixup.isNormal ? normalBase : positionBase);
+        const int64_t resolved = base + fixup.relative;
+        if (resolved < 0) {
+            chunk.error = "relative face index points before the start of the file";
+            return false;
+        }
+        auto& target = fixup.isNormal ? chunk.normalIndices : chunk.positionIndices;
+        target[fixup.corner] = static_cast<uint32_t>(resolved);
+    }
+
+    for (uint32_t index : chunk.positionIndices) {
+        if (index >= positionCount) {
+            chunk.error = "face vertex index out of range";
+            return false;
+        }
+    }
+    if (chunk.hasNormalRefs) {
+        for (uint32_t index : chunk.normalIndices) {
+            if (index != ObjData::NO_INDEX && index >= normalCount) {
+                chunk.error = "face normal index out of range";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool ObjParser::parseFile(const std::string& filename, ObjData& out, std::string& error,
+                          const ProgressCallback& progress) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        error = "cannot open file " + filename;
+        return false;
+    }
+    return parse(file.data(), file.size(), out, error, progress);
+}
+
+bool ObjParser::parse(const char* data, size_t size, ObjData& out, std::string& error,
+                      const ProgressCallback& progress) {
+    out = ObjData{};
+
+    // --- Split into line-aligned chunks ---
+    const size_t workers = Parallel::workerCount();
+    size_t chunkCount = std::max<size_t>(1, std::min(workers * CHUNKS_PER_WORKER, size / MIN_CHUNK_SIZE));
+
+    std::vector<Chunk> chunks(chunkCount);
+    const char* fileEnd = data + size;
+    const char* chunkBegin = data;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const char* chunkEnd = fileEnd;
+        if (i + 1 < chunkCount) {
+            // Move the split point forward to just after the next newline
+            const char* target = std::max(chunkBegin, data + (size / chunkCount) * (i + 1));
+            const char* newline = static_cast<const char*>(std::memchr(target, '\n', fileEnd - target));
+            chunkEnd = newline ? newline + 1 : fileEnd;
+        }
+        chunks[i].begin = chunkBegin;
+        chunks[i].end = chunkEnd;
+        chunkBegin = chunkEnd;
+    }
+
+    // --- Parse chunks in parallel ---
+    std::atomic<size_t> bytesParsed{0};
+    Parallel::forEach(chunkCount, [&](size_t i) {
+        parseChunk(chunks[i]);
+        const size_t chunkBytes = static_cast<size_t>(chunks[i].end - chunks[i].begin);
+        const size_t done = bytesParsed.fetch_add(chunkBytes) + chunkBytes;
+        if (progress && size > 0) progress(static_cast<float>(done) / static_cast<float>(size));
+    });
+
+    for (const Chunk& chunk : chunks) {
+        if (!chunk.error.empty()) {
+            error = chunk.error + " at byte " + std::to_string((chunk.begin - data) + chunk.errorOffset);
+            return false;
+        }
+    }
+
+    // --- Prefix sums give each chunk its output offsets ---
+    std::vector<size_t> positionBase(chunkCount + 1, 0);
+    std::vector<size_t> normalBase(chunkCount + 1, 0);
+    std::vector<size_t> cornerBase(chunkCount + 1, 0);
+    bool hasColors = false;
+    bool hasNormalRefs = false;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        positionBase[i + 1] = positionBase[i] + chunks[i].positions.size() / 3;
+        normalBase[i + 1] = normalBase[i] + chunks[i].normals.size() / 3;
+        cornerBase[i + 1] = cornerBase[i] + chunks[i].positionIndices.size();
+        hasColors |= chunks[i].hasColors;
+        hasNormalRefs |= chunks[i].hasNormalRefs;
+    }
+
+    const size_t positionCount = positionBase[chunkCount];
+    const size_t normalCount = normalBase[chunkCount];
+    const size_t cornerCount = cornerBase[chunkCount];
+    if (positionCount >= ObjData::NO_INDEX || normalCount >= ObjData::NO_INDEX) {
+        error = "too many vertices for 32-bit indices";
+        return false;
+    }
+
+    out.positions.resize(positionCount * 3);
+    out.normals.resize(normalCount * 3);
+    out.positionIndices.resize(cornerCount);
+    if (hasColors) out.colors.resize(positionCount * 3);
+    if (hasNormalRefs) out.normalIndices.resize(cornerCount);
+
+    // --- Merge chunks in parallel ---
+    Parallel::forEach(chunkCount, [&](size_t i) {
+        Chunk& chunk = chunks[i];
+        if (!resolveIndices(chunk, positionBase[i], normalBase[i], positionCount, normalCount)) return;
+
+        std::copy(chunk.positions.begin(), chunk.positions.end(), out.positions.begin() + positionBase[i] * 3);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), out.normals.begin() + normalBase[i] * 3);
+        std::copy(chunk.positionIndices.begin(), chunk.positionIndices.end(), out.positionIndices.begin() + cornerBase[i]);
+
+        if (hasColors) {
+            auto colorOut = out.colors.begin() + positionBase[i] * 3;
+            if (chunk.hasColors) {
+                std::copy(chunk.colors.begin(), chunk.colors.end(), colorOut);
+            } else {
+                std::fill(colorOut, colorOut + chunk.positions.size(), 1.0f);
+            }
+        }
+        if (hasNormalRefs) {
+            std::copy(chunk.normalIndices.begin(), chunk.normalIndices.end(), out.normalIndices.begin() + cornerBase[i]);
+        }
+
+        // Release the chunk's memory as soon as it has been merged
+        chunk = Chunk{};
+    });
+
+    // Merge errors are recorded on the (otherwise cleared) chunk that failed
+    for (const Chunk& chunk : chunks) {
+        if (!chunk.error.empty()) {
+            error = chunk.error;
+            out = ObjData{};
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Raw geometry read from an OBJ file, before conversion to our Vertex format.
+ *
+ * Faces are triangulated (fan) and their indices are zero-based and already
+ * resolved against the whole file, so they can be used directly.
+ */
+struct ObjData {
+    static constexpr uint32_t NO_INDEX = 0xFFFFFFFFu;
+
+    std::vector<float> positions;          // xyz per `v` line
+    std::vector<float> colors;             // rgb per `v` line, empty when the file has no vertex colors
+    std::vector<float> normals;            // xyz per `vn` line
+    std::vector<uint32_t> positionIndices; // 3 per triangle
+    std::vector<uint32_t> normalIndices;   // Parallel to positionIndices (NO_INDEX where a corner has none), empty when no face references a normal
+
+    size_t vertexCount() const { return positions.size() / 3; }
+    size_t triangleCount() const { return positionIndices.size() / 3; }
+};
+
+/**
+ * @brief Multithreaded OBJ parser working directly on a memory-mapped file.
+ *
+ * The file is split into line-aligned chunks which are tokenized in parallel, each
+ * chunk producing its own position/color/normal/face arrays. A prefix sum over the
+ * per-chunk counts then gives every chunk its output offsets, and the chunks are
+ * copied into the final arrays in parallel. Negative (relative) face indices are
+ * recorded as fix-ups during parsing and resolved once the chunk's base vertex is
+ * known.
+ *
+ * Only the data our Vertex format uses is kept: `v` (with optional vertex color),
+ * `vn` and `f`. Texture coordinates, groups, materials and smoothing groups are
+ * skipped.
+ *
+ * Keywords: OBJ Parsing, Memory Mapped I/O, Parallel Tokenization, Prefix Sum
+ */
+class ObjParser {
+public:
+    /**
+     * @brief Receives the fraction of the input parsed so far (0..1).
+     *
+     * Called from the parser's worker threads, possibly concurrently.
+     */
+    using ProgressCallback = std::function<void(float)>;
+
+    /**
+     * @brief Memory-maps and parses an OBJ file.
+     * @param filename Path to the OBJ file.
+     * @param out Receives the parsed geometry (previous content is replaced).
+     * @param error Receives a description of the problem on failure.
+     * @param progress Optional progress callback.
+     * @return true if parsing was successful, false otherwise.
+     */
+    static bool parseFile(const std::string& filename, ObjData& out, std::string& error,
+                          const ProgressCallback& progress = nullptr);
+
+    /**
+     * @brief Parses OBJ text already in memory.
+     * @param data Start of the OBJ text (does not need to be null-terminated).
+     * @param size Size of the text in bytes.
+     * @param out Receives the parsed geometry (previous content is replaced).
+     * @param error Receives a description of the problem on failure.
+     * @param progress Optional progress callback.
+     * @return true if parsing was successful, false otherwise.
+     */
+    static bool parse(const char* data, size_t size, ObjData& out, std::string& error,
+                      const ProgressCallback& progress = nullptr);
+};
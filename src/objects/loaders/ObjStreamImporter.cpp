@@ -0,0 +1,285 @@
+#include "ObjStreamImporter.h"
+#include "ObjTokenizer.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+using namespace ObjTokenizer;
+
+constexpr size_t MIN_WINDOW_BYTES = 4096;
+constexpr size_t MIN_STAGING_BYTES = 256 * 1024;
+
+/**
+ * @brief Reads a file line by line through a fixed-size window.
+ *
+ * The window only grows if a single line is longer than the whole window.
+ */
+class LineReader {
+public:
+    explicit LineReader(size_t windowBytes) : buffer_(windowBytes) {}
+
+    bool open(const std::string& filename) {
+        file_.open(filename, std::ios::binary);
+        rewind();
+        return file_.is_open();
+    }
+
+    void rewind() {
+        file_.clear();
+        file_.seekg(0);
+        begin_ = end_ = 0;
+        eof_ = false;
+        lineNumber_ = 0;
+    }
+
+    // Returns the next line without its '\n'. Valid until the next call.
+    bool nextLine(const char*& line, const char*& lineEnd) {
+        while (true) {
+            const char* start = buffer_.data() + begin_;
+            const char* stop = buffer_.data() + end_;
+            const char* newline = static_cast<const char*>(std::memchr(start, '\n', stop - start));
+            if (newline) {
+                line = start;
+                lineEnd = newline;
+                begin_ = static_cast<size_t>(newline + 1 - buffer_.data());
+                ++lineNumber_;
+                return true;
+            }
+            if (eof_) {
+                if (start == stop) return false;
+                line = start; // Last line without a trailing newline
+                lineEnd = stop;
+                begin_ = end_;
+                ++lineNumber_;
+                return true;
+            }
+            refill();
+        }
+    }
+
+    size_t windowBytes() const { return buffer_.size(); }
+    size_t lineNumber() const { return lineNumber_; }
+
+private:
+    void refill() {
+        // Move the partial line to the front of the window and read behind it
+        const size_t remaining = end_ - begin_;
+        std::memmove(buffer_.data(), buffer_.data() + begin_, remaining);
+        begin_ = 0;
+        end_ = remaining;
+        if (end_ == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2); // A single line fills the window
+        }
+
+        file_.read(buffer_.data() + end_, static_cast<std::streamsize>(buffer_.size() - end_));
+        const size_t bytesRead = static_cast<size_t>(file_.gcount());
+        end_ += bytesRead;
+        if (bytesRead == 0) eof_ = true;
+    }
+
+    std::ifstream file_;
+    std::vector<char> buffer_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    bool eof_ = false;
+    size_t lineNumber_ = 0;
+};
+
+/**
+ * @brief Hands out vertex/index slots from the sink one at a time, acquiring a new
+ * span whenever the current one is full.
+ */
+template <typename T>
+class SpanWriter {
+public:
+    using AcquireFn = T* (MeshStreamSink::*)(size_t, size_t&);
+    using CommitFn = void (MeshStreamSink::*)(size_t);
+
+    SpanWriter(MeshStreamSink& sink, AcquireFn acquire, CommitFn commit, size_t total)
+        : sink_(sink), acquire_(acquire), commit_(commit), remaining_(total) {}
+
+    T& next() {
+        if (used_ == capacity_) {
+            flush();
+            span_ = (sink_.*acquire_)(remaining_, capacity_);
+        }
+        --remaining_;
+        return span_[used_++];
+    }
+
+    void flush() {
+        if (used_ > 0) (sink_.*commit_)(used_);
+        used_ = 0;
+        capacity_ = 0;
+    }
+
+private:
+    MeshStreamSink& sink_;
+    AcquireFn acquire_;
+    CommitFn commit_;
+    T* span_ = nullptr;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+    size_t remaining_;
+};
+
+} // namespace
+
+bool ObjStreamImporter::import(const std::string& filename, const Options& options, MeshStreamSink& sink, Stats& stats) {
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    stats = Stats{};
+
+    LineReader reader(std::max(options.windowBytes, MIN_WINDOW_BYTES));
+    if (!reader.open(filename)) {
+        std::cerr << "Failed to open OBJ file: " << filename << std::endl;
+        return false;
+    }
+
+    auto fail = [&](const char* message) {
+        std::cerr << "Failed to stream OBJ file: " << filename << std::endl;
+        std::cerr << "ERR: line " << reader.lineNumber() << ": " << message << std::endl;
+        return false;
+    };
+
+    const char* line = nullptr;
+    const char* lineEnd = nullptr;
+    const char* rest = nullptr;
+    const char* error = nullptr;
+    bool hasNormal = false;
+    std::vector<CornerRef> polygon;
+
+    // --- Pass 1: count vertices and triangles so every table can be sized exactly ---
+    size_t vertexCount = 0;
+    size_t triangleCount = 0;
+    bool hasColors = false;
+    while (reader.nextLine(line, lineEnd)) {
+        switch (classifyLine(line, lineEnd, rest)) {
+            case LineType::Vertex: {
+                float values[6];
+                const int count = parseFloats(rest, lineEnd, values, 6);
+                if (count < 3) return fail("vertex with fewer than 3 coordinates");
+                hasColors |= (count == 6);
+                ++vertexCount;
+                break;
+            }
+            case LineType::Face:
+                if (!parseFaceCorners(rest, lineEnd, polygon, hasNormal, error)) return fail(error);
+                if (polygon.size() >= 3) triangleCount += polygon.size() - 2;
+                break;
+            default:
+                break;
+        }
+    }
+
+    const size_t outputCount = triangleCount * 3;
+    if (outputCount == 0) return fail("no faces");
+    if (outputCount > 0xFFFFFFFFull) return fail("too many vertices for 32-bit indices");
+
+    // --- Memory plan: whatever the window and position table leave is staging ---
+    stats.positionTableBytes = vertexCount * 3 * sizeof(float) * (hasColors ? 2 : 1);
+    size_t fixedBytes = reader.windowBytes() + stats.positionTableBytes;
+    size_t stagingBudget = options.memoryBudget > fixedBytes ? options.memoryBudget - fixedBytes : 0;
+    if (stagingBudget < MIN_STAGING_BYTES) {
+        std::cerr << "Warning: memory budget of " << options.memoryBudget
+                  << " bytes is too small for the position table of " << filename
+                  << "; using the minimum staging size" << std::endl;
+        stagingBudget = MIN_STAGING_BYTES;
+    }
+
+    std::vector<float> positions;
+    std::vector<float> colors;
+    positions.reserve(vertexCount * 3);
+    if (hasColors) colors.reserve(vertexCount * 3);
+
+    sink.begin(outputCount, outputCount, stagingBudget);
+    SpanWriter<Vertex> vertexWriter(sink, &MeshStreamSink::acquireVertices, &MeshStreamSink::commitVertices, outputCount);
+    SpanWriter<uint32_t> indexWriter(sink, &MeshStreamSink::acquireIndices, &MeshStreamSink::commitIndices, outputCount);
+
+    // --- Pass 2: fill the position table and convert faces into the sink ---
+    reader.rewind();
+    uint32_t nextIndex = 0;
+    while (reader.nextLine(line, lineEnd)) {
+        const LineType type = classifyLine(line, lineEnd, rest);
+        if (type == LineType::Vertex) {
+            float values[6];
+            const int count = parseFloats(rest, lineEnd, values, 6);
+            positions.insert(positions.end(), {values[0] * options.scale, values[1] * options.scale, values[2] * options.scale});
+            if (hasColors) {
+                if (count == 6) colors.insert(colors.end(), values + 3, values + 6);
+                else colors.insert(colors.end(), {1.0f, 1.0f, 1.0f});
+            }
+            continue;
+        }
+        if (type != LineType::Face) continue;
+
+        parseFaceCorners(rest, lineEnd, polygon, hasNormal, error);
+        if (polygon.size() < 3) continue;
+
+        // Resolve to zero-based positions. Only already-read vertices can be used in a
+        // single streaming pass, which is what the OBJ spec and every exporter produce.
+        const int64_t knownVertices = static_cast<int64_t>(positions.size() / 3);
+        uint32_t resolved[3];
+        for (size_t corner = 0; corner < polygon.size(); ++corner) {
+            int64_t& position = polygon[corner].position;
+            position = position > 0 ? position - 1 : knownVertices + position;
+            if (position < 0 || position >= knownVertices) {
+                return fail("face references a vertex that has not been defined yet");
+            }
+        }
+
+        for (size_t i = 2; i < polygon.size(); ++i) {
+            resolved[0] = static_cast<uint32_t>(polygon[0].position);
+            resolved[1] = static_cast<uint32_t>(polygon[i - 1].position);
+            resolved[2] = static_cast<uint32_t>(polygon[i].position);
+
+            glm::vec3 corners[3];
+            for (int c = 0; c < 3; ++c) {
+                const float* p = &positions[3 * static_cast<size_t>(resolved[c])];
+                corners[c] = glm::vec3(p[0], p[1], p[2]);
+            }
+            // Flat normal, as in ObjLoader
+            const glm::vec3 normal = glm::normalize(glm::cross(corners[1] - corners[0], corners[2] - corners[0]));
+
+            for (int c = 0; c < 3; ++c) {
+                Vertex& vertex = vertexWriter.next();
+                vertex.pos = corners[c];
+                vertex.normal = normal;
+                if (hasColors) {
+                    const float* color = &colors[3 * static_cast<size_t>(resolved[c])];
+                    vertex.color = glm::vec3(color[0], color[1], color[2]);
+                } else {
+                    vertex.color = glm::vec3(1.0f, 1.0f, 1.0f);
+                }
+                indexWriter.next() = nextIndex++;
+            }
+        }
+    }
+
+    vertexWriter.flush();
+    indexWriter.flush();
+    stats.stagingBytes = sink.stagingBytes(); // Sampled before finish() releases staging
+    sink.finish();
+
+    stats.vertexCount = outputCount;
+    stats.indexCount = outputCount;
+    stats.positionTableBytes = (positions.capacity() + colors.capacity()) * sizeof(float);
+    stats.windowBytes = reader.windowBytes();
+    stats.peakHostBytes = stats.positionTableBytes + stats.windowBytes + stats.stagingBytes;
+    stats.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    std::cout << "Streamed OBJ file: " << filename << std::endl;
+    std::cout << "Vertices: " << stats.vertexCount << std::endl;
+    std::cout << "Indices: " << stats.indexCount << std::endl;
+    std::cout << "Peak host memory: " << stats.peakHostBytes / 1024 << " KiB"
+              << " (positions " << stats.positionTableBytes / 1024
+              << " KiB, window " << stats.windowBytes / 1024
+              << " KiB, staging " << stats.stagingBytes / 1024 << " KiB)" << std::endl;
+    return true;
+}
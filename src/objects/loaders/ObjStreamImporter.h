@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../geometry/MeshStreamSink.h"
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Bounded-memory OBJ importer that converts faces straight into a MeshStreamSink.
+ *
+ * The file is read through a fixed-size window in two passes. The first pass stores
+ * the (scaled) position table and counts the triangles; the second converts every
+ * face into flat-shaded vertices written directly into the sink's staging spans.
+ * Nothing proportional to the face count is ever held in host memory; the only
+ * structure that grows with the model is the position table (12 bytes per `v`, plus
+ * 12 for vertex colors when present).
+ *
+ * Vertices are not welded in this mode (welding needs a table proportional to the
+ * output), so the index stream is simply sequential.
+ *
+ * Keywords: Streaming Import, Bounded Memory, OBJ Parsing, Peak Memory
+ */
+class ObjStreamImporter {
+public:
+    /**
+     * @brief Options for a streaming import.
+     */
+    struct Options {
+        float scale = 1.0f;                        // Uniform scale applied to positions
+        size_t memoryBudget = 64 * 1024 * 1024;    // Host memory budget: read window + position table + staging
+        size_t windowBytes = 1024 * 1024;          // Size of the file read window
+    };
+
+    /**
+     * @brief Figures reported after an import.
+     */
+    struct Stats {
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        size_t positionTableBytes = 0;  // Position (and color) table
+        size_t windowBytes = 0;         // Read window (grows only for lines longer than the window)
+        size_t stagingBytes = 0;        // Reported by the sink
+        size_t peakHostBytes = 0;       // Sum of the above at their peak
+        double seconds = 0.0;
+    };
+
+    /**
+     * @brief Streams an OBJ file into a sink.
+     * @param filename Path to the OBJ file.
+     * @param options Import options.
+     * @param sink Destination for the converted vertices and indices.
+     * @param stats Receives import statistics.
+     * @return true if the import was successful, false otherwise (errors are printed).
+     */
+    static bool import(const std::string& filename, const Options& options, MeshStreamSink& sink, Stats& stats);
+};
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+/**
+ * @brief Low-level OBJ tokenizing helpers shared by the OBJ parsers.
+ *
+ * All functions work on [p, end) ranges of text that is not null-terminated (a
+ * memory-mapped file or a read window) and advance p past what they consume.
+ *
+ * Keywords: Tokenizer, Fast Float Parsing, OBJ Format
+ */
+namespace ObjTokenizer {
+
+    inline bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    inline bool isDigit(char c) {
+        return static_cast<unsigned>(c - '0') < 10u;
+    }
+
+    inline const char* skipSpace(const char* p, const char* end) {
+        while (p < end && isSpace(*p)) ++p;
+        return p;
+    }
+
+    // Slow path for anything the fast path does not handle (nan, inf, huge exponents).
+    // The text is not null-terminated, so the token is copied out first.
+    inline bool parseFloatSlow(const char*& p, const char* end, float& value) {
+        char buffer[64];
+        size_t length = 0;
+        while (p + length < end && !isSpace(p[length]) && p[length] != '\n' && length < sizeof(buffer) - 1) {
+            buffer[length] = p[length];
+            ++length;
+        }
+        buffer[length] = '\0';
+
+        char* parsedEnd = nullptr;
+        value = std::strtof(buffer, &parsedEnd);
+        if (parsedEnd == buffer) return false;
+        p += parsedEnd - buffer;
+        return true;
+    }
+
+    /**
+     * @brief Parses a decimal float at p, advancing p past it.
+     *
+     * Accumulates up to 19 significant digits into an integer and applies the decimal
+     * exponent with a single multiply/divide in double precision, which is exact enough
+     * for the float result and several times faster than strtof.
+     */
+    inline bool parseFloat(const char*& p, const char* end, float& value) {
+        static constexpr double POW10[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        static constexpr int MAX_POW10 = 22;
+
+        const char* s = p;
+        bool negative = false;
+        if (s < end && (*s == '-' || *s == '+')) {
+            negative = (*s == '-');
+            ++s;
+        }
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        int significantDigits = 0;
+        bool anyDigits = false;
+
+        for (; s < end && isDigit(*s); ++s) {
+            anyDigits = true;
+            if (significantDigits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*s - '0');
+                if (mantissa != 0) ++significantDigits;
+            } else {
+                ++exponent; // Digits past our precision only scale the value
+            }
+        }
+        if (s < end && *s == '.') {
+            ++s;
+            for (; s < end && isDigit(*s); ++s) {
+                anyDigits = true;
+                if (significantDigits < 19) {
+                    mantissa = mantissa * 10 + static_cast<uint64_t>(*s - '0');
+                    if (mantissa != 0) ++significantDigits;
+                    --exponent;
+                }
+            }
+        }
+        if (!anyDigits) {
+            return parseFloatSlow(p, end, value);
+        }
+
+        if (s < end && (*s == 'e' || *s == 'E')) {
+            const char* e = s + 1;
+            bool negativeExponent = false;
+            if (e < end && (*e == '-' || *e == '+')) {
+                negativeExponent = (*e == '-');
+                ++e;
+            }
+            if (e < end && isDigit(*e)) {
+                int explicitExponent = 0;
+                for (; e < end && isDigit(*e); ++e) {
+                    if (explicitExponent < 10000) explicitExponent = explicitExponent * 10 + (*e - '0');
+                }
+                exponent += negativeExponent ? -explicitExponent : explicitExponent;
+                s = e;
+            }
+        }
+
+        double result = static_cast<double>(mantissa);
+        if (exponent < -2 * MAX_POW10 || exponent > 2 * MAX_POW10) {
+            if (mantissa != 0) return parseFloatSlow(p, end, value);
+        } else if (exponent < 0) {
+            int e = -exponent;
+            if (e > MAX_POW10) { result /= POW10[MAX_POW10]; e -= MAX_POW10; }
+            result /= POW10[e];
+        } else if (exponent > 0) {
+            int e = exponent;
+            if (e > MAX_POW10) { result *= POW10[MAX_POW10]; e -= MAX_POW10; }
+            result *= POW10[e];
+        }
+
+        value = static_cast<float>(negative ? -result : result);
+        p = s;
+        return true;
+    }
+
+    // Parses a (possibly negative) integer at p, advancing p past it
+    inline bool parseInt(const char*& p, const char* end, int64_t& value) {
+        const char* s = p;
+        bool negative = false;
+        if (s < end && (*s == '-' || *s == '+')) {
+            negative = (*s == '-');
+            ++s;
+        }
+        if (s >= end || !isDigit(*s)) return false;
+
+        int64_t result = 0;
+        for (; s < end && isDigit(*s); ++s) {
+            if (result < (int64_t(1) << 40)) result = result * 10 + (*s - '0');
+        }
+        value = negative ? -result : result;
+        p = s;
+        return true;
+    }
+
+    /**
+     * @brief Parses up to maxCount whitespace-separated floats starting at p.
+     * @return Number of floats parsed.
+     */
+    inline int parseFloats(const char* p, const char* end, float* values, int maxCount) {
+        int count = 0;
+        while (count < maxCount) {
+            p = skipSpace(p, end);
+            if (p >= end || !parseFloat(p, end, values[count])) break;
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief One face corner as written in the file (1-based, or negative for relative).
+     */
+    struct CornerRef {
+        int64_t position;
+        int64_t normal;  // 0 when absent
+    };
+
+    /**
+     * @brief Parses the corners of an `f` line. p points just past the keyword.
+     * @param corners Receives the corners (cleared first). Any container with clear()/push_back().
+     * @param hasNormal Set to true if any corner references a normal.
+     * @param error Receives a static description of the problem on failure.
+     * @return true on success.
+     */
+    template <typename CornerList>
+    bool parseFaceCorners(const char* p, const char* end, CornerList& corners, bool& hasNormal, const char*& error) {
+        corners.clear();
+        while (true) {
+            p = skipSpace(p, end);
+            if (p >= end) break;
+
+            CornerRef ref{0, 0};
+            if (!parseInt(p, end, ref.position) || ref.position == 0) {
+                error = "invalid face vertex index";
+                return false;
+            }
+            if (p < end && *p == '/') {
+                ++p;
+                int64_t texcoord;
+                parseInt(p, end, texcoord); // Texture coordinates are not used
+                if (p < end && *p == '/') {
+                    ++p;
+                    if (!parseInt(p, end, ref.normal) || ref.normal == 0) {
+                        error = "invalid face normal index";
+                        return false;
+                    }
+                    hasNormal = true;
+                }
+            }
+            if (p < end && !isSpace(*p)) {
+                error = "unexpected character in face";
+                return false;
+            }
+            corners.push_back(ref);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Kind of OBJ line, determined from its keyword.
+     */
+    enum class LineType { Other, Vertex, Normal, Face };
+
+    /**
+     * @brief Classifies a line and returns a pointer just past its keyword.
+     */
+    inline LineType classifyLine(const char* line, const char* end, const char*& rest) {
+        const char* p = skipSpace(line, end);
+        if (p + 1 < end) {
+            if (p[0] == 'v' && isSpace(p[1])) { rest = p + 1; return LineType::Vertex; }
+            if (p[0] == 'v' && p[1] == 'n' && p + 2 < end && isSpace(p[2])) { rest = p + 2; return LineType::Normal; }
+            if (p[0] == 'f' && isSpace(p[1])) { rest = p + 1; return LineType::Face; }
+        }
+        // Everything else (comments, vt, o, g, s, usemtl, mtllib, l, p) is skipped
+        rest = end;
+        return LineType::Other;
+    }
+
+} // namespace ObjTokenizer
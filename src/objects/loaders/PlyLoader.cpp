@@ -0,0 +1,531 @@
+#include "PlyLoader.h"
+#include "MeshCache.h"
+#include "../../common/MappedFile.h"
+#include "../../common/Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+// Records per parallel task
+constexpr size_t DECODE_BATCH = 1 << 16;
+
+// The header is searched for end_header only this far, so other files are rejected quickly
+constexpr size_t MAX_HEADER_SIZE = 1 << 20;
+
+enum class Scalar { Int8, Uint8, Int16, Uint16, Int32, Uint32, Float32, Float64, Invalid };
+
+Scalar parseScalar(const std::string& name) {
+    if (name == "char" || name == "int8") return Scalar::Int8;
+    if (name == "uchar" || name == "uint8") return Scalar::Uint8;
+    if (name == "short" || name == "int16") return Scalar::Int16;
+    if (name == "ushort" || name == "uint16") return Scalar::Uint16;
+    if (name == "int" || name == "int32") return Scalar::Int32;
+    if (name == "uint" || name == "uint32") return Scalar::Uint32;
+    if (name == "float" || name == "float32") return Scalar::Float32;
+    if (name == "double" || name == "float64") return Scalar::Float64;
+    return Scalar::Invalid;
+}
+
+size_t scalarSize(Scalar type) {
+    switch (type) {
+    case Scalar::Int8:
+    case Scalar::Uint8: return 1;
+    case Scalar::Int16:
+    case Scalar::Uint16: return 2;
+    case Scalar::Int32:
+    case Scalar::Uint32:
+    case Scalar::Float32: return 4;
+    case Scalar::Float64: return 8;
+    default: return 0;
+    }
+}
+
+bool isInteger(Scalar type) {
+    return type != Scalar::Float32 && type != Scalar::Float64 && type != Scalar::Invalid;
+}
+
+struct Property {
+    std::string name;
+    Scalar type = Scalar::Invalid;      // Value type (element type for lists)
+    Scalar countType = Scalar::Invalid; // Length type for lists, Invalid for single values
+    size_t offset = 0;                  // Position in the record (elements without lists only)
+
+    bool isList() const { return countType != Scalar::Invalid; }
+};
+
+struct Element {
+    std::string name;
+    size_t count = 0;
+    std::vector<Property> properties;
+    size_t stride = 0; // Record size, 0 when the element has list properties
+
+    int find(const char* propertyName) const {
+        for (size_t i = 0; i < properties.size(); ++i) {
+            if (properties[i].name == propertyName) return static_cast<int>(i);
+        }
+        return -1;
+    }
+};
+
+struct Header {
+    bool swap = false; // File byte order differs from the host's
+    std::vector<Element> elements;
+    size_t dataOffset = 0;
+};
+
+bool hostIsLittleEndian() {
+    const uint16_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+template <typename T>
+T loadValue(const char* p, bool swap) {
+    T value;
+    if (swap) {
+        char bytes[sizeof(T)];
+        for (size_t i = 0; i < sizeof(T); ++i) bytes[i] = p[sizeof(T) - 1 - i];
+        std::memcpy(&value, bytes, sizeof(T));
+    } else {
+        std::memcpy(&value, p, sizeof(T));
+    }
+    return value;
+}
+
+double readScalar(const char* p, Scalar type, bool swap) {
+    switch (type) {
+    case Scalar::Int8: return static_cast<int8_t>(*p);
+    case Scalar::Uint8: return static_cast<uint8_t>(*p);
+    case Scalar::Int16: return loadValue<int16_t>(p, swap);
+    case Scalar::Uint16: return loadValue<uint16_t>(p, swap);
+    case Scalar::Int32: return loadValue<int32_t>(p, swap);
+    case Scalar::Uint32: return loadValue<uint32_t>(p, swap);
+    case Scalar::Float32: return loadValue<float>(p, swap);
+    case Scalar::Float64: return loadValue<double>(p, swap);
+    default: return 0.0;
+    }
+}
+
+// Integer types only (list lengths and vertex indices); negative values stay negative
+int64_t readInteger(const char* p, Scalar type, bool swap) {
+    switch (type) {
+    case Scalar::Int8: return static_cast<int8_t>(*p);
+    case Scalar::Uint8: return static_cast<uint8_t>(*p);
+    case Scalar::Int16: return loadValue<int16_t>(p, swap);
+    case Scalar::Uint16: return loadValue<uint16_t>(p, swap);
+    case Scalar::Int32: return loadValue<int32_t>(p, swap);
+    case Scalar::Uint32: return loadValue<uint32_t>(p, swap);
+    default: return -1;
+    }
+}
+
+// Factor mapping a stored color channel to 0..1
+float colorScale(Scalar type) {
+    switch (type) {
+    case Scalar::Uint8: return 1.0f / 255.0f;
+    case Scalar::Uint16: return 1.0f / 65535.0f;
+    default: return 1.0f;
+    }
+}
+
+bool parseHeader(const char* data, size_t size, Header& header, std::string& error) {
+    static const char END_HEADER[] = "end_header";
+    if (size < 4 || std::memcmp(data, "ply", 3) != 0 || (data[3] != '\n' && data[3] != '\r')) {
+        error = "not a PLY file";
+        return false;
+    }
+
+    // Find the line holding end_header; the binary data starts after its newline
+    const char* searchEnd = data + std::min(size, MAX_HEADER_SIZE);
+    const char* endHeader = std::search(data, searchEnd, END_HEADER, END_HEADER + sizeof(END_HEADER) - 1);
+    const char* dataStart = std::find(endHeader, searchEnd, '\n');
+    if (dataStart == searchEnd) {
+        error = "missing end_header";
+        return false;
+    }
+    header.dataOffset = static_cast<size_t>(dataStart + 1 - data);
+
+    std::istringstream lines(std::string(data, endHeader));
+    std::string line;
+    bool haveFormat = false;
+    while (std::getline(lines, line)) {
+        std::istringstream words(line);
+        std::string keyword;
+        words >> keyword;
+        if (keyword == "format") {
+            std::string format, version;
+            words >> format >> version;
+            if (format == "binary_little_endian") {
+                header.swap = !hostIsLittleEndian();
+            } else if (format == "binary_big_endian") {
+                header.swap = hostIsLittleEndian();
+            } else if (format == "ascii") {
+                error = "ASCII PLY is not supported, only binary";
+                return false;
+            } else {
+                error = "unknown format " + format;
+                return false;
+            }
+            haveFormat = true;
+        } else if (keyword == "element") {
+            Element element;
+            std::string count;
+            words >> element.name >> count;
+            char* countEnd = nullptr;
+            element.count = static_cast<size_t>(std::strtoull(count.c_str(), &countEnd, 10));
+            if (count.empty() || *countEnd != '\0') {
+                error = "invalid count for element " + element.name;
+                return false;
+            }
+            header.elements.push_back(std::move(element));
+        } else if (keyword == "property") {
+            if (header.elements.empty()) {
+                error = "property outside of an element";
+                return false;
+            }
+            Property property;
+            std::string type;
+            words >> type;
+            if (type == "list") {
+                std::string countType, valueType;
+                words >> countType >> valueType;
+                property.countType = parseScalar(countType);
+                property.type = parseScalar(valueType);
+                if (!isInteger(property.countType) || property.type == Scalar::Invalid) {
+                    error = "invalid list property: " + line;
+                    return false;
+                }
+            } else {
+                property.type = parseScalar(type);
+                if (property.type == Scalar::Invalid) {
+                    error = "invalid property type: " + line;
+                    return false;
+                }
+            }
+            words >> property.name;
+            header.elements.back().properties.push_back(std::move(property));
+        }
+        // comment and obj_info lines carry nothing we need
+    }
+    if (!haveFormat) {
+        error = "missing format line";
+        return false;
+    }
+
+    // Record layout of elements without lists
+    for (Element& element : header.elements) {
+        size_t offset = 0;
+        for (Property& property : element.properties) {
+            if (property.isList()) {
+                offset = 0;
+                break;
+            }
+            property.offset = offset;
+            offset += scalarSize(property.type);
+        }
+        element.stride = offset;
+    }
+    return true;
+}
+
+// Advances past an element with list properties, one record at a time
+bool skipRecords(const Element& element, const char*& p, const char* end, bool swap) {
+    for (size_t r = 0; r < element.count; ++r) {
+        for (const Property& property : element.properties) {
+            size_t length = 1;
+            if (property.isList()) {
+                const size_t countSize = scalarSize(property.countType);
+                if (static_cast<size_t>(end - p) < countSize) return false;
+                const int64_t count = readInteger(p, property.countType, swap);
+                if (count < 0) return false;
+                length = static_cast<size_t>(count);
+                p += countSize;
+            }
+            const size_t valueSize = scalarSize(property.type);
+            if (length > static_cast<size_t>(end - p) / valueSize) return false;
+            p += length * valueSize;
+        }
+    }
+    return true;
+}
+
+bool decodeVertices(const Element& element, const char*& p, const char* end, bool swap, float scale,
+                    std::vector<Vertex>& vertices, bool& hasNormals, std::string& error) {
+    if (element.stride == 0) {
+        error = "vertex element with list properties";
+        return false;
+    }
+    if (element.count > std::numeric_limits<uint32_t>::max()) {
+        error = "more vertices than 32-bit indices can address";
+        return false;
+    }
+    if (element.count > static_cast<size_t>(end - p) / element.stride) {
+        error = "vertex data is truncated";
+        return false;
+    }
+
+    auto findAny = [&element](std::initializer_list<const char*> names) {
+        for (const char* name : names) {
+            const int index = element.find(name);
+            if (index >= 0) return index;
+        }
+        return -1;
+    };
+    const int position[3] = {element.find("x"), element.find("y"), element.find("z")};
+    const int normal[3] = {element.find("nx"), element.find("ny"), element.find("nz")};
+    const int color[3] = {findAny({"red", "r", "diffuse_red"}), findAny({"green", "g", "diffuse_green"}),
+                          findAny({"blue", "b", "diffuse_blue"})};
+    if (position[0] < 0 || position[1] < 0 || position[2] < 0) {
+        error = "vertex element has no x, y and z";
+        return false;
+    }
+    hasNormals = normal[0] >= 0 && normal[1] >= 0 && normal[2] >= 0;
+    const bool hasColors = color[0] >= 0 && color[1] >= 0 && color[2] >= 0;
+
+    // Per channel: offset in the record, type and scale
+    struct Channel {
+        size_t offset = 0;
+        Scalar type = Scalar::Invalid;
+        float scale = 1.0f;
+    };
+    auto channel = [&element](int index, float factor) {
+        Channel result;
+        if (index >= 0) {
+            result.offset = element.properties[index].offset;
+            result.type = element.properties[index].type;
+            result.scale = factor;
+        }
+        return result;
+    };
+    Channel channels[9];
+    for (int c = 0; c < 3; ++c) {
+        channels[c] = channel(position[c], scale);
+        channels[3 + c] = channel(normal[c], 1.0f);
+        channels[6 + c] = channel(color[c], color[c] >= 0 ? colorScale(element.properties[color[c]].type) : 1.0f);
+    }
+
+    const char* records = p;
+    const size_t stride = element.stride;
+    vertices.resize(element.count);
+    Parallel::forEach((element.count + DECODE_BATCH - 1) / DECODE_BATCH, [&](size_t batch) {
+        const size_t first = batch * DECODE_BATCH;
+        const size_t last = std::min(first + DECODE_BATCH, element.count);
+        auto read = [swap](const char* record, const Channel& c) {
+            return static_cast<float>(readScalar(record + c.offset, c.type, swap)) * c.scale;
+        };
+        for (size_t v = first; v < last; ++v) {
+            const char* record = records + v * stride;
+            Vertex& vertex = vertices[v];
+            vertex.pos = glm::vec3(read(record, channels[0]), read(record, channels[1]), read(record, channels[2]));
+            vertex.normal = hasNormals
+                ? glm::vec3(read(record, channels[3]), read(record, channels[4]), read(record, channels[5]))
+                : glm::vec3(0.0f);
+            vertex.color = hasColors
+                ? glm::vec3(read(record, channels[6]), read(record, channels[7]), read(record, channels[8]))
+                : glm::vec3(1.0f);
+        }
+    });
+    p += element.count * stride;
+    return true;
+}
+
+// Faces that are all triangles have a fixed record size; decodes them in parallel if so
+bool decodeTriangleFaces(const Element& element, int listIndex, const char*& p, const char* end, bool swap,
+                         size_t vertexCount, std::vector<uint32_t>& indices, bool& valid) {
+    size_t stride = 0, listOffset = 0;
+    for (size_t i = 0; i < element.properties.size(); ++i) {
+        const Property& property = element.properties[i];
+        if (static_cast<int>(i) == listIndex) {
+            listOffset = stride;
+            stride += scalarSize(property.countType) + 3 * scalarSize(property.type);
+        } else if (property.isList()) {
+            return false;
+        } else {
+            stride += scalarSize(property.type);
+        }
+    }
+    if (element.count > static_cast<size_t>(end - p) / stride) return false;
+
+    // Every count must be 3. Any other count is found at its true offset, since all the
+    // records before the first non-triangle have the assumed size.
+    const Property& list = element.properties[listIndex];
+    const char* records = p;
+    const size_t batches = (element.count + DECODE_BATCH - 1) / DECODE_BATCH;
+    std::atomic<bool> allTriangles{true};
+    Parallel::forEach(batches, [&](size_t batch) {
+        const size_t last = std::min((batch + 1) * DECODE_BATCH, element.count);
+        for (size_t f = batch * DECODE_BATCH; f < last && allTriangles.load(std::memory_order_relaxed); ++f) {
+            if (readInteger(records + f * stride + listOffset, list.countType, swap) != 3) {
+                allTriangles = false;
+            }
+        }
+    });
+    if (!allTriangles) return false;
+
+    const size_t countSize = scalarSize(list.countType);
+    const size_t indexSize = scalarSize(list.type);
+    std::atomic<bool> inRange{true};
+    indices.resize(element.count * 3);
+    Parallel::forEach(batches, [&](size_t batch) {
+        const size_t last = std::min((batch + 1) * DECODE_BATCH, element.count);
+        bool ok = true;
+        for (size_t f = batch * DECODE_BATCH; f < last; ++f) {
+            const char* values = records + f * stride + listOffset + countSize;
+            for (size_t c = 0; c < 3; ++c) {
+                const int64_t index = readInteger(values + c * indexSize, list.type, swap);
+                ok &= index >= 0 && static_cast<uint64_t>(index) < vertexCount;
+                indices[3 * f + c] = static_cast<uint32_t>(index);
+            }
+        }
+        if (!ok) inRange = false;
+    });
+    valid = inRange;
+    p += element.count * stride;
+    return true;
+}
+
+// General faces: walks the records once and fan-triangulates polygons
+bool decodePolygonFaces(const Element& element, int listIndex, const char*& p, const char* end, bool swap,
+                        size_t vertexCount, std::vector<uint32_t>& indices, std::string& error) {
+    indices.clear();
+    indices.reserve(element.count * 3);
+    for (size_t f = 0; f < element.count; ++f) {
+        for (size_t i = 0; i < element.properties.size(); ++i) {
+            const Property& property = element.properties[i];
+            const size_t valueSize = scalarSize(property.type);
+            size_t length = 1;
+            if (property.isList()) {
+                const size_t countSize = scalarSize(property.countType);
+                const int64_t count = static_cast<size_t>(end - p) >= countSize
+                    ? readInteger(p, property.countType, swap) : -1;
+                if (count < 0) {
+                    error = "face data is truncated";
+                    return false;
+                }
+                length = static_cast<size_t>(count);
+                p += countSize;
+            }
+            if (length > static_cast<size_t>(end - p) / valueSize) {
+                error = "face data is truncated";
+                return false;
+            }
+
+            if (static_cast<int>(i) == listIndex) {
+                uint32_t first = 0, previous = 0;
+                for (size_t c = 0; c < length; ++c) {
+                    const int64_t index = readInteger(p + c * valueSize, property.type, swap);
+                    if (index < 0 || static_cast<uint64_t>(index) >= vertexCount) {
+                        error = "face " + std::to_string(f) + " has an out of range vertex index";
+                        return false;
+                    }
+                    const uint32_t current = static_cast<uint32_t>(index);
+                    if (c == 0) {
+                        first = current;
+                    } else if (c >= 2) {
+                        indices.push_back(first);
+                        indices.push_back(previous);
+                        indices.push_back(current);
+                    }
+                    previous = current;
+                }
+            }
+            p += length * valueSize;
+        }
+    }
+    return true;
+}
+
+bool decodeFaces(const Element& element, const char*& p, const char* end, bool swap, size_t vertexCount,
+                 std::vector<uint32_t>& indices, std::string& error) {
+    int listIndex = element.find("vertex_indices");
+    if (listIndex < 0) listIndex = element.find("vertex_index");
+    if (listIndex < 0 || !element.properties[listIndex].isList() ||
+        !isInteger(element.properties[listIndex].type)) {
+        error = "face element has no integer vertex_indices list";
+        return false;
+    }
+
+    bool valid = true;
+    if (decodeTriangleFaces(element, listIndex, p, end, swap, vertexCount, indices, valid)) {
+        if (!valid) error = "a face has an out of range vertex index";
+        return valid;
+    }
+    return decodePolygonFaces(element, listIndex, p, end, swap, vertexCount, indices, error);
+}
+
+} // namespace
+
+bool PlyLoader::load(const std::string& filename, float scale, std::vector<Vertex>& vertices,
+                     std::vector<uint32_t>& indices, bool& hasNormals, std::string& error) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        error = "could not open " + filename;
+        return false;
+    }
+    return parse(file.data(), file.size(), scale, vertices, indices, hasNormals, error);
+}
+
+bool PlyLoader::parse(const char* data, size_t size, float scale, std::vector<Vertex>& vertices,
+                      std::vector<uint32_t>& indices, bool& hasNormals, std::string& error) {
+    vertices.clear();
+    indices.clear();
+    hasNormals = false;
+
+    Header header;
+    if (!parseHeader(data, size, header, error)) return false;
+
+    const Element* vertexElement = nullptr;
+    for (const Element& element : header.elements) {
+        if (element.name == "vertex") vertexElement = &element;
+    }
+    if (!vertexElement) {
+        error = "no vertex element";
+        return false;
+    }
+
+    // Elements are stored one after the other in header order
+    const char* p = data + header.dataOffset;
+    const char* end = data + size;
+    bool haveFaces = false;
+    for (const Element& element : header.elements) {
+        if (&element == vertexElement) {
+            if (!decodeVertices(element, p, end, header.swap, scale, vertices, hasNormals, error)) return false;
+        } else if (element.name == "face" && !haveFaces) {
+            if (!decodeFaces(element, p, end, header.swap, vertexElement->count, indices, error)) return false;
+            haveFaces = true;
+        } else if (element.properties.empty()) {
+            continue; // Records without properties take no space
+        } else if (element.stride > 0) {
+            if (element.count > static_cast<size_t>(end - p) / element.stride) {
+                error = element.name + " data is truncated";
+                return false;
+            }
+            p += element.count * element.stride;
+        } else if (!skipRecords(element, p, end, header.swap)) {
+            error = element.name + " data is truncated";
+            return false;
+        }
+    }
+
+    if (indices.empty()) {
+        error = "no faces (point clouds are not supported)";
+        return false;
+    }
+    return true;
+}
+
+uint64_t PlyLoader::cacheKey(float scale) {
+    static constexpr uint32_t CONVERSION_VERSION = 1;
+    const struct {
+        uint32_t format; // Distinguishes PLY results from other formats
+        uint32_t version;
+        float scale;
+    } key{0x706C79u, CONVERSION_VERSION, scale};
+    return MeshCache::hashBytes(&key, sizeof(key));
+}
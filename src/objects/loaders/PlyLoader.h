@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../../common/Vertex.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Loads binary PLY files (little- or big-endian), as written by 3D scanners.
+ *
+ * The file is memory-mapped and only the text header is parsed. The element data
+ * is a sequence of records, so once the header is known every vertex record sits at
+ * a fixed offset and the vertices are decoded in parallel batches straight into
+ * Vertex. Faces are list records and can have any size; the common case of a file
+ * holding only triangles is detected (every count is 3) and decoded in parallel as
+ * well, anything else is walked once and fan-triangulated.
+ *
+ * Recognized vertex properties are x/y/z, nx/ny/nz and red/green/blue (also
+ * r/g/b and diffuse_red/green/blue), in any scalar type. 8- and 16-bit unsigned
+ * colors are normalized to 0..1. Vertices without a color are white. Other
+ * properties and elements are skipped.
+ *
+ * ASCII PLY and point clouds (no faces) are rejected.
+ *
+ * Keywords: PLY, Stanford Triangle Format, Binary Mesh Loading, Memory Mapped I/O, Parallel Decoding
+ */
+class PlyLoader {
+public:
+    /**
+     * @brief Memory-maps and loads a binary PLY file.
+     * @param filename Path to the file.
+     * @param scale Uniform scale applied to positions.
+     * @param vertices Receives one vertex per PLY vertex.
+     * @param indices Receives the triangle indices.
+     * @param hasNormals Set when the file has per-vertex normals (otherwise they are zero).
+     * @param error Receives a description of the problem on failure.
+     * @return true if loading was successful, false otherwise.
+     */
+    static bool load(const std::string& filename, float scale, std::vector<Vertex>& vertices,
+                     std::vector<uint32_t>& indices, bool& hasNormals, std::string& error);
+
+    /**
+     * @brief Loads a binary PLY file already in memory.
+     * @param data Start of the file.
+     * @param size Size of the file in bytes.
+     */
+    static bool parse(const char* data, size_t size, float scale, std::vector<Vertex>& vertices,
+                      std::vector<uint32_t>& indices, bool& hasNormals, std::string& error);
+
+    /**
+     * @brief Key of the loaded result for the mesh cache.
+     */
+    static uint64_t cacheKey(float scale);
+};
@@ -0,0 +1,130 @@
+#include "StlLoader.h"
+#include "MeshCache.h"
+#include "../geometry/VertexWelder.h"
+#include "../../common/MappedFile.h"
+#include "../../common/Parallel.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// Binary STL layout (little-endian)
+constexpr size_t HEADER_SIZE = 80;
+constexpr size_t PREAMBLE_SIZE = HEADER_SIZE + 4; // Header and triangle count
+constexpr size_t RECORD_SIZE = 50;                // Normal, three corners, attribute word
+constexpr size_t CORNERS_OFFSET = 12;             // The facet normal is not used
+constexpr size_t ATTRIBUTE_OFFSET = 48;
+
+// Triangles per parallel task
+constexpr size_t DECODE_BATCH = 1 << 16;
+
+float readFloat(const char* p) {
+    float value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t readUint32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint16_t readUint16(const char* p) {
+    uint16_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Expands a 5-bit color channel to 0..1
+float channel(uint16_t attribute, int shift) {
+    return static_cast<float>((attribute >> shift) & 0x1F) / 31.0f;
+}
+
+} // namespace
+
+bool StlLoader::load(const std::string& filename, float scale, std::vector<Vertex>& vertices,
+                     std::vector<uint32_t>& indices, std::string& error) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        error = "could not open " + filename;
+        return false;
+    }
+    return parse(file.data(), file.size(), scale, vertices, indices, error);
+}
+
+bool StlLoader::parse(const char* data, size_t size, float scale, std::vector<Vertex>& vertices,
+                      std::vector<uint32_t>& indices, std::string& error) {
+    vertices.clear();
+    indices.clear();
+
+    // ASCII files start with "solid", but so do some binary headers: the size decides
+    const bool solid = size >= 5 && std::memcmp(data, "solid", 5) == 0;
+    const size_t triangleCount = size >= PREAMBLE_SIZE ? readUint32(data + HEADER_SIZE) : 0;
+    const size_t expectedSize = PREAMBLE_SIZE + triangleCount * RECORD_SIZE;
+    if (size < PREAMBLE_SIZE || size < expectedSize || (solid && size != expectedSize)) {
+        error = solid ? "ASCII STL is not supported, only binary" : "not a binary STL file or truncated";
+        return false;
+    }
+    if (triangleCount == 0) {
+        error = "no triangles";
+        return false;
+    }
+    if (3 * triangleCount > std::numeric_limits<uint32_t>::max()) {
+        error = "more triangles than 32-bit indices can address";
+        return false;
+    }
+
+    // Materialise Magics stores "COLOR=" and a default RGBA color in the header
+    const char* header = data;
+    const char* colorTag = std::search(header, header + HEADER_SIZE, "COLOR=", "COLOR=" + 6);
+    const bool magics = colorTag + 10 <= header + HEADER_SIZE;
+    glm::vec3 defaultColor(1.0f);
+    if (magics) {
+        const unsigned char* rgba = reinterpret_cast<const unsigned char*>(colorTag + 6);
+        defaultColor = glm::vec3(rgba[0], rgba[1], rgba[2]) / 255.0f;
+    }
+
+    // Decode every corner in parallel; each triangle writes its own three slots
+    std::vector<Vertex> corners(3 * triangleCount);
+    const char* records = data + PREAMBLE_SIZE;
+    Parallel::forEach((triangleCount + DECODE_BATCH - 1) / DECODE_BATCH, [&](size_t batch) {
+        const size_t last = std::min((batch + 1) * DECODE_BATCH, triangleCount);
+        for (size_t t = batch * DECODE_BATCH; t < last; ++t) {
+            const char* record = records + t * RECORD_SIZE;
+            const uint16_t attribute = readUint16(record + ATTRIBUTE_OFFSET);
+            glm::vec3 color = defaultColor;
+            if (magics && !(attribute & 0x8000)) {
+                color = glm::vec3(channel(attribute, 0), channel(attribute, 5), channel(attribute, 10));
+            } else if (!magics && (attribute & 0x8000)) {
+                color = glm::vec3(channel(attribute, 10), channel(attribute, 5), channel(attribute, 0));
+            }
+            for (size_t c = 0; c < 3; ++c) {
+                const char* corner = record + CORNERS_OFFSET + 12 * c;
+                Vertex& vertex = corners[3 * t + c];
+                vertex.pos = glm::vec3(readFloat(corner), readFloat(corner + 4), readFloat(corner + 8)) * scale;
+                vertex.normal = glm::vec3(0.0f);
+                vertex.color = color;
+            }
+        }
+    });
+
+    // A closed mesh has about half as many vertices as triangles
+    VertexWelder welder(vertices, 0.0f, triangleCount / 2);
+    indices.resize(corners.size());
+    for (size_t i = 0; i < corners.size(); ++i) {
+        indices[i] = welder.insert(corners[i]);
+    }
+    return true;
+}
+
+uint64_t StlLoader::cacheKey(float scale) {
+    static constexpr uint32_t CONVERSION_VERSION = 1;
+    const struct {
+        uint32_t format; // Distinguishes STL results from other formats
+        uint32_t version;
+        float scale;
+    } key{0x73746Cu, CONVERSION_VERSION, scale};
+    return MeshCache::hashBytes(&key, sizeof(key));
+}
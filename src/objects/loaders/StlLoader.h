@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../../common/Vertex.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Loads binary STL files.
+ *
+ * Binary STL is an 80-byte header, a triangle count and one 50-byte record per
+ * triangle (facet normal, three corners, a 16-bit attribute). The file is
+ * memory-mapped and the records are decoded in parallel batches. STL does not share
+ * vertices between triangles, so the corners are then welded on position and color
+ * (VertexWelder) into an indexed mesh.
+ *
+ * Normals are left zero: the facet normals are often missing or wrong, and they
+ * would keep welded corners apart. Callers generate smooth normals over the welded
+ * mesh instead.
+ *
+ * Per-facet colors in the attribute word are read in both common conventions:
+ * VisCAM/SolidView (bit 15 set, blue in the low bits) and Materialise Magics
+ * ("COLOR=" in the header, bit 15 clear, red in the low bits). Facets without a
+ * color are white, or the Magics default color. ASCII STL is rejected.
+ *
+ * Keywords: STL, Stereolithography, Binary Mesh Loading, Memory Mapped I/O, Vertex Welding
+ */
+class StlLoader {
+public:
+    /**
+     * @brief Memory-maps and loads a binary STL file.
+     * @param filename Path to the file.
+     * @param scale Uniform scale applied to positions.
+     * @param vertices Receives the welded vertices (zero normals).
+     * @param indices Receives the triangle indices.
+     * @param error Receives a description of the problem on failure.
+     * @return true if loading was successful, false otherwise.
+     */
+    static bool load(const std::string& filename, float scale, std::vector<Vertex>& vertices,
+                     std::vector<uint32_t>& indices, std::string& error);
+
+    /**
+     * @brief Loads a binary STL file already in memory.
+     * @param data Start of the file.
+     * @param size Size of the file in bytes.
+     */
+    static bool parse(const char* data, size_t size, float scale, std::vector<Vertex>& vertices,
+                      std::vector<uint32_t>& indices, std::string& error);
+
+    /**
+     * @brief Key of the loaded result for the mesh cache.
+     */
+    static uint64_t cacheKey(float scale);
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <utility>
+
+/**
+ * @brief Defers destruction of GPU resources until the frames using them have finished.
+ *
+ * Instead of idling the device before replacing a buffer, the old handles are
+ * pushed here tagged with the last frame number that may still reference them.
+ * Once the engine knows that frame has completed (its in-flight fence was waited
+ * on), flush() runs the deleters. Entries are pushed in frame order, so flushing
+ * only ever looks at the front of the queue.
+ *
+ * Keywords: Deferred Deletion, Resource Lifetime, Frames In Flight
+ */
+class DeletionQueue {
+public:
+    /**
+     * @brief Queues a deleter for a resource last used by frame retireFrame.
+     */
+    void push(uint64_t retireFrame, std::function<void()> deleter) {
+        entries.push_back({retireFrame, std::move(deleter)});
+    }
+
+    /**
+     * @brief Runs the deleters of every resource whose last frame has completed.
+     * @param completedFrames Number of frames known to be finished on the GPU
+     *                        (frames 0 .. completedFrames-1).
+     */
+    void flush(uint64_t completedFrames) {
+        while (!entries.empty() && entries.front().retireFrame < completedFrames) {
+            entries.front().deleter();
+            entries.pop_front();
+        }
+    }
+
+    /**
+     * @brief Runs all remaining deleters. The device must be idle.
+     */
+    void flushAll() {
+        while (!entries.empty()) {
+            entries.front().deleter();
+            entries.pop_front();
+        }
+    }
+
+    bool empty() const { return entries.empty(); }
+
+private:
+    struct Entry {
+        uint64_t retireFrame;
+        std::function<void()> deleter;
+    };
+
+    std::deque<Entry> entries;
+};
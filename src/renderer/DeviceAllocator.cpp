@@ -0,0 +1,496 @@
+#include "DeviceAllocator.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace {
+
+constexpr uint32_t NONE = UINT32_MAX;
+constexpr uint32_t DEDICATED = UINT32_MAX; // Allocation::chunk of a dedicated allocation
+constexpr VkDeviceSize GRANULE = 16;       // Every range is a multiple of this, at a multiple of it
+
+uint32_t floorLog2(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<uint32_t>(index);
+#else
+    return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+}
+
+uint32_t lowestBit(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+}
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief Allocates and maps blocks with the Vulkan API.
+ */
+class VulkanBlockSource : public DeviceAllocator::BlockSource {
+public:
+    explicit VulkanBlockSource(VkDevice deviceHandle) : device(deviceHandle) {}
+
+    VkResult allocate(uint32_t memoryType, VkDeviceSize size, VkDeviceMemory& memory) override {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = size;
+        allocInfo.memoryTypeIndex = memoryType;
+        return vkAllocateMemory(device, &allocInfo, nullptr, &memory);
+    }
+
+    void free(VkDeviceMemory memory) override {
+        vkFreeMemory(device, memory, nullptr);
+    }
+
+    VkResult map(VkDeviceMemory memory, void*& data) override {
+        return vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data);
+    }
+
+    void unmap(VkDeviceMemory memory) override {
+        vkUnmapMemory(device, memory);
+    }
+
+private:
+    VkDevice device;
+};
+
+} // namespace
+
+/**
+ * @brief Two-level segregated fit bookkeeping of the ranges of one block.
+ *
+ * The block is a doubly linked list of chunks in address order; free chunks are
+ * also linked into the list of their size class. The first level splits sizes by
+ * power of two, the second into SL_COUNT equal steps, and a bitmap per level marks
+ * the non-empty lists. Sizes below 256 bytes share the first class in 8-byte steps.
+ * Adjacent free chunks are always merged.
+ */
+class DeviceAllocator::Tlsf {
+public:
+    explicit Tlsf(VkDeviceSize size) {
+        for (auto& level : heads) std::fill(std::begin(level), std::end(level), NONE);
+        const uint32_t whole = newChunk();
+        chunks[whole].offset = 0;
+        chunks[whole].size = size;
+        insertFree(whole);
+    }
+
+    /**
+     * @brief Finds and claims size bytes at an offset aligned to alignment (both multiples of GRANULE).
+     */
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, uint32_t& chunk, VkDeviceSize& offset) {
+        // Chunks start on GRANULE multiples, so this much covers any alignment padding
+        const VkDeviceSize searchSize = size + (alignment > GRANULE ? alignment - GRANULE : 0);
+        const uint32_t found = findFree(searchSize);
+        if (found == NONE) return false;
+        removeFree(found);
+
+        const VkDeviceSize aligned = alignUp(chunks[found].offset, alignment);
+        const VkDeviceSize padding = aligned - chunks[found].offset;
+        if (padding > 0) {
+            // The previous chunk is in use (free neighbours are always merged), so the padding stays on its own
+            const uint32_t front = newChunk();
+            Chunk& current = chunks[found];
+            chunks[front].offset = current.offset;
+            chunks[front].size = padding;
+            linkBefore(front, found);
+            current.offset = aligned;
+            current.size -= padding;
+            insertFree(front);
+        }
+        if (chunks[found].size > size) {
+            const uint32_t back = newChunk();
+            Chunk& current = chunks[found];
+            chunks[back].offset = current.offset + size;
+            chunks[back].size = current.size - size;
+            current.size = size;
+            linkAfter(back, found);
+            insertFree(back);
+        }
+        chunks[found].free = false;
+        used += size;
+        chunk = found;
+        offset = aligned;
+        return true;
+    }
+
+    void free(uint32_t index) {
+        used -= chunks[index].size;
+        chunks[index].free = true;
+        const uint32_t next = chunks[index].nextPhysical;
+        if (next != NONE && chunks[next].free) {
+            removeFree(next);
+            chunks[index].size += chunks[next].size;
+            unlink(next);
+        }
+        const uint32_t previous = chunks[index].prevPhysical;
+        if (previous != NONE && chunks[previous].free) {
+            removeFree(previous);
+            chunks[previous].size += chunks[index].size;
+            unlink(index);
+            index = previous;
+        }
+        insertFree(index);
+    }
+
+    VkDeviceSize usedBytes() const { return used; }
+
+private:
+    static constexpr uint32_t SL_BITS = 5;
+    static constexpr uint32_t SL_COUNT = 1u << SL_BITS;
+    static constexpr uint32_t SMALL_LOG2 = 8; // Sizes below 256 bytes form class 0
+    static constexpr uint32_t FL_COUNT = 48;  // Chunks up to 2^55 bytes
+
+    struct Chunk {
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        uint32_t prevPhysical = NONE;
+        uint32_t nextPhysical = NONE;
+        uint32_t prevFree = NONE;
+        uint32_t nextFree = NONE;
+        bool free = false;
+    };
+
+    std::vector<Chunk> chunks;
+    std::vector<uint32_t> spareChunks;
+    VkDeviceSize used = 0;
+    uint64_t firstLevelMap = 0;
+    uint32_t secondLevelMap[FL_COUNT] = {};
+    uint32_t heads[FL_COUNT][SL_COUNT];
+
+    static void mapping(VkDeviceSize size, uint32_t& fl, uint32_t& sl) {
+        if (size < (VkDeviceSize(1) << SMALL_LOG2)) {
+            fl = 0;
+            sl = static_cast<uint32_t>(size >> (SMALL_LOG2 - SL_BITS));
+            return;
+        }
+        const uint32_t log = floorLog2(size);
+        fl = log - SMALL_LOG2 + 1;
+        sl = static_cast<uint32_t>(size >> (log - SL_BITS)) - SL_COUNT;
+    }
+
+    // A free chunk of at least size bytes, or NONE
+    uint32_t findFree(VkDeviceSize size) const {
+        // Round up to the next class boundary so that every chunk of the class fits
+        if (size >= (VkDeviceSize(1) << SMALL_LOG2)) size += (VkDeviceSize(1) << (floorLog2(size) - SL_BITS)) - 1;
+        uint32_t fl, sl;
+        mapping(size, fl, sl);
+        if (fl >= FL_COUNT) return NONE;
+
+        uint32_t secondLevel = secondLevelMap[fl] & (~0u << sl);
+        if (secondLevel == 0) {
+            const uint64_t firstLevel = fl + 1 < 64 ? firstLevelMap & (~uint64_t(0) << (fl + 1)) : 0;
+            if (firstLevel == 0) return NONE;
+            fl = lowestBit(firstLevel);
+            secondLevel = secondLevelMap[fl];
+        }
+        sl = lowestBit(secondLevel);
+        return heads[fl][sl];
+    }
+
+    void insertFree(uint32_t index) {
+        uint32_t fl, sl;
+        mapping(chunks[index].size, fl, sl);
+        Chunk& chunk = chunks[index];
+        chunk.free = true;
+        chunk.prevFree = NONE;
+        chunk.nextFree = heads[fl][sl];
+        if (chunk.nextFree != NONE) chunks[chunk.nextFree].prevFree = index;
+        heads[fl][sl] = index;
+        firstLevelMap |= uint64_t(1) << fl;
+        secondLevelMap[fl] |= 1u << sl;
+    }
+
+    void removeFree(uint32_t index) {
+        uint32_t fl, sl;
+        mapping(chunks[index].size, fl, sl);
+        Chunk& chunk = chunks[index];
+        if (chunk.prevFree != NONE) {
+            chunks[chunk.prevFree].nextFree = chunk.nextFree;
+        } else {
+            heads[fl][sl] = chunk.nextFree;
+        }
+        if (chunk.nextFree != NONE) chunks[chunk.nextFree].prevFree = chunk.prevFree;
+        chunk.prevFree = chunk.nextFree = NONE;
+        if (heads[fl][sl] == NONE) {
+            secondLevelMap[fl] &= ~(1u << sl);
+            if (secondLevelMap[fl] == 0) firstLevelMap &= ~(uint64_t(1) << fl);
+        }
+    }
+
+    uint32_t newChunk() {
+        if (!spareChunks.empty()) {
+            const uint32_t index = spareChunks.back();
+            spareChunks.pop_back();
+            chunks[index] = Chunk();
+            return index;
+        }
+        chunks.emplace_back();
+        return static_cast<uint32_t>(chunks.size() - 1);
+    }
+
+    void linkBefore(uint32_t index, uint32_t next) {
+        chunks[index].nextPhysical = next;
+        chunks[index].prevPhysical = chunks[next].prevPhysical;
+        if (chunks[next].prevPhysical != NONE) chunks[chunks[next].prevPhysical].nextPhysical = index;
+        chunks[next].prevPhysical = index;
+    }
+
+    void linkAfter(uint32_t index, uint32_t previous) {
+        chunks[index].prevPhysical = previous;
+        chunks[index].nextPhysical = chunks[previous].nextPhysical;
+        if (chunks[previous].nextPhysical != NONE) chunks[chunks[previous].nextPhysical].prevPhysical = index;
+        chunks[previous].nextPhysical = index;
+    }
+
+    // Removes a chunk from the address list and recycles it
+    void unlink(uint32_t index) {
+        const Chunk& chunk = chunks[index];
+        if (chunk.prevPhysical != NONE) chunks[chunk.prevPhysical].nextPhysical = chunk.nextPhysical;
+        if (chunk.nextPhysical != NONE) chunks[chunk.nextPhysical].prevPhysical = chunk.prevPhysical;
+        spareChunks.push_back(index);
+    }
+};
+
+DeviceAllocator::Block::Block() = default;
+DeviceAllocator::Block::~Block() = default;
+
+DeviceAllocator::DeviceAllocator() = default;
+
+DeviceAllocator::~DeviceAllocator() {
+    destroy();
+}
+
+void DeviceAllocator::create(VkPhysicalDevice physicalDevice, VkDevice logicalDevice) {
+    VkPhysicalDeviceMemoryProperties properties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &properties);
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+
+    create(properties, deviceProperties.limits.bufferImageGranularity,
+           std::unique_ptr<BlockSource>(new VulkanBlockSource(logicalDevice)));
+    device = logicalDevice;
+}
+
+void DeviceAllocator::create(const VkPhysicalDeviceMemoryProperties& properties, VkDeviceSize bufferImageGranularity,
+                             std::unique_ptr<BlockSource> blockSource, VkDeviceSize blockSize) {
+    destroy();
+    source = std::move(blockSource);
+    memoryProperties = properties;
+    separateOptimal = bufferImageGranularity > 1;
+    preferredBlockSize = std::max(alignUp(blockSize, GRANULE), GRANULE);
+    pools.resize(2 * memoryProperties.memoryTypeCount);
+    for (uint32_t i = 0; i < pools.size(); ++i) pools[i].memoryType = i / 2;
+}
+
+void DeviceAllocator::destroy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint32_t leaked = 0;
+    for (Pool& pool : pools) {
+        for (std::unique_ptr<Block>& block : pool.blocks) {
+            if (!block) continue;
+            leaked += block->allocationCount;
+            if (block->mapCount > 0) source->unmap(block->memory);
+            source->free(block->memory);
+        }
+    }
+    if (leaked > 0) std::cerr << "DeviceAllocator: " << leaked << " allocations were not freed." << std::endl;
+    pools.clear();
+    source.reset();
+    device = VK_NULL_HANDLE;
+}
+
+DeviceAllocator::Allocation DeviceAllocator::allocate(const VkMemoryRequirements& requirements,
+                                                      VkMemoryPropertyFlags properties, ResourceKind kind,
+                                                      VkMemoryPropertyFlags preferredProperties) {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool typeFound = false;
+    Allocation allocation;
+    // Like VulkanUtils::findMemoryType, but moves on to the next suitable type when one is full.
+    // Types with the preferred properties as well are tried first.
+    const bool preferring = (preferredProperties & ~properties) != 0;
+    for (int pass = preferring ? 0 : 1; pass < 2; ++pass) {
+        const VkMemoryPropertyFlags wanted = pass == 0 ? properties | preferredProperties : properties;
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+            const bool typeAllowed = (requirements.memoryTypeBits & (1u << i)) != 0;
+            const bool propertiesMatch = (memoryProperties.memoryTypes[i].propertyFlags & wanted) == wanted;
+            if (!typeAllowed || !propertiesMatch) continue;
+            typeFound = true;
+            if (allocateFromType(i, requirements, kind, allocation)) return allocation;
+        }
+    }
+    throw std::runtime_error(typeFound ? "Failed to allocate device memory: out of memory!"
+                                       : "Failed to find suitable memory type!");
+}
+
+VkMemoryPropertyFlags DeviceAllocator::getPropertyFlags(const Allocation& allocation) const {
+    if (!allocation.isValid()) return 0;
+    return memoryProperties.memoryTypes[allocation.memoryType].propertyFlags;
+}
+
+bool DeviceAllocator::allocateFromType(uint32_t memoryType, const VkMemoryRequirements& requirements,
+                                       ResourceKind kind, Allocation& allocation) {
+    const uint32_t poolIndex = 2 * memoryType + (separateOptimal && kind == ResourceKind::Optimal ? 1 : 0);
+    Pool& pool = pools[poolIndex];
+    const VkDeviceSize size = alignUp(std::max<VkDeviceSize>(requirements.size, 1), GRANULE);
+    const VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, GRANULE);
+    const VkDeviceSize blockSize = blockSizeFor(memoryType);
+
+    allocation.memoryType = memoryType;
+    allocation.pool = poolIndex;
+    allocation.size = size;
+
+    // Large resources get their own memory rather than most of a block
+    if (size > blockSize / 2) {
+        std::unique_ptr<Block> block(new Block());
+        if (source->allocate(memoryType, size, block->memory) != VK_SUCCESS) return false;
+        block->size = size;
+        block->allocationCount = 1;
+        allocation.memory = block->memory;
+        allocation.offset = 0;
+        allocation.chunk = DEDICATED;
+        allocation.block = storeBlock(pool, std::move(block));
+        return true;
+    }
+
+    uint32_t chunk = 0;
+    VkDeviceSize offset = 0;
+    for (uint32_t b = 0; b < pool.blocks.size(); ++b) {
+        Block* block = pool.blocks[b].get();
+        if (!block || !block->ranges || !block->ranges->allocate(size, alignment, chunk, offset)) continue;
+        ++block->allocationCount;
+        allocation.memory = block->memory;
+        allocation.offset = offset;
+        allocation.block = b;
+        allocation.chunk = chunk;
+        return true;
+    }
+
+    // No room: add a block, smaller ones if the heap cannot fit a full one
+    for (VkDeviceSize newSize = blockSize; newSize >= size + alignment; newSize /= 2) {
+        std::unique_ptr<Block> block(new Block());
+        if (source->allocate(memoryType, newSize, block->memory) != VK_SUCCESS) continue;
+        block->size = newSize;
+        block->ranges.reset(new Tlsf(newSize));
+        block->ranges->allocate(size, alignment, chunk, offset);
+        block->allocationCount = 1;
+        allocation.memory = block->memory;
+        allocation.offset = offset;
+        allocation.chunk = chunk;
+        allocation.block = storeBlock(pool, std::move(block));
+        return true;
+    }
+    return false;
+}
+
+VkDeviceSize DeviceAllocator::blockSizeFor(uint32_t memoryType) const {
+    const VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryType].heapIndex].size;
+    if (heapSize <= (VkDeviceSize(1) << 30)) return std::max(alignUp(heapSize / 8, GRANULE), GRANULE);
+    return preferredBlockSize;
+}
+
+uint32_t DeviceAllocator::storeBlock(Pool& pool, std::unique_ptr<Block> block) {
+    for (uint32_t i = 0; i < pool.blocks.size(); ++i) {
+        if (!pool.blocks[i]) {
+            pool.blocks[i] = std::move(block);
+            return i;
+        }
+    }
+    pool.blocks.push_back(std::move(block));
+    return static_cast<uint32_t>(pool.blocks.size() - 1);
+}
+
+void DeviceAllocator::releaseBlock(Pool& pool, uint32_t index) {
+    Block& block = *pool.blocks[index];
+    if (block.mapCount > 0) source->unmap(block.memory);
+    source->free(block.memory);
+    pool.blocks[index].reset();
+}
+
+void DeviceAllocator::free(Allocation& allocation) {
+    if (!allocation.isValid()) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    Pool& pool = pools[allocation.pool];
+    Block& block = *pool.blocks[allocation.block];
+    --block.allocationCount;
+
+    if (allocation.chunk == DEDICATED) {
+        releaseBlock(pool, allocation.block);
+    } else {
+        block.ranges->free(allocation.chunk);
+        if (block.allocationCount == 0) {
+            // Keep one empty block around so a pool that drains and refills does not thrash
+            for (uint32_t b = 0; b < pool.blocks.size(); ++b) {
+                const Block* other = pool.blocks[b].get();
+                if (b != allocation.block && other && other->ranges && other->allocationCount == 0) {
+                    releaseBlock(pool, allocation.block);
+                    break;
+                }
+            }
+        }
+    }
+    allocation = Allocation();
+}
+
+void* DeviceAllocator::map(const Allocation& allocation) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Block& block = *pools[allocation.pool].blocks[allocation.block];
+    if (block.mapCount == 0 && source->map(block.memory, block.mapped) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to map device memory!");
+    }
+    ++block.mapCount;
+    return static_cast<char*>(block.mapped) + allocation.offset;
+}
+
+void DeviceAllocator::unmap(const Allocation& allocation) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Block& block = *pools[allocation.pool].blocks[allocation.block];
+    if (block.mapCount > 0 && --block.mapCount == 0) {
+        source->unmap(block.memory);
+        block.mapped = nullptr;
+    }
+}
+
+std::vector<DeviceAllocator::HeapStats> DeviceAllocator::getHeapStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<HeapStats> stats(memoryProperties.memoryHeapCount);
+    for (uint32_t h = 0; h < memoryProperties.memoryHeapCount; ++h) stats[h].heapSize = memoryProperties.memoryHeaps[h].size;
+    for (const Pool& pool : pools) {
+        HeapStats& heap = stats[memoryProperties.memoryTypes[pool.memoryType].heapIndex];
+        for (const std::unique_ptr<Block>& block : pool.blocks) {
+            if (!block) continue;
+            heap.blockBytes += block->size;
+            ++heap.blockCount;
+            heap.allocationCount += block->allocationCount;
+            heap.usedBytes += block->ranges ? block->ranges->usedBytes() : block->size;
+        }
+    }
+    return stats;
+}
+
+void DeviceAllocator::printStats(std::ostream& out) const {
+    const std::vector<HeapStats> stats = getHeapStats();
+    constexpr double MIB = 1024.0 * 1024.0;
+    for (size_t h = 0; h < stats.size(); ++h) {
+        const HeapStats& heap = stats[h];
+        if (heap.blockCount == 0) continue;
+        out << "Device memory heap " << h << " (" << heap.heapSize / MIB << " MiB): "
+            << heap.usedBytes / MIB << " MiB used by " << heap.allocationCount << " allocations in "
+            << heap.blockBytes / MIB << " MiB of " << heap.blockCount << " blocks" << std::endl;
+    }
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief Sub-allocates buffer and image memory from large VkDeviceMemory blocks.
+ *
+ * Every vkAllocateMemory is slow and drivers cap how many may exist at once
+ * (maxMemoryAllocationCount, often 4096), so one allocation per resource does not
+ * scale to thousands of meshes. Instead every memory type has a pool of blocks
+ * (blockSize, or 1/8 of a heap of 1 GiB or less), and each resource gets an aligned
+ * range of a block from a TLSF (two-level segregated fit) allocator: free ranges are
+ * binned by size class, a fitting one is found in constant time through two bitmaps,
+ * split on allocation and merged with its free neighbours on release.
+ *
+ * When bufferImageGranularity is above 1, linear resources (buffers, linear images)
+ * and optimal-tiling images come from separate blocks, so they never share a
+ * granularity page. Resources larger than half a block get a dedicated allocation.
+ * A pool keeps at most one empty block for reuse and returns the others to the driver.
+ *
+ * A block is mapped while any of its allocations is mapped. getHeapStats() reports
+ * the reserved and used bytes of every heap.
+ *
+ * All Vulkan memory calls go through a BlockSource, so the allocator can run on a
+ * mock memory-type table with fake blocks, without a GPU.
+ *
+ * Keywords: Memory Sub-Allocation, TLSF, vkAllocateMemory, Memory Pools, bufferImageGranularity
+ */
+class DeviceAllocator {
+public:
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = VkDeviceSize(64) << 20;
+
+    enum class ResourceKind {
+        Linear, // Buffers and linear-tiling images
+        Optimal // Optimal-tiling images
+    };
+
+    /**
+     * @brief A range of device memory backing one resource.
+     */
+    struct Allocation {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0; // Where the resource is bound within memory
+        VkDeviceSize size = 0;
+        uint32_t memoryType = 0;
+        uint32_t pool = 0;       // Where the range came from, for free()
+        uint32_t block = 0;
+        uint32_t chunk = 0;
+
+        bool isValid() const { return memory != VK_NULL_HANDLE; }
+    };
+
+    /**
+     * @brief Usage of one memory heap.
+     */
+    struct HeapStats {
+        VkDeviceSize heapSize = 0;
+        VkDeviceSize blockBytes = 0;  // Reserved with vkAllocateMemory
+        VkDeviceSize usedBytes = 0;   // Handed out to resources (including alignment)
+        uint32_t blockCount = 0;      // Live VkDeviceMemory objects, dedicated ones included
+        uint32_t allocationCount = 0;
+    };
+
+    /**
+     * @brief Allocates, frees and maps whole blocks (vkAllocateMemory and friends, or a mock).
+     */
+    class BlockSource {
+    public:
+        virtual ~BlockSource() = default;
+        virtual VkResult allocate(uint32_t memoryType, VkDeviceSize size, VkDeviceMemory& memory) = 0;
+        virtual void free(VkDeviceMemory memory) = 0;
+        virtual VkResult map(VkDeviceMemory memory, void*& data) = 0;
+        virtual void unmap(VkDeviceMemory memory) = 0;
+    };
+
+    DeviceAllocator();
+    ~DeviceAllocator();
+
+    DeviceAllocator(const DeviceAllocator&) = delete;
+    DeviceAllocator& operator=(const DeviceAllocator&) = delete;
+
+    /**
+     * @brief Sets the allocator up for a device.
+     */
+    void create(VkPhysicalDevice physicalDevice, VkDevice device);
+
+    /**
+     * @brief Sets the allocator up for a memory-type table and block source (tests use a mock of both).
+     */
+    void create(const VkPhysicalDeviceMemoryProperties& properties, VkDeviceSize bufferImageGranularity,
+                std::unique_ptr<BlockSource> source, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+
+    /**
+     * @brief Frees every block. Allocations still alive are reported as leaks.
+     */
+    void destroy();
+
+    /**
+     * @brief Allocates memory for a resource.
+     * @param requirements From vkGet{Buffer,Image}MemoryRequirements.
+     * @param properties Required memory properties; the first matching type with room is used.
+     * @param kind Whether the resource is linear or an optimal-tiling image.
+     * @param preferredProperties Properties to have as well if a type with room offers them.
+     * Throws std::runtime_error if no memory type fits or they are all out of memory.
+     */
+    Allocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+                        ResourceKind kind, VkMemoryPropertyFlags preferredProperties = 0);
+
+    /**
+     * @brief Returns an allocation's range to its block and resets it (no-op if invalid).
+     */
+    void free(Allocation& allocation);
+
+    /**
+     * @brief Maps a host-visible allocation and returns a pointer to its first byte.
+     */
+    void* map(const Allocation& allocation);
+    void unmap(const Allocation& allocation);
+
+    /**
+     * @brief Usage per memory heap, indexed like VkPhysicalDeviceMemoryProperties::memoryHeaps.
+     */
+    std::vector<HeapStats> getHeapStats() const;
+
+    /**
+     * @brief Prints one line per heap in use.
+     */
+    void printStats(std::ostream& out) const;
+
+    /**
+     * @brief Properties of the memory type an allocation came from (0 if invalid).
+     */
+    VkMemoryPropertyFlags getPropertyFlags(const Allocation& allocation) const;
+
+    const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const { return memoryProperties; }
+    VkDevice getDevice() const { return device; }
+
+private:
+    class Tlsf; // Free-range bookkeeping of one block (DeviceAllocator.cpp)
+
+    struct Block {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        std::unique_ptr<Tlsf> ranges; // Null for a dedicated allocation
+        void* mapped = nullptr;
+        uint32_t mapCount = 0;
+        uint32_t allocationCount = 0;
+
+        Block();
+        ~Block();
+    };
+
+    struct Pool {
+        uint32_t memoryType = 0;
+        std::vector<std::unique_ptr<Block>> blocks; // Freed blocks leave a null slot, reused later
+    };
+
+    VkDevice device = VK_NULL_HANDLE;
+    std::unique_ptr<BlockSource> source;
+    VkPhysicalDeviceMemoryProperties memoryProperties{};
+    bool separateOptimal = false; // bufferImageGranularity > 1
+    VkDeviceSize preferredBlockSize = DEFAULT_BLOCK_SIZE;
+    std::vector<Pool> pools;      // Two per memory type: linear, then optimal (when separated)
+    mutable std::mutex mutex;
+
+    bool allocateFromType(uint32_t memoryType, const VkMemoryRequirements& requirements, ResourceKind kind,
+                          Allocation& allocation);
+    VkDeviceSize blockSizeFor(uint32_t memoryType) const;
+    uint32_t storeBlock(Pool& pool, std::unique_ptr<Block> block);
+    void releaseBlock(Pool& pool, uint32_t index);
+};
@@ -0,0 +1,123 @@
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+FrameScheduler::~FrameScheduler() {
+    destroy();
+}
+
+void FrameScheduler::create(VkDevice deviceHandle, bool useTimeline, uint32_t count) {
+    destroy();
+    device = deviceHandle;
+    framesInFlight = std::clamp<uint32_t>(count, 1, MAX_FRAMES_IN_FLIGHT);
+    frameNumber = 0;
+    indexBase = 0;
+    completedFrames = 0;
+
+    if (useTimeline) {
+        // Counter = number of completed frames
+        VkSemaphoreTypeCreateInfo typeInfo{};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &typeInfo;
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &timeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create frame timeline semaphore!");
+        }
+        return;
+    }
+
+    // Unsignalled: a fence is reset again right before each submission that uses it
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    for (VkFence& fence : fences) {
+        if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create frame fence!");
+        }
+    }
+}
+
+void FrameScheduler::destroy() {
+    if (device == VK_NULL_HANDLE) return;
+
+    waitIdle();
+    if (timeline != VK_NULL_HANDLE) vkDestroySemaphore(device, timeline, nullptr);
+    for (VkFence& fence : fences) {
+        if (fence != VK_NULL_HANDLE) vkDestroyFence(device, fence, nullptr);
+        fence = VK_NULL_HANDLE;
+    }
+    timeline = VK_NULL_HANDLE;
+    device = VK_NULL_HANDLE;
+}
+
+void FrameScheduler::setFramesInFlight(uint32_t count) {
+    count = std::clamp<uint32_t>(count, 1, MAX_FRAMES_IN_FLIGHT);
+    if (count == framesInFlight) return;
+    waitIdle();
+    framesInFlight = count;
+    indexBase = frameNumber;
+}
+
+void FrameScheduler::beginFrame() {
+    // Frame N reuses the resources of frame N - framesInFlight
+    if (frameNumber - indexBase >= framesInFlight) waitRetired(frameNumber - framesInFlight);
+}
+
+VkFence FrameScheduler::acquireFence() {
+    if (timeline != VK_NULL_HANDLE) return VK_NULL_HANDLE;
+    // Last used by frame N - MAX_FRAMES_IN_FLIGHT, which beginFrame() saw retire
+    VkFence fence = fences[frameNumber % MAX_FRAMES_IN_FLIGHT];
+    vkResetFences(device, 1, &fence);
+    return fence;
+}
+
+void FrameScheduler::endFrame() {
+    ++frameNumber;
+}
+
+bool FrameScheduler::isRetired(uint64_t frame) {
+    return frame < getCompletedFrames();
+}
+
+uint64_t FrameScheduler::getCompletedFrames() {
+    if (timeline != VK_NULL_HANDLE) {
+        uint64_t value = 0;
+        if (vkGetSemaphoreCounterValue(device, timeline, &value) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to query frame timeline!");
+        }
+        return value;
+    }
+
+    // Frames complete in submission order on the graphics queue
+    while (completedFrames < frameNumber &&
+           vkGetFenceStatus(device, fences[completedFrames % MAX_FRAMES_IN_FLIGHT]) == VK_SUCCESS) {
+        ++completedFrames;
+    }
+    return completedFrames;
+}
+
+void FrameScheduler::waitRetired(uint64_t frame) {
+    if (frame >= frameNumber) return; // Never submitted
+
+    if (timeline != VK_NULL_HANDLE) {
+        const uint64_t value = frame + 1;
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &timeline;
+        waitInfo.pValues = &value;
+        vkWaitSemaphores(device, &waitInfo, UINT64_MAX);
+        return;
+    }
+
+    if (frame < completedFrames) return;
+    vkWaitForFences(device, 1, &fences[frame % MAX_FRAMES_IN_FLIGHT], VK_TRUE, UINT64_MAX);
+    completedFrames = frame + 1;
+}
+
+void FrameScheduler::waitIdle() {
+    if (frameNumber > 0) waitRetired(frameNumber - 1);
+}
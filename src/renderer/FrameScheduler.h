@@ -0,0 +1,113 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Paces the frame loop and tracks which frames have retired on the GPU.
+ *
+ * Frames are numbered 0, 1, 2, ... in submission order. Every frame's graphics
+ * submission signals one timeline semaphore with its number + 1, so the counter
+ * value is the number of frames that have completed: frame N has retired once it
+ * reaches N + 1. beginFrame() lets the CPU run at most framesInFlight frames ahead
+ * by waiting for frame N - framesInFlight before frame N is recorded; per-frame
+ * resources are indexed with getFrameIndex().
+ *
+ * Without timeline semaphores each submission gets a fence instead, taken from a
+ * ring of MAX_FRAMES_IN_FLIGHT so the count can change without recreating them.
+ * Fences are polled in submission order, giving the same answers.
+ *
+ * isRetired() and getCompletedFrames() never block, so subsystems can recycle
+ * memory as soon as the last frame using it has finished rather than a fixed
+ * number of frames later.
+ *
+ * Keywords: Frame Pacing, Frames In Flight, Timeline Semaphore, Frame Retirement
+ */
+class FrameScheduler {
+public:
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+    FrameScheduler() = default;
+    ~FrameScheduler();
+
+    FrameScheduler(const FrameScheduler&) = delete;
+    FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+    /**
+     * @brief Creates the timeline semaphore (or the fence ring).
+     * @param device Logical device.
+     * @param useTimeline Use a timeline semaphore (the timelineSemaphore feature must be enabled).
+     * @param framesInFlight Frames the CPU may run ahead of the GPU (clamped to 1..MAX_FRAMES_IN_FLIGHT).
+     */
+    void create(VkDevice device, bool useTimeline, uint32_t framesInFlight);
+
+    /**
+     * @brief Waits for the submitted frames and destroys the semaphore or fences.
+     */
+    void destroy();
+
+    /**
+     * @brief Changes the number of frames in flight.
+     *
+     * Waits for every submitted frame first, so frame indices restart at 0 and the
+     * caller can resize its per-frame resources right after.
+     */
+    void setFramesInFlight(uint32_t count);
+
+    /**
+     * @brief Waits until the frame about to be recorded may reuse its per-frame resources.
+     */
+    void beginFrame();
+
+    /**
+     * @brief Semaphore and value the frame's submission must signal (null without timelines).
+     */
+    VkSemaphore getTimeline() const { return timeline; }
+    uint64_t getSignalValue() const { return frameNumber + 1; }
+
+    /**
+     * @brief Fence the frame's submission must signal (null with a timeline). Already reset.
+     */
+    VkFence acquireFence();
+
+    /**
+     * @brief Marks the frame as submitted and moves on to the next one.
+     */
+    void endFrame();
+
+    /**
+     * @brief Whether frame `frame` (and every earlier one) has completed on the GPU. Never blocks.
+     */
+    bool isRetired(uint64_t frame);
+
+    /**
+     * @brief Number of frames known to have completed (frames 0 .. count-1). Never blocks.
+     */
+    uint64_t getCompletedFrames();
+
+    /**
+     * @brief Blocks until frame `frame` has completed (returns at once if it was never submitted).
+     */
+    void waitRetired(uint64_t frame);
+
+    /**
+     * @brief Blocks until every submitted frame has completed.
+     */
+    void waitIdle();
+
+    uint64_t getFrameNumber() const { return frameNumber; }
+    uint32_t getFrameIndex() const { return static_cast<uint32_t>((frameNumber - indexBase) % framesInFlight); }
+    uint32_t getFramesInFlight() const { return framesInFlight; }
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    VkSemaphore timeline = VK_NULL_HANDLE;
+    std::array<VkFence, MAX_FRAMES_IN_FLIGHT> fences{}; // Fence of frame N is fences[N % MAX_FRAMES_IN_FLIGHT]
+    uint32_t framesInFlight = 2;
+    uint64_t frameNumber = 0;     // Frame being recorded; also the number of frames submitted
+    uint64_t indexBase = 0;       // First frame since the last count change (frame indices start there)
+    uint64_t completedFrames = 0; // Frames known to have completed (fence path)
+};
@@ -0,0 +1,109 @@
+#include "GpuMeshStreamSink.h"
+#include "VulkanUtils.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+// Each ring gets at least this much so a block always holds a useful span
+constexpr VkDeviceSize MIN_RING_BYTES = 64 * 1024;
+}
+
+GpuMeshStreamSink::GpuMeshStreamSink(DeviceAllocator& memoryAllocator, VkCommandPool pool, VkQueue uploadQueue)
+    : allocator(memoryAllocator), commandPool(pool), queue(uploadQueue) {}
+
+GpuMeshStreamSink::~GpuMeshStreamSink() {
+    vertexRing.destroy();
+    indexRing.destroy();
+    // Buffers that were never released (import failed) are destroyed here
+    VulkanUtils::destroyBuffer(allocator, vertexBuffer, vertexBufferMemory);
+    VulkanUtils::destroyBuffer(allocator, indexBuffer, indexBufferMemory);
+}
+
+void GpuMeshStreamSink::begin(size_t vertexCount, size_t indexCount, size_t stagingBudget) {
+    if (vertexCount == 0 || indexCount == 0) {
+        throw std::runtime_error("Cannot stream an empty mesh!");
+    }
+    indexTotal = indexCount;
+
+    // 1. Final device-local buffers at their exact sizes
+    VulkanUtils::createBuffer(allocator, sizeof(Vertex) * vertexCount,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        vertexBuffer, vertexBufferMemory);
+    VulkanUtils::createBuffer(allocator, sizeof(uint32_t) * indexCount,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        indexBuffer, indexBufferMemory);
+
+    // 2. Split the staging budget by how many bytes each stream carries
+    const double vertexBytes = static_cast<double>(sizeof(Vertex) * vertexCount);
+    const double indexBytes = static_cast<double>(sizeof(uint32_t) * indexCount);
+    VkDeviceSize vertexRingBytes = static_cast<VkDeviceSize>(stagingBudget * (vertexBytes / (vertexBytes + indexBytes)));
+    VkDeviceSize indexRingBytes = stagingBudget > vertexRingBytes ? stagingBudget - vertexRingBytes : 0;
+
+    // No point in staging more than the stream itself
+    vertexRingBytes = std::min<VkDeviceSize>(std::max(vertexRingBytes, MIN_RING_BYTES), static_cast<VkDeviceSize>(vertexBytes) + MIN_RING_BYTES);
+    indexRingBytes = std::min<VkDeviceSize>(std::max(indexRingBytes, MIN_RING_BYTES), static_cast<VkDeviceSize>(indexBytes) + MIN_RING_BYTES);
+
+    vertexRing.create(allocator, commandPool, queue, vertexRingBytes);
+    indexRing.create(allocator, commandPool, queue, indexRingBytes);
+    peakStagingBytes = static_cast<size_t>(vertexRing.size() + indexRing.size());
+}
+
+Vertex* GpuMeshStreamSink::acquireVertices(size_t maxCount, size_t& count) {
+    VkDeviceSize granted = 0;
+    void* span = vertexRing.acquire(sizeof(Vertex), sizeof(Vertex) * maxCount, alignof(Vertex), granted);
+    count = static_cast<size_t>(granted / sizeof(Vertex));
+    return static_cast<Vertex*>(span);
+}
+
+void GpuMeshStreamSink::commitVertices(size_t count) {
+    vertexRing.commit(sizeof(Vertex) * count, vertexBuffer, sizeof(Vertex) * verticesWritten);
+    verticesWritten += count;
+}
+
+uint32_t* GpuMeshStreamSink::acquireIndices(size_t maxCount, size_t& count) {
+    VkDeviceSize granted = 0;
+    void* span = indexRing.acquire(sizeof(uint32_t), sizeof(uint32_t) * maxCount, alignof(uint32_t), granted);
+    count = static_cast<size_t>(granted / sizeof(uint32_t));
+    return static_cast<uint32_t*>(span);
+}
+
+void GpuMeshStreamSink::commitIndices(size_t count) {
+    indexRing.commit(sizeof(uint32_t) * count, indexBuffer, sizeof(uint32_t) * indicesWritten);
+    indicesWritten += count;
+}
+
+void GpuMeshStreamSink::finish() {
+    vertexRing.finish();
+    indexRing.finish();
+
+    std::cout << "Streamed upload: " << vertexRing.getSubmitCount() + indexRing.getSubmitCount()
+              << " staging submits, " << vertexRing.getStallCount() + indexRing.getStallCount()
+              << " stalls" << std::endl;
+
+    // Staging memory is no longer needed once the copies have landed
+    vertexRing.destroy();
+    indexRing.destroy();
+}
+
+size_t GpuMeshStreamSink::stagingBytes() const {
+    return peakStagingBytes;
+}
+
+void GpuMeshStreamSink::release(VkBuffer& outVertexBuffer, DeviceAllocator::Allocation& outVertexMemory,
+                                VkBuffer& outIndexBuffer, DeviceAllocator::Allocation& outIndexMemory,
+                                uint32_t& outIndexCount) {
+    outVertexBuffer = vertexBuffer;
+    outVertexMemory = vertexBufferMemory;
+    outIndexBuffer = indexBuffer;
+    outIndexMemory = indexBufferMemory;
+    outIndexCount = static_cast<uint32_t>(indexTotal);
+
+    vertexBuffer = VK_NULL_HANDLE;
+    vertexBufferMemory = DeviceAllocator::Allocation();
+    indexBuffer = VK_NULL_HANDLE;
+    indexBufferMemory = DeviceAllocator::Allocation();
+}
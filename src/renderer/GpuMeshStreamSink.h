@@ -0,0 +1,52 @@
+#pragma once
+
+#include "StagingRing.h"
+#include "../objects/geometry/MeshStreamSink.h"
+
+/**
+ * @brief MeshStreamSink that streams vertices and indices into device-local buffers.
+ *
+ * begin() creates the final vertex and index buffers at their exact sizes plus one
+ * StagingRing per stream, splitting the staging budget by element size. Spans
+ * handed to the importer point straight into the persistently mapped rings, and
+ * full ring blocks are copied to the device-local buffers while parsing continues.
+ * After finish() the buffers are handed to the engine with release().
+ *
+ * Keywords: Streaming Upload, Staging Ring, Device Local Memory, Zero-Copy Import
+ */
+class GpuMeshStreamSink : public MeshStreamSink {
+public:
+    GpuMeshStreamSink(DeviceAllocator& allocator, VkCommandPool commandPool, VkQueue queue);
+    ~GpuMeshStreamSink() override;
+
+    void begin(size_t vertexCount, size_t indexCount, size_t stagingBudget) override;
+    Vertex* acquireVertices(size_t maxCount, size_t& count) override;
+    void commitVertices(size_t count) override;
+    uint32_t* acquireIndices(size_t maxCount, size_t& count) override;
+    void commitIndices(size_t count) override;
+    void finish() override;
+    size_t stagingBytes() const override;
+
+    /**
+     * @brief Transfers ownership of the filled buffers to the caller.
+     */
+    void release(VkBuffer& outVertexBuffer, DeviceAllocator::Allocation& outVertexMemory,
+                 VkBuffer& outIndexBuffer, DeviceAllocator::Allocation& outIndexMemory, uint32_t& outIndexCount);
+
+private:
+    DeviceAllocator& allocator;
+    VkCommandPool commandPool;
+    VkQueue queue;
+
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;
+    DeviceAllocator::Allocation vertexBufferMemory;
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    DeviceAllocator::Allocation indexBufferMemory;
+
+    StagingRing vertexRing;
+    StagingRing indexRing;
+    size_t verticesWritten = 0;
+    size_t indicesWritten = 0;
+    size_t indexTotal = 0;
+    size_t peakStagingBytes = 0;
+};
@@ -0,0 +1,71 @@
+#include "GpuTimer.h"
+
+#include <stdexcept>
+
+GpuTimer::~GpuTimer() {
+    destroy();
+}
+
+void GpuTimer::create(VkPhysicalDevice physicalDevice, VkDevice deviceHandle, uint32_t queueFamily,
+                      uint32_t framesInFlight, uint32_t timestampsPerFrame) {
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+    const uint32_t validBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0;
+    if (validBits == 0 || timestampsPerFrame < 2) return; // Timing stays disabled
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    nanosecondsPerTick = properties.limits.timestampPeriod;
+    validMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = framesInFlight * timestampsPerFrame;
+    if (vkCreateQueryPool(deviceHandle, &poolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create timestamp query pool!");
+    }
+    device = deviceHandle;
+    queriesPerFrame = timestampsPerFrame;
+    pending.assign(framesInFlight, false);
+}
+
+void GpuTimer::destroy() {
+    if (queryPool != VK_NULL_HANDLE) vkDestroyQueryPool(device, queryPool, nullptr);
+    queryPool = VK_NULL_HANDLE;
+    device = VK_NULL_HANDLE;
+    pending.clear();
+}
+
+void GpuTimer::reset(VkCommandBuffer commandBuffer, uint32_t frame) {
+    if (!isEnabled()) return;
+    vkCmdResetQueryPool(commandBuffer, queryPool, frame * queriesPerFrame, queriesPerFrame);
+    pending[frame] = true;
+}
+
+void GpuTimer::write(VkCommandBuffer commandBuffer, uint32_t frame, uint32_t index, VkPipelineStageFlagBits stage) {
+    if (!isEnabled()) return;
+    vkCmdWriteTimestamp(commandBuffer, stage, queryPool, frame * queriesPerFrame + index);
+}
+
+bool GpuTimer::collect(uint32_t frame, std::vector<double>& intervalsMs) {
+    if (!isEnabled() || !pending[frame]) return false;
+    pending[frame] = false;
+
+    std::vector<uint64_t> ticks(queriesPerFrame);
+    // The frame's fence has signalled, so the results are available without waiting
+    if (vkGetQueryPoolResults(device, queryPool, frame * queriesPerFrame, queriesPerFrame,
+                              ticks.size() * sizeof(uint64_t), ticks.data(), sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+        return false;
+    }
+
+    intervalsMs.resize(queriesPerFrame - 1);
+    for (uint32_t i = 0; i + 1 < queriesPerFrame; ++i) {
+        const uint64_t elapsed = ((ticks[i + 1] & validMask) - (ticks[i] & validMask)) & validMask;
+        intervalsMs[i] = static_cast<double>(elapsed) * nanosecondsPerTick * 1e-6;
+    }
+    return true;
+}
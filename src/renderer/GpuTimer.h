@@ -0,0 +1,74 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Measures GPU time between timestamps written into each frame's command buffer.
+ *
+ * Every frame in flight owns a slice of one timestamp query pool. The slice is
+ * reset at the start of the frame's command buffer, timestamps are written at
+ * points of interest, and once the frame's fence has signalled, collect() returns
+ * the time between consecutive timestamps. Frames never wait on query results.
+ *
+ * If the graphics queue has no timestamp support, or the timer was never
+ * created, every call does nothing. It can therefore stay in the frame loop.
+ *
+ * Keywords: GPU Timing, Timestamp Queries, vkCmdWriteTimestamp, Benchmarking
+ */
+class GpuTimer {
+public:
+    GpuTimer() = default;
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    /**
+     * @brief Creates the query pool, if the queue family supports timestamps.
+     * @param queueFamily Family of the queue the timed command buffers are submitted to.
+     * @param framesInFlight Number of frames in flight (one slice of queries each).
+     * @param timestampsPerFrame Timestamps written per frame (all of them, every frame).
+     */
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t framesInFlight,
+                uint32_t timestampsPerFrame);
+
+    /**
+     * @brief Destroys the query pool. The device must be idle.
+     */
+    void destroy();
+
+    /**
+     * @brief Whether timestamps are recorded.
+     */
+    bool isEnabled() const { return queryPool != VK_NULL_HANDLE; }
+
+    /**
+     * @brief Resets the frame's queries (outside a render pass, before any write()).
+     */
+    void reset(VkCommandBuffer commandBuffer, uint32_t frame);
+
+    /**
+     * @brief Writes timestamp `index` of the frame once `stage` has completed for prior commands.
+     */
+    void write(VkCommandBuffer commandBuffer, uint32_t frame, uint32_t index, VkPipelineStageFlagBits stage);
+
+    /**
+     * @brief Reads the frame's timestamps; call after its fence has signalled.
+     * @param frame Frame in flight whose command buffer has completed.
+     * @param intervalsMs Receives timestampsPerFrame - 1 durations, in milliseconds.
+     * @return False if disabled or the frame has not recorded timestamps since its last collect().
+     */
+    bool collect(uint32_t frame, std::vector<double>& intervalsMs);
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    uint32_t queriesPerFrame = 0;
+    double nanosecondsPerTick = 1.0;   // VkPhysicalDeviceLimits::timestampPeriod
+    uint64_t validMask = ~0ull;        // Timestamp bits the queue actually writes
+    std::vector<bool> pending;         // Per frame: reset and written, not yet collected
+};
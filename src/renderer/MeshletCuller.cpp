@@ -0,0 +1,302 @@
+#include "MeshletCuller.h"
+#include "VulkanUtils.h"
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Must match local_size_x in shaders/meshlet_cull.comp
+constexpr uint32_t WORKGROUP_SIZE = 64;
+
+} // namespace
+
+MeshletCuller::~MeshletCuller() {
+    destroy();
+}
+
+void MeshletCuller::create(DeviceAllocator& memoryAllocator, bool gpuCulling, uint32_t maxDrawIndirectCount,
+                           uint32_t framesInFlight, const std::string& shaderPath) {
+    allocator = &memoryAllocator;
+    device = memoryAllocator.getDevice();
+    gpuSupported = gpuCulling;
+    maxDrawCount = maxDrawIndirectCount;
+    frames.assign(framesInFlight, FrameData{});
+    if (!gpuSupported) return; // CPU path needs no Vulkan objects
+
+    // --- Descriptor set layout: meshlet records (read) and draw commands (write) ---
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create meshlet culling descriptor set layout!");
+    }
+
+    // --- Pipeline layout: the set plus the per-frame parameters as push constants ---
+    VkPushConstantRange pushRange{};
+    pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(CullParams);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create meshlet culling pipeline layout!");
+    }
+
+    // --- Compute pipeline ---
+    auto shaderCode = VulkanUtils::readFile(shaderPath);
+    VkShaderModule shaderModule = VulkanUtils::createShaderModule(device, shaderCode);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = pipelineLayout;
+    VkResult result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create meshlet culling pipeline!");
+    }
+
+    createFrames(framesInFlight);
+}
+
+void MeshletCuller::setFramesInFlight(uint32_t framesInFlight) {
+    if (device == VK_NULL_HANDLE || framesInFlight == frames.size()) return;
+    for (FrameData& frame : frames) {
+        VulkanUtils::destroyBuffer(*allocator, frame.drawBuffer, frame.drawMemory);
+    }
+    if (descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    descriptorPool = VK_NULL_HANDLE;
+
+    frames.assign(framesInFlight, FrameData{});
+    if (gpuSupported) createFrames(framesInFlight);
+    createDrawBuffers();
+}
+
+void MeshletCuller::createFrames(uint32_t framesInFlight) {
+    // --- One descriptor set per frame in flight ---
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 2 * framesInFlight;
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = framesInFlight;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create meshlet culling descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(framesInFlight, setLayout);
+    std::vector<VkDescriptorSet> sets(framesInFlight);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = framesInFlight;
+    allocInfo.pSetLayouts = layouts.data();
+    if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate meshlet culling descriptor sets!");
+    }
+    for (uint32_t i = 0; i < framesInFlight; ++i) {
+        frames[i].descriptorSet = sets[i];
+    }
+}
+
+void MeshletCuller::destroy() {
+    if (device == VK_NULL_HANDLE) return;
+
+    for (FrameData& frame : frames) {
+        VulkanUtils::destroyBuffer(*allocator, frame.drawBuffer, frame.drawMemory);
+    }
+    frames.clear();
+    VulkanUtils::destroyBuffer(*allocator, meshletBuffer, meshletMemory);
+    meshlets.clear();
+
+    // Descriptor sets are freed with their pool
+    if (descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    if (pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, pipeline, nullptr);
+    if (pipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    if (setLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+    descriptorPool = VK_NULL_HANDLE;
+    pipeline = VK_NULL_HANDLE;
+    pipelineLayout = VK_NULL_HANDLE;
+    setLayout = VK_NULL_HANDLE;
+    allocator = nullptr;
+    device = VK_NULL_HANDLE;
+}
+
+void MeshletCuller::setMeshlets(std::vector<MeshletCullData> newMeshlets, VkBuffer newMeshletBuffer,
+                                const DeviceAllocator::Allocation& newMeshletMemory, DeletionQueue& deletionQueue,
+                                uint64_t retireFrame) {
+    // Frames in flight may still read the old buffers
+    DeviceAllocator* memoryAllocator = allocator;
+    std::vector<std::pair<VkBuffer, DeviceAllocator::Allocation>> retired = {{meshletBuffer, meshletMemory}};
+    for (FrameData& frame : frames) {
+        retired.push_back({frame.drawBuffer, frame.drawMemory});
+        frame.drawBuffer = VK_NULL_HANDLE;
+        frame.drawMemory = DeviceAllocator::Allocation();
+        frame.cpuDraws.clear();
+    }
+    deletionQueue.push(retireFrame, [memoryAllocator, retired]() mutable {
+        for (auto& buffer : retired) {
+            VulkanUtils::destroyBuffer(*memoryAllocator, buffer.first, buffer.second);
+        }
+    });
+
+    meshlets = std::move(newMeshlets);
+    meshletBuffer = newMeshletBuffer;
+    meshletMemory = newMeshletMemory;
+    ++generation;
+
+    createDrawBuffers();
+}
+
+void MeshletCuller::createDrawBuffers() {
+    // Indirect command buffers: written by the compute pass, read by the draw
+    if (!usesGpu()) return;
+    const VkDeviceSize drawBytes = sizeof(VkDrawIndexedIndirectCommand) * meshlets.size();
+    for (FrameData& frame : frames) {
+        VulkanUtils::createBuffer(*allocator, drawBytes,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            frame.drawBuffer, frame.drawMemory);
+    }
+}
+
+bool MeshletCuller::usesGpu() const {
+    return gpuSupported && meshletBuffer != VK_NULL_HANDLE && !meshlets.empty() && meshlets.size() <= maxDrawCount;
+}
+
+MeshletCuller::CullParams MeshletCuller::computeParams(const glm::mat4& modelViewProj, const glm::mat4& modelView) const {
+    CullParams params{};
+
+    // Planes from the rows of the model-to-clip matrix (Gribb/Hartmann), for Vulkan's 0..w depth
+    auto row = [&](int i) { return glm::vec4(modelViewProj[0][i], modelViewProj[1][i], modelViewProj[2][i], modelViewProj[3][i]); };
+    params.planes[0] = row(3) + row(0); // Left
+    params.planes[1] = row(3) - row(0); // Right
+    params.planes[2] = row(3) + row(1); // Top/bottom (swapped by Vulkan's Y flip,
+    params.planes[3] = row(3) - row(1); // which does not matter for culling)
+    params.planes[4] = row(2);          // Near
+    params.planes[5] = row(3) - row(2); // Far
+    for (glm::vec4& plane : params.planes) {
+        const float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) plane = plane * (1.0f / length);
+    }
+
+    params.cameraPosition = glm::inverse(modelView) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    params.meshletCount = static_cast<uint32_t>(meshlets.size());
+    return params;
+}
+
+std::vector<MeshletCullData> MeshletCuller::makeCullData(const std::vector<Meshlet>& meshlets,
+                                                        const std::vector<MeshletBounds>& bounds,
+                                                        const std::vector<int32_t>& vertexOffsets) {
+    std::vector<MeshletCullData> data(meshlets.size());
+    for (size_t i = 0; i < meshlets.size(); ++i) {
+        data[i].bounds = bounds[i];
+        data[i].firstIndex = 3 * meshlets[i].triangleOffset;
+        data[i].indexCount = 3 * meshlets[i].triangleCount;
+        data[i].vertexOffset = i < vertexOffsets.size() ? vertexOffsets[i] : 0;
+    }
+    return data;
+}
+
+bool MeshletCuller::isVisible(const MeshletBounds& bounds, const CullParams& params) {
+    for (const glm::vec4& plane : params.planes) {
+        if (glm::dot(glm::vec3(plane), bounds.center) + plane.w <= -bounds.radius) return false;
+    }
+    const glm::vec3 offset = bounds.center - glm::vec3(params.cameraPosition);
+    return glm::dot(offset, bounds.coneAxis) < bounds.coneCutoff * glm::length(offset) + bounds.radius;
+}
+
+void MeshletCuller::recordCull(VkCommandBuffer commandBuffer, uint32_t frameIndex, const CullParams& params) {
+    FrameData& frame = frames[frameIndex];
+
+    if (!usesGpu()) {
+        // CPU path: merge consecutive visible meshlets (with the same base vertex) into index ranges
+        frame.cpuDraws.clear();
+        cpuVisibleCount = 0;
+        for (const MeshletCullData& meshlet : meshlets) {
+            if (!isVisible(meshlet.bounds, params)) continue;
+            ++cpuVisibleCount;
+            if (!frame.cpuDraws.empty() &&
+                frame.cpuDraws.back().firstIndex + frame.cpuDraws.back().indexCount == meshlet.firstIndex &&
+                frame.cpuDraws.back().vertexOffset == meshlet.vertexOffset) {
+                frame.cpuDraws.back().indexCount += meshlet.indexCount;
+            } else {
+                frame.cpuDraws.push_back({meshlet.indexCount, 1, meshlet.firstIndex, meshlet.vertexOffset, 0});
+            }
+        }
+        return;
+    }
+
+    if (frame.boundGeneration != generation) updateDescriptorSet(frame);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1,
+                            &frame.descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullParams), &params);
+    vkCmdDispatch(commandBuffer, (params.meshletCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    // The draw reads the commands the dispatch wrote
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = frame.drawBuffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                         0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void MeshletCuller::recordDraw(VkCommandBuffer commandBuffer, uint32_t frameIndex) const {
+    const FrameData& frame = frames[frameIndex];
+    if (usesGpu()) {
+        vkCmdDrawIndexedIndirect(commandBuffer, frame.drawBuffer, 0, static_cast<uint32_t>(meshlets.size()),
+                                 sizeof(VkDrawIndexedIndirectCommand));
+        return;
+    }
+    for (const VkDrawIndexedIndirectCommand& draw : frame.cpuDraws) {
+        vkCmdDrawIndexed(commandBuffer, draw.indexCount, 1, draw.firstIndex, draw.vertexOffset, 0);
+    }
+}
+
+void MeshletCuller::updateDescriptorSet(FrameData& frame) {
+    // Only called while recording this frame, after its fence was waited on, so the
+    // set is not in use by the GPU
+    VkDescriptorBufferInfo meshletInfo{meshletBuffer, 0, VK_WHOLE_SIZE};
+    VkDescriptorBufferInfo drawInfo{frame.drawBuffer, 0, VK_WHOLE_SIZE};
+
+    std::array<VkWriteDescriptorSet, 2> writes{};
+    for (uint32_t i = 0; i < writes.size(); ++i) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = frame.descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    }
+    writes[0].pBufferInfo = &meshletInfo;
+    writes[1].pBufferInfo = &drawInfo;
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    frame.boundGeneration = generation;
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+
+#include "../objects/geometry/MeshletBuilder.h"
+#include "DeletionQueue.h"
+#include "DeviceAllocator.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief GPU record of one meshlet, read by the culling compute shader (std430, 48 bytes).
+ */
+struct MeshletCullData {
+    MeshletBounds bounds;    // Sphere and normal cone (model space)
+    uint32_t firstIndex = 0; // Index range of the meshlet in the index buffer
+    uint32_t indexCount = 0;
+    int32_t vertexOffset = 0; // Base vertex of the draw (see IndexPacker)
+    uint32_t padding = 0;
+};
+
+/**
+ * @brief Culls meshlets against the view frustum and by normal cone before drawing.
+ *
+ * With the multiDrawIndirect feature, a compute prepass (shaders/meshlet_cull.comp)
+ * writes one VkDrawIndexedIndirectCommand per meshlet (instanceCount 0 when culled)
+ * and a single vkCmdDrawIndexedIndirect draws the survivors, so the CPU cost does
+ * not grow with the mesh. Each frame in flight has its own command buffer, as the
+ * GPU may still draw from the previous frame's commands while the next cull runs.
+ *
+ * Without it the same tests run on the CPU and consecutive visible meshlets are
+ * merged into one vkCmdDrawIndexed per run.
+ *
+ * Frustum planes and the camera position are passed in model space, so meshlet
+ * bounds are used as stored (the model matrix must be rigid).
+ *
+ * Keywords: Meshlet Culling, Frustum Culling, Cone Culling, Indirect Drawing, Compute Prepass
+ */
+class MeshletCuller {
+public:
+    /**
+     * @brief Per-frame culling parameters (push constants of the compute shader).
+     */
+    struct CullParams {
+        glm::vec4 planes[6];         // Frustum planes in model space (xyz normal pointing in, w distance)
+        glm::vec4 cameraPosition;    // Model space, w unused
+        uint32_t meshletCount = 0;
+    };
+
+    MeshletCuller() = default;
+    ~MeshletCuller();
+
+    MeshletCuller(const MeshletCuller&) = delete;
+    MeshletCuller& operator=(const MeshletCuller&) = delete;
+
+    /**
+     * @brief Creates the compute pipeline (when gpuCulling) and per-frame descriptor sets.
+     * @param allocator Allocator of the indirect draw buffers (also provides the logical device).
+     * @param gpuCulling Whether the device supports (and has enabled) multiDrawIndirect.
+     * @param maxDrawIndirectCount Device limit; larger meshlet counts fall back to the CPU.
+     * @param framesInFlight Number of frames in flight (one indirect buffer each).
+     * @param shaderPath Path of the compiled culling shader.
+     */
+    void create(DeviceAllocator& allocator, bool gpuCulling, uint32_t maxDrawIndirectCount,
+                uint32_t framesInFlight, const std::string& shaderPath);
+
+    /**
+     * @brief Destroys all resources. The device must be idle.
+     */
+    void destroy();
+
+    /**
+     * @brief Resizes the per-frame descriptor sets and indirect buffers. Every frame must have completed.
+     */
+    void setFramesInFlight(uint32_t framesInFlight);
+
+    /**
+     * @brief Replaces the meshlets to cull.
+     * @param meshlets CPU copy of the meshlet records (kept for the CPU path).
+     * @param meshletBuffer Device buffer holding the same records (STORAGE usage); ownership
+     *                      passes to the culler. May be VK_NULL_HANDLE on the CPU path.
+     * @param meshletMemory Memory of meshletBuffer.
+     * @param deletionQueue Receives the old buffers, retired after retireFrame.
+     */
+    void setMeshlets(std::vector<MeshletCullData> meshlets, VkBuffer meshletBuffer,
+                     const DeviceAllocator::Allocation& meshletMemory, DeletionQueue& deletionQueue,
+                     uint64_t retireFrame);
+
+    /**
+     * @brief Whether there are meshlets to cull (otherwise draw the mesh as usual).
+     */
+    bool hasMeshlets() const { return !meshlets.empty(); }
+    bool usesGpu() const;
+
+    /**
+     * @brief Builds the culling parameters for a model-view-projection and model-view matrix.
+     */
+    CullParams computeParams(const glm::mat4& modelViewProj, const glm::mat4& modelView) const;
+
+    /**
+     * @brief Records the culling prepass for a frame (GPU path), or culls on the CPU.
+     *
+     * Must be recorded outside a render pass.
+     */
+    void recordCull(VkCommandBuffer commandBuffer, uint32_t frame, const CullParams& params);
+
+    /**
+     * @brief Records the draws of the visible meshlets (index/vertex buffers must be bound).
+     */
+    void recordDraw(VkCommandBuffer commandBuffer, uint32_t frame) const;
+
+    /**
+     * @brief Meshlets drawn by the last CPU cull (GPU results are not read back).
+     */
+    uint32_t getCpuVisibleCount() const { return cpuVisibleCount; }
+
+    /**
+     * @brief Builds the GPU records of meshlets (index ranges of the source index buffer).
+     * @param vertexOffsets Base vertex of each meshlet's draw; empty means 0 for all.
+     */
+    static std::vector<MeshletCullData> makeCullData(const std::vector<Meshlet>& meshlets,
+                                                     const std::vector<MeshletBounds>& bounds,
+                                                     const std::vector<int32_t>& vertexOffsets);
+
+    /**
+     * @brief Frustum and cone test of one meshlet (same as the compute shader).
+     */
+    static bool isVisible(const MeshletBounds& bounds, const CullParams& params);
+
+    /**
+     * @brief Access mask / stage the meshlet buffer must be made visible to after an upload.
+     */
+    static constexpr VkAccessFlags SHADER_ACCESS = VK_ACCESS_SHADER_READ_BIT;
+    static constexpr VkPipelineStageFlags SHADER_STAGE = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+private:
+    DeviceAllocator* allocator = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    bool gpuSupported = false;
+    uint32_t maxDrawCount = 0;
+
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+
+    struct FrameData {
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        VkBuffer drawBuffer = VK_NULL_HANDLE;       // VkDrawIndexedIndirectCommand per meshlet
+        DeviceAllocator::Allocation drawMemory;
+        uint64_t boundGeneration = 0;               // Meshlet generation the descriptor set points at
+        std::vector<VkDrawIndexedIndirectCommand> cpuDraws; // Merged visible runs (CPU path)
+    };
+    std::vector<FrameData> frames;
+
+    std::vector<MeshletCullData> meshlets;
+    VkBuffer meshletBuffer = VK_NULL_HANDLE;
+    DeviceAllocator::Allocation meshletMemory;
+    uint64_t generation = 0; // Bumped by setMeshlets()
+    uint32_t cpuVisibleCount = 0;
+
+    void createFrames(uint32_t framesInFlight);
+    void createDrawBuffers();
+    void updateDescriptorSet(FrameData& frame);
+};
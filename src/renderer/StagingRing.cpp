@@ -0,0 +1,279 @@
+#include "StagingRing.h"
+#include "VulkanUtils.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+StagingRing::~StagingRing() {
+    destroy();
+}
+
+void StagingRing::create(DeviceAllocator& memoryAllocator, VkCommandPool pool, VkQueue transferQueue,
+                         VkDeviceSize size, uint32_t blockCount, VkSemaphore timelineSemaphore) {
+    destroy();
+    if (blockCount == 0 || size < blockCount) {
+        throw std::runtime_error("Invalid staging ring size!");
+    }
+
+    allocator = &memoryAllocator;
+    device = memoryAllocator.getDevice();
+    commandPool = pool;
+    queue = transferQueue;
+    timeline = timelineSemaphore;
+    blockBytes = (size / blockCount) & ~VkDeviceSize(15); // Keep blocks 16-byte aligned
+    totalSize = blockBytes * blockCount;
+
+    // 1. One host-visible, coherent buffer for all blocks, mapped for its whole lifetime
+    VulkanUtils::createBuffer(*allocator, totalSize,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        buffer, memory);
+    mapped = static_cast<char*>(allocator->map(memory));
+
+    // 2. A command buffer and fence per block
+    blocks.resize(blockCount);
+    std::vector<VkCommandBuffer> commandBuffers(blockCount);
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = commandPool;
+    allocInfo.commandBufferCount = blockCount;
+    if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate staging ring command buffers!");
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    for (uint32_t i = 0; i < blockCount; ++i) {
+        blocks[i].commandBuffer = commandBuffers[i];
+        if (vkCreateFence(device, &fenceInfo, nullptr, &blocks[i].fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create staging ring fence!");
+        }
+    }
+
+    currentBlock = 0;
+    head = 0;
+    submitCount = 0;
+    stallCount = 0;
+}
+
+void StagingRing::destroy() {
+    if (device == VK_NULL_HANDLE) return;
+
+    // Outstanding copies still read from the staging buffer
+    for (Block& block : blocks) waitBlock(block);
+
+    for (Block& block : blocks) {
+        if (block.fence != VK_NULL_HANDLE) vkDestroyFence(device, block.fence, nullptr);
+        if (block.commandBuffer != VK_NULL_HANDLE) vkFreeCommandBuffers(device, commandPool, 1, &block.commandBuffer);
+    }
+    blocks.clear();
+
+    if (mapped) allocator->unmap(memory);
+    VulkanUtils::destroyBuffer(*allocator, buffer, memory);
+
+    mapped = nullptr;
+    allocator = nullptr;
+    timeline = VK_NULL_HANDLE;
+    consumerStages = 0;
+    consumerAccess = 0;
+    device = VK_NULL_HANDLE;
+    totalSize = 0;
+    blockBytes = 0;
+}
+
+void StagingRing::setConsumerBarrier(VkPipelineStageFlags stages, VkAccessFlags access) {
+    consumerStages = stages;
+    consumerAccess = access;
+}
+
+void* StagingRing::acquire(VkDeviceSize minBytes, VkDeviceSize maxBytes, VkDeviceSize alignment, VkDeviceSize& grantedBytes) {
+    if (minBytes > blockBytes) {
+        throw std::runtime_error("Staging ring block too small for requested span!");
+    }
+
+    VkDeviceSize offset = (head + alignment - 1) / alignment * alignment;
+    if (offset + minBytes > blockBytes) {
+        // Current block is full: send it off and move to the next one
+        submitCurrentBlock();
+        offset = 0;
+    }
+
+    acquiredOffset = currentBlock * blockBytes + offset;
+    acquiredBytes = std::min(maxBytes, blockBytes - offset);
+    head = offset;
+    grantedBytes = acquiredBytes;
+    return mapped + acquiredOffset;
+}
+
+void StagingRing::commit(VkDeviceSize bytes, VkBuffer dstBuffer, VkDeviceSize dstOffset) {
+    if (bytes == 0) return;
+    if (bytes > acquiredBytes) {
+        throw std::runtime_error("Staging ring commit exceeds acquired span!");
+    }
+
+    Block& block = blocks[currentBlock];
+    // Extend the previous copy when this one continues it in both buffers
+    if (!block.copies.empty()) {
+        PendingCopy& last = block.copies.back();
+        if (last.srcBuffer == buffer && last.dstBuffer == dstBuffer &&
+            last.region.srcOffset + last.region.size == acquiredOffset &&
+            last.region.dstOffset + last.region.size == dstOffset) {
+            last.region.size += bytes;
+            head += bytes;
+            acquiredOffset += bytes;
+            acquiredBytes -= bytes;
+            return;
+        }
+    }
+
+    VkBufferCopy region{};
+    region.srcOffset = acquiredOffset;
+    region.dstOffset = dstOffset;
+    region.size = bytes;
+    block.copies.push_back({buffer, dstBuffer, region});
+
+    head += bytes;
+    acquiredOffset += bytes;
+    acquiredBytes -= bytes;
+}
+
+void StagingRing::copy(VkBuffer srcBuffer, VkBuffer dstBuffer, const VkBufferCopy& region) {
+    if (region.size == 0) return;
+    blocks[currentBlock].copies.push_back({srcBuffer, dstBuffer, region});
+}
+
+uint64_t StagingRing::flush() {
+    if (!blocks[currentBlock].copies.empty()) submitCurrentBlock();
+    return submitCount;
+}
+
+void StagingRing::finish() {
+    flush();
+    for (Block& block : blocks) waitBlock(block);
+    currentBlock = 0;
+    head = 0;
+}
+
+void StagingRing::submitCurrentBlock() {
+    // The block's command buffer and fence stay busy until its copies are done,
+    // so later copies always go to the next block
+    submitBlock(blocks[currentBlock]);
+    currentBlock = (currentBlock + 1) % static_cast<uint32_t>(blocks.size());
+    Block& next = blocks[currentBlock];
+    if (next.inFlight) {
+        ++stallCount;
+        waitBlock(next);
+    }
+    head = 0;
+}
+
+void StagingRing::submitBlock(Block& block) {
+    if (block.copies.empty()) return;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkResetCommandBuffer(block.commandBuffer, 0);
+    vkBeginCommandBuffer(block.commandBuffer, &beginInfo);
+
+    // Copies were committed in order; batch consecutive ones with the same source and destination
+    std::vector<VkBufferCopy> regions;
+    for (size_t i = 0; i < block.copies.size();) {
+        VkBuffer src = block.copies[i].srcBuffer;
+        VkBuffer dst = block.copies[i].dstBuffer;
+        regions.clear();
+        for (; i < block.copies.size() && block.copies[i].srcBuffer == src && block.copies[i].dstBuffer == dst; ++i) {
+            regions.push_back(block.copies[i].region);
+        }
+        vkCmdCopyBuffer(block.commandBuffer, src, dst, static_cast<uint32_t>(regions.size()), regions.data());
+    }
+
+    if (consumerStages != 0) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = consumerAccess;
+        vkCmdPipelineBarrier(block.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, consumerStages,
+            0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    if (vkEndCommandBuffer(block.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to record staging ring copies!");
+    }
+
+    const uint64_t ticket = submitCount + 1;
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &block.commandBuffer;
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    if (timeline != VK_NULL_HANDLE) {
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &ticket;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &timeline;
+    }
+    if (vkQueueSubmit(queue, 1, &submitInfo, block.fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit staging ring copies!");
+    }
+
+    block.inFlight = true;
+    block.ticket = ticket;
+    block.copies.clear();
+    submitCount = ticket;
+}
+
+bool StagingRing::isComplete(uint64_t ticket) {
+    return ticket <= completedTicket();
+}
+
+void StagingRing::wait(uint64_t ticket) {
+    if (ticket > submitCount) flush();
+    if (timeline != VK_NULL_HANDLE) {
+        const uint64_t value = std::min(ticket, submitCount);
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &timeline;
+        waitInfo.pValues = &value;
+        vkWaitSemaphores(device, &waitInfo, UINT64_MAX);
+        return;
+    }
+    // A block's earlier submissions completed before it was reused, so only the latest ones matter
+    for (Block& block : blocks) {
+        if (block.inFlight && block.ticket <= ticket) waitBlock(block);
+    }
+}
+
+uint64_t StagingRing::completedTicket() {
+    if (timeline != VK_NULL_HANDLE) {
+        uint64_t value = 0;
+        if (vkGetSemaphoreCounterValue(device, timeline, &value) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to query staging ring timeline!");
+        }
+        return value;
+    }
+
+    // Retire signalled blocks; everything before the oldest one still in flight is done
+    uint64_t completed = submitCount;
+    for (Block& block : blocks) {
+        if (!block.inFlight) continue;
+        if (vkGetFenceStatus(device, block.fence) == VK_SUCCESS) {
+            vkResetFences(device, 1, &block.fence);
+            block.inFlight = false;
+        } else {
+            completed = std::min(completed, block.ticket - 1);
+        }
+    }
+    return completed;
+}
+
+void StagingRing::waitBlock(Block& block) {
+    if (!block.inFlight) return;
+    vkWaitForFences(device, 1, &block.fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(device, 1, &block.fence);
+    block.inFlight = false;
+}
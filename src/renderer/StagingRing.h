@@ -0,0 +1,157 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "DeviceAllocator.h"
+
+#include <vector>
+
+/**
+ * @brief Persistently mapped host-visible staging buffer used as a ring of blocks.
+ *
+ * Producers acquire space in the current block, write into it through the mapped
+ * pointer and commit a copy of the written bytes into a destination buffer. When a
+ * block is full its copies are recorded and submitted with a fence, and writing
+ * continues in the next block while the GPU drains the previous ones. A block is
+ * only reused after its fence has signalled, so at most blockCount submissions are
+ * in flight and staging memory stays fixed regardless of how much data passes
+ * through.
+ *
+ * Each submission gets a ticket (1, 2, ...). With a timeline semaphore the ticket is
+ * also the value the submission signals, so other queues can wait for the copies on
+ * the GPU; without one, completion is tracked through the block fences only.
+ *
+ * Keywords: Staging Buffer, Ring Buffer, Persistent Mapping, Upload Streaming
+ */
+class StagingRing {
+public:
+    StagingRing() = default;
+    ~StagingRing();
+
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+
+    /**
+     * @brief Creates the staging buffer, its blocks and their command buffers/fences.
+     * @param allocator Allocator of the staging memory (also provides the logical device).
+     * @param commandPool Pool to allocate the block command buffers from.
+     * @param queue Queue the copies are submitted to.
+     * @param size Total staging size in bytes (split evenly into blocks).
+     * @param blockCount Number of blocks that can be in flight.
+     * @param timeline Timeline semaphore each submission signals with its ticket (optional,
+     *                 must be at 0 and used by this ring only).
+     */
+    void create(DeviceAllocator& allocator, VkCommandPool commandPool, VkQueue queue, VkDeviceSize size, uint32_t blockCount = 4,
+                VkSemaphore timeline = VK_NULL_HANDLE);
+
+    /**
+     * @brief Ends every submission with a barrier making its copies visible to later work on the same queue.
+     * @param stages Pipeline stages that read the copied data (the queue must support them).
+     * @param access Accesses of those stages.
+     */
+    void setConsumerBarrier(VkPipelineStageFlags stages, VkAccessFlags access);
+
+    /**
+     * @brief Waits for outstanding copies and destroys all resources.
+     */
+    void destroy();
+
+    /**
+     * @brief Returns a mapped pointer to between minBytes and maxBytes of contiguous space.
+     *
+     * Submits the current block and moves on (waiting for the next block's fence if
+     * it is still in flight) when fewer than minBytes are left.
+     * @param minBytes Smallest useful span (must not exceed the block size).
+     * @param maxBytes Bytes the caller would like.
+     * @param alignment Required alignment of the span's offset in the staging buffer.
+     * @param grantedBytes Receives the span size.
+     */
+    void* acquire(VkDeviceSize minBytes, VkDeviceSize maxBytes, VkDeviceSize alignment, VkDeviceSize& grantedBytes);
+
+    /**
+     * @brief Commits the first bytes of the last acquired span as a copy into dstBuffer.
+     */
+    void commit(VkDeviceSize bytes, VkBuffer dstBuffer, VkDeviceSize dstOffset);
+
+    /**
+     * @brief Adds a copy from another buffer to the current block (it goes out with the block's submission).
+     */
+    void copy(VkBuffer srcBuffer, VkBuffer dstBuffer, const VkBufferCopy& region);
+
+    /**
+     * @brief Submits the current block's pending copies (if any); later ones go to the next block.
+     * @return Ticket of the last submission, which covers every copy made so far (0 if none).
+     */
+    uint64_t flush();
+
+    /**
+     * @brief Flushes and blocks until every submitted copy has completed.
+     */
+    void finish();
+
+    /**
+     * @brief Ticket the current block will get when it is submitted.
+     */
+    uint64_t pendingTicket() const { return submitCount + 1; }
+
+    /**
+     * @brief Whether the submission with this ticket (and every earlier one) has completed. Never blocks.
+     */
+    bool isComplete(uint64_t ticket);
+
+    /**
+     * @brief Blocks until the submission with this ticket has completed (flushes first if it is still pending).
+     */
+    void wait(uint64_t ticket);
+
+    VkSemaphore getTimeline() const { return timeline; }
+
+    VkDeviceSize size() const { return totalSize; }
+    VkDeviceSize blockSize() const { return blockBytes; }
+    uint64_t getSubmitCount() const { return submitCount; }
+    uint64_t getStallCount() const { return stallCount; }
+
+private:
+    struct PendingCopy {
+        VkBuffer srcBuffer;
+        VkBuffer dstBuffer;
+        VkBufferCopy region;
+    };
+
+    struct Block {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        bool inFlight = false;
+        uint64_t ticket = 0; // Of the last submission
+        std::vector<PendingCopy> copies;
+    };
+
+    DeviceAllocator* allocator = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    VkSemaphore timeline = VK_NULL_HANDLE;
+    VkPipelineStageFlags consumerStages = 0; // Barrier after the copies (0: none)
+    VkAccessFlags consumerAccess = 0;
+
+    VkBuffer buffer = VK_NULL_HANDLE;
+    DeviceAllocator::Allocation memory;
+    char* mapped = nullptr;
+    VkDeviceSize totalSize = 0;
+    VkDeviceSize blockBytes = 0;
+
+    std::vector<Block> blocks;
+    uint32_t currentBlock = 0;
+    VkDeviceSize head = 0;          // Write offset within the current block
+    VkDeviceSize acquiredOffset = 0; // Offset (in the whole buffer) of the last acquired span
+    VkDeviceSize acquiredBytes = 0;
+
+    uint64_t submitCount = 0;        // Also the ticket of the last submission
+    uint64_t stallCount = 0;         // Times a producer had to wait for a block's fence
+
+    void submitCurrentBlock();
+    void submitBlock(Block& block);
+    void waitBlock(Block& block);
+    uint64_t completedTicket();
+};
@@ -0,0 +1,207 @@
+#include "UploadManager.h"
+#include "VulkanUtils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+UploadManager::~UploadManager() {
+    destroy();
+}
+
+namespace {
+constexpr VkMemoryPropertyFlags DIRECT_PROPERTIES =
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+}
+
+void UploadManager::create(DeviceAllocator& memoryAllocator, uint32_t queueFamily, VkQueue queue, bool useTimeline,
+                           VkDeviceSize stagingSize, bool directWrites) {
+    destroy();
+    allocator = &memoryAllocator;
+    device = memoryAllocator.getDevice();
+    family = queueFamily;
+
+    // 1. Command pool of the upload queue's family (the ring resets its block command buffers one by one)
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create upload command pool!");
+    }
+
+    // 2. Timeline semaphore counting completed submissions
+    if (useTimeline) {
+        VkSemaphoreTypeCreateInfo typeInfo{};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &typeInfo;
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &timeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create upload timeline semaphore!");
+        }
+    }
+
+    // 3. The staging ring submitting to the upload queue
+    ring.create(memoryAllocator, commandPool, queue, stagingSize, 4, timeline);
+
+    // 4. Direct writes when the largest device-local heap is host-visible too (UMA or resizable BAR).
+    //    A small BAR window (typically 256 MiB) is left to per-frame data.
+    stats = Stats();
+    directBudget = 0;
+    if (!directWrites) return;
+    const VkPhysicalDeviceMemoryProperties& memory = memoryAllocator.getMemoryProperties();
+    VkDeviceSize largestDeviceHeap = 0;
+    for (uint32_t i = 0; i < memory.memoryHeapCount; ++i) {
+        if (memory.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            largestDeviceHeap = std::max(largestDeviceHeap, memory.memoryHeaps[i].size);
+        }
+    }
+    for (uint32_t i = 0; i < memory.memoryTypeCount; ++i) {
+        if ((memory.memoryTypes[i].propertyFlags & DIRECT_PROPERTIES) != DIRECT_PROPERTIES) continue;
+        const VkMemoryHeap& heap = memory.memoryHeaps[memory.memoryTypes[i].heapIndex];
+        if (heap.size < largestDeviceHeap) continue;
+        directHeap = memory.memoryTypes[i].heapIndex;
+        directBudget = heap.size / 4 * 3; // Leave room for images and the driver
+        break;
+    }
+}
+
+void UploadManager::destroy() {
+    if (device == VK_NULL_HANDLE) return;
+
+    ring.destroy(); // Waits for the submitted copies
+    while (!oversized.empty()) {
+        VulkanUtils::destroyBuffer(*allocator, oversized.front().buffer, oversized.front().memory);
+        oversized.pop_front();
+    }
+    if (timeline != VK_NULL_HANDLE) vkDestroySemaphore(device, timeline, nullptr);
+    if (commandPool != VK_NULL_HANDLE) vkDestroyCommandPool(device, commandPool, nullptr);
+
+    timeline = VK_NULL_HANDLE;
+    commandPool = VK_NULL_HANDLE;
+    directBudget = 0;
+    allocator = nullptr;
+    device = VK_NULL_HANDLE;
+}
+
+void UploadManager::setConsumerBarrier(VkPipelineStageFlags stages, VkAccessFlags access) {
+    ring.setConsumerBarrier(stages, access);
+}
+
+void UploadManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, const std::vector<uint32_t>& queueFamilies,
+                                 VkBuffer& buffer, DeviceAllocator::Allocation& memory) {
+    VkMemoryPropertyFlags preferred = 0;
+    if (directBudget != 0 && allocator->getHeapStats()[directHeap].usedBytes + size <= directBudget) {
+        preferred = DIRECT_PROPERTIES;
+    }
+    // Still device-local when the host-visible types are full; upload() then stages
+    VulkanUtils::createBuffer(*allocator, size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, memory, queueFamilies, preferred);
+}
+
+bool UploadManager::isDirect(const DeviceAllocator::Allocation& memory) const {
+    return directBudget != 0 && (allocator->getPropertyFlags(memory) & DIRECT_PROPERTIES) == DIRECT_PROPERTIES;
+}
+
+void UploadManager::upload(VkBuffer dst, const DeviceAllocator::Allocation& dstMemory, VkDeviceSize dstOffset,
+                           VkDeviceSize size, const std::function<void(void*)>& fill) {
+    if (size == 0) return;
+    if (!isDirect(dstMemory)) {
+        upload(dst, dstOffset, size, fill);
+        return;
+    }
+
+    // Coherent memory: the writes are visible to every later submission without a flush
+    fill(static_cast<char*>(allocator->map(dstMemory)) + dstOffset);
+    allocator->unmap(dstMemory);
+    ++stats.directUploads;
+    stats.directBytes += size;
+}
+
+void UploadManager::upload(VkBuffer dst, const DeviceAllocator::Allocation& dstMemory, VkDeviceSize dstOffset,
+                           const void* data, VkDeviceSize size) {
+    upload(dst, dstMemory, dstOffset, size, [data, size](void* out) {
+        std::memcpy(out, data, static_cast<size_t>(size));
+    });
+}
+
+void UploadManager::upload(VkBuffer dst, VkDeviceSize dstOffset, VkDeviceSize size,
+                           const std::function<void(void*)>& fill) {
+    if (size == 0) return;
+    ++stats.stagedUploads;
+    stats.stagedBytes += size;
+
+    if (size <= ring.blockSize()) {
+        VkDeviceSize granted = 0;
+        void* span = ring.acquire(size, size, 16, granted);
+        fill(span);
+        ring.commit(size, dst, dstOffset);
+        return;
+    }
+
+    // Too large for a ring block: stage it in its own buffer, freed once the copy is done
+    OversizedUpload staging{ring.pendingTicket(), VK_NULL_HANDLE, DeviceAllocator::Allocation()};
+    VulkanUtils::createBuffer(*allocator, size,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        staging.buffer, staging.memory);
+    fill(allocator->map(staging.memory));
+    allocator->unmap(staging.memory); // Coherent memory, no flush needed
+
+    VkBufferCopy region{};
+    region.dstOffset = dstOffset;
+    region.size = size;
+    ring.copy(staging.buffer, dst, region);
+    oversized.push_back(staging);
+}
+
+void UploadManager::upload(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+    upload(dst, dstOffset, size, [data, size](void* out) {
+        std::memcpy(out, data, static_cast<size_t>(size));
+    });
+}
+
+void UploadManager::copy(VkBuffer src, VkBuffer dst, const VkBufferCopy& region) {
+    ++stats.copies;
+    stats.copiedBytes += region.size;
+    ring.copy(src, dst, region);
+}
+
+uint64_t UploadManager::submit() {
+    const uint64_t ticket = ring.flush();
+    releaseOversized();
+    return ticket;
+}
+
+bool UploadManager::isComplete(uint64_t ticket) {
+    releaseOversized();
+    return ring.isComplete(ticket);
+}
+
+void UploadManager::wait(uint64_t ticket) {
+    ring.wait(ticket);
+    releaseOversized();
+}
+
+void UploadManager::releaseOversized() {
+    while (!oversized.empty() && ring.isComplete(oversized.front().ticket)) {
+        VulkanUtils::destroyBuffer(*allocator, oversized.front().buffer, oversized.front().memory);
+        oversized.pop_front();
+    }
+}
+
+void UploadManager::printStats(std::ostream& out) const {
+    const double mib = 1.0 / (1024.0 * 1024.0);
+    out << "Uploads: ";
+    if (directBudget != 0) {
+        out << "direct writes into heap " << directHeap << " (budget " << directBudget * mib << " MiB), ";
+    } else {
+        out << "staged only, ";
+    }
+    out << stats.directUploads << " direct (" << stats.directBytes * mib << " MiB), "
+        << stats.stagedUploads << " staged (" << stats.stagedBytes * mib << " MiB), "
+        << stats.copies << " copies (" << stats.copiedBytes * mib << " MiB)." << std::endl;
+}
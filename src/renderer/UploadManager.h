@@ -0,0 +1,190 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "StagingRing.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief Uploads buffer data without stalling the CPU or the graphics queue.
+ *
+ * Data is written into a persistently mapped StagingRing and the copies into the
+ * destination buffers are recorded in batches, one command buffer per ring block.
+ * The copies go to the queue given at creation, which is a dedicated transfer queue
+ * when the device has one, so they run alongside rendering.
+ *
+ * submit() sends everything recorded so far and returns a ticket. With a timeline
+ * semaphore the ticket is the value it reaches once those copies are done, and the
+ * renderer waits for it on the GPU in the submission that first reads the data;
+ * isComplete() polls it without blocking. Without timeline semaphores the uploads
+ * must run on the queue that reads the data: every submission then ends with a
+ * barrier for the consumer stages (setConsumerBarrier), and tickets are tracked
+ * through the ring's fences.
+ *
+ * Payloads larger than a ring block get a staging buffer of their own, released once
+ * their ticket has completed.
+ *
+ * On devices where the main device-local heap is also host-visible (integrated GPUs,
+ * software rasterizers, discrete cards with resizable BAR) staging is pure overhead:
+ * buffers made with createBuffer() are then placed in that memory while the heap
+ * stays within a budget, and upload() writes into them directly with no copy or
+ * ticket. Everything else still goes through the ring. getStats() counts both paths.
+ *
+ * Keywords: Upload Manager, Transfer Queue, Timeline Semaphore, Staging Ring, Asynchronous Upload, ReBAR, UMA
+ */
+class UploadManager {
+public:
+    static constexpr VkDeviceSize DEFAULT_STAGING_SIZE = VkDeviceSize(32) << 20;
+
+    /**
+     * @brief Uploads per path since creation.
+     */
+    struct Stats {
+        uint64_t directUploads = 0;    // Written straight into device-local host-visible memory
+        uint64_t stagedUploads = 0;    // Written into staging memory and copied
+        uint64_t copies = 0;           // Copies from buffers staged by the caller
+        VkDeviceSize directBytes = 0;
+        VkDeviceSize stagedBytes = 0;
+        VkDeviceSize copiedBytes = 0;
+    };
+
+    UploadManager() = default;
+    ~UploadManager();
+
+    UploadManager(const UploadManager&) = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+
+    /**
+     * @brief Creates the command pool, timeline semaphore and staging ring.
+     * @param allocator Allocator of the staging memory (also provides the logical device).
+     * @param queueFamily Family of queue.
+     * @param queue Queue the copies are submitted to.
+     * @param useTimeline Signal a timeline semaphore (the timelineSemaphore feature must be enabled).
+     * @param stagingSize Size of the staging ring in bytes.
+     * @param directWrites Write into device-local host-visible memory when the device has a large enough heap of it.
+     */
+    void create(DeviceAllocator& allocator, uint32_t queueFamily, VkQueue queue, bool useTimeline,
+                VkDeviceSize stagingSize = DEFAULT_STAGING_SIZE, bool directWrites = true);
+
+    /**
+     * @brief Waits for outstanding copies and destroys all resources.
+     */
+    void destroy();
+
+    /**
+     * @brief Makes every submission end with a barrier for consumers on the same queue (see StagingRing).
+     */
+    void setConsumerBarrier(VkPipelineStageFlags stages, VkAccessFlags access);
+
+    /**
+     * @brief Creates a device-local buffer for upload(), host-visible as well when direct writes are within budget.
+     * @param queueFamilies Families sharing the buffer (see VulkanUtils::createBuffer).
+     */
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, const std::vector<uint32_t>& queueFamilies,
+                      VkBuffer& buffer, DeviceAllocator::Allocation& memory);
+
+    /**
+     * @brief Whether upload() writes into this memory directly (it is host-visible and coherent).
+     */
+    bool isDirect(const DeviceAllocator::Allocation& memory) const;
+
+    /**
+     * @brief Records an upload of size bytes into dst at dstOffset, or writes it in place when dstMemory is direct.
+     * @param fill Writes the size bytes to the given (mapped) pointer.
+     * The destination must not be in use by the GPU when it is written directly.
+     */
+    void upload(VkBuffer dst, const DeviceAllocator::Allocation& dstMemory, VkDeviceSize dstOffset, VkDeviceSize size,
+                const std::function<void(void*)>& fill);
+
+    /**
+     * @brief Records an upload of a copy of data, or writes it in place when dstMemory is direct.
+     */
+    void upload(VkBuffer dst, const DeviceAllocator::Allocation& dstMemory, VkDeviceSize dstOffset,
+                const void* data, VkDeviceSize size);
+
+    /**
+     * @brief Records an upload of size bytes into dst at dstOffset.
+     * @param fill Writes the size bytes to the given (mapped staging) pointer.
+     */
+    void upload(VkBuffer dst, VkDeviceSize dstOffset, VkDeviceSize size, const std::function<void(void*)>& fill);
+
+    /**
+     * @brief Records an upload of a copy of data.
+     */
+    void upload(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+    /**
+     * @brief Records a copy from a buffer the caller staged itself (it must stay alive until the ticket completes).
+     */
+    void copy(VkBuffer src, VkBuffer dst, const VkBufferCopy& region);
+
+    /**
+     * @brief Submits the recorded copies.
+     * @return Ticket covering every copy recorded so far (0 if nothing was ever recorded).
+     */
+    uint64_t submit();
+
+    /**
+     * @brief Whether the copies of a ticket have completed. Never blocks.
+     */
+    bool isComplete(uint64_t ticket);
+
+    /**
+     * @brief Blocks until the copies of a ticket have completed.
+     */
+    void wait(uint64_t ticket);
+
+    /**
+     * @brief Semaphore reaching each ticket's value when its copies are done (null without timelines).
+     */
+    VkSemaphore getTimeline() const { return timeline; }
+
+    uint32_t getQueueFamily() const { return family; }
+
+    /**
+     * @brief Whether createBuffer() can place buffers in device-local host-visible memory.
+     */
+    bool hasDirectWrites() const { return directBudget != 0; }
+
+    /**
+     * @brief Counts a direct write the caller made itself (e.g. on a worker, into a buffer from createBuffer()).
+     */
+    void countDirectUpload(VkDeviceSize bytes) {
+        ++stats.directUploads;
+        stats.directBytes += bytes;
+    }
+
+    const Stats& getStats() const { return stats; }
+
+    /**
+     * @brief Prints the upload path in use and the uploads per path.
+     */
+    void printStats(std::ostream& out) const;
+
+private:
+    struct OversizedUpload {
+        uint64_t ticket;
+        VkBuffer buffer;
+        DeviceAllocator::Allocation memory;
+    };
+
+    DeviceAllocator* allocator = nullptr;
+    VkDevice device = VK_NULL_HANDLE;
+    uint32_t family = 0;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkSemaphore timeline = VK_NULL_HANDLE;
+    StagingRing ring;
+    std::deque<OversizedUpload> oversized; // Dedicated staging buffers, in ticket order
+
+    uint32_t directHeap = 0;       // Heap of the device-local host-visible memory
+    VkDeviceSize directBudget = 0; // Bytes of it buffers may use (0: no direct writes)
+    Stats stats;
+
+    void releaseOversized();
+};
@@ -1,9 +1,13 @@
 #include "VulkanEngine.h"
 #include "../scene/Scene.h" // Include Scene to get data
+#include "GpuMeshStreamSink.h" // Streaming model import into device buffers
+#include "../objects/loaders/LoadedMesh.h" // Meshes published by the scene's background loader
+#include "../common/AsyncFileReader.h" // Batched shader reads
 
 #include <set>        // For unique queue families
 #include <cstring>    // For strcmp
 #include <algorithm>  // For std::clamp
+#include <cmath>      // For std::tan (LOD selection)
 #include <iostream>   // For setup messages / errors
 #include <fstream>    // For file operations
 #include <chrono>     // For time-based operations
@@ -49,26 +53,57 @@ void VulkanEngine::initVulkan(const Scene& scene) {
         createSurface();
         pickPhysicalDevice();
         createLogicalDevice();
+        allocator.create(physicalDevice, device); // Memory for all buffers and images below
+        frameScheduler.create(device, timelineSemaphores, framesInFlight); // Sizes every per-frame resource
         createSwapChain();
         createImageViews();      // Color views
         createRenderPass();
         createDescriptorSetLayout();
         createGraphicsPipeline();
         createCommandPool();     // Create pool before buffers that might need it for copies
+        createUploadManager();   // Staging ring and upload queue, before the first buffers
+        meshletCuller.create(allocator, multiDrawIndirectEnabled, maxDrawIndirectCount,
+                             frameScheduler.getFramesInFlight(), "build/shaders/cull.spv");
         createDepthResources();
         createFramebuffers();    // Create framebuffers after render pass and image views
 
-        // Create buffers using data from the scene
-        createVertexBuffer(scene.getVertices());
-        createIndexBuffer(scene.getIndices());
+        // Create buffers using data from the scene (vectors or a mapped mesh cache),
+        // or stream the model straight into them when the scene holds no CPU copy.
+        // A scene still loading in the background has no mesh yet; it is uploaded
+        // from drawFrame() once published, and nothing is drawn until then.
+        if (scene.isStreamed()) {
+            importStreamedModel(scene.getModelPath(), scene.getStreamOptions());
+        } else if (std::shared_ptr<const LoadedMesh> loaded = scene.getMesh()) {
+            std::shared_ptr<const GeometryBuffer::CpuData> cpuData = loaded->geometry->getCpuData();
+            if (cpuData && !cpuData->view.empty()) {
+                const MeshView& mesh = cpuData->view;
+                createVertexBuffer(mesh.vertices, mesh.vertexCount, loaded->vertexFormat,
+                                   loaded->vertexLayout, loaded->quantization);
+                createIndexBuffer(mesh, loaded->indexLayout);
+                createMeshletBuffer(*loaded);
+                meshTicket = uploads.submit(); // The first frame waits for these copies, not the CPU
+                meshLods = loaded->geometry->getLods();
+                meshSphereCenter = scene.getBoundingSphereCenter();
+                meshSphereRadius = scene.getBoundingSphereRadius();
+                loaded->geometry->markUploaded(); // The GPU has it now; drop the CPU copy unless someone asked for it
+            }
+        }
+        displayedMeshVersion = scene.getMeshVersion();
 
         createUniformBuffers();
         createDescriptorPool();
         createDescriptorSets();
         createCommandBuffers();
         createSyncObjects();
+        if (gpuTiming) {
+            gpuTimer.create(physicalDevice, device, findQueueFamilies(physicalDevice).graphicsFamily.value(),
+                            frameScheduler.getFramesInFlight(), TIMESTAMP_COUNT);
+            if (!gpuTimer.isEnabled()) std::cerr << "GPU timing unavailable: the graphics queue has no timestamps." << std::endl;
+        }
 
          std::cout << "Vulkan Engine Initialized Successfully." << std::endl;
+         allocator.printStats(std::cout);
+         uploads.printStats(std::cout);
 
     } catch (const std::exception& e) {
         std::cerr << "Vulkan Initialization Error: " << e.what() << std::endl;
@@ -94,53 +129,53 @@ void VulkanEngine::cleanup() {
        vkDeviceWaitIdle(device);
     }
 
-    cleanupSwapChain(); // Clean swapchain + depth + framebuffers + color views
+    cleanupSwapChain(); // Clean swapchain + depth + framebuffers + color views + present semaphores
+    for (std::function<void()>& retire : retiredSwapChains) retire(); // Replaced swapchains not queued yet
+    retiredSwapChains.clear();
 
     // Destroy pipeline and related objects
-    if (graphicsPipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, graphicsPipeline, nullptr);
+    for (size_t format = 0; format < PIPELINE_FORMATS; ++format) {
+        for (size_t layout = 0; layout < PIPELINE_LAYOUTS; ++layout) {
+            if (meshPipelines[format][layout] != VK_NULL_HANDLE) vkDestroyPipeline(device, meshPipelines[format][layout], nullptr);
+            if (depthPipelines[format][layout] != VK_NULL_HANDLE) vkDestroyPipeline(device, depthPipelines[format][layout], nullptr);
+        }
+    }
     if (pipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
     if (renderPass != VK_NULL_HANDLE) vkDestroyRenderPass(device, renderPass, nullptr);
 
-    // Destroy uniform buffers and memory
-    for (size_t i = 0; i < uniformBuffers.size(); ++i) {
-        if (uniformBuffers[i] != VK_NULL_HANDLE) vkDestroyBuffer(device, uniformBuffers[i], nullptr);
-        if (uniformBuffersMemory[i] != VK_NULL_HANDLE) vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
-    }
-    uniformBuffers.clear();
-    uniformBuffersMemory.clear();
-    uniformBuffersMapped.clear();
-
-
-    // Destroy descriptor pool (implicitly frees descriptor sets)
-    if (descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    // Destroy uniform buffers, descriptor sets and command buffers of the frames in flight
+    destroyFrameResources();
 
     // Destroy descriptor set layout
     if (descriptorSetLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 
+    // Destroy mesh uploads still in progress and buffers awaiting deferred deletion
+    destroyMeshUpload(meshUpload);
+    for (MeshUpload& abandoned : abandonedUploads) destroyMeshUpload(abandoned);
+    abandonedUploads.clear();
+    deletionQueue.flushAll();
+    meshletCuller.destroy();
+    gpuTimer.destroy();
+    uploads.destroy();
+
     // Destroy geometry buffers
-    if (indexBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, indexBuffer, nullptr);
-    if (indexBufferMemory != VK_NULL_HANDLE) vkFreeMemory(device, indexBufferMemory, nullptr);
-    if (vertexBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, vertexBuffer, nullptr);
-    if (vertexBufferMemory != VK_NULL_HANDLE) vkFreeMemory(device, vertexBufferMemory, nullptr);
+    VulkanUtils::destroyBuffer(allocator, indexBuffer, indexBufferMemory);
+    VulkanUtils::destroyBuffer(allocator, vertexBuffer, vertexBufferMemory);
 
     // Destroy synchronization objects
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-         // Check if vectors were populated before destroying
-        if (i < renderFinishedSemaphores.size() && renderFinishedSemaphores[i] != VK_NULL_HANDLE)
-            vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
-        if (i < imageAvailableSemaphores.size() && imageAvailableSemaphores[i] != VK_NULL_HANDLE)
-            vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
-        if (i < inFlightFences.size() && inFlightFences[i] != VK_NULL_HANDLE)
-            vkDestroyFence(device, inFlightFences[i], nullptr);
+    for (size_t i = 0; i < imageAvailableSemaphores.size(); ++i) {
+        if (imageAvailableSemaphores[i] != VK_NULL_HANDLE) vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
     }
     imageAvailableSemaphores.clear();
-    renderFinishedSemaphores.clear();
-    inFlightFences.clear();
+    frameScheduler.destroy();
 
 
     // Destroy command pool (implicitly frees command buffers)
     if (commandPool != VK_NULL_HANDLE) vkDestroyCommandPool(device, commandPool, nullptr);
 
+    // Release the memory blocks (every buffer and image is gone by now)
+    allocator.destroy();
+
     // Destroy logical device
     if (device != VK_NULL_HANDLE) vkDestroyDevice(device, nullptr);
 
@@ -167,28 +202,55 @@ void VulkanEngine::cleanup() {
  * @brief Handles window resizing by recreating the swapchain and dependent resources.
  * @param scene Scene object needed to recreate vertex/index buffers if necessary (though currently not needed as they are device local).
  *
- * Called when the window size changes. Destroys the old swapchain, framebuffers,
- * depth buffer, and image views, then recreates them with the new dimensions.
+ * Called when the window size changes. The new swapchain is created with the current
+ * one as oldSwapchain, so the presentation engine hands its images over without the
+ * device going idle. Frames in flight may still render into and present the old
+ * images, and a retired frame's present need not have finished, so the old swapchain,
+ * its image views, framebuffers and present semaphores and the depth image are kept
+ * in retiredSwapChains. drawFrame() queues them for deletion with the first frame
+ * acquired from the new swapchain, and they are destroyed once that frame has
+ * completed. Nothing waits: a resize costs at most the frame in which it happens.
+ *
+ * A minimized window (zero-sized framebuffer) has no surface to draw to. The current
+ * swapchain is kept and rendering is suspended until the window has a size again;
+ * drawFrame() checks every frame rather than blocking here.
  *
- * Keywords: Swapchain Recreation, Window Resize Handling, Framebuffer Resizing
+ * Keywords: Swapchain Recreation, Window Resize Handling, oldSwapchain, Deferred Deletion
  */
 void VulkanEngine::recreateSwapChain(const Scene& scene) {
-    // Handle minimization: pause rendering until window is restored
+    (void)scene;
     int width = 0, height = 0;
     glfwGetFramebufferSize(window, &width, &height);
-    while (width == 0 || height == 0) {
-        glfwGetFramebufferSize(window, &width, &height);
-        glfwWaitEvents(); // Wait for window events (like restore)
-    }
-
-    // Wait for the device to finish any current work before destroying resources
-    vkDeviceWaitIdle(device);
-
-    // Cleanup old resources
-    cleanupSwapChain();
-
-    // Recreate resources with new size/properties
-    createSwapChain();
+    swapChainSuspended = width == 0 || height == 0;
+    if (swapChainSuspended) return;
+
+    // Keep the current resources until a frame from the new swapchain has retired (earlier frames may use them)
+    DeviceAllocator* memoryAllocator = &allocator;
+    VkDevice deviceHandle = device;
+    VkSwapchainKHR oldSwapChain = swapChain;
+    std::vector<VkImageView> oldImageViews = std::move(swapChainImageViews);
+    std::vector<VkFramebuffer> oldFramebuffers = std::move(swapChainFramebuffers);
+    VkImage oldDepthImage = depthImage;
+    DeviceAllocator::Allocation oldDepthMemory = depthImageMemory;
+    VkImageView oldDepthView = depthImageView;
+    swapChainImageViews.clear();
+    swapChainFramebuffers.clear();
+    depthImage = VK_NULL_HANDLE;
+    depthImageMemory = DeviceAllocator::Allocation();
+    depthImageView = VK_NULL_HANDLE;
+    std::vector<VkSemaphore> oldPresentSemaphores = std::move(renderFinishedSemaphores);
+    renderFinishedSemaphores.clear();
+    retiredSwapChains.push_back([=]() mutable {
+        for (VkSemaphore semaphore : oldPresentSemaphores) vkDestroySemaphore(deviceHandle, semaphore, nullptr);
+        for (VkFramebuffer framebuffer : oldFramebuffers) vkDestroyFramebuffer(deviceHandle, framebuffer, nullptr);
+        for (VkImageView imageView : oldImageViews) vkDestroyImageView(deviceHandle, imageView, nullptr);
+        if (oldDepthView != VK_NULL_HANDLE) vkDestroyImageView(deviceHandle, oldDepthView, nullptr);
+        VulkanUtils::destroyImage(*memoryAllocator, oldDepthImage, oldDepthMemory);
+        if (oldSwapChain != VK_NULL_HANDLE) vkDestroySwapchainKHR(deviceHandle, oldSwapChain, nullptr);
+    });
+
+    // Recreate resources with new size/properties, handing the old images over
+    createSwapChain(oldSwapChain);
     createImageViews();     // Color views for new swapchain images
     // RenderPass doesn't usually need recreation unless multisampling changes etc.
     createDepthResources(); // Depth buffer needs new size
@@ -211,20 +273,42 @@ void VulkanEngine::recreateSwapChain(const Scene& scene) {
  * Orchestrates waiting, image acquisition, command recording, submission, and presentation.
  * Includes logic to handle swapchain recreation automatically if needed.
  *
- * Keywords: Render Loop, Frame Submission, Presentation, Synchronization Primitives
+ * The submission signals the frame scheduler's timeline semaphore with the frame's
+ * number + 1 (or a fence without timelines); that is the only CPU-GPU sync of the loop.
+ *
+ * Keywords: Render Loop, Frame Submission, Presentation, Synchronization Primitives, Timeline Semaphore
  */
 void VulkanEngine::drawFrame(const Scene& scene) {
-    // 1. Wait for the fence associated with the 'currentFrame' index.
-    // This ensures that the command buffer and resources for this frame index
-    // are no longer in use by the GPU from a previous iteration.
-    // Timeout is UINT64_MAX, effectively waiting indefinitely.
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    // A new frame count (setFramesInFlight) takes effect between frames
+    if (framesInFlight != frameScheduler.getFramesInFlight()) resizeFrameResources();
+
+    // 1. Wait until the frame that last used this frame's command buffer, uniform buffer
+    // and descriptor set (framesInFlight frames ago) has retired on the GPU.
+    frameScheduler.beginFrame();
+    currentFrame = frameScheduler.getFrameIndex();
+    const uint64_t frameNumber = frameScheduler.getFrameNumber();
+    const uint32_t syncIndex = static_cast<uint32_t>(frameNumber % FrameScheduler::MAX_FRAMES_IN_FLIGHT);
+
+    // Buffers whose last frame has retired can be destroyed now, however recent it was
+    deletionQueue.flush(frameScheduler.getCompletedFrames());
+
+    // The frame's previous timestamps are complete as well
+    collectGpuTimings();
+
+    // Advance a background mesh upload (never blocks; swaps buffers when it is done)
+    pollMeshUpload(scene);
+
+    // While minimized there is nothing to draw to; look again next frame instead of blocking
+    if (swapChainSuspended) {
+        recreateSwapChain(scene); // Clears the flag once the window has a size again
+        if (swapChainSuspended) return;
+    }
 
     // 2. Acquire an available image index from the swapchain.
-    // The imageAvailableSemaphore[currentFrame] will be signaled when the presentation
+    // The imageAvailableSemaphore[syncIndex] will be signaled when the presentation
     // engine is finished with this image and it's ready for us to render to.
     uint32_t imageIndex;
-    VkResult acquireResult = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    VkResult acquireResult = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[syncIndex], VK_NULL_HANDLE, &imageIndex);
 
     // Handle cases where the swapchain is no longer optimal or usable.
     if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR) {
@@ -236,29 +320,38 @@ void VulkanEngine::drawFrame(const Scene& scene) {
         throw std::runtime_error("Failed to acquire swap chain image!");
     }
 
+    // Presents of replaced swapchains are done once this frame, the first from the new one, has retired
+    for (std::function<void()>& retire : retiredSwapChains) deletionQueue.push(frameNumber, std::move(retire));
+    retiredSwapChains.clear();
+
      // --- Frame is ready to be rendered ---
 
+    // Submit this frame's share of a progressive mesh upload. It may swap in the new
+    // mesh or make a finer level resident, so it comes before the LOD is selected.
+    streamMeshUpload();
+
     // 3. Update the uniform buffer for the current frame index with scene data.
     updateUniformBuffer(currentFrame, scene);
 
-    // 4. Reset the fence *before* submitting new work that will signal it.
-    // We only reset the fence if we are sure we are going to submit work using it.
-    vkResetFences(device, 1, &inFlightFences[currentFrame]);
-
-    // 5. Reset and Record the command buffer for the current frame index.
+    // 4. Reset and Record the command buffer for the current frame index.
     vkResetCommandBuffer(commandBuffers[currentFrame], 0); // Reset the buffer before re-recording
     recordCommandBuffer(commandBuffers[currentFrame], imageIndex); // Record drawing commands
 
 
-    // 6. Submit the command buffer to the graphics queue.
+    // 5. Submit the command buffer to the graphics queue.
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    // Specify which semaphores to wait for before execution begins.
-    VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
+    // Specify which semaphores to wait for before execution begins: the swapchain image,
+    // and the upload timeline while the mesh data this frame reads is still being copied
+    // (a GPU-side wait; without timelines uploads share this queue and end with a barrier).
+    VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[syncIndex], uploads.getTimeline()};
     // Specify the pipeline stage(s) where waiting should occur.
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
+    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | MeshletCuller::SHADER_STAGE};
+    const uint64_t waitValues[] = {0, meshTicket}; // The binary semaphore's value is ignored
+    const bool waitForUploads = waitSemaphores[1] != VK_NULL_HANDLE && !uploads.isComplete(meshTicket);
+    submitInfo.waitSemaphoreCount = waitForUploads ? 2 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
 
@@ -266,23 +359,34 @@ void VulkanEngine::drawFrame(const Scene& scene) {
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
 
-    // Specify which semaphores to signal once command buffer execution finishes.
-    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
+    // Specify which semaphores to signal once command buffer execution finishes: the one
+    // presentation waits for, and the frame timeline with this frame's value (retirement).
+    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[imageIndex], frameScheduler.getTimeline()};
+    const uint64_t signalValues[] = {0, frameScheduler.getSignalValue()};
+    const bool signalTimeline = signalSemaphores[1] != VK_NULL_HANDLE;
+    submitInfo.signalSemaphoreCount = signalTimeline ? 2 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    // Submit the work. The inFlightFences[currentFrame] will be signaled upon completion.
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = submitInfo.waitSemaphoreCount;
+    timelineInfo.pWaitSemaphoreValues = waitValues;
+    timelineInfo.signalSemaphoreValueCount = submitInfo.signalSemaphoreCount;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
+    submitInfo.pNext = (waitForUploads || signalTimeline) ? &timelineInfo : nullptr;
+
+    // Submit the work. Without timelines the scheduler's fence for this frame is signaled upon completion.
+    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, frameScheduler.acquireFence()) != VK_SUCCESS) {
         throw std::runtime_error("Failed to submit draw command buffer!");
     }
 
-    // 7. Present the rendered image to the window.
+    // 6. Present the rendered image to the window.
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
     // Wait for rendering to finish (signaled by renderFinishedSemaphore) before presentation.
     presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+    presentInfo.pWaitSemaphores = &renderFinishedSemaphores[imageIndex];
 
     // Specify the swapchain and image index to present.
     VkSwapchainKHR swapChains[] = {swapChain};
@@ -301,9 +405,8 @@ void VulkanEngine::drawFrame(const Scene& scene) {
         throw std::runtime_error("Failed to present swap chain image!");
     }
 
-    // 8. Advance to the next frame index for the next iteration.
-    // Modulo operator ensures wrapping around MAX_FRAMES_IN_FLIGHT.
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    // 7. Advance to the next frame number (and with it the per-frame resource index).
+    frameScheduler.endFrame();
 }
 
 /**
@@ -313,6 +416,45 @@ void VulkanEngine::notifyFramebufferResized() {
     framebufferResized = true;
 }
 
+/**
+ * @brief Whether drawing is suspended because the window is minimized.
+ */
+bool VulkanEngine::isRenderingSuspended() const {
+    return swapChainSuspended;
+}
+
+/**
+ * @brief Whether a mesh upload is in progress.
+ */
+bool VulkanEngine::isMeshUploadPending() const {
+    return meshUpload.active;
+}
+
+void VulkanEngine::setFramesInFlight(uint32_t count) {
+    framesInFlight = std::clamp<uint32_t>(count, 1, FrameScheduler::MAX_FRAMES_IN_FLIGHT); // Applied by drawFrame
+}
+
+bool VulkanEngine::isFrameRetired(uint64_t frame) {
+    return frameScheduler.isRetired(frame);
+}
+
+void VulkanEngine::setDepthPrepass(bool enabled) {
+    depthPrepass = enabled; // Both passes' pipelines always exist; takes effect next frame
+}
+
+void VulkanEngine::setGpuTiming(bool enabled) {
+    gpuTiming = enabled;
+}
+
+void VulkanEngine::setProgressiveUpload(bool enabled, VkDeviceSize budgetBytes) {
+    progressiveUpload = enabled; // Applies to the next upload
+    uploadBudgetBytes = std::max<VkDeviceSize>(budgetBytes, 1);
+}
+
+void VulkanEngine::setDirectUploads(bool enabled) {
+    directUploads = enabled;
+}
+
 
 // --- Private Initialization Steps ---
 
@@ -337,7 +479,14 @@ void VulkanEngine::createInstance() {
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "Custom Vulkan Engine"; // Customize engine name
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0; // Target Vulkan 1.0
+    // Target Vulkan 1.2 (timeline semaphores) when the loader knows it; a 1.0 loader
+    // has no vkEnumerateInstanceVersion and rejects any other version.
+    uint32_t loaderVersion = VK_API_VERSION_1_0;
+    auto enumerateInstanceVersion = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+        vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion"));
+    if (enumerateInstanceVersion != nullptr) enumerateInstanceVersion(&loaderVersion);
+    instanceApiVersion = loaderVersion >= VK_API_VERSION_1_1 ? VK_API_VERSION_1_2 : VK_API_VERSION_1_0;
+    appInfo.apiVersion = instanceApiVersion;
 
     // --- Instance Creation Info ---
     VkInstanceCreateInfo createInfo{};
@@ -462,6 +611,7 @@ void VulkanEngine::createLogicalDevice() {
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     // Use a set to handle cases where graphics and present families are the same
     std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+    if (indices.transferFamily) uniqueQueueFamilies.insert(indices.transferFamily.value());
 
     float queuePriority = 1.0f; // Priority between 0.0 and 1.0
     for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -473,9 +623,30 @@ void VulkanEngine::createLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    // Specify device features to enable (none needed for this basic example)
+    // Specify device features to enable
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
     VkPhysicalDeviceFeatures deviceFeatures{};
-    // Example: if (supportedFeatures.samplerAnisotropy) { deviceFeatures.samplerAnisotropy = VK_TRUE; }
+    // One indirect draw per frame for all meshlets (meshlets are culled on the CPU without it)
+    if (supportedFeatures.multiDrawIndirect) {
+        deviceFeatures.multiDrawIndirect = VK_TRUE;
+        multiDrawIndirectEnabled = true;
+        maxDrawIndirectCount = properties.limits.maxDrawIndirectCount;
+    }
+
+    // Timeline semaphores (core in Vulkan 1.2) let frames wait for uploads on the GPU
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    if (std::min(instanceApiVersion, properties.apiVersion) >= VK_API_VERSION_1_2) {
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &timelineFeatures;
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+        timelineSemaphores = timelineFeatures.timelineSemaphore == VK_TRUE;
+    }
 
     // --- Logical Device Create Info ---
     VkDeviceCreateInfo createInfo{};
@@ -483,6 +654,10 @@ void VulkanEngine::createLogicalDevice() {
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
+    if (timelineSemaphores) {
+        timelineFeatures.pNext = nullptr;
+        createInfo.pNext = &timelineFeatures; // Enables the queried timelineSemaphore feature
+    }
 
     // Enable required device extensions (e.g., swapchain)
     createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
@@ -504,6 +679,7 @@ void VulkanEngine::createLogicalDevice() {
     // Get handles to the created device queues
     vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+    if (indices.transferFamily) vkGetDeviceQueue(device, indices.transferFamily.value(), 0, &transferQueue);
      std::cout << "Logical Device Created." << std::endl;
 
 }
@@ -513,10 +689,11 @@ void VulkanEngine::createLogicalDevice() {
  *
  * The swap chain is a queue of images waiting to be presented to the screen.
  * Chooses optimal surface format, presentation mode, and extent based on device capabilities.
+ * @param oldSwapChain Swapchain being replaced (retired by the call; the caller destroys it), or VK_NULL_HANDLE.
  *
- * Keywords: VkSwapchainKHR, vkCreateSwapchainKHR, Swap Chain Images, Presentation
+ * Keywords: VkSwapchainKHR, vkCreateSwapchainKHR, Swap Chain Images, Presentation, oldSwapchain
  */
-void VulkanEngine::createSwapChain() {
+void VulkanEngine::createSwapChain(VkSwapchainKHR oldSwapChain) {
     VulkanUtils::SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
 
     VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
@@ -558,18 +735,32 @@ void VulkanEngine::createSwapChain() {
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE; // Allow clipping of obscured pixels
-    // createInfo.oldSwapchain = VK_NULL_HANDLE; // For resizing, provide the old one here
+    // On resize the old swapchain hands over its images; it is retired even if creation fails
+    createInfo.oldSwapchain = oldSwapChain;
 
     // Create the swapchain object
-    if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
+    VkSwapchainKHR newSwapChain = VK_NULL_HANDLE;
+    if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &newSwapChain) != VK_SUCCESS) {
+        swapChain = VK_NULL_HANDLE; // The caller owns the retired one
         throw std::runtime_error("Failed to create swap chain!");
     }
+    swapChain = newSwapChain;
 
     // Retrieve the handles to the swap chain images
     vkGetSwapchainImagesKHR(device, swapChain, &imageCount, nullptr); // Get count first
     swapChainImages.resize(imageCount);
     vkGetSwapchainImagesKHR(device, swapChain, &imageCount, swapChainImages.data()); // Get image handles
 
+    // One present semaphore per image (see renderFinishedSemaphores)
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    renderFinishedSemaphores.assign(imageCount, VK_NULL_HANDLE);
+    for (VkSemaphore& semaphore : renderFinishedSemaphores) {
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create present semaphore!");
+        }
+    }
+
     // Store the chosen format and extent for later use
     swapChainImageFormat = surfaceFormat.format;
     swapChainExtent = extent;
@@ -721,28 +912,61 @@ void VulkanEngine::createDescriptorSetLayout() {
 }
 
 /**
- * @brief Creates the Graphics Pipeline (VkPipeline).
+ * @brief Creates the Graphics Pipelines (VkPipeline).
  *
  * Defines the entire rendering pipeline state: shaders, vertex input, assembly,
  * rasterization, viewport, depth/stencil testing, color blending, etc.
  * It links together shader modules, pipeline layout, and render pass.
  *
- * Keywords: VkPipeline, vkCreateGraphicsPipelines, Pipeline State Object (PSO), Shader Stages
+ * The mesh can be stored in any VertexFormat and VertexLayout, which are baked into
+ * a pipeline's vertex input. So one pipeline is created per combination, in two
+ * passes: meshPipelines shade the mesh and read every vertex stream, and
+ * depthPipelines (the depth prepass) read VERTEX_STREAM_POSITION only and have no
+ * fragment shader. Apart from that, all pipelines share the same state.
+ *
+ * Keywords: VkPipeline, vkCreateGraphicsPipelines, Pipeline State Object (PSO), Shader Stages, Depth Prepass
  */
 void VulkanEngine::createGraphicsPipeline() {
-    // --- Load Shader Bytecode ---
-    auto vertShaderCode = VulkanUtils::readFile("build/shaders/vert.spv");
-    auto fragShaderCode = VulkanUtils::readFile("build/shaders/frag.spv");
-
-    // --- Create Shader Modules ---
-    VkShaderModule vertShaderModule = VulkanUtils::createShaderModule(device, vertShaderCode);
-    VkShaderModule fragShaderModule = VulkanUtils::createShaderModule(device, fragShaderCode);
+    // --- Load Shader Bytecode and Create Shader Modules ---
+    // Vertex shaders indexed by VertexFormat
+    const char* vertShaderPaths[2] = {"build/shaders/vert.spv", "build/shaders/vert_quantized.spv"};
+    const char* depthShaderPaths[2] = {"build/shaders/depth.spv", "build/shaders/depth_quantized.spv"};
+    // All shaders are read in one batch, so their reads overlap instead of queuing one after another
+    const std::vector<std::string> shaderPaths = {"build/shaders/frag.spv", vertShaderPaths[0], depthShaderPaths[0],
+                                                  vertShaderPaths[1], depthShaderPaths[1]};
+    std::vector<std::vector<char>> shaderCode;
+    std::string readError;
+    if (!AsyncFileReader::readFiles(shaderPaths, shaderCode, readError)) {
+        throw std::runtime_error("Failed to read shaders: " + readError);
+    }
+    std::vector<VkShaderModule> shaderModules; // Destroyed once the pipelines exist
+    auto loadShader = [&](size_t index) {
+        shaderModules.push_back(VulkanUtils::createShaderModule(device, shaderCode[index]));
+        return shaderModules.back();
+    };
+    auto destroyShaderModules = [&]() {
+        for (VkShaderModule module : shaderModules) vkDestroyShaderModule(device, module, nullptr);
+        shaderModules.clear();
+    };
+
+    VkShaderModule fragShaderModule = VK_NULL_HANDLE;
+    VkShaderModule vertShaderModules[2] = {};
+    VkShaderModule depthShaderModules[2] = {};
+    try {
+        fragShaderModule = loadShader(0);
+        for (int format = 0; format < 2; ++format) {
+            vertShaderModules[format] = loadShader(1 + 2 * format);
+            depthShaderModules[format] = loadShader(2 + 2 * format);
+        }
+    } catch (...) {
+        destroyShaderModules();
+        throw;
+    }
 
     // --- Define Shader Stages ---
     VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
     vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = vertShaderModule;
     vertShaderStageInfo.pName = "main"; // Entry point function name in the shader
 
     VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
@@ -751,19 +975,6 @@ void VulkanEngine::createGraphicsPipeline() {
     fragShaderStageInfo.module = fragShaderModule;
     fragShaderStageInfo.pName = "main";
 
-    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
-
-    // --- Vertex Input State ---
-    // Describes how vertex data is fed into the vertex shader.
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    auto bindingDescription = Vertex::getBindingDescription(); // Get from Vertex struct
-    auto attributeDescriptions = Vertex::getAttributeDescriptions(); // Get from Vertex struct
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
     // --- Input Assembly State ---
     // Describes how vertices are assembled into primitives (e.g., triangles).
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
@@ -804,11 +1015,17 @@ void VulkanEngine::createGraphicsPipeline() {
     depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
     depthStencil.depthTestEnable = VK_TRUE; // Enable depth testing
     depthStencil.depthWriteEnable = VK_TRUE; // Allow writing to depth buffer
-    // Fragments pass if their depth is less than the stored depth (closer to camera)
-    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    // Fragments pass if their depth is not farther than the stored depth. Equal passes
+    // so that, after a depth prepass, only the nearest surface is shaded (without a
+    // prepass this behaves like LESS).
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
     depthStencil.depthBoundsTestEnable = VK_FALSE; // Not constraining depth range
     depthStencil.stencilTestEnable = VK_FALSE; // Not using stencil buffer
 
+    // The prepass lays down the nearest depth
+    VkPipelineDepthStencilStateCreateInfo prepassDepthStencil = depthStencil;
+    prepassDepthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
     // --- Color Blend State --- (Disabled - standard opaque rendering)
     VkPipelineColorBlendAttachmentState colorBlendAttachment{}; // State per attachment
     colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
@@ -820,6 +1037,12 @@ void VulkanEngine::createGraphicsPipeline() {
     colorBlending.attachmentCount = 1;
     colorBlending.pAttachments = &colorBlendAttachment; // State for the single color attachment
 
+    // The prepass has no fragment shader and leaves the color attachment untouched
+    VkPipelineColorBlendAttachmentState prepassBlendAttachment = colorBlendAttachment;
+    prepassBlendAttachment.colorWriteMask = 0;
+    VkPipelineColorBlendStateCreateInfo prepassColorBlending = colorBlending;
+    prepassColorBlending.pAttachments = &prepassBlendAttachment;
+
     // --- Dynamic State ---
     // Specifies which pipeline states can be changed dynamically via command buffers.
     std::vector<VkDynamicState> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
@@ -839,8 +1062,7 @@ void VulkanEngine::createGraphicsPipeline() {
 
     if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
         // Cleanup shader modules if layout creation fails
-        vkDestroyShaderModule(device, fragShaderModule, nullptr);
-        vkDestroyShaderModule(device, vertShaderModule, nullptr);
+        destroyShaderModules();
         throw std::runtime_error("Failed to create pipeline layout!");
     }
 
@@ -848,9 +1070,6 @@ void VulkanEngine::createGraphicsPipeline() {
     // Brings all the state objects together.
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2; // Number of shader stages
-    pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
     pipelineInfo.pViewportState = &viewportState;
     pipelineInfo.pRasterizationState = &rasterizer;
@@ -864,20 +1083,69 @@ void VulkanEngine::createGraphicsPipeline() {
     // pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Not deriving from another pipeline
     // pipelineInfo.basePipelineIndex = -1;
 
-    // Create the graphics pipeline object
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-        // Cleanup layout and shader modules if pipeline creation fails
-        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-        vkDestroyShaderModule(device, fragShaderModule, nullptr);
-        vkDestroyShaderModule(device, vertShaderModule, nullptr);
-        throw std::runtime_error("Failed to create graphics pipeline!");
+    // --- Variants: pass x VertexFormat x VertexLayout ---
+    // The create infos point into these arrays, so they are filled before any pointer is taken
+    constexpr size_t VARIANT_COUNT = 2 * PIPELINE_FORMATS * PIPELINE_LAYOUTS;
+    std::array<VertexStreams::InputDescription, VARIANT_COUNT> inputDescriptions;
+    std::array<VkPipelineVertexInputStateCreateInfo, VARIANT_COUNT> vertexInputInfos{};
+    std::array<std::array<VkPipelineShaderStageCreateInfo, 2>, VARIANT_COUNT> shaderStages{};
+    std::array<VkGraphicsPipelineCreateInfo, VARIANT_COUNT> pipelineInfos{};
+    std::array<VkPipeline*, VARIANT_COUNT> targets{};
+
+    size_t variant = 0;
+    for (int depthOnly = 0; depthOnly < 2; ++depthOnly) {
+        for (size_t format = 0; format < PIPELINE_FORMATS; ++format) {
+            for (size_t layout = 0; layout < PIPELINE_LAYOUTS; ++layout, ++variant) {
+                // The vertex input declares only the streams the vertex shader reads
+                const uint32_t streams = depthOnly ? VERTEX_STREAM_POSITION : VERTEX_STREAM_ALL;
+                inputDescriptions[variant] = VertexStreams::describe(static_cast<VertexFormat>(format),
+                                                                     static_cast<VertexLayout>(layout), streams);
+                const VertexStreams::InputDescription& input = inputDescriptions[variant];
+
+                VkPipelineVertexInputStateCreateInfo& vertexInputInfo = vertexInputInfos[variant];
+                vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+                vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(input.bindings.size());
+                vertexInputInfo.pVertexBindingDescriptions = input.bindings.data();
+                vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(input.attributes.size());
+                vertexInputInfo.pVertexAttributeDescriptions = input.attributes.data();
+
+                shaderStages[variant] = {vertShaderStageInfo, fragShaderStageInfo};
+                shaderStages[variant][0].module = depthOnly ? depthShaderModules[format] : vertShaderModules[format];
+
+                VkGraphicsPipelineCreateInfo& info = pipelineInfos[variant];
+                info = pipelineInfo;
+                info.stageCount = depthOnly ? 1 : 2; // Depth only: vertex shader alone
+                info.pStages = shaderStages[variant].data();
+                info.pVertexInputState = &vertexInputInfo;
+                if (depthOnly) {
+                    info.pDepthStencilState = &prepassDepthStencil;
+                    info.pColorBlendState = &prepassColorBlending;
+                }
+                targets[variant] = depthOnly ? &depthPipelines[format][layout] : &meshPipelines[format][layout];
+            }
+        }
     }
 
+    // Create all graphics pipeline objects in one call
+    std::array<VkPipeline, VARIANT_COUNT> pipelines{};
+    VkResult pipelineResult = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, static_cast<uint32_t>(pipelineInfos.size()),
+                                                        pipelineInfos.data(), nullptr, pipelines.data());
+
     // --- Cleanup ---
     // Shader modules can be destroyed after pipeline creation as they are baked into the pipeline object.
-    vkDestroyShaderModule(device, fragShaderModule, nullptr);
-    vkDestroyShaderModule(device, vertShaderModule, nullptr);
-     std::cout << "Graphics Pipeline Created." << std::endl;
+    destroyShaderModules();
+
+    if (pipelineResult != VK_SUCCESS) {
+        // Cleanup pipelines that were created and the layout if pipeline creation fails
+        for (VkPipeline pipeline : pipelines) {
+            if (pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, pipeline, nullptr);
+        }
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        pipelineLayout = VK_NULL_HANDLE;
+        throw std::runtime_error("Failed to create graphics pipeline!");
+    }
+    for (size_t i = 0; i < VARIANT_COUNT; ++i) *targets[i] = pipelines[i];
+     std::cout << "Graphics Pipelines Created." << std::endl;
 
 }
 
@@ -906,6 +1174,39 @@ void VulkanEngine::createCommandPool() {
 
 }
 
+/**
+ * @brief Creates the upload manager on the dedicated transfer queue, or on the graphics queue.
+ *
+ * The transfer queue is only used with timeline semaphores, through which frames wait
+ * on the GPU for the copies they read. Buffers written there are shared concurrently
+ * with the graphics family rather than having their ownership transferred. Without
+ * timeline semaphores uploads go to the graphics queue and end with a barrier for
+ * vertex input and the culling shader, so later frames see the data in queue order.
+ * Unless setDirectUploads(false) was called, geometry is written straight into
+ * device-local memory when the device's main heap is host-visible.
+ *
+ * Keywords: Transfer Queue, Timeline Semaphore, Concurrent Sharing, Upload Manager, ReBAR
+ */
+void VulkanEngine::createUploadManager() {
+    VulkanUtils::QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    uploadQueueFamilies.clear();
+    if (timelineSemaphores && transferQueue != VK_NULL_HANDLE) {
+        uploads.create(allocator, indices.transferFamily.value(), transferQueue, true,
+                       UploadManager::DEFAULT_STAGING_SIZE, directUploads);
+        uploadQueueFamilies = {indices.graphicsFamily.value(), indices.transferFamily.value()};
+    } else {
+        uploads.create(allocator, indices.graphicsFamily.value(), graphicsQueue, timelineSemaphores,
+                       UploadManager::DEFAULT_STAGING_SIZE, directUploads);
+        if (!timelineSemaphores) {
+            uploads.setConsumerBarrier(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | MeshletCuller::SHADER_STAGE,
+                VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | MeshletCuller::SHADER_ACCESS);
+        }
+    }
+     std::cout << "Upload Manager Created (" << (uploadQueueFamilies.empty() ? "graphics" : "transfer") << " queue, "
+               << (timelineSemaphores ? "timeline semaphore" : "fences") << ", "
+               << (uploads.hasDirectWrites() ? "direct writes into ReBAR/UMA memory" : "staged") << ")." << std::endl;
+}
+
 /**
  * @brief Creates the depth buffer image and image view.
  *
@@ -918,7 +1219,7 @@ void VulkanEngine::createDepthResources() {
     VkFormat depthFormat = VulkanUtils::findDepthFormat(physicalDevice);
 
     // Create the depth image
-    VulkanUtils::createImage(physicalDevice, device,
+    VulkanUtils::createImage(allocator,
         swapChainExtent.width, swapChainExtent.height,
         depthFormat,
         VK_IMAGE_TILING_OPTIMAL, // Optimal tiling for GPU access
@@ -980,122 +1281,166 @@ void VulkanEngine::createFramebuffers() {
 
 /**
  * @brief Creates the Vertex Buffer (VkBuffer).
- * @param sceneVertices Vector of vertex data provided by the Scene.
+ * @param sceneVertices Vertex data provided by the Scene (may point into a memory-mapped file).
+ * @param vertexCount Number of vertices.
+ * @param format Vertex format of the GPU buffer; Quantized converts the vertices on the way.
+ * @param layout Interleaved, or Split into a position stream and an attribute stream.
+ * @param quantization Dequantization parameters of the mesh (Quantized format only).
  *
- * Creates a device-local buffer and copies the vertex data into it using a staging buffer.
+ * Creates a device-local buffer and records an upload of the vertex data into it. The data
+ * is written (quantized, split) straight from its source into the upload manager's mapped
+ * staging memory; the copy is submitted without waiting (see initVulkan).
  *
  * Keywords: VkBuffer, Vertex Buffer Object (VBO), Staging Buffer, Device Local Memory
  */
-void VulkanEngine::createVertexBuffer(const std::vector<Vertex>& sceneVertices) {
-    if (sceneVertices.empty()) {
+void VulkanEngine::createVertexBuffer(const Vertex* sceneVertices, size_t vertexCount, VertexFormat format,
+                                      VertexLayout layout, const VertexQuantizer::Quantization& quantization) {
+    if (sceneVertices == nullptr || vertexCount == 0) {
         throw std::runtime_error("Cannot create vertex buffer, vertex data is empty!");
     }
-    VkDeviceSize bufferSize = sizeof(sceneVertices[0]) * sceneVertices.size();
-
-    // 1. Create Staging Buffer (CPU-visible memory)
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    VulkanUtils::createBuffer(physicalDevice, device, bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT, // Usage: Source for transfer
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, // CPU visible & coherent
-        stagingBuffer, stagingBufferMemory);
-
-    // 2. Map staging buffer memory and copy vertex data into it
-    void* data;
-    // Map the whole buffer memory range
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, sceneVertices.data(), (size_t)bufferSize); // Copy data from vector
-    vkUnmapMemory(device, stagingBufferMemory); // Unmap (coherent means no explicit flush needed)
-
-    // 3. Create Vertex Buffer (GPU-local memory)
-    VulkanUtils::createBuffer(physicalDevice, device, bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, // Usage: Destination for transfer + Vertex buffer
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, // Optimal GPU memory
+    VkDeviceSize bufferSize = VertexStreams::bufferSize(format, layout, vertexCount);
+
+    // 1. Create Vertex Buffer (GPU-local memory, host-visible too on ReBAR/UMA, shared with the upload queue)
+    uploads.createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, uploadQueueFamilies,
         vertexBuffer, vertexBufferMemory);
 
-    // 4. Copy data from staging buffer to vertex buffer using the utility function
-    VulkanUtils::copyBuffer(device, commandPool, graphicsQueue, stagingBuffer, vertexBuffer, bufferSize);
+    // 2. Write the vertices, converted to the mesh's format and layout, into the buffer or staging memory
+    uploads.upload(vertexBuffer, vertexBufferMemory, 0, bufferSize, [&](void* data) {
+        VertexStreams::write(sceneVertices, vertexCount, format, layout, quantization, data);
+    });
+
+    meshVertexFormat = format;
+    meshVertexLayout = layout;
+    meshAttributeOffset = VertexStreams::attributeOffset(format, layout, vertexCount);
+    meshQuantization = quantization;
+     std::cout << "Vertex Buffer Created (" << vertexCount << " vertices, " << bufferSize << " bytes, "
+               << (uploads.isDirect(vertexBufferMemory) ? "direct" : "staged") << ")." << std::endl;
+}
 
-    // 5. Destroy the staging buffer and its memory (no longer needed)
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+/**
+ * @brief Streams a model file directly into device-local vertex and index buffers.
+ * @param modelPath Path to the OBJ file.
+ * @param options Streaming options (scale, host memory budget).
+ *
+ * The importer converts faces straight into persistently mapped staging rings, and
+ * full ring blocks are copied to the final buffers while parsing continues, so host
+ * memory stays within the budget regardless of model size.
+ *
+ * Keywords: Streaming Import, Staging Ring, Bounded Memory Upload
+ */
+void VulkanEngine::importStreamedModel(const std::string& modelPath, const ObjStreamImporter::Options& options) {
+    GpuMeshStreamSink sink(allocator, commandPool, graphicsQueue);
+    ObjStreamImporter::Stats stats;
+    if (!ObjStreamImporter::import(modelPath, options, sink, stats)) {
+        throw std::runtime_error("Failed to stream model: " + modelPath);
+    }
+    sink.release(vertexBuffer, vertexBufferMemory, indexBuffer, indexBufferMemory, indexCount);
 
-     std::cout << "Vertex Buffer Created (" << sceneVertices.size() << " vertices)." << std::endl;
+    std::cout << "Vertex Buffer Created (" << stats.vertexCount << " vertices, streamed)." << std::endl;
+    std::cout << "Index Buffer Created (" << indexCount << " indices, streamed)." << std::endl;
 }
 
 /**
  * @brief Creates the Index Buffer (VkBuffer).
- * @param sceneIndices Vector of index data provided by the Scene.
+ * @param mesh Mesh provided by the Scene (its indices may point into a memory-mapped file).
+ * @param layout Index width and draw ranges chosen for the mesh (see IndexPacker).
  *
- * Creates a device-local buffer and copies the index data into it using a staging buffer.
- * Also stores the index count for use in draw calls.
+ * Creates a device-local buffer and records an upload of the index data into it,
+ * narrowing it to 16 bits when the layout says so. Also stores the index count and
+ * layout for use in draw calls.
  *
- * Keywords: VkBuffer, Index Buffer Object (IBO), Element Buffer, Staging Buffer
+ * Keywords: VkBuffer, Index Buffer Object (IBO), Element Buffer, Staging Buffer, 16-bit Indices
  */
-void VulkanEngine::createIndexBuffer(const std::vector<uint32_t>& sceneIndices) {
-     if (sceneIndices.empty()) {
+void VulkanEngine::createIndexBuffer(const MeshView& mesh, const IndexPacker::Layout& layout) {
+     if (mesh.indices == nullptr || mesh.indexCount == 0) {
         throw std::runtime_error("Cannot create index buffer, index data is empty!");
     }
-    VkDeviceSize bufferSize = sizeof(sceneIndices[0]) * sceneIndices.size();
-    indexCount = static_cast<uint32_t>(sceneIndices.size()); // Store count for drawing
-
-    // 1. Create Staging Buffer
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    VulkanUtils::createBuffer(physicalDevice, device, bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        stagingBuffer, stagingBufferMemory);
-
-    // 2. Map and Copy data
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, sceneIndices.data(), (size_t)bufferSize);
-    vkUnmapMemory(device, stagingBufferMemory);
-
-    // 3. Create Index Buffer
-    VulkanUtils::createBuffer(physicalDevice, device, bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, // Usage: Destination + Index buffer
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+    VkDeviceSize bufferSize = layout.indexSize() * mesh.indexCount;
+    indexCount = static_cast<uint32_t>(mesh.indexCount); // Store count for drawing
+    meshIndexLayout = layout;
+
+    // 1. Create Index Buffer
+    uploads.createBuffer(bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, uploadQueueFamilies,
         indexBuffer, indexBufferMemory);
 
-    // 4. Copy from staging to index buffer
-    VulkanUtils::copyBuffer(device, commandPool, graphicsQueue, stagingBuffer, indexBuffer, bufferSize);
+    // 2. Write the indices into the buffer or staging memory
+    uploads.upload(indexBuffer, indexBufferMemory, 0, bufferSize, [&](void* data) {
+        if (layout.format == IndexFormat::Uint16) {
+            IndexPacker::packUint16(mesh, layout, static_cast<uint16_t*>(data));
+        } else {
+            memcpy(data, mesh.indices, (size_t)bufferSize);
+        }
+    });
+
+     std::cout << "Index Buffer Created (" << indexCount << " indices, "
+               << (layout.format == IndexFormat::Uint16 ? 16 : 32) << "-bit, "
+               << layout.ranges.size() << " draw ranges, "
+               << (uploads.isDirect(indexBufferMemory) ? "direct" : "staged") << ")." << std::endl;
 
-    // 5. Destroy staging buffer
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+}
 
-     std::cout << "Index Buffer Created (" << indexCount << " indices)." << std::endl;
+/**
+ * @brief Hands the meshlets of a mesh to the meshlet culler.
+ * @param mesh Loaded mesh whose meshlets (LOD 0) are culled before drawing.
+ *
+ * With GPU culling the meshlet records are also uploaded into a device-local storage
+ * buffer read by the culling shader; otherwise the culler keeps only the CPU copy.
+ *
+ * Keywords: Meshlet Buffer, Storage Buffer, Staging Buffer
+ */
+void VulkanEngine::createMeshletBuffer(const LoadedMesh& mesh) {
+    std::vector<MeshletCullData> meshlets = MeshletCuller::makeCullData(mesh.meshlets, mesh.meshletBounds,
+                                                                       mesh.indexLayout.meshletVertexOffsets);
+    VkBuffer meshletBuffer = VK_NULL_HANDLE;
+    DeviceAllocator::Allocation meshletMemory;
+
+    if (multiDrawIndirectEnabled && !meshlets.empty()) {
+        VkDeviceSize bufferSize = sizeof(MeshletCullData) * meshlets.size();
+
+        // Create the storage buffer and upload the records into it
+        uploads.createBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, uploadQueueFamilies,
+            meshletBuffer, meshletMemory);
+        uploads.upload(meshletBuffer, meshletMemory, 0, meshlets.data(), bufferSize);
+    }
 
+    const size_t meshletCount = meshlets.size();
+    meshletCuller.setMeshlets(std::move(meshlets), meshletBuffer, meshletMemory, deletionQueue, frameScheduler.getFrameNumber());
+    std::cout << "Meshlets Created (" << meshletCount << ", culled on the "
+              << (meshletCuller.usesGpu() ? "GPU" : "CPU") << ")." << std::endl;
 }
 
 /**
  * @brief Creates Uniform Buffers (VkBuffer).
  *
  * Creates one UBO for each frame in flight. These buffers are host-visible and
- * persistently mapped for efficient updates from the CPU each frame.
+ * persistently mapped for efficient updates from the CPU each frame. They are
+ * placed in device-local memory when a host-visible type of it has room (BAR,
+ * ReBAR or UMA), so the shaders read them without crossing the bus.
  *
  * Keywords: VkBuffer, Uniform Buffer Object (UBO), Constant Buffer, Host Visible Memory, Persistent Mapping
  */
 void VulkanEngine::createUniformBuffers() {
     VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+    const uint32_t frameCount = frameScheduler.getFramesInFlight();
 
-    uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-    uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+    uniformBuffers.resize(frameCount);
+    uniformBuffersMemory.resize(frameCount);
+    uniformBuffersMapped.resize(frameCount);
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        VulkanUtils::createBuffer(physicalDevice, device, bufferSize,
+    for (size_t i = 0; i < frameCount; i++) {
+        VulkanUtils::createBuffer(allocator, bufferSize,
             VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, // Usage: Uniform buffer
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, // CPU visible & coherent
-            uniformBuffers[i], uniformBuffersMemory[i]);
+            uniformBuffers[i], uniformBuffersMemory[i], {},
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT); // Preferably in GPU memory
 
         // Map the buffer memory once and keep the pointer. Coherent memory doesn't require explicit flush/invalidate.
         // The pointer in uniformBuffersMapped[i] can be used directly with memcpy in updateUniformBuffer.
-        vkMapMemory(device, uniformBuffersMemory[i], 0, bufferSize, 0, &uniformBuffersMapped[i]);
+        uniformBuffersMapped[i] = allocator.map(uniformBuffersMemory[i]);
     }
-     std::cout << "Uniform Buffers Created." << std::endl;
+     std::cout << "Uniform Buffers Created ("
+               << ((allocator.getPropertyFlags(uniformBuffersMemory[0]) & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+                   ? "device-local" : "host") << " memory)." << std::endl;
 
 }
 
@@ -1112,7 +1457,7 @@ void VulkanEngine::createDescriptorPool() {
     VkDescriptorPoolSize poolSize{};
     poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER; // Type of descriptor
     // Number of descriptors of this type (one UBO per frame in flight)
-    poolSize.descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolSize.descriptorCount = frameScheduler.getFramesInFlight();
 
     // --- Descriptor Pool Create Info ---
     VkDescriptorPoolCreateInfo poolInfo{};
@@ -1120,7 +1465,7 @@ void VulkanEngine::createDescriptorPool() {
     poolInfo.poolSizeCount = 1; // Number of pool size structures
     poolInfo.pPoolSizes = &poolSize;
     // Maximum number of descriptor sets that can be allocated from this pool.
-    poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolInfo.maxSets = frameScheduler.getFramesInFlight();
     // Optional flag: VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT allows individual sets to be freed.
 
     if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
@@ -1140,16 +1485,17 @@ void VulkanEngine::createDescriptorPool() {
  */
 void VulkanEngine::createDescriptorSets() {
     // Need one layout per set to allocate
-    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
+    const uint32_t frameCount = frameScheduler.getFramesInFlight();
+    std::vector<VkDescriptorSetLayout> layouts(frameCount, descriptorSetLayout);
 
     // --- Descriptor Set Allocation Info ---
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = descriptorPool; // Pool to allocate from
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    allocInfo.descriptorSetCount = frameCount;
     allocInfo.pSetLayouts = layouts.data(); // Layout for each set
 
-    descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    descriptorSets.resize(frameCount);
     // Allocate the descriptor set handles
     if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
         throw std::runtime_error("Failed to allocate descriptor sets!");
@@ -1157,7 +1503,7 @@ void VulkanEngine::createDescriptorSets() {
 
     // --- Update each Descriptor Set ---
     // Configure each set to point to the correct uniform buffer for that frame.
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (size_t i = 0; i < frameCount; i++) {
         // Information about the buffer to bind
         VkDescriptorBufferInfo bufferInfo{};
         bufferInfo.buffer = uniformBuffers[i]; // The UBO for frame 'i'
@@ -1192,7 +1538,7 @@ void VulkanEngine::createDescriptorSets() {
  * Keywords: VkCommandBuffer, vkAllocateCommandBuffers, Primary Command Buffer
  */
 void VulkanEngine::createCommandBuffers() {
-    commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    commandBuffers.resize(frameScheduler.getFramesInFlight());
 
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -1210,53 +1556,85 @@ void VulkanEngine::createCommandBuffers() {
 }
 
 /**
- * @brief Creates Synchronization Primitives (Semaphores and Fences).
+ * @brief Creates Synchronization Primitives (Semaphores).
  *
- * Creates semaphores to synchronize operations within or across queues (GPU-GPU sync)
- * and fences to synchronize operations between the host (CPU) and a queue (CPU-GPU sync).
- * One set is created for each frame in flight.
+ * Creates the binary semaphores ordering swapchain acquisition before rendering
+ * (GPU-GPU sync). CPU-GPU sync is the frame scheduler's timeline semaphore, created
+ * with it. The semaphores form a ring of FrameScheduler::MAX_FRAMES_IN_FLIGHT indexed
+ * by frame number, so they never need resizing: one is reused four frames later,
+ * after its frame has retired. The semaphores ordering rendering before presentation
+ * belong to the swapchain images (see createSwapChain()).
  *
- * Keywords: VkSemaphore, VkFence, vkCreateSemaphore, vkCreateFence, Synchronization, GPU-GPU Sync, CPU-GPU Sync
+ * Keywords: VkSemaphore, vkCreateSemaphore, Synchronization, GPU-GPU Sync
  */
 void VulkanEngine::createSyncObjects() {
-    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+    imageAvailableSemaphores.resize(FrameScheduler::MAX_FRAMES_IN_FLIGHT);
 
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    // Create fences in the signaled state, so the first call to vkWaitForFences in drawFrame doesn't block indefinitely.
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-    bool success = true;
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS)
+    for (size_t i = 0; i < FrameScheduler::MAX_FRAMES_IN_FLIGHT; i++) {
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS)
         {
-             success = false;
-             // Stop creating on failure
-             // Cleanup already created objects for this frame index 'i'
-             if (inFlightFences[i] != VK_NULL_HANDLE) vkDestroyFence(device, inFlightFences[i], nullptr);
-             if (renderFinishedSemaphores[i] != VK_NULL_HANDLE) vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
-             if (imageAvailableSemaphores[i] != VK_NULL_HANDLE) vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
-             // Cleanup objects created for previous frame indices (0 to i-1)
-             for(size_t j = 0; j < i; ++j) {
-                vkDestroyFence(device, inFlightFences[j], nullptr);
-                vkDestroySemaphore(device, renderFinishedSemaphores[j], nullptr);
-                vkDestroySemaphore(device, imageAvailableSemaphores[j], nullptr);
-             }
-             // Clear vectors to prevent double deletion in main cleanup
-            imageAvailableSemaphores.clear();
-            renderFinishedSemaphores.clear();
-            inFlightFences.clear();
+            // Handles left null are skipped by cleanup()
             throw std::runtime_error("Failed to create synchronization objects for a frame!");
         }
     }
-     std::cout << "Synchronization Objects Created." << std::endl;
+     std::cout << "Synchronization Objects Created (" << frameScheduler.getFramesInFlight() << " frames in flight, "
+               << (frameScheduler.getTimeline() != VK_NULL_HANDLE ? "timeline semaphore" : "fences") << ")." << std::endl;
+}
+
+/**
+ * @brief Destroys the uniform buffers, descriptor sets and command buffers of the frames in flight.
+ *
+ * None of the frames using them may still be executing.
+ */
+void VulkanEngine::destroyFrameResources() {
+    for (size_t i = 0; i < uniformBuffers.size(); ++i) {
+        if (uniformBuffersMemory[i].isValid()) allocator.unmap(uniformBuffersMemory[i]);
+        VulkanUtils::destroyBuffer(allocator, uniformBuffers[i], uniformBuffersMemory[i]);
+    }
+    uniformBuffers.clear();
+    uniformBuffersMemory.clear();
+    uniformBuffersMapped.clear();
+
+    // Destroying the pool frees its descriptor sets
+    if (descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    descriptorPool = VK_NULL_HANDLE;
+    descriptorSets.clear();
+
+    if (!commandBuffers.empty()) {
+        vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+    }
+    commandBuffers.clear();
+}
+
+/**
+ * @brief Applies a new frames-in-flight count (setFramesInFlight) between two frames.
+ *
+ * Waits for the submitted frames to retire (on the frame timeline, not the whole
+ * device), then recreates every per-frame resource for the new count. Frame indices
+ * restart at 0.
+ *
+ * Keywords: Frames In Flight, Latency, Per-Frame Resources
+ */
+void VulkanEngine::resizeFrameResources() {
+    frameScheduler.setFramesInFlight(framesInFlight); // Waits for every submitted frame
+    deletionQueue.flush(frameScheduler.getCompletedFrames());
+
+    destroyFrameResources();
+    createUniformBuffers();
+    createDescriptorPool();
+    createDescriptorSets();
+    createCommandBuffers();
+    meshletCuller.setFramesInFlight(framesInFlight);
+    if (gpuTiming) {
+        gpuTimer.destroy();
+        gpuTimer.create(physicalDevice, device, findQueueFamilies(physicalDevice).graphicsFamily.value(),
+                        framesInFlight, TIMESTAMP_COUNT);
+    }
+
+    std::cout << "Frames in flight: " << framesInFlight << "." << std::endl;
 }
 
 
@@ -1290,7 +1668,8 @@ void VulkanEngine::updateUniformBuffer(uint32_t currentImageIndex, const Scene&
                            glm::vec3(0.0f, 1.0f, 0.0f)); // Up vector (Y is up)
 
     // Projection matrix: Perspective projection
-    ubo.proj = glm::perspective(glm::radians(45.0f), // Vertical field-of-view
+    const float fovY = glm::radians(45.0f);
+    ubo.proj = glm::perspective(fovY, // Vertical field-of-view
                                 swapChainExtent.width / (float)swapChainExtent.height, // Aspect ratio
                                 0.1f,  // Near clipping plane
                                 20.0f); // Far clipping plane (adjust based on room size)
@@ -1300,6 +1679,15 @@ void VulkanEngine::updateUniformBuffer(uint32_t currentImageIndex, const Scene&
     // Flipping the sign of the Y scaling factor in the projection matrix corrects this.
     ubo.proj[1][1] *= -1;
 
+    // Level of detail for this frame's draw, and the frustum/camera to cull its meshlets with
+    // (never finer than what a progressive upload has made resident so far)
+    currentLod = std::max(selectLod(ubo.view * ubo.model, fovY), residentLod);
+    cullParams = meshletCuller.computeParams(ubo.proj * ubo.view * ubo.model, ubo.view * ubo.model);
+
+    // Dequantization of the displayed mesh (ignored by the full-precision vertex shader)
+    ubo.positionScale = glm::vec4(meshQuantization.scale, 0.0f);
+    ubo.positionOffset = glm::vec4(meshQuantization.offset, 0.0f);
+
     // --- Copy data to the mapped buffer ---
     // uniformBuffersMapped[currentImageIndex] points directly to the UBO memory for this frame.
     memcpy(uniformBuffersMapped[currentImageIndex], &ubo, sizeof(ubo));
@@ -1327,6 +1715,18 @@ void VulkanEngine::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t i
         throw std::runtime_error("Failed to begin recording command buffer!");
     }
 
+    // --- Meshlet Culling ---
+    // LOD 0 is drawn through the meshlet culler. Its compute prepass writes this frame's
+    // indirect draws and must run before the render pass begins.
+    const bool cullMeshlets = indexCount > 0 && meshletCulling && currentLod == 0 && meshletCuller.hasMeshlets();
+    if (cullMeshlets) {
+        meshletCuller.recordCull(commandBuffer, currentFrame, cullParams);
+    }
+
+    // --- GPU Timing ---
+    // This frame's timestamp queries are reused, so they are reset before the render pass
+    gpuTimer.reset(commandBuffer, currentFrame);
+
     // --- Begin Render Pass ---
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -1347,9 +1747,6 @@ void VulkanEngine::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t i
     // VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS: Primary buffer executes secondary buffers.
     vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-    // --- Bind Pipeline ---
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-
     // --- Set Dynamic State ---
     // Set Viewport
     VkViewport viewport{};
@@ -1367,29 +1764,74 @@ void VulkanEngine::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t i
     scissor.extent = swapChainExtent;
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    // --- Bind Buffers ---
-    // Bind Vertex Buffer
-    VkBuffer vertexBuffers[] = {vertexBuffer};
-    VkDeviceSize offsets[] = {0}; // Starting offset in the buffer
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets); // Bind to binding point 0
-
-    // Bind Index Buffer
-    // VK_INDEX_TYPE_UINT32 because our indices vector uses uint32_t
-    vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-    // --- Bind Descriptor Sets ---
-    // Bind the descriptor set for the current frame (containing the updated UBO)
-    // Binds set `descriptorSets[currentFrame]` to set index 0 for the graphics pipeline.
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
-
-    // --- Issue Draw Call ---
-    // Draw the indexed geometry.
-    // indexCount: Number of indices to draw (retrieved when index buffer was created).
-    // instanceCount: 1 (not using instancing).
-    // firstIndex: 0 (start at the beginning of the index buffer).
-    // vertexOffset: 0 (add to vertex index before indexing into vertex buffer).
-    // firstInstance: 0 (offset for instanced rendering).
-    vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+    gpuTimer.write(commandBuffer, currentFrame, TIMESTAMP_PASS_BEGIN, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+    // While the model is still loading there is no geometry yet: the pass only clears
+    const bool prepass = indexCount > 0 && depthPrepass;
+    if (indexCount > 0) {
+        // --- Bind Buffers ---
+        // Bind Vertex Buffer: binding 0 holds whole vertices (interleaved) or positions
+        // (split); with the split layout binding 1 holds normals and colors, further
+        // into the same buffer. Pipelines only fetch the bindings they declare.
+        VkBuffer vertexBuffers[] = {vertexBuffer, vertexBuffer};
+        VkDeviceSize offsets[] = {0, meshAttributeOffset}; // Starting offset of each stream in the buffer
+        const uint32_t streamCount = meshVertexLayout == VertexLayout::Split ? 2 : 1;
+        vkCmdBindVertexBuffers(commandBuffer, 0, streamCount, vertexBuffers, offsets);
+
+        // Bind Index Buffer
+        // 16-bit when every draw range of the mesh reaches its vertices from its base vertex
+        const VkIndexType indexType = meshIndexLayout.format == IndexFormat::Uint16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, indexType);
+
+        // --- Bind Descriptor Sets ---
+        // Bind the descriptor set for the current frame (containing the updated UBO)
+        // Binds set `descriptorSets[currentFrame]` to set index 0 for the graphics pipeline.
+        // All mesh pipelines share the layout, so the set stays bound across them.
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+
+        // --- Issue Draw Calls ---
+        // Draw the indexed geometry of the selected level of detail. All levels share
+        // the buffers; without LODs the whole index buffer is the only level. A level
+        // is one draw range, or several when it was split for 16-bit indices.
+        // indexCount: Number of indices of the range.
+        // instanceCount: 1 (not using instancing).
+        // firstIndex: Where the range's indices start in the index buffer.
+        // vertexOffset: Base vertex of the range (added to each index).
+        // firstInstance: 0 (offset for instanced rendering).
+        // LOD 0 with meshlets draws only the meshlets that survived culling.
+        auto drawMesh = [&]() {
+            if (cullMeshlets) {
+                meshletCuller.recordDraw(commandBuffer, currentFrame);
+            } else if (currentLod < meshIndexLayout.lodCount()) {
+                for (uint32_t r = meshIndexLayout.lodRangeOffsets[currentLod]; r < meshIndexLayout.lodRangeOffsets[currentLod + 1]; ++r) {
+                    const IndexRange& range = meshIndexLayout.ranges[r];
+                    vkCmdDrawIndexed(commandBuffer, range.indexCount, 1, range.firstIndex, range.vertexOffset, 0);
+                }
+            } else {
+                vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+            }
+        };
+
+        // The pipelines' vertex input must match the format and layout of the displayed mesh's vertex buffer
+        const size_t format = static_cast<size_t>(meshVertexFormat);
+        const size_t layout = static_cast<size_t>(meshVertexLayout);
+
+        // --- Depth Prepass ---
+        // Positions only: fills the depth buffer so the shading pass below runs the
+        // fragment shader once per pixel (its LESS_OR_EQUAL test rejects hidden surfaces)
+        if (prepass) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depthPipelines[format][layout]);
+            drawMesh();
+        }
+        gpuTimer.write(commandBuffer, currentFrame, TIMESTAMP_PREPASS_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+        // --- Shading Pass ---
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshPipelines[format][layout]);
+        drawMesh();
+    } else {
+        gpuTimer.write(commandBuffer, currentFrame, TIMESTAMP_PREPASS_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    }
+    gpuTimer.write(commandBuffer, currentFrame, TIMESTAMP_PASS_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
 
     // --- End Render Pass ---
     vkCmdEndRenderPass(commandBuffer);
@@ -1400,6 +1842,508 @@ void VulkanEngine::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t i
     }
 }
 
+/**
+ * @brief Advances the background mesh upload by one step, without blocking.
+ * @param scene Scene whose published mesh should end up on screen.
+ *
+ * Steps, one per call as each becomes ready:
+ * 1. The scene published a new mesh version: create the buffers and start copying
+ *    the mesh into mapped staging memory on a worker thread.
+ * 2. The staging copy finished: submit the GPU copies through the upload manager.
+ * 3. Their ticket completed: swap in the new buffers and retire the old ones to the
+ *    deletion queue (they may still be used by frames in flight).
+ *
+ * A progressive upload only needs step 1 here, and releasing the CPU copy once the
+ * staging worker is done; its copies and the swap happen in streamMeshUpload().
+ *
+ * An upload superseded before step 2 is moved to abandonedUploads, and a later call
+ * destroys it once its worker has finished, so the frame never waits for the copy.
+ *
+ * Keywords: Asynchronous Upload, Buffer Swap, Upload Tickets, Deferred Deletion
+ */
+void VulkanEngine::pollMeshUpload(const Scene& scene) {
+    // Superseded uploads are freed once their staging worker has let go of the buffers
+    for (size_t i = 0; i < abandonedUploads.size();) {
+        if (abandonedUploads[i].stagingCopy.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++i;
+            continue;
+        }
+        destroyMeshUpload(abandonedUploads[i]);
+        abandonedUploads.erase(abandonedUploads.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+
+    // A newer mesh supersedes an upload that has not been submitted yet. Its worker may
+    // still be writing, so the upload is set aside rather than waited for.
+    if (scene.getMeshVersion() != displayedMeshVersion &&
+        (!meshUpload.active || (!meshUpload.submitted && meshUpload.version != scene.getMeshVersion()))) {
+        if (meshUpload.active) {
+            abandonedUploads.push_back(std::move(meshUpload));
+            meshUpload = MeshUpload();
+        }
+        std::shared_ptr<const LoadedMesh> mesh = scene.getMesh();
+        if (!mesh || mesh->geometry->getIndexCount() == 0 || mesh->geometry->getVertexCount() == 0) {
+            displayedMeshVersion = scene.getMeshVersion(); // Nothing to upload (keep drawing what we have)
+        } else if (!mesh->geometry->isCpuResident()) {
+            // Already uploaded once and released; only a reload brings the data back
+            std::cerr << "Mesh geometry has no CPU copy left to upload." << std::endl;
+            displayedMeshVersion = scene.getMeshVersion();
+        } else {
+            beginMeshUpload(mesh, scene.getMeshVersion());
+        }
+        return;
+    }
+
+    if (!meshUpload.active) return;
+
+    if (meshUpload.progressive) {
+        if (meshUpload.source && meshUpload.stagingCopy.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            meshUpload.stagingCopy.get(); // Propagates a failed copy
+            releaseMeshUploadSource();
+        }
+        return;
+    }
+
+    if (!meshUpload.submitted) {
+        if (meshUpload.stagingCopy.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+        meshUpload.stagingCopy.get(); // Propagates a failed copy
+        submitMeshUpload();
+        return;
+    }
+
+    if (!uploads.isComplete(meshUpload.ticket)) return;
+
+    // --- Copies landed: swap buffers ---
+    swapInMeshUpload();
+    destroyMeshUpload(meshUpload);
+
+    std::cout << "Mesh swapped in (" << indexCount << " indices)." << std::endl;
+}
+
+/**
+ * @brief Creates the buffers for a mesh upload and starts the staging copy on a worker.
+ * @param mesh Mesh to upload (kept alive by the upload until the copy is done).
+ * @param version Scene mesh version of the data.
+ *
+ * Vertices, indices and meshlet records share one staging buffer, in that order,
+ * unless the device buffers are host-visible and written directly.
+ * A progressive upload writes them level by level, coarsest first, and plans the
+ * copies streamMeshUpload() will submit.
+ */
+void VulkanEngine::beginMeshUpload(const std::shared_ptr<const LoadedMesh>& mesh, uint64_t version) {
+    MeshUpload& upload = meshUpload;
+    upload.active = true;
+    upload.submitted = false;
+    upload.version = version;
+    upload.source = mesh;
+    upload.sourceData = mesh->geometry->getCpuData();
+    const MeshView view = upload.sourceData->view;
+    upload.vertexFormat = mesh->vertexFormat;
+    upload.vertexLayout = mesh->vertexLayout;
+    upload.quantization = mesh->quantization;
+    upload.vertexBytes = VertexStreams::bufferSize(upload.vertexFormat, upload.vertexLayout, view.vertexCount);
+    upload.attributeOffset = VertexStreams::attributeOffset(upload.vertexFormat, upload.vertexLayout,
+                                                            view.vertexCount);
+    upload.indexLayout = mesh->indexLayout;
+    upload.indexBytes = upload.indexLayout.indexSize() * view.indexCount;
+    upload.indexCount = static_cast<uint32_t>(view.indexCount);
+    upload.lods = mesh->geometry->getLods();
+    upload.sphereCenter = mesh->boundingSphereCenter;
+    upload.sphereRadius = mesh->boundingSphereRadius;
+    upload.meshlets = MeshletCuller::makeCullData(mesh->meshlets, mesh->meshletBounds,
+                                                  upload.indexLayout.meshletVertexOffsets);
+    upload.meshletBytes = multiDrawIndirectEnabled ? sizeof(MeshletCullData) * upload.meshlets.size() : 0;
+    upload.progressive = progressiveUpload && upload.lods.size() >= 2 &&
+                         upload.indexLayout.lodCount() == upload.lods.size();
+    const VkDeviceSize stagingBytes = upload.vertexBytes + upload.indexBytes + upload.meshletBytes;
+
+    // 1. The final device-local buffers (host-visible too when the upload manager writes directly)
+    uploads.createBuffer(upload.vertexBytes, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, uploadQueueFamilies,
+        upload.vertexBuffer, upload.vertexMemory);
+    uploads.createBuffer(upload.indexBytes, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, uploadQueueFamilies,
+        upload.indexBuffer, upload.indexMemory);
+    if (upload.meshletBytes > 0) {
+        uploads.createBuffer(upload.meshletBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, uploadQueueFamilies,
+            upload.meshletBuffer, upload.meshletMemory);
+    }
+    upload.direct = uploads.isDirect(upload.vertexMemory) && uploads.isDirect(upload.indexMemory) &&
+                    (upload.meshletBytes == 0 || uploads.isDirect(upload.meshletMemory));
+
+    // 2. Map once here (the device buffers, or a staging buffer (CPU-visible) holding all streams in order);
+    //    the (possibly large) memcpy runs on a worker so the frame loop keeps going
+    char* vertexOut = nullptr;
+    char* indexOut = nullptr;
+    char* meshletOut = nullptr;
+    if (upload.direct) {
+        upload.directMemory = {upload.vertexMemory, upload.indexMemory};
+        if (upload.meshletBytes > 0) upload.directMemory.push_back(upload.meshletMemory);
+        vertexOut = static_cast<char*>(allocator.map(upload.vertexMemory));
+        indexOut = static_cast<char*>(allocator.map(upload.indexMemory));
+        if (upload.meshletBytes > 0) meshletOut = static_cast<char*>(allocator.map(upload.meshletMemory));
+        uploads.countDirectUpload(stagingBytes);
+    } else {
+        VulkanUtils::createBuffer(allocator, stagingBytes,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            upload.stagingBuffer, upload.stagingMemory);
+        vertexOut = static_cast<char*>(allocator.map(upload.stagingMemory));
+        indexOut = vertexOut + upload.vertexBytes;
+        meshletOut = indexOut + upload.indexBytes;
+    }
+    const size_t indexBytes = static_cast<size_t>(upload.indexBytes);
+    // Owned by the upload and not touched until the swap; the vector's storage stays put when
+    // a superseded upload is moved to abandonedUploads
+    const MeshletCullData* meshlets = upload.meshlets.data();
+    const size_t meshletBytes = static_cast<size_t>(upload.meshletBytes);
+    const VertexFormat format = upload.vertexFormat;
+    const VertexLayout layout = upload.vertexLayout;
+    const VertexQuantizer::Quantization quantization = upload.quantization;
+    if (upload.progressive) {
+        // The swap hands the meshlet records and index layout to the engine while
+        // finer levels are still being staged, so the worker gets its own layout and
+        // the (small) meshlet records are staged right away
+        if (meshletBytes > 0) memcpy(meshletOut, meshlets, meshletBytes);
+        const IndexPacker::Layout levelLayout = upload.indexLayout;
+        const std::vector<MeshLod> lods = upload.lods;
+        std::shared_ptr<std::atomic<uint32_t>> stagedLevels = std::make_shared<std::atomic<uint32_t>>(0);
+        upload.stagedLevels = stagedLevels;
+        upload.stagingCopy = std::async(std::launch::async,
+                                        [vertexOut, indexOut, view, format, layout, quantization, levelLayout, lods, stagedLevels]() {
+            const size_t levelCount = lods.size();
+            for (size_t level = levelCount; level-- > 0;) {
+                const size_t firstVertex = static_cast<size_t>(lods[level].vertexOffset);
+                const size_t endVertex = level + 1 < levelCount ? static_cast<size_t>(lods[level + 1].vertexOffset)
+                                                                : view.vertexCount;
+                VertexStreams::writeRange(view.vertices, view.vertexCount, firstVertex, endVertex - firstVertex,
+                                          format, layout, quantization, vertexOut);
+                if (levelLayout.format == IndexFormat::Uint16) {
+                    IndexPacker::packUint16Level(view, levelLayout, static_cast<uint32_t>(level),
+                                                 reinterpret_cast<uint16_t*>(indexOut));
+                } else {
+                    memcpy(indexOut + sizeof(uint32_t) * lods[level].firstIndex,
+                           view.indices + lods[level].firstIndex, sizeof(uint32_t) * lods[level].indexCount);
+                }
+                stagedLevels->store(static_cast<uint32_t>(levelCount - level), std::memory_order_release);
+            }
+        });
+        planMeshStreaming(view.vertexCount);
+    } else {
+        // A copy, not a pointer into the upload, which moves if it is superseded
+        const IndexPacker::Layout indexLayout = upload.indexLayout;
+        upload.stagingCopy = std::async(std::launch::async,
+                                        [vertexOut, indexOut, meshletOut, view, indexBytes, meshlets, meshletBytes, format, layout, quantization, indexLayout]() {
+            VertexStreams::write(view.vertices, view.vertexCount, format, layout, quantization, vertexOut);
+            if (indexLayout.format == IndexFormat::Uint16) {
+                IndexPacker::packUint16(view, indexLayout, reinterpret_cast<uint16_t*>(indexOut));
+            } else {
+                memcpy(indexOut, view.indices, indexBytes);
+            }
+            if (meshletBytes > 0) memcpy(meshletOut, meshlets, meshletBytes);
+        });
+    }
+
+    std::cout << "Uploading mesh in the background (" << view.vertexCount << " vertices, "
+              << view.indexCount << " indices" << (upload.progressive ? ", coarse level first" : "")
+              << (upload.direct ? ", direct" : ", staged") << ")." << std::endl;
+}
+
+/**
+ * @brief Submits the staging-to-device copies of the mesh upload through the upload manager.
+ *
+ * The copies run on the upload queue; the swap waits for their ticket, and frames
+ * drawing the new buffers wait for it on the GPU as well (see drawFrame).
+ */
+void VulkanEngine::submitMeshUpload() {
+    MeshUpload& upload = meshUpload;
+    releaseMeshUploadSource();
+    upload.submitted = true;
+    if (upload.direct) return; // Already in place; ticket 0 is complete
+
+
+    VkBufferCopy vertexRegion{};
+    vertexRegion.srcOffset = 0;
+    vertexRegion.size = upload.vertexBytes;
+    uploads.copy(upload.stagingBuffer, upload.vertexBuffer, vertexRegion);
+
+    VkBufferCopy indexRegion{};
+    indexRegion.srcOffset = upload.vertexBytes;
+    indexRegion.size = upload.indexBytes;
+    uploads.copy(upload.stagingBuffer, upload.indexBuffer, indexRegion);
+
+    if (upload.meshletBytes > 0) {
+        VkBufferCopy meshletRegion{};
+        meshletRegion.srcOffset = upload.vertexBytes + upload.indexBytes;
+        meshletRegion.size = upload.meshletBytes;
+        uploads.copy(upload.stagingBuffer, upload.meshletBuffer, meshletRegion);
+    }
+
+    upload.ticket = uploads.submit();
+}
+
+/**
+ * @brief Unmaps what the worker wrote into and releases the upload's reference to the CPU mesh data.
+ *
+ * Called once the staging copy is done. The engine no longer needs the CPU copy, so it
+ * is freed here unless something else (physics, picking) asked to keep it.
+ */
+void VulkanEngine::releaseMeshUploadSource() {
+    MeshUpload& upload = meshUpload;
+    unmapMeshUploadTargets(upload); // Coherent memory, no flush needed
+    upload.source->geometry->markUploaded();
+    upload.sourceData.reset();
+    upload.source.reset();
+}
+
+/**
+ * @brief Unmaps the staging buffer, or the device buffers of a direct upload.
+ * @param upload The current upload or an abandoned one.
+ */
+void VulkanEngine::unmapMeshUploadTargets(MeshUpload& upload) {
+    if (upload.stagingMemory.isValid()) allocator.unmap(upload.stagingMemory);
+    for (const DeviceAllocator::Allocation& memory : upload.directMemory) allocator.unmap(memory);
+    upload.directMemory.clear();
+}
+
+/**
+ * @brief Splits a progressive upload into the copies streamMeshUpload() submits.
+ * @param vertexCount Vertices of the mesh (all levels).
+ *
+ * Levels go coarsest first. Each level's vertex range (both streams when split), its
+ * index range and, with LOD 0, the meshlet records are cut into copies of at most
+ * uploadBudgetBytes. The last copy of a level marks it resident. The staging buffer
+ * mirrors the device buffers, so source and destination offsets only differ by the
+ * stream's base in the staging buffer.
+ */
+void VulkanEngine::planMeshStreaming(size_t vertexCount) {
+    MeshUpload& upload = meshUpload;
+    const VkDeviceSize indexSize = upload.indexLayout.indexSize();
+    const uint32_t levelCount = static_cast<uint32_t>(upload.lods.size());
+
+    auto addCopies = [&](VkBuffer dstBuffer, VkDeviceSize srcBase, VkDeviceSize dstOffset, VkDeviceSize size,
+                         uint32_t stagedLevels) {
+        for (VkDeviceSize done = 0; done < size; done += uploadBudgetBytes) {
+            MeshUpload::StreamCopy copy;
+            copy.dstBuffer = dstBuffer;
+            copy.region.srcOffset = srcBase + dstOffset + done;
+            copy.region.dstOffset = dstOffset + done;
+            copy.region.size = std::min(uploadBudgetBytes, size - done);
+            copy.stagedLevels = stagedLevels;
+            upload.streamCopies.push_back(copy);
+        }
+    };
+
+    for (uint32_t level = levelCount; level-- > 0;) {
+        const uint32_t stagedLevels = levelCount - level; // The worker stages levels in the same order
+        const VkDeviceSize firstVertex = static_cast<VkDeviceSize>(upload.lods[level].vertexOffset);
+        const VkDeviceSize endVertex = level + 1 < levelCount
+            ? static_cast<VkDeviceSize>(upload.lods[level + 1].vertexOffset) : vertexCount;
+        if (upload.vertexLayout == VertexLayout::Split) {
+            const VkDeviceSize positionSize = VertexStreams::positionSize(upload.vertexFormat);
+            const VkDeviceSize attributeSize = VertexStreams::attributeSize(upload.vertexFormat);
+            addCopies(upload.vertexBuffer, 0, firstVertex * positionSize, (endVertex - firstVertex) * positionSize,
+                      stagedLevels);
+            addCopies(upload.vertexBuffer, 0, upload.attributeOffset + firstVertex * attributeSize,
+                      (endVertex - firstVertex) * attributeSize, stagedLevels);
+        } else {
+            const VkDeviceSize stride = VertexStreams::bufferSize(upload.vertexFormat, VertexLayout::Interleaved, 1);
+            addCopies(upload.vertexBuffer, 0, firstVertex * stride, (endVertex - firstVertex) * stride, stagedLevels);
+        }
+        addCopies(upload.indexBuffer, upload.vertexBytes, upload.lods[level].firstIndex * indexSize,
+                  upload.lods[level].indexCount * indexSize, stagedLevels);
+        if (level == 0 && upload.meshletBytes > 0) {
+            addCopies(upload.meshletBuffer, upload.vertexBytes + upload.indexBytes, 0, upload.meshletBytes,
+                      stagedLevels);
+        }
+        if (!upload.streamCopies.empty()) upload.streamCopies.back().completesLevel = static_cast<int32_t>(level);
+    }
+}
+
+/**
+ * @brief Submits this frame's share of a progressive upload through the upload manager.
+ *
+ * Copies are submitted in plan order, up to uploadBudgetBytes per frame (at least
+ * one) and only from levels the staging worker has written, so the frame time stays
+ * flat however large the mesh is. The copy completing the coarsest level swaps the
+ * new buffers in; each later level lowers residentLod, which bounds LOD selection.
+ * Either way the frame about to be drawn waits for the copies through meshTicket.
+ * After LOD 0 the staging buffer is retired with that frame, which only completes
+ * after the copies reading it. A direct upload has nothing to copy: each level is
+ * resident as soon as the worker has written it.
+ *
+ * Keywords: Progressive Streaming, Upload Budget, Coarse-to-Fine Refinement
+ */
+void VulkanEngine::streamMeshUpload() {
+    MeshUpload& upload = meshUpload;
+    if (!upload.active || !upload.progressive || upload.streamCopies.empty()) return;
+    const uint32_t stagedLevels = upload.stagedLevels->load(std::memory_order_acquire);
+    if (upload.streamCopies.front().stagedLevels > stagedLevels) return;
+
+    VkDeviceSize submittedBytes = 0;
+    int32_t completedLevel = -1;
+    while (!upload.streamCopies.empty()) {
+        const MeshUpload::StreamCopy& copy = upload.streamCopies.front();
+        if (copy.stagedLevels > stagedLevels) break;
+        if (!upload.direct) {
+            if (submittedBytes > 0 && submittedBytes + copy.region.size > uploadBudgetBytes) break;
+            uploads.copy(upload.stagingBuffer, copy.dstBuffer, copy.region);
+            submittedBytes += copy.region.size;
+        }
+        if (copy.completesLevel >= 0) completedLevel = copy.completesLevel;
+        upload.streamCopies.pop_front();
+    }
+    if (!upload.direct) upload.ticket = uploads.submit();
+    upload.submitted = true; // Data now lands in the new buffers; the upload can no longer be abandoned
+
+    if (completedLevel < 0) return;
+    if (displayedMeshVersion != upload.version) {
+        swapInMeshUpload();
+        std::cout << "Mesh swapped in at LOD " << completedLevel << " (" << meshLods[completedLevel].indexCount
+                  << " of " << indexCount << " indices), refining." << std::endl;
+    }
+    residentLod = static_cast<uint32_t>(completedLevel);
+    meshTicket = upload.ticket; // This frame may draw the level just copied
+    if (completedLevel > 0) return;
+
+    // --- LOD 0 submitted: the upload is complete ---
+    if (upload.source) {
+        upload.stagingCopy.get(); // Every level is staged, so the worker is done
+        releaseMeshUploadSource();
+    }
+    if (upload.stagingBuffer != VK_NULL_HANDLE) {
+        DeviceAllocator* memoryAllocator = &allocator;
+        VkBuffer stagingBuffer = upload.stagingBuffer;
+        DeviceAllocator::Allocation stagingMemory = upload.stagingMemory;
+        deletionQueue.push(frameScheduler.getFrameNumber(), [=]() mutable {
+            VulkanUtils::destroyBuffer(*memoryAllocator, stagingBuffer, stagingMemory);
+        });
+    }
+    upload.stagingBuffer = VK_NULL_HANDLE;
+    upload.stagingMemory = DeviceAllocator::Allocation();
+    upload.ticket = 0; // Nothing left for destroyMeshUpload() to wait for
+    destroyMeshUpload(upload);
+
+    std::cout << "Mesh refined to LOD 0 (" << indexCount << " indices)." << std::endl;
+}
+
+/**
+ * @brief Makes the upload's buffers the displayed mesh and retires the current ones.
+ *
+ * The current buffers may still be read by the frames in flight, so they are only
+ * destroyed once the frame being built now has completed.
+ */
+void VulkanEngine::swapInMeshUpload() {
+    DeviceAllocator* memoryAllocator = &allocator;
+    VkBuffer oldVertexBuffer = vertexBuffer;
+    DeviceAllocator::Allocation oldVertexMemory = vertexBufferMemory;
+    VkBuffer oldIndexBuffer = indexBuffer;
+    DeviceAllocator::Allocation oldIndexMemory = indexBufferMemory;
+    deletionQueue.push(frameScheduler.getFrameNumber(), [=]() mutable {
+        VulkanUtils::destroyBuffer(*memoryAllocator, oldIndexBuffer, oldIndexMemory);
+        VulkanUtils::destroyBuffer(*memoryAllocator, oldVertexBuffer, oldVertexMemory);
+    });
+
+    vertexBuffer = meshUpload.vertexBuffer;
+    vertexBufferMemory = meshUpload.vertexMemory;
+    indexBuffer = meshUpload.indexBuffer;
+    indexBufferMemory = meshUpload.indexMemory;
+    indexCount = meshUpload.indexCount;
+    meshVertexFormat = meshUpload.vertexFormat;
+    meshVertexLayout = meshUpload.vertexLayout;
+    meshAttributeOffset = meshUpload.attributeOffset;
+    meshQuantization = meshUpload.quantization;
+    meshIndexLayout = std::move(meshUpload.indexLayout);
+    meshLods = std::move(meshUpload.lods);
+    meshSphereCenter = meshUpload.sphereCenter;
+    meshSphereRadius = meshUpload.sphereRadius;
+    meshletCuller.setMeshlets(std::move(meshUpload.meshlets), meshUpload.meshletBuffer, meshUpload.meshletMemory,
+                              deletionQueue, frameScheduler.getFrameNumber());
+    currentLod = 0;
+    residentLod = 0;
+    displayedMeshVersion = meshUpload.version;
+    meshTicket = meshUpload.ticket;
+
+    // Ownership moved to the engine; destroyMeshUpload() frees only the staging side
+    meshUpload.vertexBuffer = VK_NULL_HANDLE;
+    meshUpload.vertexMemory = DeviceAllocator::Allocation();
+    meshUpload.indexBuffer = VK_NULL_HANDLE;
+    meshUpload.indexMemory = DeviceAllocator::Allocation();
+    meshUpload.meshletBuffer = VK_NULL_HANDLE;
+    meshUpload.meshletMemory = DeviceAllocator::Allocation();
+}
+
+/**
+ * @brief Releases everything owned by a mesh upload and resets it.
+ * @param upload The current upload or an abandoned one.
+ *
+ * Waits for the staging worker and submitted copies first; only called when they
+ * are known to be done, when nothing was submitted, or during cleanup.
+ */
+void VulkanEngine::destroyMeshUpload(MeshUpload& upload) {
+    if (!upload.active) return;
+
+    if (upload.stagingCopy.valid()) upload.stagingCopy.wait();
+    if (upload.ticket != 0) uploads.wait(upload.ticket);
+    if (upload.source) unmapMeshUploadTargets(upload);
+    VulkanUtils::destroyBuffer(allocator, upload.stagingBuffer, upload.stagingMemory);
+    VulkanUtils::destroyBuffer(allocator, upload.vertexBuffer, upload.vertexMemory);
+    VulkanUtils::destroyBuffer(allocator, upload.indexBuffer, upload.indexMemory);
+    VulkanUtils::destroyBuffer(allocator, upload.meshletBuffer, upload.meshletMemory);
+
+    upload = MeshUpload();
+}
+
+/**
+ * @brief Picks the coarsest level of detail whose error stays below lodPixelError on screen.
+ * @param modelView Model-view matrix of the draw (rigid, so model units are world units).
+ * @param fovY Vertical field of view of the projection, in radians.
+ *
+ * A level's error (model units) is projected at the nearest point of the mesh's
+ * bounding sphere, which is conservative for the whole mesh.
+ *
+ * Keywords: Level of Detail Selection, Screen-Space Error
+ */
+uint32_t VulkanEngine::selectLod(const glm::mat4& modelView, float fovY) const {
+    if (meshLods.size() < 2) return 0;
+
+    const glm::vec3 center = glm::vec3(modelView * glm::vec4(meshSphereCenter, 1.0f));
+    const float distance = std::max(glm::length(center) - meshSphereRadius, 0.1f); // Clamp to the near plane
+    const float pixelsPerUnit = static_cast<float>(swapChainExtent.height) / (2.0f * std::tan(fovY * 0.5f) * distance);
+
+    // Errors grow with each level, so stop at the first one that is too coarse
+    uint32_t lod = 0;
+    for (uint32_t i = 1; i < static_cast<uint32_t>(meshLods.size()); ++i) {
+        if (meshLods[i].error * pixelsPerUnit > lodPixelError) break;
+        lod = i;
+    }
+    return lod;
+}
+
+/**
+ * @brief Reads the pass timings of the frame whose fence just signalled and reports averages.
+ *
+ * Prints the mean depth prepass and shading pass times every GPU_TIMING_REPORT_FRAMES
+ * frames, together with the mesh's vertex format and layout, so layouts can be compared
+ * by running the same model with and without --split-streams.
+ *
+ * Keywords: GPU Timing, Timestamp Queries, Vertex Layout Benchmark
+ */
+void VulkanEngine::collectGpuTimings() {
+    constexpr uint32_t GPU_TIMING_REPORT_FRAMES = 240;
+    if (!gpuTimer.collect(currentFrame, gpuIntervalsMs)) return;
+
+    gpuPrepassMs += gpuIntervalsMs[INTERVAL_PREPASS];
+    gpuShadingMs += gpuIntervalsMs[INTERVAL_SHADING];
+    if (++gpuTimedFrames < GPU_TIMING_REPORT_FRAMES) return;
+
+    std::cout << "GPU time ("
+              << (meshVertexFormat == VertexFormat::Quantized ? "quantized" : "full") << ", "
+              << (meshVertexLayout == VertexLayout::Split ? "split" : "interleaved") << " vertices): "
+              << "depth prepass " << gpuPrepassMs / gpuTimedFrames << " ms, "
+              << "shading " << gpuShadingMs / gpuTimedFrames << " ms" << std::endl;
+    gpuPrepassMs = 0.0;
+    gpuShadingMs = 0.0;
+    gpuTimedFrames = 0;
+}
+
 /**
  * @brief Cleans up swap chain specific resources.
  *
@@ -1409,9 +2353,8 @@ void VulkanEngine::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t i
 void VulkanEngine::cleanupSwapChain() {
     // Destroy depth resources
     if (depthImageView != VK_NULL_HANDLE) vkDestroyImageView(device, depthImageView, nullptr);
-    if (depthImage != VK_NULL_HANDLE) vkDestroyImage(device, depthImage, nullptr);
-    if (depthImageMemory != VK_NULL_HANDLE) vkFreeMemory(device, depthImageMemory, nullptr);
-    depthImageView = VK_NULL_HANDLE; depthImage = VK_NULL_HANDLE; depthImageMemory = VK_NULL_HANDLE;
+    VulkanUtils::destroyImage(allocator, depthImage, depthImageMemory);
+    depthImageView = VK_NULL_HANDLE;
 
     // Destroy framebuffers
     for (auto framebuffer : swapChainFramebuffers) {
@@ -1425,6 +2368,12 @@ void VulkanEngine::cleanupSwapChain() {
     }
     swapChainImageViews.clear();
 
+    // Destroy present semaphores
+    for (VkSemaphore semaphore : renderFinishedSemaphores) {
+        if (semaphore != VK_NULL_HANDLE) vkDestroySemaphore(device, semaphore, nullptr);
+    }
+    renderFinishedSemaphores.clear();
+
     // Destroy swapchain
     if (swapChain != VK_NULL_HANDLE) vkDestroySwapchainKHR(device, swapChain, nullptr);
     swapChain = VK_NULL_HANDLE;
@@ -1485,9 +2434,12 @@ bool VulkanEngine::checkDeviceExtensionSupport(VkPhysicalDevice queryDevice) {
 }
 
 /**
- * @brief Finds indices of queue families supporting graphics and presentation.
+ * @brief Finds indices of queue families supporting graphics and presentation, and a dedicated transfer family.
  * @param queryDevice The VkPhysicalDevice handle to check.
  * @return VulkanUtils::QueueFamilyIndices struct containing optional indices.
+ *
+ * The transfer family is one without graphics, preferably without compute as well
+ * (the copy engine of discrete GPUs), so every family is looked at.
  */
 VulkanUtils::QueueFamilyIndices VulkanEngine::findQueueFamilies(VkPhysicalDevice queryDevice) {
     VulkanUtils::QueueFamilyIndices indices;
@@ -1498,21 +2450,26 @@ VulkanUtils::QueueFamilyIndices VulkanEngine::findQueueFamilies(VkPhysicalDevice
 
     int i = 0;
     for (const auto& queueFamily : queueFamilies) {
-        // Check for graphics support
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-            indices.graphicsFamily = i;
-        }
+        // Graphics and present: keep the first family (pair) that completes them
+        if (!indices.isComplete()) {
+            // Check for graphics support
+            if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+                indices.graphicsFamily = i;
+            }
 
-        // Check for presentation support to the created surface
-        VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(queryDevice, i, surface, &presentSupport);
-        if (presentSupport) {
-            indices.presentFamily = i;
+            // Check for presentation support to the created surface
+            VkBool32 presentSupport = false;
+            vkGetPhysicalDeviceSurfaceSupportKHR(queryDevice, i, surface, &presentSupport);
+            if (presentSupport) {
+                indices.presentFamily = i;
+            }
         }
 
-        // Early exit if all found
-        if (indices.isComplete()) {
-            break;
+        // Dedicated transfer family: transfers without graphics, ideally without compute too
+        const VkQueueFlags flags = queueFamily.queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT) &&
+            (!indices.transferFamily || !(flags & VK_QUEUE_COMPUTE_BIT))) {
+            indices.transferFamily = i;
         }
         i++;
     }
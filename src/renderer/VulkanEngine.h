@@ -10,16 +10,33 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "../common/Vertex.h" // Include Vertex definition
+#include "../objects/geometry/MeshView.h" // MeshLod (levels of detail of the displayed mesh)
 #include "VulkanUtils.h"      // Include helper functions and structs
+#include "../objects/loaders/ObjStreamImporter.h" // Streaming import options
+#include "DeletionQueue.h"    // Deferred destruction of replaced buffers
+#include "UploadManager.h"    // Staging ring and asynchronous transfer queue
+#include "MeshletCuller.h"    // Frustum/cone culling of LOD 0 meshlets
+#include "../objects/geometry/VertexQuantizer.h" // Quantized vertex layout
+#include "../objects/geometry/IndexPacker.h"     // 16-bit index layout and draw ranges
+#include "../objects/geometry/VertexStreams.h"   // Interleaved or split vertex streams
+#include "../objects/geometry/GeometryBuffer.h"  // Shared mesh data, released after upload
+#include "GpuTimer.h"         // Timestamp queries (pass timings)
+#include "FrameScheduler.h"   // Frame timeline, frames in flight and retirement queries
 
 #include <vector>
 #include <string>
 #include <optional>
+#include <future>    // Background staging copies
+#include <atomic>    // Staging progress of progressive uploads
+#include <deque>
+#include <memory>
+#include <functional> // Destroyers of replaced swapchains
 #include <stdexcept> // For runtime_error
 #include <chrono>    // Potentially for timing within engine later
 
 // Forward declare Scene class to avoid circular includes if Scene needs VulkanEngine
 class Scene;
+struct LoadedMesh;
 
 /**
  * @brief Encapsulates the core Vulkan initialization, rendering resources, and frame loop logic.
@@ -63,7 +80,7 @@ public:
      * @brief Executes the rendering logic for a single frame.
      *
      * This function handles:
-     * - Waiting for the previous frame to finish.
+     * - Waiting until the frame that last used this frame's resources has retired.
      * - Acquiring the next swapchain image.
      * - Updating the uniform buffer (with data likely provided by the Scene).
      * - Recording drawing commands into a command buffer.
@@ -81,6 +98,73 @@ public:
      */
     void notifyFramebufferResized();
 
+    /**
+     * @brief Whether drawing is suspended because the window is minimized.
+     *
+     * drawFrame() then returns at once; the caller can wait for window events
+     * instead of polling in a tight loop.
+     */
+    bool isRenderingSuspended() const;
+
+    /**
+     * @brief Whether a newly loaded mesh is still being uploaded (the previous one is drawn meanwhile).
+     */
+    bool isMeshUploadPending() const;
+
+    /**
+     * @brief Sets how many frames the CPU may record ahead of the GPU (clamped to 1..4).
+     *
+     * Fewer frames lower input latency, more frames keep the GPU busy through CPU
+     * spikes. Can be called at any time: the per-frame resources (uniform buffers,
+     * descriptor sets, command buffers, culling and timing slots) are resized at the
+     * start of the next frame, after the frames in flight have retired.
+     */
+    void setFramesInFlight(uint32_t count);
+    uint32_t getFramesInFlight() const { return framesInFlight; }
+
+    /**
+     * @brief Number of the next frame to be submitted (frames are numbered from 0 in submission order).
+     */
+    uint64_t getFrameNumber() const { return frameScheduler.getFrameNumber(); }
+
+    /**
+     * @brief Whether frame `frame` has completed on the GPU, so memory it used can be recycled. Never blocks.
+     */
+    bool isFrameRetired(uint64_t frame);
+
+    /**
+     * @brief Enables a position-only depth prepass before shading the mesh.
+     *
+     * Shading then runs once per visible pixel, at the cost of drawing the mesh twice.
+     * The prepass fetches positions only, which is cheapest with VertexLayout::Split.
+     */
+    void setDepthPrepass(bool enabled);
+
+    /**
+     * @brief Prints averaged GPU times of the depth prepass and shading pass (timestamp queries).
+     *
+     * Must be called before initVulkan(). Used to compare vertex formats and layouts on large meshes.
+     */
+    void setGpuTiming(bool enabled);
+
+    /**
+     * @brief Uploads newly loaded meshes coarse level first, then refines them over the following frames.
+     * @param budgetBytes Largest amount of mesh data copied to the GPU per frame (at least one copy is made).
+     *
+     * The coarsest level of detail is drawn as soon as it has been copied; finer
+     * levels are streamed into the same buffers and each becomes selectable once all
+     * its data is resident. Meshes without levels of detail are uploaded whole.
+     */
+    void setProgressiveUpload(bool enabled, VkDeviceSize budgetBytes);
+
+    /**
+     * @brief Writes geometry straight into device-local memory when the device's main heap is host-visible.
+     *
+     * On by default; turning it off forces the staging path (to compare both). Must be
+     * called before initVulkan().
+     */
+    void setDirectUploads(bool enabled);
+
      // --- Debug Callback ---
     // Static member function to be used as the callback by Vulkan
     static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
@@ -93,12 +177,16 @@ private:
     // --- Core Vulkan Objects ---
     GLFWwindow* window; // Pointer to the application window
     VkInstance instance = VK_NULL_HANDLE;
+    uint32_t instanceApiVersion = VK_API_VERSION_1_0; // Vulkan version requested at instance creation
     VkDebugUtilsMessengerEXT debugMessenger = VK_NULL_HANDLE;
     VkSurfaceKHR surface = VK_NULL_HANDLE;
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     VkDevice device = VK_NULL_HANDLE; // Logical device
+    DeviceAllocator allocator;        // Memory of every buffer and image (sub-allocated from large blocks)
     VkQueue graphicsQueue = VK_NULL_HANDLE;
     VkQueue presentQueue = VK_NULL_HANDLE;
+    VkQueue transferQueue = VK_NULL_HANDLE;  // Dedicated transfer queue (null if the device has none)
+    bool timelineSemaphores = false;         // Device feature enabled in createLogicalDevice (Vulkan 1.2)
 
     // --- Swapchain Objects ---
     VkSwapchainKHR swapChain = VK_NULL_HANDLE;
@@ -111,7 +199,11 @@ private:
     VkRenderPass renderPass = VK_NULL_HANDLE;
     VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
-    VkPipeline graphicsPipeline = VK_NULL_HANDLE;
+    // One pipeline per vertex format and layout, indexed [VertexFormat][VertexLayout]
+    static constexpr size_t PIPELINE_FORMATS = 2;
+    static constexpr size_t PIPELINE_LAYOUTS = 2;
+    VkPipeline meshPipelines[PIPELINE_FORMATS][PIPELINE_LAYOUTS] = {};  // Shading (reads all vertex streams)
+    VkPipeline depthPipelines[PIPELINE_FORMATS][PIPELINE_LAYOUTS] = {}; // Depth prepass (reads positions only)
 
     // --- Framebuffers ---
     std::vector<VkFramebuffer> swapChainFramebuffers;
@@ -120,17 +212,135 @@ private:
     VkCommandPool commandPool = VK_NULL_HANDLE;
     std::vector<VkCommandBuffer> commandBuffers; // One per frame in flight
 
+    // --- Uploads ---
+    UploadManager uploads;                     // Staging ring submitting on the transfer queue (or graphics)
+    std::vector<uint32_t> uploadQueueFamilies; // Families sharing buffers written by uploads (empty: graphics only)
+    uint64_t meshTicket = 0;                   // Upload ticket of the displayed mesh data; frames wait for it on the GPU
+    bool directUploads = true;                 // Allow writes into ReBAR/UMA memory (setDirectUploads)
+
     // --- Buffers & Memory ---
     // Geometry buffers (handles owned by engine, data provided by scene at init)
     VkBuffer vertexBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
+    DeviceAllocator::Allocation vertexBufferMemory;
     VkBuffer indexBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
-    uint32_t indexCount = 0; // Store index count after buffer creation
+    DeviceAllocator::Allocation indexBufferMemory;
+    uint32_t indexCount = 0; // Store index count after buffer creation (0 = nothing to draw yet)
+    VertexFormat meshVertexFormat = VertexFormat::Full; // Format of vertexBuffer
+    VertexLayout meshVertexLayout = VertexLayout::Interleaved; // Stream layout of vertexBuffer
+    VkDeviceSize meshAttributeOffset = 0;                // Offset of the attribute stream in vertexBuffer (Split layout)
+    VertexQuantizer::Quantization meshQuantization;      // Dequantization of vertexBuffer (Quantized layout)
+    IndexPacker::Layout meshIndexLayout;                 // Index width and draw ranges of indexBuffer (no ranges = one draw)
+    uint64_t displayedMeshVersion = 0; // Scene mesh version the buffers above hold
+
+    // Levels of detail of the displayed mesh (empty = draw the whole index range)
+    std::vector<MeshLod> meshLods;
+    glm::vec3 meshSphereCenter = glm::vec3(0.0f); // Model-space bounding sphere, for LOD selection
+    float meshSphereRadius = 0.0f;
+    uint32_t currentLod = 0;     // Level drawn this frame (chosen in updateUniformBuffer)
+    uint32_t residentLod = 0;    // Finest level whose data is on the GPU (above 0 while a progressive upload refines)
+    float lodPixelError = 1.0f;  // Largest screen-space error a coarser level may have, in pixels
+
+    // Meshlet culling of LOD 0 (compute prepass + indirect draws, or on the CPU)
+    MeshletCuller meshletCuller;
+    MeshletCuller::CullParams cullParams{}; // Computed in updateUniformBuffer
+    bool meshletCulling = true;             // Draw LOD 0 through the culler when it has meshlets
+    bool multiDrawIndirectEnabled = false;  // Device feature enabled in createLogicalDevice
+    uint32_t maxDrawIndirectCount = 1;      // Device limit
+
+    bool depthPrepass = false; // Position-only depth pass before shading
+
+    // GPU timing of the passes (timestamps written each frame, indexed per frame in flight)
+    enum Timestamp : uint32_t {
+        TIMESTAMP_PASS_BEGIN,
+        TIMESTAMP_PREPASS_END,
+        TIMESTAMP_PASS_END,
+        TIMESTAMP_COUNT
+    };
+    // Intervals GpuTimer::collect() returns: each runs from one timestamp to the next
+    enum TimestampInterval : uint32_t {
+        INTERVAL_PREPASS,  // TIMESTAMP_PASS_BEGIN to TIMESTAMP_PREPASS_END
+        INTERVAL_SHADING,  // TIMESTAMP_PREPASS_END to TIMESTAMP_PASS_END
+        INTERVAL_COUNT
+    };
+    static_assert(INTERVAL_COUNT == TIMESTAMP_COUNT - 1, "One interval between each pair of timestamps");
+    GpuTimer gpuTimer;
+    bool gpuTiming = false;          // Create gpuTimer at init (setGpuTiming)
+    std::vector<double> gpuIntervalsMs;
+    double gpuPrepassMs = 0.0;       // Sums since the last report
+    double gpuShadingMs = 0.0;
+    uint32_t gpuTimedFrames = 0;
+
+    /**
+     * @brief In-flight upload of a mesh published by the scene after initialization.
+     *
+     * The mesh is copied into a staging buffer on a worker thread, the copies are
+     * submitted through the upload manager without waiting, and the new buffers
+     * replace the current ones only once their ticket has completed. Rendering
+     * continues with the old buffers (or nothing) throughout.
+     *
+     * A progressive upload instead stages the levels of detail coarsest first, and
+     * streamMeshUpload() submits their copies a budget at a time each frame. The new
+     * buffers are swapped in with the coarsest level and the upload ends once LOD 0
+     * (and the meshlets) have been copied.
+     *
+     * When the upload manager places all new buffers in host-visible device memory
+     * (ReBAR/UMA), the worker writes into them directly: there is no staging buffer
+     * and no copy, and each level is ready as soon as it has been written.
+     */
+    struct MeshUpload {
+        /**
+         * @brief One staging-to-device copy of a progressive upload.
+         */
+        struct StreamCopy {
+            VkBuffer dstBuffer = VK_NULL_HANDLE;
+            VkBufferCopy region{};
+            uint32_t stagedLevels = 0;  // Levels the staging worker must have written first
+            int32_t completesLevel = -1; // Level made resident by this copy (-1: none)
+        };
+
+        bool active = false;                      // An upload is in progress
+        bool submitted = false;                   // Copy commands were submitted (ticket pending, or streaming)
+        bool progressive = false;                 // Streamed level by level (setProgressiveUpload)
+        bool direct = false;                      // The worker writes into the device buffers, nothing is copied
+        uint64_t version = 0;                     // Scene mesh version being uploaded
+        std::shared_ptr<const LoadedMesh> source; // Mesh being uploaded; its CPU geometry is released once submitted
+        std::shared_ptr<const GeometryBuffer::CpuData> sourceData; // Keeps the CPU data alive during the staging copy
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;
+        DeviceAllocator::Allocation stagingMemory;
+        VkBuffer vertexBuffer = VK_NULL_HANDLE;
+        DeviceAllocator::Allocation vertexMemory;
+        VkBuffer indexBuffer = VK_NULL_HANDLE;
+        DeviceAllocator::Allocation indexMemory;
+        VkBuffer meshletBuffer = VK_NULL_HANDLE;  // Meshlet records, only created for GPU culling
+        DeviceAllocator::Allocation meshletMemory;
+        std::vector<DeviceAllocator::Allocation> directMemory; // Device buffers mapped for the worker (direct)
+        VkDeviceSize vertexBytes = 0;
+        VkDeviceSize indexBytes = 0;
+        VkDeviceSize meshletBytes = 0;
+        uint32_t indexCount = 0;
+        VertexFormat vertexFormat = VertexFormat::Full;
+        VertexLayout vertexLayout = VertexLayout::Interleaved;
+        VkDeviceSize attributeOffset = 0;
+        VertexQuantizer::Quantization quantization;
+        IndexPacker::Layout indexLayout;
+        std::vector<MeshletCullData> meshlets;    // Meshlets of LOD 0
+        std::vector<MeshLod> lods;                // Level of detail table of the mesh
+        glm::vec3 sphereCenter = glm::vec3(0.0f); // Bounding sphere of the mesh
+        float sphereRadius = 0.0f;
+        std::future<void> stagingCopy;            // memcpy into the mapped staging buffer
+        std::shared_ptr<std::atomic<uint32_t>> stagedLevels; // Levels written so far, coarsest first (progressive)
+        std::deque<StreamCopy> streamCopies;      // Copies not submitted yet, coarsest level first (progressive)
+        uint64_t ticket = 0;                      // Upload ticket of the last submitted copies
+    };
+    MeshUpload meshUpload;
+    std::vector<MeshUpload> abandonedUploads; // Superseded before submission; freed once their worker is done
+    bool progressiveUpload = false;                       // Upload new meshes coarse level first (setProgressiveUpload)
+    VkDeviceSize uploadBudgetBytes = 16 * 1024 * 1024;    // Mesh data copied per frame by a progressive upload
+    DeletionQueue deletionQueue; // Buffers replaced while frames using them were in flight
 
     // Uniform buffers (one per frame in flight)
     std::vector<VkBuffer> uniformBuffers;
-    std::vector<VkDeviceMemory> uniformBuffersMemory;
+    std::vector<DeviceAllocator::Allocation> uniformBuffersMemory;
     std::vector<void*> uniformBuffersMapped; // Persistently mapped pointers
 
     // --- Descriptors ---
@@ -139,18 +349,25 @@ private:
 
     // --- Depth Buffering ---
     VkImage depthImage = VK_NULL_HANDLE;
-    VkDeviceMemory depthImageMemory = VK_NULL_HANDLE;
+    DeviceAllocator::Allocation depthImageMemory;
     VkImageView depthImageView = VK_NULL_HANDLE;
 
     // --- Synchronization ---
+    FrameScheduler frameScheduler; // Frame timeline semaphore (or fences), frame numbers and indices
+    uint32_t framesInFlight = 2;   // Requested frames in flight, 1..4 (setFramesInFlight)
+    uint32_t currentFrame = 0;     // Per-frame resource index of the frame being built (frameScheduler.getFrameIndex())
+    // Acquire semaphores, a ring of FrameScheduler::MAX_FRAMES_IN_FLIGHT indexed by frame number,
+    // so they outlive any change of the frame count
     std::vector<VkSemaphore> imageAvailableSemaphores;
+    // Present semaphores, one per swapchain image: a present may wait on one until its image is acquired again
     std::vector<VkSemaphore> renderFinishedSemaphores;
-    std::vector<VkFence> inFlightFences;
-    uint32_t currentFrame = 0; // Index for current frame in flight (0 to MAX_FRAMES_IN_FLIGHT-1)
-    int MAX_FRAMES_IN_FLIGHT = 2; // Number of frames to process concurrently
+    // Destroyers of replaced swapchains (and their views, framebuffers, depth and present semaphores),
+    // queued for deletion by the first frame acquired from the swapchain that replaced them
+    std::vector<std::function<void()>> retiredSwapChains;
 
     // --- State Flags ---
     bool framebufferResized = false; // Flag set by GLFW callback
+    bool swapChainSuspended = false; // Window minimized; the swapchain is recreated once it has a size again
 
     // --- Private Initialization Steps ---
     void createInstance();
@@ -158,27 +375,44 @@ private:
     void createSurface();
     void pickPhysicalDevice();
     void createLogicalDevice();
-    void createSwapChain();
+    void createSwapChain(VkSwapchainKHR oldSwapChain = VK_NULL_HANDLE);
     void createImageViews();
     void createRenderPass();
     void createDescriptorSetLayout();
     void createGraphicsPipeline();
     void createCommandPool();
+    void createUploadManager();
     void createDepthResources();
     void createFramebuffers();
-    void createVertexBuffer(const std::vector<Vertex>& vertices);
-    void createIndexBuffer(const std::vector<uint32_t>& indices);
+    void createVertexBuffer(const Vertex* vertices, size_t vertexCount, VertexFormat format, VertexLayout layout,
+                            const VertexQuantizer::Quantization& quantization);
+    void createIndexBuffer(const MeshView& mesh, const IndexPacker::Layout& layout);
+    void createMeshletBuffer(const LoadedMesh& mesh);
+    void importStreamedModel(const std::string& modelPath, const ObjStreamImporter::Options& options);
     void createUniformBuffers();
     void createDescriptorPool();
     void createDescriptorSets();
     void createCommandBuffers();
     void createSyncObjects();
+    void destroyFrameResources();
+    void resizeFrameResources();
 
     // --- Private Runtime Steps ---
     void updateUniformBuffer(uint32_t currentImageIndex, const Scene& scene);
     void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
     void cleanupSwapChain();
     void recreateSwapChain(const Scene& scene); // Needs scene data again for buffers
+    void pollMeshUpload(const Scene& scene);
+    void beginMeshUpload(const std::shared_ptr<const LoadedMesh>& mesh, uint64_t version);
+    void submitMeshUpload();
+    void planMeshStreaming(size_t vertexCount);
+    void streamMeshUpload();
+    void swapInMeshUpload();
+    void releaseMeshUploadSource();
+    void unmapMeshUploadTargets(MeshUpload& upload);
+    void destroyMeshUpload(MeshUpload& upload);
+    uint32_t selectLod(const glm::mat4& modelView, float fovY) const;
+    void collectGpuTimings();
 
     // --- Private Helper Functions ---
     // (Device suitability checks are closely tied to engine state)
@@ -215,5 +449,7 @@ private:
         alignas(16) glm::mat4 model; // alignas(16) ensures alignment meets Vulkan requirements (vec4 size)
         alignas(16) glm::mat4 view;
         alignas(16) glm::mat4 proj;
+        alignas(16) glm::vec4 positionScale;  // Dequantization of QuantizedVertex positions (xyz)
+        alignas(16) glm::vec4 positionOffset;
     };
 };
\ No newline at end of file
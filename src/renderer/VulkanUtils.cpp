@@ -87,13 +87,23 @@ namespace VulkanUtils {
      * @brief Creates a Vulkan buffer and its memory. Implementation.
      * See VulkanUtils.h for details.
      */
-    void createBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
+    void createBuffer(DeviceAllocator& allocator, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, DeviceAllocator::Allocation& bufferMemory,
+                      const std::vector<uint32_t>& queueFamilies, VkMemoryPropertyFlags preferredProperties) {
+        VkDevice device = allocator.getDevice();
+
         // 1. Define buffer properties
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         bufferInfo.size = size;           // Size in bytes
         bufferInfo.usage = usage;         // How the buffer will be used
-        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // Only used by one queue family (graphics)
+        if (queueFamilies.size() >= 2) {
+            // Written on one family and read on another (e.g. transfer and graphics) without ownership transfers
+            bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+            bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+        } else {
+            bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // Only used by one queue family (graphics)
+        }
 
         // 2. Create the buffer handle
         if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
@@ -104,89 +114,45 @@ namespace VulkanUtils {
         VkMemoryRequirements memRequirements;
         vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
 
-        // 4. Define memory allocation info
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size; // Allocate required size
-        // Find a memory type index that fits the buffer's requirements and our desired properties
-        allocInfo.memoryTypeIndex = findMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);
-
-        // 5. Allocate the device memory
-        if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
+        // 4. Sub-allocate a range of a memory block of a type that fits the requirements and our properties
+        //    (preferring types that also have the preferred ones)
+        try {
+            bufferMemory = allocator.allocate(memRequirements, properties, DeviceAllocator::ResourceKind::Linear,
+                                              preferredProperties);
+        } catch (...) {
             // Clean up the buffer handle if memory allocation fails
             vkDestroyBuffer(device, buffer, nullptr);
-            throw std::runtime_error("Failed to allocate buffer memory!");
+            throw;
         }
 
-        // 6. Bind the allocated memory to the buffer handle
-        // The '0' is the memory offset - the buffer starts at the beginning of the allocated memory block.
-        VkResult bindResult = vkBindBufferMemory(device, buffer, bufferMemory, 0);
+        // 5. Bind the range to the buffer handle (the buffer starts at its offset within the block)
+        VkResult bindResult = vkBindBufferMemory(device, buffer, bufferMemory.memory, bufferMemory.offset);
         if(bindResult != VK_SUCCESS) {
              // Clean up if binding fails
-            vkDestroyBuffer(device, buffer, nullptr);
-            vkFreeMemory(device, bufferMemory, nullptr);
+            destroyBuffer(allocator, buffer, bufferMemory);
              throw std::runtime_error("Failed to bind buffer memory!");
         }
     }
 
     /**
-     * @brief Copies data between buffers. Implementation.
+     * @brief Destroys a buffer and frees its memory. Implementation.
      * See VulkanUtils.h for details.
      */
-    void copyBuffer(VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-        // --- Create a temporary command buffer for the copy operation ---
-        VkCommandBufferAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // Can be submitted directly
-        allocInfo.commandPool = commandPool; // Pool to allocate from
-        allocInfo.commandBufferCount = 1;
-
-        VkCommandBuffer commandBuffer;
-        VkResult allocateResult = vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-        if (allocateResult != VK_SUCCESS) {
-             throw std::runtime_error("Failed to allocate temporary command buffer for copy!");
+    void destroyBuffer(DeviceAllocator& allocator, VkBuffer& buffer, DeviceAllocator::Allocation& bufferMemory) {
+        if (buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(allocator.getDevice(), buffer, nullptr);
+            buffer = VK_NULL_HANDLE;
         }
-
-
-        // --- Record the copy command ---
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        // VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT: Hint that we'll submit this buffer once and then discard it.
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-        vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-        // Define the copy region (copy the entire buffer)
-        VkBufferCopy copyRegion{};
-        // copyRegion.srcOffset = 0; // Optional: default 0
-        // copyRegion.dstOffset = 0; // Optional: default 0
-        copyRegion.size = size;
-        // Record the copy command
-        vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-        vkEndCommandBuffer(commandBuffer);
-
-        // --- Submit the command buffer to the graphics queue ---
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer; // The buffer containing the copy command
-
-        // Submit and wait for completion. Using a fence here would be more efficient for overlapping
-        // multiple transfers, but waiting for idle is simpler for a single blocking copy.
-        vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE); // No fence needed for blocking wait
-        vkQueueWaitIdle(graphicsQueue); // Block CPU until the copy operation finishes on the GPU
-
-        // --- Clean up the temporary command buffer ---
-        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+        allocator.free(bufferMemory);
     }
 
-
     /**
      * @brief Creates a Vulkan image and its memory. Implementation.
      * See VulkanUtils.h for details.
      */
-    void createImage(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) {
+    void createImage(DeviceAllocator& allocator, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, DeviceAllocator::Allocation& imageMemory) {
+        VkDevice device = allocator.getDevice();
+
         // 1. Define image properties
         VkImageCreateInfo imageInfo{};
         imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -212,27 +178,36 @@ namespace VulkanUtils {
         VkMemoryRequirements memRequirements;
         vkGetImageMemoryRequirements(device, image, &memRequirements);
 
-        // 4. Define memory allocation info
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);
-
-        // 5. Allocate memory
-        if (vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-             vkDestroyImage(device, image, nullptr); // Clean up image handle
-            throw std::runtime_error("Failed to allocate image memory!");
+        // 4. Sub-allocate memory, away from linear resources when the device needs that (bufferImageGranularity)
+        const DeviceAllocator::ResourceKind kind = tiling == VK_IMAGE_TILING_OPTIMAL ? DeviceAllocator::ResourceKind::Optimal
+                                                                                     : DeviceAllocator::ResourceKind::Linear;
+        try {
+            imageMemory = allocator.allocate(memRequirements, properties, kind);
+        } catch (...) {
+            vkDestroyImage(device, image, nullptr); // Clean up image handle
+            throw;
         }
 
-        // 6. Bind memory to the image
-        VkResult bindResult = vkBindImageMemory(device, image, imageMemory, 0); // Bind at offset 0
+        // 5. Bind memory to the image
+        VkResult bindResult = vkBindImageMemory(device, image, imageMemory.memory, imageMemory.offset);
          if(bindResult != VK_SUCCESS) {
-             vkDestroyImage(device, image, nullptr);
-             vkFreeMemory(device, imageMemory, nullptr);
+             destroyImage(allocator, image, imageMemory);
              throw std::runtime_error("Failed to bind image memory!");
          }
     }
 
+    /**
+     * @brief Destroys an image and frees its memory. Implementation.
+     * See VulkanUtils.h for details.
+     */
+    void destroyImage(DeviceAllocator& allocator, VkImage& image, DeviceAllocator::Allocation& imageMemory) {
+        if (image != VK_NULL_HANDLE) {
+            vkDestroyImage(allocator.getDevice(), image, nullptr);
+            image = VK_NULL_HANDLE;
+        }
+        allocator.free(imageMemory);
+    }
+
     /**
      * @brief Creates a Vulkan image view. Implementation.
      * See VulkanUtils.h for details.
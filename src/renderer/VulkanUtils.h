@@ -7,6 +7,8 @@
 #include <string>
 #include <optional> // For QueueFamilyIndices
 
+#include "DeviceAllocator.h"
+
 // Forward declare Vulkan handles used in function signatures
 // This avoids including vulkan.h directly in this header, reducing compile times slightly
 // for files that only need these declarations. Actual implementations in VulkanUtils.cpp
@@ -39,6 +41,8 @@ namespace VulkanUtils {
      *
      * Vulkan commands are submitted to queues, and queues belong to families.
      * We need to find queue families that support graphics operations and presentation.
+     * A family that supports transfers but not graphics (a DMA engine on discrete GPUs)
+     * is optional; uploads run on it when present.
      *
      * `std::optional` is used because a physical device might not support the required families.
      *
@@ -47,6 +51,7 @@ namespace VulkanUtils {
     struct QueueFamilyIndices {
         std::optional<uint32_t> graphicsFamily; // Index of a queue family supporting graphics commands
         std::optional<uint32_t> presentFamily;  // Index of a queue family supporting presentation to a surface
+        std::optional<uint32_t> transferFamily; // Dedicated transfer family (no graphics), if the device has one
 
         /**
          * @brief Checks if all required queue families have been found.
@@ -115,47 +120,36 @@ namespace VulkanUtils {
 
     /**
      * @brief Creates a Vulkan buffer and allocates memory for it.
-     * @param physicalDevice The physical device (needed for memory properties).
-     * @param device The logical device.
+     * @param allocator The device memory allocator (also provides the logical device).
      * @param size The desired size of the buffer in bytes.
      * @param usage Flags specifying how the buffer will be used (e.g., Vertex Buffer, Transfer Source).
      * @param properties Required memory properties for the buffer's backing memory.
      * @param buffer Reference to store the created VkBuffer handle.
-     * @param bufferMemory Reference to store the allocated VkDeviceMemory handle.
+     * @param bufferMemory Reference to store the range of device memory backing the buffer.
+     * @param queueFamilies Queue families that access the buffer; with two or more it is
+     *                      shared concurrently, otherwise it is exclusive to one family.
+     * @param preferredProperties Memory properties to have as well when a memory type offers them
+     *                            (e.g. DEVICE_LOCAL for host-visible data on ReBAR/UMA devices).
      *
      * This is a fundamental helper for creating any buffer (vertex, index, uniform, staging).
-     * It handles buffer creation, querying memory requirements, finding a suitable memory type,
-     * allocating the memory, and binding the memory to the buffer.
+     * It handles buffer creation, querying memory requirements, sub-allocating a range of a
+     * memory block that fits them, and binding that range to the buffer.
      *
-     * Keywords: VkBuffer, VkDeviceMemory, Buffer Creation, Memory Allocation, VkBufferUsageFlags, vkCreateBuffer, vkAllocateMemory, vkBindBufferMemory
+     * Keywords: VkBuffer, Buffer Creation, Memory Allocation, VkBufferUsageFlags, vkCreateBuffer, vkBindBufferMemory
      */
-    void createBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+    void createBuffer(DeviceAllocator& allocator, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, DeviceAllocator::Allocation& bufferMemory,
+                      const std::vector<uint32_t>& queueFamilies = {}, VkMemoryPropertyFlags preferredProperties = 0);
 
     /**
-     * @brief Copies data from one Vulkan buffer to another using a command buffer.
-     * @param device The logical device.
-     * @param commandPool The command pool to allocate the temporary command buffer from.
-     * @param graphicsQueue The queue to submit the copy command to.
-     * @param srcBuffer The source buffer.
-     * @param dstBuffer The destination buffer.
-     * @param size The number of bytes to copy.
+     * @brief Destroys a buffer made by createBuffer and frees its memory. Null handles are skipped.
      *
-     * This function encapsulates the process of:
-     * 1. Allocating a temporary command buffer.
-     * 2. Recording a vkCmdCopyBuffer command.
-     * 3. Submitting the command buffer to a queue.
-     * 4. Waiting for the queue to become idle (ensuring the copy completes).
-     * 5. Freeing the temporary command buffer.
-     * Essential for transferring data from CPU-visible staging buffers to GPU-local device buffers.
-     *
-     * Keywords: vkCmdCopyBuffer, Buffer Transfer, Staging Buffer, Command Buffer Submission, vkQueueSubmit, vkQueueWaitIdle
+     * Keywords: vkDestroyBuffer, Memory Release
      */
-    void copyBuffer(VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+    void destroyBuffer(DeviceAllocator& allocator, VkBuffer& buffer, DeviceAllocator::Allocation& bufferMemory);
 
     /**
      * @brief Creates a Vulkan image object and allocates memory for it.
-     * @param physicalDevice The physical device (needed for memory properties).
-     * @param device The logical device.
+     * @param allocator The device memory allocator (also provides the logical device).
      * @param width Image width.
      * @param height Image height.
      * @param format The pixel format of the image (e.g., VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_D32_SFLOAT).
@@ -163,13 +157,21 @@ namespace VulkanUtils {
      * @param usage Flags specifying how the image will be used (e.g., Sampled, Color Attachment, Depth Attachment).
      * @param properties Required memory properties for the image's backing memory.
      * @param image Reference to store the created VkImage handle.
-     * @param imageMemory Reference to store the allocated VkDeviceMemory handle.
+     * @param imageMemory Reference to store the range of device memory backing the image.
      *
      * Similar to createBuffer, but for 2D image resources like textures or attachments.
+     * Optimal-tiling images are kept out of the memory blocks that hold buffers.
+     *
+     * Keywords: VkImage, Image Creation, Texture, Framebuffer Attachment, VkImageUsageFlags, VkFormat, VkImageTiling
+     */
+    void createImage(DeviceAllocator& allocator, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, DeviceAllocator::Allocation& imageMemory);
+
+    /**
+     * @brief Destroys an image made by createImage and frees its memory. Null handles are skipped.
      *
-     * Keywords: VkImage, VkDeviceMemory, Image Creation, Texture, Framebuffer Attachment, VkImageUsageFlags, VkFormat, VkImageTiling
+     * Keywords: vkDestroyImage, Memory Release
      */
-    void createImage(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+    void destroyImage(DeviceAllocator& allocator, VkImage& image, DeviceAllocator::Allocation& imageMemory);
 
     /**
      * @brief Creates a Vulkan image view.
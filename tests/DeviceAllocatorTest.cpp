@@ -0,0 +1,272 @@
+// Drives DeviceAllocator through a mock BlockSource and memory-type table (no GPU needed).
+// Run through CTest: ctest --test-dir build
+
+#include "renderer/DeviceAllocator.h"
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition)                                                               \
+    do {                                                                               \
+        if (!(condition)) {                                                            \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " #condition << std::endl;  \
+            ++failures;                                                                \
+        }                                                                              \
+    } while (0)
+
+constexpr VkDeviceSize BLOCK_SIZE = VkDeviceSize(1) << 20;
+
+// What the mock source has handed out; outlives the source, which the allocator owns
+struct MockMemory {
+    struct Block {
+        uint32_t memoryType;
+        VkDeviceSize size;
+        std::vector<char> bytes; // Backing store while mapped
+    };
+    std::map<uintptr_t, Block> live;
+    uintptr_t nextHandle = 0x1000;
+    uint32_t allocateCalls = 0;
+    uint32_t mapped = 0;
+};
+
+class MockBlockSource : public DeviceAllocator::BlockSource {
+public:
+    explicit MockBlockSource(MockMemory& mockMemory) : memory(mockMemory) {}
+
+    VkResult allocate(uint32_t memoryType, VkDeviceSize size, VkDeviceMemory& handle) override {
+        ++memory.allocateCalls;
+        const uintptr_t key = memory.nextHandle;
+        memory.nextHandle += 0x10;
+        memory.live[key] = {memoryType, size, {}};
+        handle = reinterpret_cast<VkDeviceMemory>(key);
+        return VK_SUCCESS;
+    }
+
+    void free(VkDeviceMemory handle) override {
+        CHECK(memory.live.erase(reinterpret_cast<uintptr_t>(handle)) == 1);
+    }
+
+    VkResult map(VkDeviceMemory handle, void*& data) override {
+        MockMemory::Block& block = memory.live.at(reinterpret_cast<uintptr_t>(handle));
+        block.bytes.resize(static_cast<size_t>(block.size));
+        data = block.bytes.data();
+        ++memory.mapped;
+        return VK_SUCCESS;
+    }
+
+    void unmap(VkDeviceMemory) override {
+        --memory.mapped;
+    }
+
+private:
+    MockMemory& memory;
+};
+
+// Type 0: device local (8 GiB heap), type 1: host visible and coherent (256 MiB heap)
+VkPhysicalDeviceMemoryProperties mockProperties() {
+    VkPhysicalDeviceMemoryProperties properties{};
+    properties.memoryHeapCount = 2;
+    properties.memoryHeaps[0].size = VkDeviceSize(8) << 30;
+    properties.memoryHeaps[0].flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+    properties.memoryHeaps[1].size = VkDeviceSize(256) << 20;
+    properties.memoryTypeCount = 2;
+    properties.memoryTypes[0] = {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0};
+    properties.memoryTypes[1] = {VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1};
+    return properties;
+}
+
+VkMemoryRequirements requirements(VkDeviceSize size, VkDeviceSize alignment = 256, uint32_t typeBits = 0x3) {
+    VkMemoryRequirements result{};
+    result.size = size;
+    result.alignment = alignment;
+    result.memoryTypeBits = typeBits;
+    return result;
+}
+
+void createAllocator(DeviceAllocator& allocator, MockMemory& memory, VkDeviceSize granularity) {
+    std::unique_ptr<DeviceAllocator::BlockSource> source(new MockBlockSource(memory));
+    allocator.create(mockProperties(), granularity, std::move(source), BLOCK_SIZE);
+}
+
+void testSubAllocation() {
+    MockMemory memory;
+    DeviceAllocator allocator;
+    createAllocator(allocator, memory, 1);
+
+    std::vector<DeviceAllocator::Allocation> allocations;
+    for (int i = 0; i < 16; ++i) {
+        allocations.push_back(allocator.allocate(requirements(1000 + i, 256), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                 DeviceAllocator::ResourceKind::Linear));
+    }
+    CHECK(memory.allocateCalls == 1); // All from one block
+    for (size_t i = 0; i < allocations.size(); ++i) {
+        CHECK(allocations[i].memory == allocations[0].memory);
+        CHECK(allocations[i].offset % 256 == 0);
+        CHECK(allocations[i].size >= 1000 + i);
+        for (size_t j = 0; j < i; ++j) {
+            const bool disjoint = allocations[i].offset >= allocations[j].offset + allocations[j].size ||
+                                  allocations[j].offset >= allocations[i].offset + allocations[i].size;
+            CHECK(disjoint);
+        }
+    }
+    for (DeviceAllocator::Allocation& allocation : allocations) allocator.free(allocation);
+    CHECK(allocator.getHeapStats()[0].usedBytes == 0);
+    allocator.destroy();
+    CHECK(memory.live.empty());
+}
+
+void testPoolSeparation() {
+    // bufferImageGranularity > 1: buffers and optimal-tiling images never share a block
+    {
+        MockMemory memory;
+        DeviceAllocator allocator;
+        createAllocator(allocator, memory, 1024);
+        DeviceAllocator::Allocation buffer = allocator.allocate(requirements(4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                                DeviceAllocator::ResourceKind::Linear);
+        DeviceAllocator::Allocation image = allocator.allocate(requirements(4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                               DeviceAllocator::ResourceKind::Optimal);
+        CHECK(buffer.memory != image.memory);
+        CHECK(memory.allocateCalls == 2);
+        allocator.free(buffer);
+        allocator.free(image);
+        allocator.destroy();
+        CHECK(memory.live.empty());
+    }
+    // Granularity 1: no separation needed
+    {
+        MockMemory memory;
+        DeviceAllocator allocator;
+        createAllocator(allocator, memory, 1);
+        DeviceAllocator::Allocation buffer = allocator.allocate(requirements(4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                                DeviceAllocator::ResourceKind::Linear);
+        DeviceAllocator::Allocation image = allocator.allocate(requirements(4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                               DeviceAllocator::ResourceKind::Optimal);
+        CHECK(buffer.memory == image.memory);
+        CHECK(memory.allocateCalls == 1);
+        allocator.free(buffer);
+        allocator.free(image);
+        allocator.destroy();
+    }
+}
+
+void testDedicatedAllocation() {
+    MockMemory memory;
+    DeviceAllocator allocator;
+    createAllocator(allocator, memory, 1);
+
+    DeviceAllocator::Allocation small = allocator.allocate(requirements(4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                           DeviceAllocator::ResourceKind::Linear);
+    // Over half a block: its own VkDeviceMemory of just its size
+    const VkDeviceSize largeSize = BLOCK_SIZE / 2 + 4096;
+    DeviceAllocator::Allocation large = allocator.allocate(requirements(largeSize), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                           DeviceAllocator::ResourceKind::Linear);
+    CHECK(large.memory != small.memory);
+    CHECK(large.offset == 0);
+    CHECK(memory.live.at(reinterpret_cast<uintptr_t>(large.memory)).size == largeSize);
+    CHECK(allocator.getHeapStats()[0].blockCount == 2);
+
+    // Freed at once, unlike an emptied block
+    const uintptr_t largeHandle = reinterpret_cast<uintptr_t>(large.memory);
+    allocator.free(large);
+    CHECK(!large.isValid());
+    CHECK(memory.live.count(largeHandle) == 0);
+    CHECK(allocator.getHeapStats()[0].blockCount == 1);
+
+    allocator.free(small);
+    allocator.destroy();
+    CHECK(memory.live.empty());
+}
+
+void testBlockRelease() {
+    MockMemory memory;
+    DeviceAllocator allocator;
+    createAllocator(allocator, memory, 1);
+
+    // Quarter-block allocations: four blocks' worth (alignment padding may need a fifth)
+    std::vector<DeviceAllocator::Allocation> allocations;
+    for (int i = 0; i < 16; ++i) {
+        allocations.push_back(allocator.allocate(requirements(BLOCK_SIZE / 4 - 256), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                 DeviceAllocator::ResourceKind::Linear));
+    }
+    CHECK(memory.live.size() >= 4);
+
+    // Emptied blocks go back to the source, except one kept for reuse
+    for (DeviceAllocator::Allocation& allocation : allocations) allocator.free(allocation);
+    CHECK(memory.live.size() == 1);
+    const DeviceAllocator::HeapStats stats = allocator.getHeapStats()[0];
+    CHECK(stats.blockCount == 1);
+    CHECK(stats.usedBytes == 0);
+    CHECK(stats.allocationCount == 0);
+
+    // The kept block serves the next allocation
+    const uint32_t calls = memory.allocateCalls;
+    DeviceAllocator::Allocation again = allocator.allocate(requirements(4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                           DeviceAllocator::ResourceKind::Linear);
+    CHECK(memory.allocateCalls == calls);
+    allocator.free(again);
+    allocator.destroy();
+    CHECK(memory.live.empty());
+}
+
+void testMemoryTypes() {
+    MockMemory memory;
+    DeviceAllocator allocator;
+    createAllocator(allocator, memory, 1);
+
+    // Host-visible memory comes from type 1 and maps into the block's storage
+    DeviceAllocator::Allocation upload = allocator.allocate(requirements(64), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                                            DeviceAllocator::ResourceKind::Linear);
+    CHECK(upload.memoryType == 1);
+    CHECK((allocator.getPropertyFlags(upload) & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0);
+    char* data = static_cast<char*>(allocator.map(upload));
+    CHECK(data != nullptr && memory.mapped == 1);
+    allocator.unmap(upload);
+    CHECK(memory.mapped == 0);
+
+    // A preferred property no type offers falls back to the required ones
+    DeviceAllocator::Allocation local = allocator.allocate(requirements(64), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                           DeviceAllocator::ResourceKind::Linear,
+                                                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    CHECK(local.memoryType == 0);
+
+    // No allowed type has the properties
+    bool threw = false;
+    try {
+        allocator.allocate(requirements(64, 256, 0x1), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                           DeviceAllocator::ResourceKind::Linear);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    allocator.free(upload);
+    allocator.free(local);
+    allocator.destroy();
+    CHECK(memory.live.empty());
+}
+
+} // namespace
+
+int main() {
+    testSubAllocation();
+    testPoolSeparation();
+    testDedicatedAllocation();
+    testBlockRelease();
+    testMemoryTypes();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+    std::cout << "DeviceAllocator tests passed." << std::endl;
+    return 0;
+}
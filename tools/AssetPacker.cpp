@@ -0,0 +1,152 @@
+// Asset packer: packs every OBJ file under a directory into one .vpak asset package.
+//
+// Build with: cmake --build build --target assetPacker
+// Run with:   build\assetPacker.exe <input directory> <output.vpak> [--scale=<s>] [--store] [--block-size=<KiB>]
+//             --store writes the meshes uncompressed (loaded straight from the mapping)
+//
+// Each model gets the processing Scene::loadMesh applies to a fresh OBJ (meshlet
+// triangle order, vertex fetch order, levels of detail), so packaged meshes render
+// exactly like the ones loaded from Models/. Assets are named by their path
+// relative to the input directory, without the extension and with '/' separators
+// (Models/props/crate.obj -> props/crate).
+//
+// All model files are read as one AsyncFileReader batch (io_uring on Linux), and
+// each is parsed as soon as its read lands.
+
+#include "common/AsyncFileReader.h"
+#include "objects/loaders/AssetPackage.h"
+#include "objects/loaders/ObjLoader.h"
+#include "objects/geometry/MeshletBuilder.h"
+#include "objects/geometry/MeshSimplifier.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct PackedMesh {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;
+};
+
+// Parses and processes one model read by AsyncFileReader
+bool processModel(const std::string& filename, const std::vector<char>& text, float scale, PackedMesh& mesh) {
+    ObjLoader::Options options;
+    options.optimizeVertexOrder = false; // MeshletBuilder::optimize() orders the triangles
+    const bool ok = ObjLoader::loadObjFromMemory(filename, text.data(), text.size(), scale, mesh.vertices,
+                                                 mesh.indices, options);
+    if (ok && !mesh.indices.empty()) {
+        MeshletBuilder::optimize(mesh.vertices, mesh.indices);
+        const bool smoothNormals = options.smoothNormals && options.weldVertices;
+        mesh.lods = MeshSimplifier::appendLodChain(mesh.vertices, mesh.indices, MeshSimplifier::DEFAULT_LOD_RATIOS,
+                                                   MeshSimplifier::Options::forNormals(smoothNormals));
+    }
+    return ok && !mesh.indices.empty();
+}
+
+std::string assetName(const std::filesystem::path& root, const std::filesystem::path& file) {
+    std::filesystem::path relative = std::filesystem::relative(file, root);
+    relative.replace_extension();
+    return relative.generic_string();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> positional;
+    float scale = 1.0f;
+    AssetPackage::WriteOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--scale=", 0) == 0) {
+            scale = std::strtof(arg.c_str() + 8, nullptr);
+        } else if (arg == "--store") {
+            options.compress = false;
+        } else if (arg.rfind("--block-size=", 0) == 0) {
+            options.blockSize = static_cast<uint32_t>(std::strtoul(arg.c_str() + 13, nullptr, 10)) * 1024;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2 || scale <= 0.0f) {
+        std::cerr << "Usage: assetPacker <input directory> <output.vpak> [--scale=<s>] [--store] [--block-size=<KiB>]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::filesystem::path root = positional[0];
+
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(root, ec)) {
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (entry.is_regular_file() && extension == ".obj") files.push_back(entry.path());
+    }
+    if (ec || files.empty()) {
+        std::cerr << "No OBJ files found in " << root.string() << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::sort(files.begin(), files.end());
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> paths;
+    for (const auto& file : files) paths.push_back(file.string());
+
+    // Models are parsed as their reads complete, while the rest are still being read.
+    // ObjParser already spreads each file across all cores, so two models at a time
+    // are enough to hide one model's processing behind the other's parse.
+    std::vector<PackedMesh> meshes(files.size());
+    std::vector<std::string> failures(files.size());
+    AsyncFileReader::Options readOptions;
+    readOptions.parseThreads = 2;
+    std::ostringstream sink; // The loader's logging is silenced for the whole batch
+    std::streambuf* previous = std::cout.rdbuf(sink.rdbuf());
+    const AsyncFileReader::Backend backend = AsyncFileReader::readAll(
+        paths,
+        [&](size_t index, std::vector<char>& text, const std::string& readError) {
+            if (!readError.empty()) {
+                failures[index] = readError;
+            } else if (!processModel(paths[index], text, scale, meshes[index])) {
+                failures[index] = "could not load it";
+            }
+        },
+        readOptions);
+    std::cout.rdbuf(previous);
+    std::cout << "Read " << files.size() << " models with "
+              << (backend == AsyncFileReader::Backend::IoUring ? "io_uring" : "reader threads") << std::endl;
+
+    std::vector<AssetPackage::Source> sources;
+    uint64_t rawBytes = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!failures[i].empty()) {
+            std::cerr << "Skipping " << paths[i] << ": " << failures[i] << std::endl;
+            continue;
+        }
+        const PackedMesh& mesh = meshes[i];
+        sources.push_back({assetName(root, files[i]), MeshView(mesh.vertices, mesh.indices, mesh.lods)});
+        rawBytes += mesh.vertices.size() * sizeof(Vertex) + mesh.indices.size() * sizeof(uint32_t);
+        std::cout << sources.back().name << ": " << mesh.vertices.size() << " vertices, "
+                  << mesh.indices.size() / 3 << " triangles" << std::endl;
+    }
+
+    std::string error;
+    if (sources.empty() || !AssetPackage::write(positional[1], sources, options, error)) {
+        std::cerr << "Could not write " << positional[1] << ": " << (sources.empty() ? "nothing to pack" : error)
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const uint64_t packedBytes = std::filesystem::file_size(positional[1], ec);
+    std::cout << "Packed " << sources.size() << " assets into " << positional[1] << ": "
+              << packedBytes / (1024 * 1024) << " MB (" << rawBytes / (1024 * 1024) << " MB of mesh data) in "
+              << seconds << " s" << std::endl;
+    return EXIT_SUCCESS;
+}
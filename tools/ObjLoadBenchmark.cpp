@@ -0,0 +1,149 @@
+// OBJ load benchmark: compares the multithreaded ObjParser against tinyobj::LoadObj.
+//
+// Build with: cmake --build build --target objLoadBenchmark
+// Run with:   build\objLoadBenchmark.exe [runs] [file.obj ...]
+//             (defaults to 5 runs over every .obj in Models/)
+
+#include "objects/loaders/ObjLoader.h"
+#include "objects/loaders/ObjParser.h"
+#include "common/Parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Result {
+    double bestSeconds = 0.0;
+    bool ok = true;
+};
+
+// Runs fn `runs` times and keeps the fastest run, which is the least noisy figure
+template <typename Fn>
+Result timeBest(int runs, Fn&& fn) {
+    Result result;
+    result.bestSeconds = 1e30;
+    for (int run = 0; run < runs; ++run) {
+        auto start = std::chrono::high_resolution_clock::now();
+        bool ok = fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        result.ok = result.ok && ok;
+        result.bestSeconds = std::min(result.bestSeconds, std::chrono::duration<double>(end - start).count());
+    }
+    return result;
+}
+
+// The speed-up column compares against reference (none if null); "n/a" when the reference failed
+void printRow(const std::string& label, const Result& result, double megabytes, const Result* reference) {
+    std::cout << "  " << std::left << std::setw(28) << label << std::right;
+    if (!result.ok) {
+        std::cout << "FAILED" << std::endl;
+        return;
+    }
+    std::cout << std::fixed << std::setprecision(2)
+              << std::setw(10) << result.bestSeconds * 1000.0 << " ms"
+              << std::setw(10) << megabytes / result.bestSeconds << " MB/s";
+    if (reference && (!reference->ok || reference->bestSeconds <= 0.0)) {
+        std::cout << std::setw(9) << "n/a";
+    } else if (reference) {
+        std::cout << std::setw(8) << reference->bestSeconds / result.bestSeconds << "x";
+    }
+    std::cout << std::endl;
+}
+
+// tinyobj parse only, matching what ObjLoader used to do before conversion
+bool parseTinyObj(const std::string& filename) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    return tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename.c_str());
+}
+
+bool parseNative(const std::string& filename) {
+    ObjData data;
+    std::string error;
+    return ObjParser::parseFile(filename, data, error);
+}
+
+// Full ObjLoader::loadObj (parse + welding + normals) with the loader's logging silenced
+bool loadFull(const std::string& filename, bool useTinyObj, bool smoothNormals = true) {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    ObjLoader::Options options;
+    options.useTinyObj = useTinyObj;
+    options.smoothNormals = smoothNormals;
+
+    std::ostringstream sink;
+    std::streambuf* previous = std::cout.rdbuf(sink.rdbuf());
+    bool ok = ObjLoader::loadObj(filename, 1.0f, vertices, indices, options);
+    std::cout.rdbuf(previous);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int runs = 5;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i == 1 && std::all_of(arg.begin(), arg.end(), ::isdigit)) {
+            runs = std::max(1, std::atoi(arg.c_str()));
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.empty()) {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator("Models", ec)) {
+            if (entry.path().extension() == ".obj") files.push_back(entry.path().string());
+        }
+        std::sort(files.begin(), files.end());
+    }
+    if (files.empty()) {
+        std::cerr << "No OBJ files given and none found in Models/" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "OBJ load benchmark: best of " << runs << " runs, "
+              << Parallel::workerCount() << " worker threads" << std::endl;
+
+    bool allOk = true;
+    for (const auto& file : files) {
+        std::error_code ec;
+        const double megabytes = static_cast<double>(std::filesystem::file_size(file, ec)) / (1024.0 * 1024.0);
+        if (ec) {
+            std::cerr << "Cannot stat " << file << std::endl;
+            allOk = false;
+            continue;
+        }
+
+        std::cout << std::endl << file << " (" << std::fixed << std::setprecision(2) << megabytes << " MB)" << std::endl;
+
+        Result tinyParse = timeBest(runs, [&]() { return parseTinyObj(file); });
+        Result nativeParse = timeBest(runs, [&]() { return parseNative(file); });
+        Result tinyLoad = timeBest(runs, [&]() { return loadFull(file, true); });
+        Result nativeLoad = timeBest(runs, [&]() { return loadFull(file, false); });
+        Result flatLoad = timeBest(runs, [&]() { return loadFull(file, false, false); });
+
+        printRow("parse  tinyobj::LoadObj", tinyParse, megabytes, nullptr);
+        printRow("parse  ObjParser", nativeParse, megabytes, &tinyParse);
+        printRow("loadObj (tinyobj)", tinyLoad, megabytes, nullptr);
+        printRow("loadObj (ObjParser)", nativeLoad, megabytes, &tinyLoad);
+        printRow("loadObj (flat normals)", flatLoad, megabytes, &nativeLoad);
+
+        allOk = allOk && tinyParse.ok && nativeParse.ok && tinyLoad.ok && nativeLoad.ok && flatLoad.ok;
+    }
+
+    return allOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}